@@ -77,6 +77,7 @@
 
 // USART communication divider (baudrate = HCLK/div, HCLK=50000000, div=min. 16; 50 at 50MHz -> 1MBaud, 1 byte = 10us)
 //#define CPU_UART_DIV	HCLK_PER_US // USART CPU baudrate divider (baudrate = HCLK/div, HCLK=50000000, div=min. 16)
+#define USE_CPULINK	0	// 1=use framed DMA bulk transfers to CPU2 with LOAD/SAVE (requires CPU2 firmware with USE_CPULINK; check free Flash)
 #define USE_DRAW	0	// 1=use graphics drawing functions
 #define USE_PRINT	0	// 1=use text printing functions
 //#define USE_KEY	1	// 1=use keyboard support
@@ -165,6 +165,9 @@
 #define CPU_CMD_SAVE12	0x3B		// save program to slot 12
 #define CPU_CMD_SAVE13	0x3C		// save program to slot 13
 
+#define CPU_CMD_LINKLOAD 0x40		// framed load of program slot (+ parameter: slot index 0..12, CPU_LINK_FAST flag)
+#define CPU_CMD_LINKSAVE 0x41		// framed save to program slot (+ parameter: slot index 0..12, CPU_LINK_FAST flag)
+
 // ===== Characters
 
 // ZX-80 Character set
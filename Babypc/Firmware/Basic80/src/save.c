@@ -105,6 +105,15 @@ void CmdSave()
 		// lock CPU communication
 		CPU_IntLock();
 
+#if USE_CPULINK
+		// framed transfer (on error continue with byte transfer)
+		if (CPU_LinkSend(CPU_CMD_LINKSAVE, slot - 1, Prog, SLOTNUM))
+		{
+			CPU_IntUnlock();
+			return;
+		}
+#endif
+
 		// send request
 		while (!CPU_SendReady()) {}
 		CPU_Send(CPU_CMD_SAVE1 + slot - 1);
@@ -178,16 +187,22 @@ void CmdLoad()
 		// lock communication
 		CPU_IntLock();
 
-		// send request
-		while (!CPU_SendReady()) {}
-		CPU_Send(CPU_CMD_LOAD1 + slot - 1);
-
-		// load data
-		int i;
-		for (i = 0; i < SLOTNUM; i++)
+#if USE_CPULINK
+		// framed transfer (on error continue with byte transfer)
+		if (!CPU_LinkRecv(CPU_CMD_LINKLOAD, slot - 1, Prog, SLOTNUM))
+#endif
 		{
-			while (!CPU_RecvReady()) {}
-			Prog[i] = CPU_Recv();
+			// send request
+			while (!CPU_SendReady()) {}
+			CPU_Send(CPU_CMD_LOAD1 + slot - 1);
+
+			// load data
+			int i;
+			for (i = 0; i < SLOTNUM; i++)
+			{
+				while (!CPU_RecvReady()) {}
+				Prog[i] = CPU_Recv();
+			}
 		}
 
 		// unlock communication
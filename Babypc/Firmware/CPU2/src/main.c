@@ -35,6 +35,15 @@
 // USART communication divider (baudrate = HCLK/div, HCLK=48000000, div=min. 16; 48 at 48MHz -> 1MBaud, 1 byte = 10us)
 #define CPU_UART_DIV	HCLK_PER_US	// USART CPU baudrate divider (baudrate = HCLK/div, HCLK=48000000, div=min. 16)
 
+// Framed DMA bulk transfers (commands CPU_CMD_LINKLOAD and CPU_CMD_LINKSAVE; CPU1 requires USE_CPULINK too)
+#ifndef USE_CPULINK
+#define USE_CPULINK	0		// 1=use framed DMA bulk transfers
+#endif
+
+#ifndef CPU_LINK_BAUD
+#define CPU_LINK_BAUD	2000000		// baudrate of bulk transfers (must be equal to CPU1)
+#endif
+
 // commands from CPU1 to CPU2
 #define CPU_CMD_SYNC	0x16		// sync - echo CPU_STATE_SYNC back, and set ROW4 to 1
 #define CPU_CMD_ROW41	0x17		// return columns in 2 bytes (in bits 0..4) and set ROW4 to 1
@@ -68,9 +77,20 @@
 #define CPU_CMD_SAVE12	0x3B		// save program to slot 12
 #define CPU_CMD_SAVE13	0x3C		// save program to slot 13
 
+#define CPU_CMD_LINKLOAD 0x40		// framed load of program slot (+ parameter: slot index 0..12, CPU_LINK_FAST flag)
+#define CPU_CMD_LINKSAVE 0x41		// framed save to program slot (+ parameter: slot index 0..12, CPU_LINK_FAST flag)
+
 // state from CPU2 to CPU1
+#define CPU_STATE_ERR	0x14		// framed transfer failed (CRC error or time-out)
 #define CPU_STATE_SYNC	0x15		// sync - echo back after CPU_CMD_SYNC
 
+// framed bulk transfer (see babypc_key.h)
+#define CPU_LINK_FAST	0x80		// parameter flag: transfer data block at CPU_LINK_BAUD
+#define CPU_LINK_WAIT	200		// pause in [us] before data and before CRC (CPU1 can be interrupted by VGA)
+#define CPU_LINK_TIMEOUT (HCLK_PER_US*50000) // time-out of parameter and data block (50 ms)
+#define CPU_LINK_TXDMA	4		// DMA channel of USART1 TX
+#define CPU_LINK_RXDMA	5		// DMA channel of USART1 RX
+
 #include "../include.h"
 
 // receive slot
@@ -110,6 +130,136 @@ u8 CPU_Recv()
 //  7 -> 1 (PC7 -> COL2)
 u16 PortCRemap[256];
 
+// write received slot Slot0 into Flash (inx = slot index 0..12)
+void SlotWrite(int inx)
+{
+	// prepare slot address and size
+	const u8* s;
+	int n;
+	if (inx == SLOTMAX)
+	{
+		s = Slot13;
+		n = 0x0200;
+	}
+	else
+	{
+		s = Slots[inx].data;
+		n = SLOTNUM;
+	}
+
+	// clear flash slot (address and size must be multiply of 256 B)
+	Flash_Erase((u32)s + FLASH_BASE, n, 1000);
+
+	// write program
+	Flash_Program((u32)s + FLASH_BASE, (const u32*)&Slot0, n, 1000);
+}
+
+#if USE_CPULINK		// 1=use framed DMA bulk transfers
+
+// receive parameter of framed command (returns -1 on time-out)
+int CPU_LinkPar()
+{
+	u32 start = Time();
+	while (!CPU_RecvReady())
+	{
+		if ((u32)(Time() - start) >= (u32)CPU_LINK_TIMEOUT) return -1;
+	}
+	return CPU_Recv();
+}
+
+// set baudrate of the link (waits for end of transmission)
+void CPU_LinkBaud(Bool fast)
+{
+	while (!USART1_TxSent()) {}
+	USART1_Baud(fast ? CPU_LINK_BAUD : (RCC_GetFreq(CLK_HCLK) + CPU_UART_DIV/2)/CPU_UART_DIV);
+}
+
+// transfer data by DMA of USART1 and wait for end of transfer (returns False on time-out)
+//  dir = DMA_CFG_DIRFROMMEM or DMA_CFG_DIRFROMPER
+Bool CPU_LinkDma(int ch, const void* buf, int len, u32 dir)
+{
+	DMAchan_t* chan = DMA1_Chan(ch);
+	DMA_Cfg(chan, 0);
+	DMA_PerAddr(chan, &USART1->DATAR);
+	DMA_MemAddr(chan, buf);
+	DMA_Cnt(chan, len);
+	DMA_Cfg(chan, dir | DMA_CFG_EN | DMA_CFG_MEMINC | DMA_CFG_PSIZE_32 |
+		DMA_CFG_MSIZE_8 | DMA_CFG_PRIOR_HIGH);
+
+	u32 start = Time();
+	Bool ok = True;
+	while (DMA_GetCnt(chan) != 0)
+	{
+		if ((u32)(Time() - start) >= (u32)CPU_LINK_TIMEOUT)
+		{
+			ok = False;
+			break;
+		}
+	}
+	DMA_ChanDisable(chan);
+	return ok;
+}
+
+// framed load from slot (par = slot index 0..12 with CPU_LINK_FAST flag)
+void CPU_LinkLoad(int par)
+{
+	// prepare data block into buffer
+	sSlot* s0 = &Slot0;
+	int inx = par & ~CPU_LINK_FAST;
+	if (inx == SLOTMAX)
+	{
+		memcpy(s0->data, Slot13, SLOT13NUM);
+		memset(s0->data + SLOT13NUM, 0xff, SLOTNUM - SLOT13NUM);
+	}
+	else
+		memcpy(s0, &Slots[inx], SLOTNUM);
+	u16 crc = Crc16AFast(s0, SLOTNUM);
+
+	// switch baudrate and wait for CPU1
+	Bool fast = (par & CPU_LINK_FAST) != 0;
+	if (fast) CPU_LinkBaud(True);
+	WaitUs(CPU_LINK_WAIT);
+
+	// send data block
+	USART1_TxDMAEnable();
+	CPU_LinkDma(CPU_LINK_TXDMA, s0, SLOTNUM, DMA_CFG_DIRFROMMEM);
+	USART1_TxDMADisable();
+
+	// send CRC after pause
+	while (!USART1_TxSent()) {}
+	WaitUs(CPU_LINK_WAIT);
+	CPU_Send((u8)crc);
+	CPU_Send((u8)(crc >> 8));
+	if (fast) CPU_LinkBaud(False);
+}
+
+// framed save to slot (par = slot index 0..12 with CPU_LINK_FAST flag)
+void CPU_LinkSave(int par)
+{
+	// switch baudrate
+	Bool fast = (par & CPU_LINK_FAST) != 0;
+	if (fast) CPU_LinkBaud(True);
+
+	// receive data block and CRC
+	sSlot* s0 = &Slot0;
+	u16 crc = 0;
+	USART1_RxDMAEnable();
+	Bool ok = CPU_LinkDma(CPU_LINK_RXDMA, s0, SLOTNUM, DMA_CFG_DIRFROMPER);
+	if (ok) ok = CPU_LinkDma(CPU_LINK_RXDMA, &crc, 2, DMA_CFG_DIRFROMPER);
+	USART1_RxDMADisable();
+	if (fast) CPU_LinkBaud(False);
+
+	// check CRC and write program
+	ok = ok && (crc == Crc16AFast(s0, SLOTNUM));
+	if (ok) SlotWrite(par & ~CPU_LINK_FAST);
+
+	// send result after pause (CPU1 returns to base baudrate)
+	WaitUs(CPU_LINK_WAIT);
+	CPU_Send(ok ? CPU_STATE_SYNC : CPU_STATE_ERR);
+}
+
+#endif // USE_CPULINK
+
 int main(void)
 {
 	u8 ch, ra, rc, rd;
@@ -187,6 +337,11 @@ int main(void)
 	GPIO_Mode(PD5, GPIO_MODE_AF);		// TX
 	GPIO_Mode(PD6, GPIO_MODE_IN);		// RX
 
+#if USE_CPULINK
+	// initialize DMA clock for framed transfers
+	RCC_DMA1ClkEnable();
+#endif
+
 	while(True)
 	{
 		if (CPU_RecvReady() && CPU_SendReady())
@@ -292,31 +447,28 @@ int main(void)
 						s0->data[i] = CPU_Recv();
 					}
 
-					// prepare slot address and size
-					const u8* s;
-					int n;
-					if (ch == CPU_CMD_SAVE13)
-					{
-						s = Slot13;
-						n = 0x0200;
-					}
-					else
-					{
-						s = Slots[ch - CPU_CMD_SAVE1].data;
-						n = SLOTNUM;
-					}
-
-					// clear flash slot (address and size must be multiply of 256 B)
-					Flash_Erase((u32)s + FLASH_BASE, n, 1000);
-
 					// write program
-					Flash_Program((u32)s + FLASH_BASE, (const u32*)s0, n, 1000);
+					SlotWrite(ch - CPU_CMD_SAVE1);
 
 					// send OK
 					while (!CPU_SendReady()) {}
 					CPU_Send(CPU_STATE_SYNC);
 				}
 				break;
+
+#if USE_CPULINK
+			// framed load from slot
+			case CPU_CMD_LINKLOAD:
+				r = CPU_LinkPar();
+				if ((r & ~CPU_LINK_FAST) <= SLOTMAX) CPU_LinkLoad(r);
+				break;
+
+			// framed save to slot
+			case CPU_CMD_LINKSAVE:
+				r = CPU_LinkPar();
+				if ((r & ~CPU_LINK_FAST) <= SLOTMAX) CPU_LinkSave(r);
+				break;
+#endif
 			}
 		}
 	}
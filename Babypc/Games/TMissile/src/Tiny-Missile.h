@@ -4,7 +4,7 @@
 
 //Public VAR
 extern unsigned long currentMillis;
-extern unsigned long MemMillis;
+extern u32 MemMillis;
 extern uint8_t RDLP;
 extern uint8_t START_RDLP;
 
@@ -35,7 +35,7 @@ extern uint8_t D_CHANGE_TPIPE;
 extern uint8_t D_CHANGE_B_TPIPE;
 
 extern unsigned long currentMillis;
-extern unsigned long MemMillis;
+extern u32 MemMillis;
 
 extern GamePlay_TPIPE GP;
 
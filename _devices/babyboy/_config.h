@@ -37,6 +37,10 @@
 #define USE_KEY		1	// 1=use keyboard support
 #endif
 
+#ifndef USE_KEY_EXTI
+#define USE_KEY_EXTI	0	// 1=use edge interrupts (EXTI) for keyboard instead of polling the pins
+#endif
+
 #ifndef USE_SOUND
 #define USE_SOUND	2	// use sound support 1=tone, 2=melody
 #endif
@@ -45,6 +49,10 @@
 #define KEYCNT_REL	50	// keyboard counter - release interval in [ms]
 #endif
 
+#ifndef KEYCNT_DEB
+#define KEYCNT_DEB	5	// keyboard counter - press debounce interval in [ms] (with USE_KEY_EXTI)
+#endif
+
 #ifndef KEYCNT_PRESS
 #define KEYCNT_PRESS	400	// keyboard counter - first repeat in [ms]
 #endif
@@ -81,6 +89,18 @@
 #define USE_FAT		0	// 1=use FAT filesystem
 #endif
 
+#ifndef USE_FIX
+#define USE_FIX		1	// 1=use fixed-point math library
+#endif
+
+#ifndef USE_KVS
+#define USE_KVS		0	// 1=use key/value store in Flash (requires USE_FLASH and USE_CRC)
+#endif
+
+#ifndef USE_MUSIC
+#define USE_MUSIC	0	// 1=use music player (requires USE_SOUND=2 or higher)
+#endif
+
 #ifndef USE_RAND
 #define USE_RAND	1	// 1=use random number generator
 #endif
@@ -93,10 +113,18 @@
 #define USE_ADC		0	// 1=use ADC peripheral
 #endif
 
+#ifndef USE_ADCSCAN
+#define USE_ADCSCAN	0	// 1=use continuous ADC scanning with DMA and oversampling (requires USE_ADC and USE_DMA)
+#endif
+
 #ifndef USE_DMA
 #define USE_DMA		0	// 1=use DMA peripheral
 #endif
 
+#ifndef USE_DMAQ
+#define USE_DMAQ	0	// 1=use asynchronous DMA memory copy and fill (requires USE_DMA)
+#endif
+
 #ifndef USE_FLASH
 #define USE_FLASH	1	// 1=use Flash programming
 #endif
@@ -105,6 +133,10 @@
 #define USE_I2C		0	// 1=use I2C peripheral
 #endif
 
+#ifndef USE_I2CQ
+#define USE_I2CQ	0	// 1=use interrupt driven I2C master with transaction queue (requires USE_I2C)
+#endif
+
 #ifndef USE_IRQ
 #define USE_IRQ		1	// 1=use IRQ interrupt support
 #endif
@@ -113,10 +145,34 @@
 #define USE_PWR		1	// 1=use power control
 #endif
 
+#ifndef USE_PROF
+#define USE_PROF	0	// 1=use sampling PC profiler (requires USE_TIM and USE_USART)
+#endif
+
+#ifndef USE_RCCSPEED
+#define USE_RCCSPEED	0	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+#endif
+
 #ifndef USE_SPI
 #define USE_SPI		0	// 1=use SPI peripheral
 #endif
 
+#ifndef USE_SPIDMA
+#define USE_SPIDMA	0	// 1=use SPI DMA transfer (requires USE_SPI and USE_DMA)
+#endif
+
+#ifndef USE_SWTIMER
+#define USE_SWTIMER	0	// 1=use software timers (timer wheel)
+#endif
+
+#ifndef USE_TASK
+#define USE_TASK	0	// 1=use cooperative task scheduler
+#endif
+
+#ifndef USE_TASK_STACK
+#define USE_TASK_STACK	0	// 1=use tasks with own stack (requires USE_TASK; for CH32V2, CH32V3)
+#endif
+
 #ifndef USE_TIM
 #define USE_TIM		1	// 1=use timers
 #endif
@@ -125,6 +181,10 @@
 #define USE_USART	1	// 1=use USART peripheral
 #endif
 
+#ifndef USE_USARTBUF
+#define USE_USARTBUF	0	// 1=use buffered USART driver with DMA ring buffers (requires USE_USART and USE_DMA)
+#endif
+
 // ----------------------------------------------------------------------------
 //                            Clock Setup
 // ----------------------------------------------------------------------------
@@ -165,6 +225,14 @@
 #define SYSTICK_MS	16
 #endif
 
+#ifndef SYSTICK_TICKLESS
+#define SYSTICK_TICKLESS 0	// 1=tickless mode, SysTick interrupt only when needed and WaitMs() sleeps (saves power)
+#endif
+
+#ifndef SYSTICK_IDLE_MS
+#define SYSTICK_IDLE_MS	(SYSTICK_MS*3)	// idle interval of SysTick in tickless mode in [ms] (= polling of released keys)
+#endif
+
 // ----------------------------------------------------------------------------
 //                          Peripheral clock enable
 // ----------------------------------------------------------------------------
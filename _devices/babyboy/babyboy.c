@@ -1,10 +1,16 @@
 
 #include "../../includes.h"
 
+#if USE_HOST
+#include "babyboy_host.c"
+#include "babyboy_draw.c"
+#include "babyboy_snd.c"
+#else
 #include "babyboy_disp.c"
 #include "babyboy_draw.c"
 #include "babyboy_key.c"
 #include "babyboy_snd.c"
 #include "babyboy_init.c"
+#endif
 
 
@@ -67,6 +67,27 @@ const u8 DispI2C_InitData[] = {
 	0xAF,			// display on
 };
 
+#if (USE_DISP == 2) && USE_I2CQ	// hardware display driver with I2C transaction queue
+
+// SSD1306 page select commands
+const u8 DispQ_PageCmd[8][4] = {
+	{ 0, 0xb0, 0x00, 0x10 },	// control byte for command, select page, set low and high column to 0
+	{ 0, 0xb1, 0x00, 0x10 },
+	{ 0, 0xb2, 0x00, 0x10 },
+	{ 0, 0xb3, 0x00, 0x10 },
+	{ 0, 0xb4, 0x00, 0x10 },
+	{ 0, 0xb5, 0x00, 0x10 },
+	{ 0, 0xb6, 0x00, 0x10 },
+	{ 0, 0xb7, 0x00, 0x10 },
+};
+
+// transactions and data buffers of 2 pages (one page is prepared while the other is sent)
+sI2cqTrans DispQ_Cmd[2];	// page select commands
+sI2cqTrans DispQ_Data[2];	// page data
+u8 DispQ_Buf[2][WIDTH+1];	// page data with control byte
+
+#endif
+
 // start I2C communication (on start, SDA and SCL must be high)
 void DispI2C_Start(void)
 {
@@ -83,6 +104,11 @@ void DispI2C_Start(void)
 #else
 // Hardware driver:
 
+#if USE_I2CQ
+	// wait for queued transactions
+	I2cqFlush();
+#endif
+
 	// sent start bit, start master mode
 	I2C1_StartEnable();
 
@@ -212,6 +238,11 @@ static void _DispI2C_SelectPage(int page)
 #else
 // Hardware driver:
 
+#if USE_I2CQ
+	// wait for queued transactions
+	I2cqFlush();
+#endif
+
 	// select page
 	I2C1_SendAddr(DISP_I2C_ADDR, I2C_DIR_WRITE); // send address, write mode
 	I2C1_WriteWait(0);			// control byte for command
@@ -275,6 +306,16 @@ void DispInit(void)
 	GPIO_Mode(DISP_SDA_GPIO, GPIO_MODE_AFOD);
 	GPIO_Mode(DISP_SCL_GPIO, GPIO_MODE_AFOD);
 
+#if USE_I2CQ
+	// Initialize I2C transaction queue
+	I2cqInit(DISP_SPEED_HZ, DISP_SDA_GPIO, DISP_SCL_GPIO);
+
+	// wait to stabilize power supply of OLED, minimum 5ms
+	WaitMs(10);
+
+	// OLED configuration
+	I2cqTransfer(DISP_I2C_ADDR, DispI2C_InitData + 1, count_of(DispI2C_InitData) - 1, NULL, 0); // send data, without address
+#else
 	// Initialize I2C interface
 	I2C1_Init(DISP_I2C_ADDR, DISP_SPEED_HZ);
 
@@ -285,6 +326,7 @@ void DispInit(void)
 	I2C1_SendAddr(DISP_I2C_ADDR, I2C_DIR_WRITE); // send address, write mode
 	I2C1_SendData(DispI2C_InitData + 1, count_of(DispI2C_InitData) - 1); // send data, without address
 	I2C1_StopEnable();			// stop transfer
+#endif
 
 #endif
 
@@ -300,12 +342,71 @@ void DispTerm(void)
 
 #if USE_DISP == 2	// 1=use software display driver, 2=use hardware display driver (0=no driver)
 
+#if USE_I2CQ
+	// terminate I2C transaction queue
+	I2cqTerm();
+#endif
+
 	// reset I2C
 	I2C1_Reset();
 
 #endif
 }
 
+#if (USE_DISP == 2) && USE_I2CQ	// hardware display driver with I2C transaction queue
+
+// Display update - send frame buffer to the display
+//  Pages are sent by I2C transaction queue, the function returns after the last page
+//  is queued and frame buffer can be changed immediately.
+void DispUpdate()
+{
+	int x, y, m;
+	for (y = 0; y < 8; y++)
+	{
+		// wait for previous page of this buffer
+		int i = y & 1;
+		sI2cqTrans* t = &DispQ_Data[i];
+		I2cqWait(t);
+
+		// prepare page data
+		u8* d = DispQ_Buf[i];
+		*d++ = 0x40;				// control byte to start transfer data
+		const u8* s = &FrameBuf[y*8*WIDTHBYTE];
+		for (x = 0; x < 16; x++)
+		{
+			for (m = 0x80; m != 0; m >>= 1)
+			{
+				u8 b = 0;
+				if ((s[0*WIDTHBYTE] & m) != 0) b |= B0;
+				if ((s[1*WIDTHBYTE] & m) != 0) b |= B1;
+				if ((s[2*WIDTHBYTE] & m) != 0) b |= B2;
+				if ((s[3*WIDTHBYTE] & m) != 0) b |= B3;
+				if ((s[4*WIDTHBYTE] & m) != 0) b |= B4;
+				if ((s[5*WIDTHBYTE] & m) != 0) b |= B5;
+				if ((s[6*WIDTHBYTE] & m) != 0) b |= B6;
+				if ((s[7*WIDTHBYTE] & m) != 0) b |= B7;
+				*d++ = b;
+			}
+			s++;
+		}
+
+		// queue page select
+		sI2cqTrans* c = &DispQ_Cmd[i];
+		c->wbuf = DispQ_PageCmd[y];
+		c->wlen = 4;
+		c->addr = DISP_I2C_ADDR;
+		I2cqAdd(c);
+
+		// queue page data
+		t->wbuf = DispQ_Buf[i];
+		t->wlen = WIDTH+1;
+		t->addr = DISP_I2C_ADDR;
+		I2cqAdd(t);
+	}
+}
+
+#else // USE_I2CQ
+
 // Display update - send frame buffer to the display (takes 15 ms)
 void DispUpdate()
 {
@@ -335,4 +436,6 @@ void DispUpdate()
 	}
 }
 
+#endif // USE_I2CQ
+
 #endif // USE_DISP
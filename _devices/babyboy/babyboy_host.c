@@ -0,0 +1,315 @@
+// ****************************************************************************
+//
+//                     BabyBoy - Host emulation of the device
+//
+// ****************************************************************************
+// Used instead of display, keyboard, sound and init drivers in host build (USE_HOST=1).
+
+#include "../../includes.h"
+
+#if USE_HOST
+
+// names of the keys (index = key code)
+const char* const HostKeyName[] = { "", "RIGHT", "UP", "LEFT", "DOWN", "A", "B", NULL };
+
+// device time service
+void HostDevTime(void) {}
+
+// ----------------------------------------------------------------------------
+//                               Display
+// ----------------------------------------------------------------------------
+
+#if USE_DISP		// 1=use software display driver, 2=use hardware display driver (0=no driver)
+
+u8 FrameBuf[FRAMESIZE];		// display graphics buffer
+
+// emulated SSD1306 display memory (8 pages of 128 columns, 1 byte = 8 vertical pixels)
+u8 HostDispMem[WIDTH*HEIGHT/8];
+int HostDispPage = 0;		// current output page
+int HostDispX = 0;		// current output column
+Bool HostDispDirty = False;	// display memory was changed since last frame
+
+// time of sending one byte to the display (DispUpdate takes 11 ms on the device)
+#define HOST_DISP_BYTE_CLK	(11*HCLK_PER_MS/(WIDTH*HEIGHT/8))
+
+const int HostDispW = WIDTH;	// width of display image
+const int HostDispH = HEIGHT;	// height of display image
+
+// render display image to RGB buffer
+void HostRender(u8* rgb)
+{
+	int x, y;
+	u8 c;
+	for (y = 0; y < HEIGHT; y++)
+	{
+		for (x = 0; x < WIDTH; x++)
+		{
+			c = ((HostDispMem[x + (y>>3)*WIDTH] >> (y & 7)) & 1) ? 255 : 0;
+			*rgb++ = c;
+			*rgb++ = c;
+			*rgb++ = c;
+		}
+	}
+}
+
+// start I2C communication
+void DispI2C_Start(void) {}
+
+// stop I2C communcation
+void DispI2C_Stop(void) {}
+
+// write a data byte to the display
+void DispI2C_Write(u8 data)
+{
+	HostTick(HOST_DISP_BYTE_CLK);
+	if (HostDispX < WIDTH) HostDispMem[HostDispX + HostDispPage*WIDTH] = data;
+	HostDispX++;
+	HostDispDirty = True;
+}
+
+// Display select SSD1306 page 0..7, start transfer data
+// - Returning to a previous page starts a new frame, so the finished frame is displayed.
+void DispI2C_SelectPage(int page)
+{
+	page &= 7;
+	if (HostDispDirty && (page <= HostDispPage))
+	{
+		HostDispDirty = False;
+		HostFrame();
+	}
+	HostDispPage = page;
+	HostDispX = 0;
+}
+
+// Display initialize
+void DispInit(void)
+{
+	memset(HostDispMem, 0, sizeof(HostDispMem));
+}
+
+// Display terminate
+void DispTerm(void) {}
+
+// Display update - send frame buffer to the display
+void DispUpdate()
+{
+	int page, x, i;
+	u8 data;
+	const u8* s;
+	for (page = 0; page < HEIGHT/8; page++)
+	{
+		DispI2C_SelectPage(page);
+		for (x = 0; x < WIDTH; x++)
+		{
+			// convert 8 vertical pixels of the frame buffer to one display byte
+			s = &FrameBuf[(x >> 3) + page*8*WIDTHBYTE];
+			data = 0;
+			for (i = 0; i < 8; i++) if ((s[i*WIDTHBYTE] & (0x80 >> (x & 7))) != 0) data |= BIT(i);
+			DispI2C_Write(data);
+		}
+	}
+	HostDispDirty = False;
+	HostFrame();
+}
+
+#else
+
+const int HostDispW = 1;
+const int HostDispH = 1;
+void HostRender(u8* rgb) { rgb[0] = rgb[1] = rgb[2] = 0; }
+
+#endif // USE_DISP
+
+// ----------------------------------------------------------------------------
+//                              Keyboard
+// ----------------------------------------------------------------------------
+
+#if USE_KEY		// 1=use keyboard support
+
+Bool KeyInitOk = False;		// keyboard initialized
+u32 KeyLastPress[KEY_NUM];
+u32 KeyLastRelease[KEY_NUM];
+volatile Bool KeyPressMap[KEY_NUM]; // keys are currently pressed (index = button code - 1)
+u8 KeyBuf[KEYBUF_SIZE];		// keyboard buffer
+volatile u8 KeyWriteOff = 0;	// write offset to keyboard buffer
+volatile u8 KeyReadOff = 0;	// read offset from keyboard buffer
+
+// write key to keyboard buffer
+void KeyWriteKey(u8 key)
+{
+	u8 w = KeyWriteOff;
+	u8 w2 = w + 1;
+	if (w2 >= KEYBUF_SIZE) w2 = 0;
+	if (w2 != KeyReadOff)
+	{
+		KeyBuf[w] = key;
+		KeyWriteOff = w2;
+	}
+}
+
+// scan keys (buttons are pressed by the key script)
+void KeyScan()
+{
+	if (!KeyInitOk) return; // keyboard not initialized
+
+	int i;
+	u32 t = (u32)HostClk; // time in ticks
+	for (i = 0; i < KEY_NUM; i++)
+	{
+		// check if button is pressed
+		if ((HostKeys & BIT64(i+1)) != 0)
+		{
+			// button is pressed for the first time
+			if (!KeyPressMap[i])
+			{
+				KeyLastPress[i] = t + (KEYCNT_PRESS - KEYCNT_REPEAT)*1000*HCLK_PER_US;
+				KeyPressMap[i] = True;
+				KeyWriteKey(i+1);
+			}
+
+			// button is already pressed - check repeat interval
+			else
+			{
+				if ((s32)(t - KeyLastPress[i]) >= (s32)(KEYCNT_REPEAT*1000*HCLK_PER_US))
+				{
+					KeyLastPress[i] = t;
+					KeyWriteKey(i+1);
+				}
+			}
+			KeyLastRelease[i] = t;
+		}
+
+		// button is release - check stop of press
+		else
+		{
+			if (KeyPressMap[i])
+			{
+				if ((s32)(t - KeyLastRelease[i]) >= (s32)(KEYCNT_REL*1000*HCLK_PER_US))
+				{
+					KeyPressMap[i] = False;
+				}
+			}
+		}
+	}
+}
+
+// get button from keyboard buffer KEY_* (returns NOKEY if no key)
+u8 KeyGet()
+{
+	HostPoll();
+
+	// check if keyboard buffer is empty
+	u8 r = KeyReadOff;
+	if (r == KeyWriteOff) return NOKEY;
+
+	// get key from keyboard buffer
+	u8 ch = KeyBuf[r];
+
+	// write new read offset
+	r++;
+	if (r >= KEYBUF_SIZE) r = 0;
+	KeyReadOff = r;
+	return ch;
+}
+
+// key flush
+void KeyFlush()
+{
+	while (KeyGet() != NOKEY) {}
+}
+
+// check no pressed key
+Bool KeyNoPressed()
+{
+	HostPoll();
+	int i;
+	for (i = 0; i < KEY_NUM; i++) if (KeyPressMap[i]) return False;
+	return True;
+}
+
+// wait for no key pressed
+void KeyWaitNoPressed()
+{
+	while (!KeyNoPressed()) {}
+}
+
+// Initialize keyboard service
+void KeyInit()
+{
+	KeyWriteOff = 0;
+	KeyReadOff = 0;
+	int i;
+	for (i = 0; i < KEY_NUM; i++) KeyPressMap[i] = False;
+	KeyInitOk = True; // keyboard initialized
+}
+
+// terminate keyboard
+void KeyTerm()
+{
+	KeyInitOk = False; // keyboard not initialized
+}
+
+#endif // USE_KEY
+
+// ----------------------------------------------------------------------------
+//                                Sound
+// ----------------------------------------------------------------------------
+
+#if USE_SOUND		// use sound support 1=tone, 2=melody
+
+// Sound initialize
+void SoundInit() {}
+
+// Sound terminate
+void SoundTerm() { HostSound(0); }
+
+// Start playing tone with divider (frequency of time base is 1 MHz)
+void PlayTone(u32 div)
+{
+	HostSound(100000000/(div+1));
+}
+
+// stop tone output
+static void SoundToneOff() { HostSound(0); }
+
+// Melody, sound effects and music are played by babyboy_snd.c, included after this file.
+
+#endif // USE_SOUND
+
+// ----------------------------------------------------------------------------
+//                             Device init
+// ----------------------------------------------------------------------------
+
+// Initialize device
+void DevInit()
+{
+#if USE_KEY		// 1=use keyboard support
+	KeyInit();
+#endif
+
+#if USE_SOUND		// use sound support 1=tone, 2=melody
+	SoundInit();
+#endif
+
+#if USE_DISP		// 1=use display support
+	DispInit();
+#endif
+
+#if USE_DRAW || USE_PRINT
+	DrawClear();
+#endif
+}
+
+// Terminate device
+void DevTerm()
+{
+#if USE_SOUND		// use sound support 1=tone, 2=melody
+	SoundTerm();
+#endif
+
+#if USE_KEY		// 1=use keyboard support
+	KeyTerm();
+#endif
+}
+
+#endif // USE_HOST
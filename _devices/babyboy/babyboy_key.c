@@ -53,6 +53,136 @@ void KeyWriteKey(u8 key)
 //#define KEYCNT_PRESS	400	// keyboard counter - first repeat in [ms]
 //#define KEYCNT_REPEAT	100	// keyboard counter - next repeat in [ms]
 
+#if USE_KEY_EXTI	// 1=use edge interrupts (EXTI) for keyboard instead of polling the pins
+
+// Keys are served by edge interrupts EXTI. The interrupt only saves time of the edge.
+// KeyScan() (from SysTick) starts one-shot timer of debounce after the edge, and then
+// timer of repeat while the key is held. Without edges and without held key, KeyScan()
+// does no work. One EXTI line can be mapped to one port only - a key on line already
+// used by other key (B on PD7 shares line 7 with DOWN on PC7) is polled by KeyScan().
+
+u8 KeyLineKey[8];		// key index of EXTI lines 0..7
+u8 KeyLineMask;			// mask of used EXTI lines
+u8 KeyPollMask;			// mask of keys without EXTI line, which must be polled
+u8 KeyPollLevel;		// last state of polled keys (bit = 1 if key is pressed)
+volatile u8 KeyEdge;		// mask of keys with new edge (set by EXTI interrupt)
+u32 KeyEdgeTime[KEY_NUM];	// time of last edge in ticks
+u8 KeyActive;			// mask of keys with running timer (debounce or repeat)
+u8 KeyDeb;			// mask of keys with running debounce timer
+u32 KeyTimer[KEY_NUM];		// expiration time of key timer in ticks
+
+// EXTI interrupt - save time of the edge
+HANDLER void EXTI7_0_IRQHandler()
+{
+	u32 t = Time();
+	u32 pend = EXTI->INTFR & KeyLineMask;
+	EXTI->INTFR = pend;
+
+	int line;
+	u8 edge = 0;
+	for (line = 0; pend != 0; line++, pend >>= 1)
+	{
+		if ((pend & 1) != 0)
+		{
+			int i = KeyLineKey[line];
+			KeyEdgeTime[i] = t;
+			edge |= BIT(i);
+		}
+	}
+	KeyEdge |= edge;
+
+	// restart SysTick time steps in tickless mode
+	SysTick_Wake();
+}
+
+// start debounce timer after edge of the key
+static void KeyStartDeb(int i, u32 t)
+{
+	// pressed key must be stable released for KEYCNT_REL, new press for KEYCNT_DEB
+	KeyTimer[i] = t + (KeyPressMap[i] ? KEYCNT_REL : KEYCNT_DEB)*1000*HCLK_PER_US;
+	KeyActive |= BIT(i);
+	KeyDeb |= BIT(i);
+}
+
+// scan keys (timer service, called from SysTick)
+void KeyScan()
+{
+	if (!KeyInitOk) return; // keyboard not initialized
+
+	int i;
+	u8 m;
+	u32 t = Time(); // time in ticks
+
+	// new edges from EXTI interrupt (EXTI has lower priority than SysTick, cannot interrupt us)
+	m = KeyEdge;
+	if (m != 0)
+	{
+		KeyEdge = 0;
+		for (i = 0; i < KEY_NUM; i++) if ((m & BIT(i)) != 0) KeyStartDeb(i, KeyEdgeTime[i]);
+	}
+
+	// polled keys - change of state starts debounce
+	m = KeyPollMask;
+	if (m != 0)
+	{
+		for (i = 0; i < KEY_NUM; i++)
+		{
+			if ((m & BIT(i)) != 0)
+			{
+				u8 lev = (GPIO_In(KeyGpioTab[i]) == 0) ? BIT(i) : 0;
+				if (((KeyPollLevel ^ lev) & BIT(i)) != 0)
+				{
+					KeyPollLevel ^= BIT(i);
+					KeyStartDeb(i, t);
+				}
+			}
+		}
+	}
+
+	// service of running timers
+	m = KeyActive;
+	if (m == 0) return;
+	for (i = 0; i < KEY_NUM; i++)
+	{
+		if (((m & BIT(i)) == 0) || ((s32)(t - KeyTimer[i]) < 0)) continue;
+
+		// button is pressed
+		if (GPIO_In(KeyGpioTab[i]) == 0)
+		{
+			// end of debounce of new press - output key and start first repeat
+			if (!KeyPressMap[i])
+			{
+				KeyPressMap[i] = True;
+				KeyWriteKey(i+1);
+				KeyTimer[i] = t + KEYCNT_PRESS*1000*HCLK_PER_US;
+			}
+
+			// end of debounce of held key (noise) - continue repeat
+			else if ((KeyDeb & BIT(i)) != 0)
+				KeyTimer[i] = t + KEYCNT_REPEAT*1000*HCLK_PER_US;
+
+			// repeat
+			else
+			{
+				KeyWriteKey(i+1);
+				KeyTimer[i] += KEYCNT_REPEAT*1000*HCLK_PER_US;
+				if ((s32)(t - KeyTimer[i]) >= 0) KeyTimer[i] = t + KEYCNT_REPEAT*1000*HCLK_PER_US;
+			}
+			KeyDeb &= ~BIT(i);
+		}
+
+		// button is released - stop timer
+		else
+		{
+			KeyPressMap[i] = False;
+			KeyActive &= ~BIT(i);
+			KeyDeb &= ~BIT(i);
+		}
+	}
+}
+
+#else // USE_KEY_EXTI
+
 // scan keys
 void KeyScan()
 {
@@ -99,6 +229,8 @@ void KeyScan()
 	}
 }
 
+#endif // USE_KEY_EXTI
+
 // get button from keyboard buffer KEY_* (returns NOKEY if no key)
 u8 KeyGet()
 {
@@ -132,6 +264,16 @@ Bool KeyNoPressed()
 	return True;
 }
 
+// check if keyboard service needs SysTick time steps (debounce, repeat or release is in progress)
+Bool KeyBusy()
+{
+#if USE_KEY_EXTI	// 1=use edge interrupts (EXTI) for keyboard instead of polling the pins
+	return (KeyActive | KeyEdge) != 0;
+#else
+	return !KeyNoPressed();
+#endif
+}
+
 // wait for no key pressed
 void KeyWaitNoPressed()
 {
@@ -165,6 +307,42 @@ void KeyInit()
 		KeyPressMap[i] = False;
 	}
 
+#if USE_KEY_EXTI	// 1=use edge interrupts (EXTI) for keyboard instead of polling the pins
+	// map keys to EXTI lines, keys on already used lines will be polled
+	KeyLineMask = 0;
+	KeyPollMask = 0;
+	KeyPollLevel = 0;
+	KeyEdge = 0;
+	KeyActive = 0;
+	KeyDeb = 0;
+	RCC_AFIClkEnable();
+	for (i = 0; i < KEY_NUM; i++)
+	{
+		int gpio = KeyGpioTab[i];
+		int line = GPIO_PIN(gpio);
+		if ((KeyLineMask & BIT(line)) != 0)
+			KeyPollMask |= BIT(i);
+		else
+		{
+			KeyLineMask |= BIT(line);
+			KeyLineKey[line] = (u8)i;
+			GPIO_EXTILine(GPIO_PORTINX(gpio), line);
+			EXTI_RiseEnable(line);
+			EXTI_FallEnable(line);
+			EXTI_Clear(line);
+			EXTI_Enable(line);
+		}
+
+		// key held during initialization
+		if (GPIO_In(gpio) == 0)
+		{
+			KeyPollLevel |= BIT(i) & KeyPollMask;
+			KeyStartDeb(i, Time());
+		}
+	}
+	NVIC_IRQEnable(IRQ_EXTI7);
+#endif
+
 	KeyInitOk = True; // keyboard initialized
 }
 
@@ -174,6 +352,23 @@ void KeyTerm()
 	KeyInitOk = False; // keyboard not initialized
 	cb();
 	int i;
+
+#if USE_KEY_EXTI	// 1=use edge interrupts (EXTI) for keyboard instead of polling the pins
+	// disable EXTI lines
+	NVIC_IRQDisable(IRQ_EXTI7);
+	for (i = 0; i < 8; i++)
+	{
+		if ((KeyLineMask & BIT(i)) != 0)
+		{
+			EXTI_Disable(i);
+			EXTI_RiseDisable(i);
+			EXTI_FallDisable(i);
+			EXTI_Clear(i);
+		}
+	}
+	KeyLineMask = 0;
+#endif
+
 	for (i = 0; i < KEY_NUM; i++) GPIO_PinReset(KeyGpioTab[i]);
 }
 
@@ -8,6 +8,12 @@
 #define VMODE	1
 #endif
 
+// Double buffering: 1=use 2 display buffers, draw into FrameBuf and show it with DispSwapBuffers()
+// (requires twice the memory of the videomode)
+#ifndef DISP_DBLBUF
+#define DISP_DBLBUF	0
+#endif
+
 // default device setup
 #ifndef USE_DRAW
 #define USE_DRAW	1	// 1=use graphics drawing functions
@@ -1,10 +1,15 @@
 
 #include "../../includes.h"
 
+#if USE_HOST
+#include "babypad_host.c"
+#include "babypad_draw.c"
+#else
 #include "babypad_vga.c"
 #include "babypad_draw.c"
 #include "babypad_key.c"
 #include "babypad_snd.c"
 #include "babypad_init.c"
+#endif
 
 
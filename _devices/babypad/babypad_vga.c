@@ -9,9 +9,29 @@
 
 #if USE_DISP		// 1=use display support
 
+#if USE_PROF && (PROF_IRQ == IRQ_TIM2)
+#error "Profiler (USE_PROF) cannot use TIM2 of VGA synchronization - set PROF_TIM, PROF_IRQ and PROF_HANDLER (TIM1 if USE_SOUND = 0)"
+#endif
+
+#if DISP_DBLBUF
+u8 FrameBuf1[FRAMESIZE];	// display graphics buffer 1
+u8 FrameBuf2[FRAMESIZE];	// display graphics buffer 2
+u8* FrameBuf = FrameBuf2;	// display graphics buffer - back buffer to draw into
+u8* volatile FrameBufDisp = FrameBuf1; // display graphics buffer - front buffer being displayed
+#if VMODE == 2
+u8 AttrBuf1[ATTRSIZE];		// display attribute buffer 1
+u8 AttrBuf2[ATTRSIZE];		// display attribute buffer 2
+u8* AttrBuf = AttrBuf2;		// display attribute buffer - back buffer to draw into
+u8* volatile AttrBufDisp = AttrBuf1; // display attribute buffer - front buffer being displayed
+#endif
+u32 DispSwapFrame;		// frame of last buffer swap
+#else
 u8 FrameBuf[FRAMESIZE];		// display graphics buffer
 #if VMODE == 2
 u8 AttrBuf[ATTRSIZE];		// display attribute buffer (1 bit = high level of white color)
+#endif
+#endif
+#if VMODE == 2
 volatile u8* AttrBufAddr;	// current pointer to attribute buffer
 #endif
 volatile u32 DispLine;		// current display line
@@ -26,14 +46,49 @@ void WaitVSync()
 	while (!DispIsVSync()) {}
 }
 
+#if DISP_DBLBUF
+// swap display buffers - show drawn back buffer FrameBuf (and AttrBuf) and draw into the other buffer
+void DispSwapBuffers()
+{
+	// previous buffer has not been displayed yet, wait for start of next frame
+	while (DispFrame == DispSwapFrame) {}
+
+	// set new front buffers - single word writes, interrupt takes them at start of next frame
+	u8* oldframe = FrameBufDisp;
+	FrameBufDisp = FrameBuf;
+#if VMODE == 2
+	u8* oldattr = AttrBufDisp;
+	AttrBufDisp = AttrBuf;
+#endif
+
+	// wait for vertical blanking - old buffers are no longer displayed
+	while (!DispIsVSync()) {}
+	DispSwapFrame = DispFrame;
+
+	// draw into old buffers
+	FrameBuf = oldframe;
+#if VMODE == 2
+	AttrBuf = oldattr;
+#endif
+}
+#endif
+
 // Initialize videomode
 void DispInit()
 {
 	DispLine = 0;			// current display line
+#if DISP_DBLBUF
+#if VMODE == 2
+	AttrBufAddr = AttrBufDisp;	// current pointer to attribute buffer
+#endif
+	FrameBufAddr = FrameBufDisp;	// current pointer to graphics buffer
+	DispSwapFrame = DispFrame - 1;	// no pending buffer swap
+#else
 #if VMODE == 2
 	AttrBufAddr = AttrBuf;		// current pointer to attribute buffer
 #endif
 	FrameBufAddr = FrameBuf;	// current pointer to graphics buffer
+#endif
 
 	// trim HSI oscillator to 25MHz
 	RCC_HSITrim(31);
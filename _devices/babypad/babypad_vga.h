@@ -87,21 +87,39 @@ extern "C" {
 
 #endif // VMODE=...
 
+#if DISP_DBLBUF
+extern u8* FrameBuf;			// display graphics buffer - back buffer to draw into
+extern u8* volatile FrameBufDisp;	// display graphics buffer - front buffer being displayed
+#if VMODE == 2
+extern u8* AttrBuf;			// display attribute buffer - back buffer to draw into
+extern u8* volatile AttrBufDisp;	// display attribute buffer - front buffer being displayed
+#endif
+#else
 extern u8 FrameBuf[FRAMESIZE];		// display graphics buffer
 #if VMODE == 2
 extern u8 AttrBuf[ATTRSIZE];		// display attribute buffer (1 bit = high level of white color; 1st pixel is MSB)
 #endif
+#endif
 extern volatile u32 DispLine;		// current display line
 extern volatile u32 DispFrame;		// current frame
 extern volatile u8* FrameBufAddr;	// current pointer to graphics buffer
 extern volatile u32 DispTimTest;	// test - get TIM-CNT value at start of image
 
 // check VSYNC
-INLINE Bool DispIsVSync() { return DispLine >= 480; }
+INLINE Bool DispIsVSync() { HOST_POLL(); return DispLine >= 480; }
 
 // wait for VSync scanline
 void WaitVSync();
 
+#if DISP_DBLBUF
+// swap display buffers - show drawn back buffer FrameBuf (and AttrBuf) and draw into the other buffer
+// - New buffer is taken by the interrupt at start of next frame, so the image never tears.
+// - Returns at start of vertical blanking at the latest, when old buffer is no longer displayed.
+// - If previous swapped buffer is not displayed yet, waits for the next frame first.
+// - New back buffer contains the image before the last one.
+void DispSwapBuffers();
+#endif
+
 // Initialize videomode
 void DispInit();
 
@@ -61,11 +61,33 @@
 #define VMODE	1
 #endif
 
+// Double buffering: 1=use 2 display buffers, draw into FrameBuf and show it with DispSwapBuffers()
+// (requires twice the memory of the videomode; not supported in videomode 5)
+#ifndef DISP_DBLBUF
+#define DISP_DBLBUF	0
+#endif
+
+// VGA interrupt profiler (debug): 1=measure interrupt latency and time of every scanline into DispProf
+// (costs about 40 clock cycles per scanline and delays the image by a few clock cycles)
+#ifndef DISP_PROF
+#define DISP_PROF	0
+#endif
+
 // USART communication divider (baudrate = HCLK/div, HCLK=50000000, div=min. 16; 50 at 50MHz -> 1MBaud, 1 byte = 10us)
 #ifndef CPU_UART_DIV
 #define CPU_UART_DIV	HCLK_PER_US // USART CPU baudrate divider (baudrate = HCLK/div, HCLK=50000000, div=min. 16)
 #endif
 
+// Framed DMA bulk transfers to CPU2 (CPU_LinkSend, CPU_LinkRecv; requires CPU2 firmware with USE_CPULINK)
+#ifndef USE_CPULINK
+#define USE_CPULINK	0	// 1=use framed DMA bulk transfers to CPU2
+#endif
+
+// Baudrate of bulk transfers (must be reachable with integer divider from both 50 MHz and 48 MHz; on error falls back to CPU_UART_DIV)
+#ifndef CPU_LINK_BAUD
+#define CPU_LINK_BAUD	2000000	// baudrate of bulk transfers (2 MBaud, 1 KB = 5 ms)
+#endif
+
 // default device setup
 #ifndef USE_DRAW
 #define USE_DRAW	1	// 1=use graphics drawing functions
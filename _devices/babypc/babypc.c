@@ -1,10 +1,15 @@
 
 #include "../../includes.h"
 
+#if USE_HOST
+#include "babypc_host.c"
+#include "babypc_draw.c"
+#else
 #include "babypc_vga.c"
 #include "babypc_draw.c"
 #include "babypc_key.c"
 #include "babypc_snd.c"
 #include "babypc_init.c"
+#endif
 
 
@@ -0,0 +1,664 @@
+// ****************************************************************************
+//
+//                     BabyPC - Host emulation of the device
+//
+// ****************************************************************************
+// Used instead of VGA, keyboard, sound and init drivers in host build (USE_HOST=1).
+// Scanlines of the VGA videomode are emulated from the HCLK clock counter. Keys and
+// melody are served in VSYNC, like in the VGA interrupt handler on the device.
+// Second CPU is not emulated, the keyboard matrix is read from the key script.
+// Videomode 5 (ZX-80 format in RAM of the emulator) is not supported.
+
+#include "../../includes.h"
+
+#if USE_HOST
+
+// names of the keys (index = key code)
+const char* const HostKeyName[] = { "",
+	"1", "2", "3", "4", "5", "6", "7", "8", "9", "0",
+	"Q", "W", "E", "R", "T", "Y", "U", "I", "O", "P",
+	"A", "S", "D", "F", "G", "H", "J", "K", "L", "NL",
+	"SHIFT", "Z", "X", "C", "V", "B", "N", "M", "DOT", "SPACE", NULL };
+
+#if USE_KEY		// 1=use keyboard support
+static void KeyScan();
+#endif
+
+#if USE_SOUND		// 1=use sound support
+static void SoundScan();
+#endif
+
+// ----------------------------------------------------------------------------
+//                               Display
+// ----------------------------------------------------------------------------
+
+#if USE_DISP		// 1=use display support
+
+#if VMODE == 5
+#error "Videomode 5 is not supported in host build"
+#endif
+
+#define HOST_VGA_LINECLK	1600	// number of HCLK clock cycles per scanline (= TIM2 period)
+#define HOST_VGA_LINES		525	// number of scanlines per frame
+#if VMODE == 0
+#define HOST_VGA_VACTIVE	256	// number of active scanlines
+#define HOST_VGA_VSYNC		(256+112+10) // 1st VSYNC scanline
+#elif (VMODE == 2) || (VMODE == 7)
+#define HOST_VGA_VACTIVE	384	// number of active scanlines
+#define HOST_VGA_VSYNC		(384+48+10) // 1st VSYNC scanline
+#else
+#define HOST_VGA_VACTIVE	480	// number of active scanlines
+#define HOST_VGA_VSYNC		(480+10) // 1st VSYNC scanline
+#endif
+#define HOST_VGA_SNDLINE	(HOST_VGA_VSYNC+1) // scanline to serve melody (last VSYNC scanline)
+#define HOST_VGA_KEYLINE	(HOST_VGA_VSYNC+2+9) // scanline to serve keys (last scanline of keyboard scanning)
+
+#if DISP_DBLBUF
+u8 FrameBuf1[FRAMESIZE];	// display graphics buffer 1
+u8 FrameBuf2[FRAMESIZE];	// display graphics buffer 2
+u8* FrameBuf = FrameBuf2;	// display graphics buffer - back buffer to draw into
+u8* volatile FrameBufDisp = FrameBuf1; // display graphics buffer - front buffer being displayed
+u32 DispSwapFrame;		// frame of last buffer swap
+#else
+u8 FrameBuf[FRAMESIZE];		// display graphics buffer
+#endif
+volatile u32 DispLine;		// current display line
+volatile u32 DispFrame = 0;	// current frame
+volatile u8* FrameBufAddr;	// current pointer to graphics buffer
+volatile u32 DispTimTest;	// test - get TIM-CNT value at start of image
+
+#if DISP_PROF		// 1=profile VGA interrupt (debug)
+volatile sDispProf DispProf;	// VGA interrupt profiler (interrupt time is not emulated, stays 0)
+
+// reset VGA interrupt profiler
+void DispProfReset()
+{
+	memset((void*)&DispProf, 0, sizeof(DispProf));
+}
+
+// get remaining CPU time available to main program, in 0.1% (interrupt time of last frame)
+int DispProfFree() { return 1000; }
+#endif
+
+u64 HostVgaLine = 0;		// absolute counter of emulated scanlines
+
+// size of display image
+#if VMODE <= 1
+const int HostDispW = WIDTH;	// width of display image
+const int HostDispH = HEIGHT;	// height of display image
+#else
+const int HostDispW = WIDTH*8;	// width of display image
+const int HostDispH = HEIGHT*8;	// height of display image
+#endif
+
+// render display image to RGB buffer
+void HostRender(u8* rgb)
+{
+	int x, y;
+	u8 c;
+#if VMODE > 1
+	u8 ch;
+#endif
+	const u8* s = (const u8*)FrameBufAddr;
+	for (y = 0; y < HostDispH; y++)
+	{
+		for (x = 0; x < HostDispW; x++)
+		{
+#if VMODE <= 1
+			// graphics modes
+			c = s[(x>>3) + y*WIDTHBYTE];
+#else
+			// text modes
+			ch = s[(x>>3) + (y>>3)*WIDTHBYTE];
+#if VMODE == 6
+			c = DrawFont[(y & 7)*128 + (ch & 0x7f)]; // ZX Spectrum font of 128 characters
+			if ((ch & 0x80) != 0) c = ~c;
+#elif VMODE == 7
+			c = DrawFont[(y & 7)*64 + (ch & 0x3f)]; // ZX-80 font of 64 characters
+			if ((ch & 0x80) != 0) c = ~c;
+#else
+			c = DrawFont[(y & 7)*256 + ch]; // font of 256 characters
+#endif
+#endif
+			c = ((c << (x & 7)) & 0x80) ? 255 : 0;
+			*rgb++ = c;
+			*rgb++ = c;
+			*rgb++ = c;
+		}
+	}
+}
+
+// device time service - emulate scanlines of the VGA interrupt
+void HostDevTime(void)
+{
+	int n;
+	u64 line = HostClk / HOST_VGA_LINECLK;
+	while (HostVgaLine < line)
+	{
+		HostVgaLine++;
+		n = (int)(HostVgaLine % HOST_VGA_LINES);
+		DispLine = n;
+
+		// start of new frame - take front buffers
+		if (n == 0)
+		{
+			DispFrame++;
+#if DISP_DBLBUF
+			FrameBufAddr = FrameBufDisp;
+#endif
+		}
+
+		// end of active image - frame is displayed
+		else if (n == HOST_VGA_VACTIVE)
+			HostFrame();
+
+#if USE_SOUND		// 1=use sound support
+		else if (n == HOST_VGA_SNDLINE)
+			SoundScan();
+#endif
+
+#if USE_KEY		// 1=use keyboard support
+		else if (n == HOST_VGA_KEYLINE)
+			KeyScan();
+#endif
+	}
+}
+
+// wait for VSync scanline
+void WaitVSync()
+{
+	while (DispIsVSync()) {}
+	while (!DispIsVSync()) {}
+}
+
+#if DISP_DBLBUF
+// swap display buffers - show drawn back buffer FrameBuf (and AttrBuf) and draw into the other buffer
+void DispSwapBuffers()
+{
+	while (DispFrame == DispSwapFrame) HostPoll();
+	u8* oldframe = FrameBufDisp;
+	FrameBufDisp = FrameBuf;
+	while (!DispIsVSync()) {}
+	DispSwapFrame = DispFrame;
+	FrameBuf = oldframe;
+}
+#endif
+
+// Initialize videomode
+void DispInit()
+{
+#if DISP_DBLBUF
+	FrameBufAddr = FrameBufDisp;
+	DispSwapFrame = DispFrame - 1;
+#else
+	FrameBufAddr = FrameBuf;
+#endif
+	HostVgaLine = HostClk / HOST_VGA_LINECLK;
+	HostVgaLine -= HostVgaLine % HOST_VGA_LINES;
+	DispLine = 0;
+}
+
+// Terminate videomode
+void DispTerm() {}
+
+#else // USE_DISP
+
+const int HostDispW = 1;
+const int HostDispH = 1;
+void HostRender(u8* rgb) { rgb[0] = rgb[1] = rgb[2] = 0; }
+void HostDevTime(void) {}
+
+#endif // USE_DISP
+
+// ----------------------------------------------------------------------------
+//                              Keyboard
+// ----------------------------------------------------------------------------
+
+#if USE_KEY		// 1=use keyboard support
+
+volatile u8 KeyReleaseCnt[KEY_NUM*2]; // key release counter + key repeat counter; >0 if key is pressed (without NOKEY)
+u8 KeyBuf[KEYBUF_SIZE];		// keyboard buffer
+volatile u8 KeyWriteOff = 0;	// write offset to keyboard buffer
+volatile u8 KeyReadOff = 0;	// read offset from keyboard buffer
+volatile u8 CPUIntLocked = False; // CPU communication from interrupt is locked (prohibited)
+u8 CPUIntLockedReq = False; // request to lock CPU communication from interrupt
+
+// Remap keys to ASCII characters
+const char KeyCharRemap[KEY_NUM+1] = {
+	0,		// #define NOKEY		0	// no key
+	'1',		// #define KEY_1		1	// 1 NOT
+	'2',		// #define KEY_2		2	// 2 AND
+	'3',		// #define KEY_3		3	// 3 THEN
+	'4',		// #define KEY_4		4	// 4 TO
+	'5',		// #define KEY_5		5	// 5 LEFT
+	'6',		// #define KEY_6		6	// 6 DOWN
+	'7',		// #define KEY_7		7	// 7 UP
+	'8',		// #define KEY_8		8	// 8 RIGHT
+	'9',		// #define KEY_9		9	// 9 HOME
+	'0',		// #define KEY_0		10	// 0 RUBOUT
+
+	'Q',		// #define KEY_Q		11	// Q
+	'W',		// #define KEY_W		12	// W
+	'E',		// #define KEY_E		13	// E
+	'R',		// #define KEY_R		14	// R
+	'T',		// #define KEY_T		15	// T
+	'Y',		// #define KEY_Y		16	// Y "
+	'U',		// #define KEY_U		17	// U $
+	'I',		// #define KEY_I		18	// I (
+	'O',		// #define KEY_O		19	// O )
+	'P',		// #define KEY_P		20	// P *
+
+	'A',		// #define KEY_A		21	// A
+	'S',		// #define KEY_S		22	// S
+	'D',		// #define KEY_D		23	// D
+	'F',		// #define KEY_F		24	// F
+	'G',		// #define KEY_G		25	// G
+	'H',		// #define KEY_H		26	// H **
+	'J',		// #define KEY_J		27	// J -
+	'K',		// #define KEY_K		28	// K +
+	'L',		// #define KEY_L		29	// L =
+	13,		// #define KEY_NL		30	// NEW LINE, EDIT
+
+	27,		// #define KEY_SHIFT	31	// SHIFT
+	'Z',		// #define KEY_Z		32	// Z :
+	'X',		// #define KEY_X		33	// X ;
+	'C',		// #define KEY_C		34	// C ?
+	'V',		// #define KEY_V		35	// V /
+	'B',		// #define KEY_B		36	// B OR
+	'N',		// #define KEY_N		37	// N <
+	'M',		// #define KEY_M		38	// M >
+	'.',		// #define KEY_DOT		39	// , ,
+	' ',		// #define KEY_SPACE	40	// SPACE BREAK
+};
+
+const char KeyCharRemapShift[KEY_NUM+1] = {
+	0,		// #define NOKEY		0	// no key
+	'1',		// #define KEY_1		1	// 1 NOT
+	'2',		// #define KEY_2		2	// 2 AND
+	'3',		// #define KEY_3		3	// 3 THEN
+	'4',		// #define KEY_4		4	// 4 TO
+	'5',		// #define KEY_5		5	// 5 LEFT
+	'6',		// #define KEY_6		6	// 6 DOWN
+	'7',		// #define KEY_7		7	// 7 UP
+	'8',		// #define KEY_8		8	// 8 RIGHT
+	'9',		// #define KEY_9		9	// 9 HOME
+	'0',		// #define KEY_0		10	// 0 RUBOUT
+
+	' ',		// #define KEY_Q		11	// Q
+	' ',		// #define KEY_W		12	// W
+	' ',		// #define KEY_E		13	// E
+	' ',		// #define KEY_R		14	// R
+	' ',		// #define KEY_T		15	// T
+	'"',		// #define KEY_Y		16	// Y "
+	'$',		// #define KEY_U		17	// U $
+	'(',		// #define KEY_I		18	// I (
+	')',		// #define KEY_O		19	// O )
+	'*',		// #define KEY_P		20	// P *
+
+	' ',		// #define KEY_A		21	// A
+	' ',		// #define KEY_S		22	// S
+	' ',		// #define KEY_D		23	// D
+	' ',		// #define KEY_F		24	// F
+	' ',		// #define KEY_G		25	// G
+	'*',		// #define KEY_H		26	// H **
+	'-',		// #define KEY_J		27	// J -
+	'+',		// #define KEY_K		28	// K +
+	'=',		// #define KEY_L		29	// L =
+	13,		// #define KEY_NL		30	// NEW LINE, EDIT
+
+	27,		// #define KEY_SHIFT	31	// SHIFT
+	':',		// #define KEY_Z		32	// Z :
+	';',		// #define KEY_X		33	// X ;
+	'?',		// #define KEY_C		34	// C ?
+	'/',		// #define KEY_V		35	// V /
+	' ',		// #define KEY_B		36	// B OR
+	'<',		// #define KEY_N		37	// N <
+	'>',		// #define KEY_M		38	// M >
+	',',		// #define KEY_DOT		39	// . ,
+	' ',		// #define KEY_SPACE	40	// SPACE BREAK
+};
+
+// check if button KEY_* is currently pressed
+Bool KeyPressed(int key)
+{
+	HostPoll();
+	return KeyReleaseCnt[key-1] > 0;
+}
+
+// scan keys in VSYNC (buttons are pressed by the key script)
+static void KeyScan()
+{
+	int i;
+	u8 w;
+	for (i = KEY_NUM-1; i >= 0; i--)
+	{
+		// button is pressed
+		if ((HostKeys & BIT64(i+1)) != 0)
+		{
+			// pressed for the first time, or repeat
+			u8 rep = 0;
+			if (KeyReleaseCnt[i] == 0)
+				rep = KEYCNT_PRESS;
+			else
+			{
+				KeyReleaseCnt[KEY_NUM+i]--;
+				if (KeyReleaseCnt[KEY_NUM+i] == 0) rep = KEYCNT_REPEAT;
+			}
+
+			// send button to keyboard buffer
+			if (rep != 0)
+			{
+				KeyReleaseCnt[KEY_NUM+i] = rep;
+				w = KeyWriteOff + 1;
+				if (w >= KEYBUF_SIZE) w = 0;
+				if (w != KeyReadOff)
+				{
+					KeyBuf[KeyWriteOff] = i+1;
+					KeyWriteOff = w;
+				}
+			}
+			KeyReleaseCnt[i] = KEYCNT_REL;
+		}
+
+		// decrease release counter
+		if (KeyReleaseCnt[i] > 0) KeyReleaseCnt[i]--;
+	}
+}
+
+// get button from keyboard buffer KEY_* (returns NOKEY if no key)
+u8 KeyGet()
+{
+	HostPoll();
+
+	// check if keyboard buffer is empty
+	u8 r = KeyReadOff;
+	if (r == KeyWriteOff) return NOKEY;
+
+	// get key from keyboard buffer
+	u8 ch = KeyBuf[r];
+
+	// write new read offset
+	r++;
+	if (r >= KEYBUF_SIZE) r = 0;
+	KeyReadOff = r;
+	return ch;
+}
+
+// key flush
+void KeyFlush()
+{
+	while (KeyGet() != NOKEY) {}
+}
+
+// check no pressed key
+Bool KeyNoPressed()
+{
+	HostPoll();
+	int i;
+	for (i = 0; i < KEY_NUM; i++) if (KeyReleaseCnt[i] > 0) return False;
+	return True;
+}
+
+// wait for no key pressed
+void KeyWaitNoPressed()
+{
+	while (!KeyNoPressed()) {}
+}
+
+// check if joystick is pressed (KEY_RIGHT, KEY_UP, KEY_LEFT, KEY_DOWN, KEY_A, KEY_B, KEY_X, KEY_Y)
+Bool JoyPressed(int key)
+{
+	switch (key)
+	{
+	case KEY_RIGHT:
+		return KeyPressed(KEY_RIGHT) || KeyPressed(KEY_F);
+
+	case KEY_UP:
+		return KeyPressed(KEY_UP) || KeyPressed(KEY_E);
+
+	case KEY_LEFT:
+		return KeyPressed(KEY_LEFT) || KeyPressed(KEY_S);
+
+	case KEY_DOWN:
+		return KeyPressed(KEY_DOWN) || KeyPressed(KEY_D);
+
+	case KEY_A:
+		return KeyPressed(KEY_A) || KeyPressed(KEY_SPACE);
+
+	case KEY_B:
+		return KeyPressed(KEY_B) || KeyPressed(KEY_NL);
+
+	case KEY_X:
+		return KeyPressed(KEY_X) || KeyPressed(KEY_P);
+
+	case KEY_Y:
+		return KeyPressed(KEY_Y) || KeyPressed(KEY_0);
+
+	default:
+		return False;
+	}
+}
+
+// get joystick (returns NOKEY or KEY_RIGHT, KEY_UP, KEY_LEFT, KEY_DOWN, KEY_A, KEY_B, KEY_X, KEY_Y)
+u8 JoyGet()
+{
+	u8 key;
+	while (True)
+	{
+		key = KeyGet();
+		switch (key)
+		{
+		case KEY_RIGHT:
+		case KEY_F:
+			return KEY_RIGHT;
+
+		case KEY_UP:
+		case KEY_E:
+			return KEY_UP;
+
+		case KEY_LEFT:
+		case KEY_S:
+			return KEY_LEFT;
+
+		case KEY_DOWN:
+		case KEY_D:
+			return KEY_DOWN;
+
+		case KEY_A:
+		case KEY_SPACE:
+			return KEY_A;
+
+		case KEY_B:
+		case KEY_NL:
+			return KEY_B;
+
+		case KEY_X:
+		case KEY_P:
+			return KEY_X;
+
+		case KEY_Y:
+		case KEY_0:
+			return KEY_Y;
+
+		case NOKEY:
+			return NOKEY;
+		}
+	}
+}
+
+// Get character (Remap keys to ASCII characters; returns NOKEY of no character)
+char KeyGetChar()
+{
+	u8 key;
+	while (True)
+	{
+		key = KeyGet();
+		if (key == NOKEY) break;
+		if (key != KEY_SHIFT) break;
+	}
+
+	if (key != NOKEY)
+	{
+		if (KeyPressed(KEY_SHIFT))
+			return KeyCharRemapShift[key];
+		else
+			return KeyCharRemap[key];
+	}
+	return key;
+}
+
+// Initialize keyboard service
+void KeyInit() {}
+
+// terminate keyboard
+void KeyTerm() {}
+
+// initialize synchronization with CPU2 (CPU2 is not emulated)
+void CPU_SyncInit() {}
+
+// check if CPU2 is ready to send data
+Bool CPU_SendReady() { return True; }
+
+// send byte to CPU2 (ignored)
+void CPU_Send(u8 data) { (void)data; }
+
+// check if data from CPU2 is ready
+Bool CPU_RecvReady() { return False; }
+
+// receive byte from CPU2
+u8 CPU_Recv() { return 0; }
+
+// lock CPU communication from interrupt
+void CPU_IntLock() { CPUIntLockedReq = True; CPUIntLocked = True; }
+
+// unlock CPU communication from interrupt
+void CPU_IntUnlock() { CPUIntLockedReq = False; CPUIntLocked = False; }
+
+#if USE_CPULINK		// 1=use framed DMA bulk transfers to CPU2
+
+// fast baudrate is OK
+Bool CPU_LinkFastOk = True;
+
+// send data block to CPU2 with framed bulk transfer (CPU2 is not emulated)
+Bool CPU_LinkSend(u8 cmd, u8 par, const void* buf, int len) { return False; }
+
+// receive data block from CPU2 with framed bulk transfer (CPU2 is not emulated)
+Bool CPU_LinkRecv(u8 cmd, u8 par, void* buf, int len) { return False; }
+
+#endif // USE_CPULINK
+
+#endif // USE_KEY
+
+// ----------------------------------------------------------------------------
+//                                Sound
+// ----------------------------------------------------------------------------
+
+#if USE_SOUND		// 1=use sound support
+
+// pointer to current melody
+volatile const sMelodyNote* SoundMelodyPtr;
+
+// pointer to next melody
+volatile const sMelodyNote* SoundMelodyNext;
+
+// remaining length of current tone (0 = no melody, -1 = start next melody)
+volatile s16 SoundMelodyLen = 0;
+
+// Sound initialize
+void SoundInit() {}
+
+// Sound terminate
+void SoundTerm() { HostSound(0); }
+
+// Start playing tone with divider (frequency of time base is 1 MHz)
+void PlayTone(u32 div)
+{
+	HostSound(100000000/(div+1));
+}
+
+// Stop playing tone or melody
+void StopSound()
+{
+	SoundMelodyLen = 0;
+	HostSound(0);
+}
+
+// Sound scan melody in VSYNC
+static void SoundScan()
+{
+	int len = SoundMelodyLen;
+	if (len == 0) return; // no melody
+
+	// pointer to current melody
+	const sMelodyNote* ptr;
+
+	// start next melody
+	if (len < 0)
+		ptr = (const sMelodyNote*)SoundMelodyNext;
+
+	// continue melody - decrease counter of current tone
+	else
+	{
+		len--;
+		SoundMelodyLen = (s16)len;
+		if (len > 0) return;
+		ptr = (const sMelodyNote*)SoundMelodyPtr + 1;
+	}
+	SoundMelodyPtr = ptr;
+
+	// start next note, end of melody or pause
+	len = ptr->len;
+	SoundMelodyLen = (s16)len;
+	if ((len == 0) || (ptr->div == 0))
+		HostSound(0);
+	else
+		PlayTone(ptr->div);
+}
+
+// play melody
+void PlayMelody(const sMelodyNote* melody)
+{
+	SoundMelodyNext = melody;
+	SoundMelodyLen = -1;
+}
+
+#endif // USE_SOUND
+
+// ----------------------------------------------------------------------------
+//                             Device init
+// ----------------------------------------------------------------------------
+
+// Initialize device
+void DevInit()
+{
+#if USE_KEY		// 1=use keyboard support
+	KeyInit();
+	CPU_SyncInit();
+#endif
+
+#if USE_SOUND		// 1=use sound support
+	SoundInit();
+#endif
+
+#if USE_DISP		// 1=use display support
+	DispInit();
+#endif
+
+#if USE_DRAW || USE_PRINT
+	DrawClear();
+#endif
+}
+
+// Terminate device
+void DevTerm()
+{
+#if USE_SOUND		// 1=use sound support
+	SoundTerm();
+#endif
+
+#if USE_KEY		// 1=use keyboard support
+	KeyTerm();
+#endif
+}
+
+#endif // USE_HOST
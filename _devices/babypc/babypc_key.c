@@ -294,6 +294,11 @@ void KeyInit()
 		USART_WORDLEN_8, USART_PARITY_NONE, USART_STOP_1);
 	GPIO_Mode(PD5, GPIO_MODE_AF);	// TX
 	GPIO_Mode(PD6, GPIO_MODE_IN);	// RX
+
+#if USE_CPULINK		// 1=use framed DMA bulk transfers to CPU2
+	// enable DMA clock for bulk transfers of USART1
+	RCC_DMA1ClkEnable();
+#endif
 }
 
 // terminate keyboard
@@ -398,4 +403,158 @@ void CPU_IntUnlock()
 	while (CPUIntLocked) { cb(); }
 }
 
+#if USE_CPULINK		// 1=use framed DMA bulk transfers to CPU2
+
+#define CPU_LINK_TXDMA		4	// DMA channel of USART1 TX
+#define CPU_LINK_RXDMA		5	// DMA channel of USART1 RX
+#define CPU_LINK_TIMEOUT	(HCLK_PER_US*50000) // time-out of data block (50 ms)
+#define CPU_LINK_ACKTIMEOUT	(HCLK_PER_US*500000) // time-out of confirmation, including flash programming (500 ms)
+
+// fast baudrate is OK (cleared after failed transfer, next transfers use base baudrate)
+Bool CPU_LinkFastOk = True;
+
+// set baudrate of the link (waits for end of transmission)
+static void CPU_LinkBaud(Bool fast)
+{
+	while (!USART1_TxSent()) {}
+	USART1_Baud(fast ? CPU_LINK_BAUD : (RCC_GetFreq(CLK_HCLK) + CPU_UART_DIV/2)/CPU_UART_DIV);
+}
+
+// start DMA transfer of USART1 (dir = DMA_CFG_DIRFROMMEM or DMA_CFG_DIRFROMPER)
+static void CPU_LinkDma(int ch, const void* buf, int len, u32 dir)
+{
+	DMAchan_t* chan = DMA1_Chan(ch);
+	DMA_Cfg(chan, 0);
+	DMA_PerAddr(chan, &USART1->DATAR);
+	DMA_MemAddr(chan, buf);
+	DMA_Cnt(chan, len);
+	DMA_Cfg(chan, dir | DMA_CFG_EN | DMA_CFG_MEMINC | DMA_CFG_PSIZE_32 |
+		DMA_CFG_MSIZE_8 | DMA_CFG_PRIOR_HIGH);
+}
+
+// wait for end of DMA transfer (returns False on time-out)
+static Bool CPU_LinkDmaWait(int ch, u32 timeout)
+{
+	DMAchan_t* chan = DMA1_Chan(ch);
+	u32 start = Time();
+	Bool ok = True;
+	while (DMA_GetCnt(chan) != 0)
+	{
+		if ((u32)(Time() - start) >= timeout)
+		{
+			ok = False;
+			break;
+		}
+	}
+	DMA_ChanDisable(chan);
+	return ok;
+}
+
+// start framed transfer - send command and switch baudrate (returns True if fast)
+static Bool CPU_LinkStart(u8 cmd, u8 par)
+{
+	// send command at base baudrate
+	Bool fast = CPU_LinkFastOk;
+	CPU_Send(cmd);
+	CPU_Send(fast ? (par | CPU_LINK_FAST) : par);
+
+	// switch to fast baudrate
+	if (fast) CPU_LinkBaud(True);
+	return fast;
+}
+
+// stop framed transfer - return to base baudrate, resynchronize on error
+static Bool CPU_LinkStop(Bool fast, Bool ok)
+{
+	if (fast) CPU_LinkBaud(False);
+	if (!ok)
+	{
+		// use base baudrate for next transfers
+		CPU_LinkFastOk = False;
+
+		// resynchronize with CPU2 (waits for time-out of CPU2)
+		CPU_SyncInit();
+	}
+	return ok;
+}
+
+// send data block to CPU2 with framed bulk transfer (returns False on error)
+//  cmd ... command CPU_CMD_LINK*
+//  par ... parameter of the command 0..127
+// CPU communication from interrupt must be locked with CPU_IntLock().
+// On error the caller can repeat the transfer with byte commands.
+Bool CPU_LinkSend(u8 cmd, u8 par, const void* buf, int len)
+{
+	u16 crc = Crc16AFast(buf, len);
+	int i;
+	for (i = 0; i < CPU_LINK_TRY; i++)
+	{
+		// flush receiver
+		if (CPU_RecvReady()) CPU_Recv();
+
+		// send command and wait for CPU2 to prepare receiving
+		Bool fast = CPU_LinkStart(cmd, par);
+		WaitUs(CPU_LINK_WAIT);
+
+		// send data block
+		USART1_TxDMAEnable();
+		CPU_LinkDma(CPU_LINK_TXDMA, buf, len, DMA_CFG_DIRFROMMEM);
+		Bool ok = CPU_LinkDmaWait(CPU_LINK_TXDMA, CPU_LINK_TIMEOUT);
+		USART1_TxDMADisable();
+
+		// send CRC after pause
+		while (!USART1_TxSent()) {}
+		WaitUs(CPU_LINK_WAIT);
+		CPU_Send((u8)crc);
+		CPU_Send((u8)(crc >> 8));
+		if (fast) CPU_LinkBaud(False);
+
+		// wait for confirmation (CPU2 programs Flash)
+		u32 start = Time();
+		while (!CPU_RecvReady() && ((u32)(Time() - start) < (u32)CPU_LINK_ACKTIMEOUT)) {}
+		ok = ok && CPU_RecvReady() && (CPU_Recv() == CPU_STATE_SYNC);
+		if (CPU_LinkStop(False, ok)) return True;
+	}
+	return False;
+}
+
+// receive data block from CPU2 with framed bulk transfer (returns False on error)
+//  cmd ... command CPU_CMD_LINK*
+//  par ... parameter of the command 0..127
+// CPU communication from interrupt must be locked with CPU_IntLock().
+// On error the caller can repeat the transfer with byte commands.
+Bool CPU_LinkRecv(u8 cmd, u8 par, void* buf, int len)
+{
+	u16 crc = 0;
+	int i;
+	for (i = 0; i < CPU_LINK_TRY; i++)
+	{
+		// flush receiver
+		if (CPU_RecvReady()) CPU_Recv();
+
+		// prepare to receive data block, before sending the command
+		USART1_RxDMAEnable();
+		CPU_LinkDma(CPU_LINK_RXDMA, buf, len, DMA_CFG_DIRFROMPER);
+
+		// send command
+		Bool fast = CPU_LinkStart(cmd, par);
+
+		// receive data block and CRC
+		Bool ok = CPU_LinkDmaWait(CPU_LINK_RXDMA, CPU_LINK_TIMEOUT);
+		if (ok)
+		{
+			CPU_LinkDma(CPU_LINK_RXDMA, &crc, 2, DMA_CFG_DIRFROMPER);
+			ok = CPU_LinkDmaWait(CPU_LINK_RXDMA, CPU_LINK_TIMEOUT);
+		}
+		USART1_RxDMADisable();
+
+		// check CRC
+		ok = ok && (crc == Crc16AFast(buf, len));
+		if (CPU_LinkStop(fast, ok)) return True;
+	}
+	return False;
+}
+
+#endif // USE_CPULINK
+
 #endif // USE_KEY
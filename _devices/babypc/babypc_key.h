@@ -82,9 +82,22 @@ extern "C" {
 #define CPU_CMD_ROW41	0x17		// return columns in 2 bytes (in bits 0..4) and set ROW4 to 1
 #define CPU_CMD_ROW40	0x18		// return columns in 2 bytes (in bits 0..4) and set ROW4 to 0
 
+#define CPU_CMD_LINKLOAD 0x40		// framed load of program slot (+ parameter: slot index 0..12, CPU_LINK_FAST flag)
+#define CPU_CMD_LINKSAVE 0x41		// framed save to program slot (+ parameter: slot index 0..12, CPU_LINK_FAST flag)
+
 // state from CPU2 to CPU1
+#define CPU_STATE_ERR	0x14		// framed transfer failed (CRC error or time-out)
 #define CPU_STATE_SYNC	0x15		// sync - echo back after CPU_CMD_SYNC
 
+// Framed bulk transfer: command byte and parameter byte are sent at base baudrate (CPU_UART_DIV),
+// then both sides switch to CPU_LINK_BAUD if parameter has CPU_LINK_FAST flag. After pause
+// CPU_LINK_WAIT the data block is sent by DMA, and after next pause follows CRC-16 CCITT
+// (Crc16AFast, 2 bytes, LOW first). Then both sides return to base baudrate; CPU2 confirms
+// received block with CPU_STATE_SYNC or CPU_STATE_ERR.
+#define CPU_LINK_FAST	0x80		// parameter flag: transfer data block at CPU_LINK_BAUD
+#define CPU_LINK_WAIT	200		// pause in [us] before data and before CRC (CPU1 can be interrupted by VGA)
+#define CPU_LINK_TRY	3		// number of attempts (first attempt with fast baudrate)
+
 // keyboard buffer
 // If you change the settings, also check the code for reading the buttons in babypc_vga_asm.S.
 #define KEYBUF_SIZE	16	// size of keyboard buffer
@@ -147,6 +160,27 @@ void CPU_IntLock();
 // unlock CPU communication from interrupt
 void CPU_IntUnlock();
 
+#if USE_CPULINK		// 1=use framed DMA bulk transfers to CPU2
+
+// fast baudrate is OK (cleared after failed transfer, next transfers use base baudrate)
+extern Bool CPU_LinkFastOk;
+
+// send data block to CPU2 with framed bulk transfer (returns False on error)
+//  cmd ... command CPU_CMD_LINK*
+//  par ... parameter of the command 0..127
+// CPU communication from interrupt must be locked with CPU_IntLock().
+// On error the caller can repeat the transfer with byte commands.
+Bool CPU_LinkSend(u8 cmd, u8 par, const void* buf, int len);
+
+// receive data block from CPU2 with framed bulk transfer (returns False on error)
+//  cmd ... command CPU_CMD_LINK*
+//  par ... parameter of the command 0..127
+// CPU communication from interrupt must be locked with CPU_IntLock().
+// On error the caller can repeat the transfer with byte commands.
+Bool CPU_LinkRecv(u8 cmd, u8 par, void* buf, int len);
+
+#endif // USE_CPULINK
+
 #ifdef __cplusplus
 }
 #endif
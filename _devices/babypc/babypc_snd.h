@@ -186,7 +186,7 @@ extern volatile const sMelodyNote* SoundMelodyNext;
 extern volatile s16 SoundMelodyLen;
 
 // check if sound of channel 0 is playing
-INLINE Bool PlayingSound() { return SoundMelodyLen != 0; }
+INLINE Bool PlayingSound() { HOST_POLL(); return SoundMelodyLen != 0; }
 
 /*
 // Game sound samples
@@ -9,8 +9,18 @@
 
 #if USE_DISP		// 1=use display support
 
+#if USE_PROF && (PROF_IRQ == IRQ_TIM2)
+#error "Profiler (USE_PROF) cannot use TIM2 of VGA synchronization - set PROF_TIM, PROF_IRQ and PROF_HANDLER (TIM1 if USE_SOUND = 0)"
+#endif
+
 #if VMODE == 5
 u8* volatile FrameBuf = (u8*)SRAM_BASE;	// display graphics buffer
+#elif DISP_DBLBUF
+u8 FrameBuf1[FRAMESIZE];	// display graphics buffer 1
+u8 FrameBuf2[FRAMESIZE];	// display graphics buffer 2
+u8* FrameBuf = FrameBuf2;	// display graphics buffer - back buffer to draw into
+u8* volatile FrameBufDisp = FrameBuf1; // display graphics buffer - front buffer being displayed
+u32 DispSwapFrame;		// frame of last buffer swap
 #else
 u8 FrameBuf[FRAMESIZE];		// display graphics buffer
 #endif
@@ -19,6 +29,34 @@ volatile u32 DispFrame = 0;	// current frame
 volatile u8* FrameBufAddr;	// current pointer to graphics buffer
 volatile u32 DispTimTest;	// test - get TIM-CNT value at start of image
 
+#if DISP_PROF		// 1=profile VGA interrupt (debug)
+volatile sDispProf DispProf;	// VGA interrupt profiler
+
+// reset VGA interrupt profiler (called from DispInit)
+void DispProfReset()
+{
+	int i;
+	IRQ_LOCK;
+	DispProf.busy = 0;
+	DispProf.frame = 0;
+	DispProf.latmin = 0xffffffff;
+	DispProf.latmax = 0;
+	DispProf.isract = 0;
+	DispProf.isrblank = 0;
+	for (i = 0; i < DISP_PROF_HIST; i++) DispProf.hist[i] = 0;
+	IRQ_UNLOCK;
+}
+
+// get remaining CPU time available to main program, in 0.1% (interrupt time of last frame)
+int DispProfFree()
+{
+	u32 total = 525*((u32)TIM2_GetLoad() + 1); // clock cycles per frame
+	u32 busy = DispProf.frame;
+	if (busy >= total) return 0;
+	return (int)((total - busy)*1000/total);
+}
+#endif
+
 // wait for VSync scanline
 void WaitVSync()
 {
@@ -26,11 +64,36 @@ void WaitVSync()
 	while (!DispIsVSync()) {}
 }
 
+#if DISP_DBLBUF && (VMODE != 5)
+// swap display buffers - show drawn back buffer FrameBuf and draw into the other buffer
+void DispSwapBuffers()
+{
+	// previous buffer has not been displayed yet, wait for start of next frame
+	while (DispFrame == DispSwapFrame) {}
+
+	// set new front buffer - single word write, interrupt takes it at start of next frame
+	u8* oldframe = FrameBufDisp;
+	FrameBufDisp = FrameBuf;
+
+	// wait for vertical blanking - old buffer is no longer displayed
+	while (!DispIsVSync()) {}
+	DispSwapFrame = DispFrame;
+
+	// draw into old buffer
+	FrameBuf = oldframe;
+}
+#endif
+
 // Initialize videomode
 void DispInit()
 {
 	DispLine = 0;			// current display line
+#if DISP_DBLBUF && (VMODE != 5)
+	FrameBufAddr = FrameBufDisp;	// current pointer to graphics buffer
+	DispSwapFrame = DispFrame - 1;	// no pending buffer swap
+#else
 	FrameBufAddr = FrameBuf;	// current pointer to graphics buffer
+#endif
 
 	// trim HSI oscillator to 25MHz
 	RCC_HSITrim(31);
@@ -107,6 +170,9 @@ void DispInit()
 	TIM2_CC1Enable();		// enable compare output
 	TIM2_CC1IntClr();		// clear interrupt request
 	TIM2_CC1IntEnable();		// enable capture compare of channel 1
+#if DISP_PROF		// 1=profile VGA interrupt (debug)
+	DispProfReset();		// reset interrupt profiler
+#endif
 	NVIC_IRQEnable(IRQ_TIM2);	// enable interrupt service
 }
 
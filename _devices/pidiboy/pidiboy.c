@@ -1,11 +1,17 @@
 
 #include "../../includes.h"
 
+#if USE_HOST
+#include "pidiboy_host.c"
+#include "pidiboy_draw.c"
+#include "pidiboy_snd.c"
+#else
 #include "pidiboy_disp.c"
 #include "pidiboy_draw.c"
 #include "pidiboy_key.c"
 #include "pidiboy_snd.c"
 #include "pidiboy_ss.c"
 #include "pidiboy_init.c"
+#endif
 
 
@@ -188,7 +188,25 @@ extern const sMelodyNote* volatile SoundMelodyNext;
 extern volatile s16 SoundMelodyLen;
 
 // check if sound of channel 0 is playing
-INLINE Bool PlayingSound() { return SoundMelodyLen != 0; }
+INLINE Bool PlayingSound() { HOST_POLL(); return SoundMelodyLen != 0; }
+
+// pointer to next sound effect
+extern const sMelodyNote* volatile SoundEffNext;
+
+// remaining length of current tone of sound effect (0 = no effect, -1 = start next effect)
+extern volatile s16 SoundEffLen;
+
+// check if sound effect is playing
+INLINE Bool PlayingEffect() { HOST_POLL(); return SoundEffLen != 0; }
+
+// check if sound service needs SysTick time steps (melody, effect or music is playing)
+INLINE Bool SoundBusy()
+{
+#if USE_MUSIC		// 1=use music player
+	if ((MusicSong != NULL) || (MusicDiv != 0)) return True;
+#endif
+	return (SoundMelodyLen != 0) || (SoundEffLen != 0);
+}
 
 /*
 // Game sound samples
@@ -205,6 +223,11 @@ void SoundInit();
 // Sound terminate
 void SoundTerm();
 
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+// update sound timer after change of system clock (registered by SoundInit)
+void SoundClock();
+#endif
+
 // Start playing tone with divider - use macro SND_GET_DIV(hz01) with
 //  frequency in 0.01 Hz, minimum 15.26Hz, or use constant NOTE_*
 void PlayTone(u32 div);
@@ -219,6 +242,15 @@ void SoundScan();
 // play music
 //  melody = pointer to array of notes sMelodyNote (terminated with NOTE_STOP)
 void PlayMelody(const sMelodyNote* melody);
+
+// play sound effect with priority - effect preempts melody and music, melody continues after it
+//  effect = pointer to array of notes sMelodyNote (terminated with NOTE_STOP)
+//  prio = priority 0..255 (effect with lower priority than current effect is not played)
+// Returns False if effect was not started.
+Bool PlayEffect(const sMelodyNote* effect, int prio);
+
+// stop sound effect (melody or music resumes)
+void StopEffect();
 #endif
 
 #ifdef __cplusplus
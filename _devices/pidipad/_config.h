@@ -15,6 +15,18 @@
 #define VMODE	1
 #endif
 
+// Double buffering: 1=use 2 display buffers, draw into FrameBuf and show it with DispSwapBuffers()
+// (requires twice the memory of the videomode)
+#ifndef DISP_DBLBUF
+#define DISP_DBLBUF	0
+#endif
+
+// VGA interrupt profiler (debug): 1=measure interrupt latency and time of every scanline into DispProf
+// (costs about 40 clock cycles per scanline and delays the image by a few clock cycles)
+#ifndef DISP_PROF
+#define DISP_PROF	0
+#endif
+
 // default device setup
 #ifndef USE_DRAW
 #define USE_DRAW	1	// 1=use graphics drawing functions
@@ -1,8 +1,13 @@
 
 #include "../../includes.h"
 
+#if USE_HOST
+#include "pidipad_host.c"
+#include "pidipad_draw.c"
+#else
 #include "pidipad_vga.c"
 #include "pidipad_draw.c"
 #include "pidipad_key.c"
 #include "pidipad_snd.c"
 #include "pidipad_init.c"
+#endif
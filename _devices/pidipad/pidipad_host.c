@@ -0,0 +1,477 @@
+// ****************************************************************************
+//
+//                     PidiPad - Host emulation of the device
+//
+// ****************************************************************************
+// Used instead of VGA, keyboard, sound and init drivers in host build (USE_HOST=1).
+// SD card is not emulated (host build uses USE_SD=0).
+// Scanlines of the VGA videomode are emulated from the HCLK clock counter. Keys and
+// melody are served in VSYNC, like in the VGA interrupt handler on the device.
+
+#include "../../includes.h"
+
+#if USE_HOST
+
+// names of the keys (index = key code)
+const char* const HostKeyName[] = { "", "RIGHT", "UP", "LEFT", "DOWN", "A", "B", "X", "Y", NULL };
+
+#if USE_KEY		// 1=use keyboard support
+static void KeyScan();
+#endif
+
+#if USE_SOUND		// 1=use sound support
+static void SoundScan();
+#endif
+
+// ----------------------------------------------------------------------------
+//                               Display
+// ----------------------------------------------------------------------------
+
+#if USE_DISP		// 1=use display support
+
+#define HOST_VGA_LINECLK	1600	// number of HCLK clock cycles per scanline (= TIM2 period)
+#define HOST_VGA_LINES		525	// number of scanlines per frame
+#if VMODE == 9
+#define HOST_VGA_VACTIVE	320	// number of active scanlines
+#define HOST_VGA_SNDLINE	(320+64+10) // scanline to serve melody (1st VSYNC scanline)
+#elif (VMODE == 4) || (VMODE == 5)
+#define HOST_VGA_VACTIVE	384	// number of active scanlines
+#define HOST_VGA_SNDLINE	(384+48+10) // scanline to serve melody (1st VSYNC scanline)
+#else
+#define HOST_VGA_VACTIVE	480	// number of active scanlines
+#define HOST_VGA_SNDLINE	(480+10) // scanline to serve melody (1st VSYNC scanline)
+#endif
+#define HOST_VGA_KEYLINE	(HOST_VGA_SNDLINE+1) // scanline to serve keys (last VSYNC scanline)
+
+#if DISP_DBLBUF
+u8 FrameBuf1[FRAMESIZE];	// display graphics buffer 1
+u8 FrameBuf2[FRAMESIZE];	// display graphics buffer 2
+u8* FrameBuf = FrameBuf2;	// display graphics buffer - back buffer to draw into
+u8* volatile FrameBufDisp = FrameBuf1; // display graphics buffer - front buffer being displayed
+#if VMODE != 5
+u8 AttrBuf1[ATTRSIZE];		// display attribute buffer 1
+u8 AttrBuf2[ATTRSIZE];		// display attribute buffer 2
+u8* AttrBuf = AttrBuf2;		// display attribute buffer - back buffer to draw into
+u8* volatile AttrBufDisp = AttrBuf1; // display attribute buffer - front buffer being displayed
+volatile u8* AttrBufAddr = AttrBuf1; // current pointer to attribute buffer
+#endif
+u32 DispSwapFrame;		// frame of last buffer swap
+#else
+u8 FrameBuf[FRAMESIZE];		// display graphics buffer
+#if VMODE != 5
+u8 AttrBuf[ATTRSIZE];		// display attribute buffer (color of 2 pixels: 1st pixels in bits 1..3, 2nd pixel in bits 5..7)
+volatile u8* AttrBufAddr = AttrBuf; // current pointer to attribute buffer
+#endif
+#endif
+
+#if (VMODE == 7) || (VMODE == 8)
+u8 FontBuf[2048];		// bont buffer 8x8
+#endif
+
+volatile int DispLine;		// current display line
+volatile u32 DispFrame;		// current frame
+#if DISP_DBLBUF
+volatile u8* FrameBufAddr = FrameBuf1;	// current pointer to graphics buffer
+#else
+volatile u8* FrameBufAddr = FrameBuf;	// current pointer to graphics buffer
+#endif
+volatile u32 DispTimTest;	// test - get TIM-CNT value at start of image
+
+#if DISP_PROF		// 1=profile VGA interrupt (debug)
+volatile sDispProf DispProf;	// VGA interrupt profiler (interrupt time is not emulated, stays 0)
+
+// reset VGA interrupt profiler
+void DispProfReset()
+{
+	memset((void*)&DispProf, 0, sizeof(DispProf));
+}
+
+// get remaining CPU time available to main program, in 0.1% (interrupt time of last frame)
+int DispProfFree() { return 1000; }
+#endif
+
+u64 HostVgaLine = 0;		// absolute counter of emulated scanlines
+
+// size of display image
+#if VMODE >= 6 && VMODE <= 8
+const int HostDispW = WIDTH*8;	// width of display image
+const int HostDispH = HEIGHT*8;	// height of display image
+#else
+const int HostDispW = WIDTH;	// width of display image
+const int HostDispH = HEIGHT;	// height of display image
+#endif
+
+// get color of pixel COL_* from front buffers
+static u8 HostGetPoint(int x, int y)
+{
+	const u8* s = (const u8*)FrameBufAddr;
+#if VMODE == 5
+	u8 a = s[y*WIDTHBYTE + x/2];
+	return ((x & 1) == 0) ? (a & 0x0f) : (a >> 4);
+#else
+	const u8* a = (const u8*)AttrBufAddr;
+	u8 c;
+#if (VMODE >= 6) && (VMODE <= 8)
+	// text modes (font: 8 lines of 256 bytes)
+#if VMODE == 6
+	const u8* f = DrawFont;
+#else
+	const u8* f = FontBuf;
+#endif
+	int x2 = x >> 3;
+	int y2 = y >> 3;
+	if (((f[(y & 7)*256 + s[x2 + y2*WIDTHBYTE]] << (x & 7)) & 0x80) == 0) return COL_BLACK;
+	c = a[y2*ATTRWIDTHBYTE + x2/2];
+	return ((x2 & 1) == 0) ? (c & 0x0f) : (c >> 4);
+#else
+	// graphics modes
+	if (((s[(x>>3) + y*WIDTHBYTE] << (x & 7)) & 0x80) == 0) return COL_BLACK;
+#if (VMODE == 1) || (VMODE == 4)
+	int x2 = x >> 3;
+	c = a[(y/8)*ATTRWIDTHBYTE + x2/2];
+#elif VMODE == 2
+	int x2 = x >> 2;
+	c = a[(y/4)*ATTRWIDTHBYTE + x2/2];
+#elif VMODE == 3
+	int x2 = x >> 1;
+	c = a[(y/2)*ATTRWIDTHBYTE + x2/2];
+#else // VMODE == 9
+	int x2 = x;
+	c = a[y*ATTRWIDTHBYTE + x2/2];
+#endif
+	return ((x2 & 1) == 0) ? (c & 0x0f) : (c >> 4);
+#endif
+#endif
+}
+
+// render display image to RGB buffer
+void HostRender(u8* rgb)
+{
+	int x, y;
+	u8 c;
+	for (y = 0; y < HostDispH; y++)
+	{
+		for (x = 0; x < HostDispW; x++)
+		{
+			c = HostGetPoint(x, y);
+			*rgb++ = ((c & COL_RED) != 0) ? 255 : 0;
+			*rgb++ = ((c & COL_GREEN) != 0) ? 255 : 0;
+			*rgb++ = ((c & COL_BLUE) != 0) ? 255 : 0;
+		}
+	}
+}
+
+// device time service - emulate scanlines of the VGA interrupt
+void HostDevTime(void)
+{
+	int n;
+	u64 line = HostClk / HOST_VGA_LINECLK;
+	while (HostVgaLine < line)
+	{
+		HostVgaLine++;
+		n = (int)(HostVgaLine % HOST_VGA_LINES);
+		DispLine = n;
+
+		// start of new frame - take front buffers
+		if (n == 0)
+		{
+			DispFrame++;
+#if DISP_DBLBUF
+			FrameBufAddr = FrameBufDisp;
+#if VMODE != 5
+			AttrBufAddr = AttrBufDisp;
+#endif
+#endif
+		}
+
+		// end of active image - frame is displayed
+		else if (n == HOST_VGA_VACTIVE)
+			HostFrame();
+
+#if USE_SOUND		// 1=use sound support
+		else if (n == HOST_VGA_SNDLINE)
+			SoundScan();
+#endif
+
+#if USE_KEY		// 1=use keyboard support
+		else if (n == HOST_VGA_KEYLINE)
+			KeyScan();
+#endif
+	}
+}
+
+// wait for VSync scanline
+void WaitVSync()
+{
+	while (DispIsVSync()) {}
+	while (!DispIsVSync()) {}
+}
+
+#if DISP_DBLBUF
+// swap display buffers - show drawn back buffer FrameBuf (and AttrBuf) and draw into the other buffer
+void DispSwapBuffers()
+{
+	while (DispFrame == DispSwapFrame) HostPoll();
+	u8* oldframe = FrameBufDisp;
+	FrameBufDisp = FrameBuf;
+#if VMODE != 5
+	u8* oldattr = AttrBufDisp;
+	AttrBufDisp = AttrBuf;
+#endif
+	while (!DispIsVSync()) {}
+	DispSwapFrame = DispFrame;
+	FrameBuf = oldframe;
+#if VMODE != 5
+	AttrBuf = oldattr;
+#endif
+}
+#endif
+
+// Initialize videomode
+void DispInit()
+{
+#if (VMODE == 7) || (VMODE == 8)
+	// copy font to font buffer
+	memcpy(FontBuf, FONT, 2048);
+#endif
+
+#if DISP_DBLBUF
+#if VMODE != 5
+	AttrBufAddr = AttrBufDisp;
+#endif
+	FrameBufAddr = FrameBufDisp;
+	DispSwapFrame = DispFrame - 1;
+#else
+#if VMODE != 5
+	AttrBufAddr = AttrBuf;
+#endif
+	FrameBufAddr = FrameBuf;
+#endif
+	HostVgaLine = HostClk / HOST_VGA_LINECLK;
+	HostVgaLine -= HostVgaLine % HOST_VGA_LINES;
+	DispLine = 0;
+}
+
+// Terminate videomode
+void DispTerm() {}
+
+#else // USE_DISP
+
+const int HostDispW = 1;
+const int HostDispH = 1;
+void HostRender(u8* rgb) { rgb[0] = rgb[1] = rgb[2] = 0; }
+void HostDevTime(void) {}
+
+#endif // USE_DISP
+
+// ----------------------------------------------------------------------------
+//                              Keyboard
+// ----------------------------------------------------------------------------
+
+#if USE_KEY		// 1=use keyboard support
+
+volatile u8 KeyReleaseCnt[KEY_NUM*2]; // key release counter + key repeat counter; >0 if key is pressed (without NOKEY)
+u8 KeyBuf[KEYBUF_SIZE];		// keyboard buffer
+volatile u8 KeyWriteOff = 0;	// write offset to keyboard buffer
+volatile u8 KeyReadOff = 0;	// read offset from keyboard buffer
+
+// scan keys in VSYNC (buttons are pressed by the key script)
+static void KeyScan()
+{
+	int i;
+	u8 w;
+	for (i = KEY_NUM-1; i >= 0; i--)
+	{
+		// button is pressed
+		if ((HostKeys & BIT64(i+1)) != 0)
+		{
+			// pressed for the first time, or repeat
+			u8 rep = 0;
+			if (KeyReleaseCnt[i] == 0)
+				rep = KEYCNT_PRESS;
+			else
+			{
+				KeyReleaseCnt[KEY_NUM+i]--;
+				if (KeyReleaseCnt[KEY_NUM+i] == 0) rep = KEYCNT_REPEAT;
+			}
+
+			// send button to keyboard buffer
+			if (rep != 0)
+			{
+				KeyReleaseCnt[KEY_NUM+i] = rep;
+				w = KeyWriteOff + 1;
+				if (w >= KEYBUF_SIZE) w = 0;
+				if (w != KeyReadOff)
+				{
+					KeyBuf[KeyWriteOff] = i+1;
+					KeyWriteOff = w;
+				}
+			}
+			KeyReleaseCnt[i] = KEYCNT_REL;
+		}
+
+		// decrease release counter
+		if (KeyReleaseCnt[i] > 0) KeyReleaseCnt[i]--;
+	}
+}
+
+// get button from keyboard buffer KEY_* (returns NOKEY if no key)
+u8 KeyGet()
+{
+	HostPoll();
+
+	// check if keyboard buffer is empty
+	u8 r = KeyReadOff;
+	if (r == KeyWriteOff) return NOKEY;
+
+	// get key from keyboard buffer
+	u8 ch = KeyBuf[r];
+
+	// write new read offset
+	r++;
+	if (r >= KEYBUF_SIZE) r = 0;
+	KeyReadOff = r;
+	return ch;
+}
+
+// key flush
+void KeyFlush()
+{
+	while (KeyGet() != NOKEY) {}
+}
+
+// check no pressed key
+Bool KeyNoPressed()
+{
+	HostPoll();
+	int i;
+	for (i = 0; i < KEY_NUM; i++) if (KeyReleaseCnt[i] > 0) return False;
+	return True;
+}
+
+// wait for no key pressed
+void KeyWaitNoPressed()
+{
+	while (!KeyNoPressed()) {}
+}
+
+// Initialize keyboard service
+void KeyInit() {}
+
+// terminate keyboard
+void KeyTerm() {}
+
+#endif // USE_KEY
+
+// ----------------------------------------------------------------------------
+//                                Sound
+// ----------------------------------------------------------------------------
+
+#if USE_SOUND		// 1=use sound support
+
+// pointer to current melody
+volatile const sMelodyNote* SoundMelodyPtr;
+
+// pointer to next melody
+volatile const sMelodyNote* SoundMelodyNext;
+
+// remaining length of current tone (0 = no melody, -1 = start next melody)
+volatile s16 SoundMelodyLen = 0;
+
+// Sound initialize
+void SoundInit() {}
+
+// Sound terminate
+void SoundTerm() { HostSound(0); }
+
+// Start playing tone with divider (frequency of time base is 1 MHz)
+void PlayTone(u32 div)
+{
+	HostSound(100000000/(div+1));
+}
+
+// Stop playing tone or melody
+void StopSound()
+{
+	SoundMelodyLen = 0;
+	HostSound(0);
+}
+
+// Sound scan melody in VSYNC
+static void SoundScan()
+{
+	int len = SoundMelodyLen;
+	if (len == 0) return; // no melody
+
+	// pointer to current melody
+	const sMelodyNote* ptr;
+
+	// start next melody
+	if (len < 0)
+		ptr = (const sMelodyNote*)SoundMelodyNext;
+
+	// continue melody - decrease counter of current tone
+	else
+	{
+		len--;
+		SoundMelodyLen = (s16)len;
+		if (len > 0) return;
+		ptr = (const sMelodyNote*)SoundMelodyPtr + 1;
+	}
+	SoundMelodyPtr = ptr;
+
+	// start next note, end of melody or pause
+	len = ptr->len;
+	SoundMelodyLen = (s16)len;
+	if ((len == 0) || (ptr->div == 0))
+		HostSound(0);
+	else
+		PlayTone(ptr->div);
+}
+
+// play melody
+void PlayMelody(const sMelodyNote* melody)
+{
+	SoundMelodyNext = melody;
+	SoundMelodyLen = -1;
+}
+
+#endif // USE_SOUND
+
+// ----------------------------------------------------------------------------
+//                             Device init
+// ----------------------------------------------------------------------------
+
+// Initialize device
+void DevInit()
+{
+#if USE_KEY		// 1=use keyboard support
+	KeyInit();
+#endif
+
+#if USE_SOUND		// 1=use sound support
+	SoundInit();
+#endif
+
+#if USE_DISP		// 1=use display support
+	DispInit();
+#endif
+
+#if USE_DRAW || USE_PRINT
+	DrawClear();
+#endif
+}
+
+// Terminate device
+void DevTerm()
+{
+#if USE_SOUND		// 1=use sound support
+	SoundTerm();
+#endif
+
+#if USE_KEY		// 1=use keyboard support
+	KeyTerm();
+#endif
+}
+
+#endif // USE_HOST
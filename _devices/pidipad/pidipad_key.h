@@ -52,7 +52,7 @@ extern volatile u8 KeyWriteOff;	// write offset to keyboard buffer
 extern volatile u8 KeyReadOff;	// read offset from keyboard buffer
 
 // check if button KEY_* is currently pressed
-INLINE Bool KeyPressed(int key) { return KeyReleaseCnt[key-1] > 0; }
+INLINE Bool KeyPressed(int key) { HOST_POLL(); return KeyReleaseCnt[key-1] > 0; }
 
 // get button from keyboard buffer KEY_* (returns NOKEY if no key)
 u8 KeyGet();
@@ -9,19 +9,70 @@
 
 #if USE_DISP		// 1=use display support
 
+#if USE_PROF && (PROF_IRQ == IRQ_TIM2)
+#error "Profiler (USE_PROF) cannot use TIM2 of VGA synchronization - set PROF_TIM, PROF_IRQ and PROF_HANDLER (TIM1 if USE_SOUND = 0)"
+#endif
+
+#if DISP_DBLBUF
+u8 FrameBuf1[FRAMESIZE];	// display graphics buffer 1
+u8 FrameBuf2[FRAMESIZE];	// display graphics buffer 2
+u8* FrameBuf = FrameBuf2;	// display graphics buffer - back buffer to draw into
+u8* volatile FrameBufDisp = FrameBuf1; // display graphics buffer - front buffer being displayed
+#if VMODE != 5
+u8 AttrBuf1[ATTRSIZE];		// display attribute buffer 1
+u8 AttrBuf2[ATTRSIZE];		// display attribute buffer 2
+u8* AttrBuf = AttrBuf2;		// display attribute buffer - back buffer to draw into
+u8* volatile AttrBufDisp = AttrBuf1; // display attribute buffer - front buffer being displayed
+volatile u8* AttrBufAddr = AttrBuf1; // current pointer to attribute buffer
+#endif
+u32 DispSwapFrame;		// frame of last buffer swap
+#else
 u8 FrameBuf[FRAMESIZE];		// display graphics buffer
 #if VMODE != 5
 u8 AttrBuf[ATTRSIZE];		// display attribute buffer (color of 2 pixels: 1st pixels in bits 1..3, 2nd pixel in bits 5..7)
 volatile u8* AttrBufAddr = AttrBuf; // current pointer to attribute buffer
 #endif
+#endif
 #if (VMODE == 7) || (VMODE == 8)
 u8 FontBuf[2048];		// bont buffer 8x8
 #endif
 volatile int DispLine;		// current display line
 volatile u32 DispFrame;		// current frame
+#if DISP_DBLBUF
+volatile u8* FrameBufAddr = FrameBuf1;	// current pointer to graphics buffer
+#else
 volatile u8* FrameBufAddr = FrameBuf;	// current pointer to graphics buffer
+#endif
 volatile u32 DispTimTest;	// test - get TIM-CNT value at start of image
 
+#if DISP_PROF		// 1=profile VGA interrupt (debug)
+volatile sDispProf DispProf;	// VGA interrupt profiler
+
+// reset VGA interrupt profiler (called from DispInit)
+void DispProfReset()
+{
+	int i;
+	IRQ_LOCK;
+	DispProf.busy = 0;
+	DispProf.frame = 0;
+	DispProf.latmin = 0xffffffff;
+	DispProf.latmax = 0;
+	DispProf.isract = 0;
+	DispProf.isrblank = 0;
+	for (i = 0; i < DISP_PROF_HIST; i++) DispProf.hist[i] = 0;
+	IRQ_UNLOCK;
+}
+
+// get remaining CPU time available to main program, in 0.1% (interrupt time of last frame)
+int DispProfFree()
+{
+	u32 total = 525*((u32)TIM2_GetLoad() + 1); // clock cycles per frame
+	u32 busy = DispProf.frame;
+	if (busy >= total) return 0;
+	return (int)((total - busy)*1000/total);
+}
+#endif
+
 // wait for VSync scanline
 void WaitVSync()
 {
@@ -29,6 +80,33 @@ void WaitVSync()
 	while (!DispIsVSync()) {}
 }
 
+#if DISP_DBLBUF
+// swap display buffers - show drawn back buffer FrameBuf (and AttrBuf) and draw into the other buffer
+void DispSwapBuffers()
+{
+	// previous buffer has not been displayed yet, wait for start of next frame
+	while (DispFrame == DispSwapFrame) {}
+
+	// set new front buffers - single word writes, interrupt takes them at start of next frame
+	u8* oldframe = FrameBufDisp;
+	FrameBufDisp = FrameBuf;
+#if VMODE != 5
+	u8* oldattr = AttrBufDisp;
+	AttrBufDisp = AttrBuf;
+#endif
+
+	// wait for vertical blanking - old buffers are no longer displayed
+	while (!DispIsVSync()) {}
+	DispSwapFrame = DispFrame;
+
+	// draw into old buffers
+	FrameBuf = oldframe;
+#if VMODE != 5
+	AttrBuf = oldattr;
+#endif
+}
+#endif
+
 // Initialize videomode
 void DispInit()
 {
@@ -38,10 +116,18 @@ void DispInit()
 #endif
 
 	DispLine = 0;			// current display line
+#if DISP_DBLBUF
+#if VMODE != 5
+	AttrBufAddr = AttrBufDisp;	// current pointer to attribute buffer
+#endif
+	FrameBufAddr = FrameBufDisp;	// current pointer to graphics buffer
+	DispSwapFrame = DispFrame - 1;	// no pending buffer swap
+#else
 #if VMODE != 5
 	AttrBufAddr = AttrBuf;		// current pointer to attribute buffer
 #endif
 	FrameBufAddr = FrameBuf;	// current pointer to graphics buffer
+#endif
 
 	// trim HSI oscillator to 25MHz
 	RCC_HSITrim(31);
@@ -139,6 +225,9 @@ void DispInit()
 	TIM2_CC1Enable();		// enable compare output
 	TIM2_CC1IntClr();		// clear interrupt request
 	TIM2_CC1IntEnable();		// enable capture compare of channel 1
+#if DISP_PROF		// 1=profile VGA interrupt (debug)
+	DispProfReset();		// reset interrupt profiler
+#endif
 	NVIC_IRQEnable(IRQ_TIM2);	// enable interrupt service
 }
 
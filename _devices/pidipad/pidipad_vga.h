@@ -141,10 +141,19 @@ extern "C" {
 
 #endif // VMODE=...
 
+#if DISP_DBLBUF
+extern u8* FrameBuf;			// display graphics buffer - back buffer to draw into
+extern u8* volatile FrameBufDisp;	// display graphics buffer - front buffer being displayed
+#if VMODE != 5
+extern u8* AttrBuf;			// display attribute buffer - back buffer to draw into
+extern u8* volatile AttrBufDisp;	// display attribute buffer - front buffer being displayed
+#endif
+#else
 extern u8 FrameBuf[FRAMESIZE];		// display graphics buffer
 #if VMODE != 5
 extern u8 AttrBuf[ATTRSIZE];		// display attribute buffer (color of 2 pixels: 1st pixels in bits 1..3, 2nd pixel in bits 5..7)
 #endif
+#endif
 #if (VMODE == 7) || (VMODE == 8)
 extern u8 FontBuf[2048];		// bont buffer 8x8
 #endif
@@ -152,18 +161,55 @@ extern volatile int DispLine;		// current display line
 extern volatile u32 DispFrame;		// current frame
 extern volatile u32 DispTimTest;	// test - get TIM-CNT value at start of image (should be 144-19=125)
 
+#if DISP_PROF		// 1=profile VGA interrupt (debug)
+// Number of entries of latency histogram (if you change it, also check this in pidipad_vga_asm.S)
+#define DISP_PROF_HIST	32
+
+// VGA interrupt profiler (times in HCLK clock cycles, measured with Timer 2 relative to interrupt request)
+typedef struct {
+	u32	entry;		// 0x00: Timer 2 counter at start of interrupt of current scanline
+	u32	busy;		// 0x04: interrupt time of current frame
+	u32	frame;		// 0x08: interrupt time of last complete frame
+	u32	latmin;		// 0x0C: min. interrupt entry latency
+	u32	latmax;		// 0x10: max. interrupt entry latency
+	u32	isract;		// 0x14: max. interrupt time of active scanline
+	u32	isrblank;	// 0x18: max. interrupt time of blank scanline
+	u32	hist[DISP_PROF_HIST]; // 0x1C: histogram of entry latency (last entry = longer latencies)
+} sDispProf;
+
+extern volatile sDispProf DispProf;
+
+// reset VGA interrupt profiler (called from DispInit)
+void DispProfReset();
+
+// get remaining CPU time available to main program, in 0.1% (interrupt time of last frame)
+int DispProfFree();
+
+// get worst-case jitter of interrupt entry (max. - min. latency) in clock cycles
+INLINE int DispProfJitter() { return (DispProf.latmax >= DispProf.latmin) ? (int)(DispProf.latmax - DispProf.latmin) : 0; }
+#endif
+
 // check VSYNC
 #if VMODE == 9
-INLINE Bool DispIsVSync() { return DispLine >= 320; }
+INLINE Bool DispIsVSync() { HOST_POLL(); return DispLine >= 320; }
 #elif (VMODE == 4) || (VMODE == 5)
-INLINE Bool DispIsVSync() { return DispLine >= 384; }
+INLINE Bool DispIsVSync() { HOST_POLL(); return DispLine >= 384; }
 #else
-INLINE Bool DispIsVSync() { return DispLine >= 480; }
+INLINE Bool DispIsVSync() { HOST_POLL(); return DispLine >= 480; }
 #endif
 
 // wait for VSync scanline
 void WaitVSync();
 
+#if DISP_DBLBUF
+// swap display buffers - show drawn back buffer FrameBuf (and AttrBuf) and draw into the other buffer
+// - New buffer is taken by the interrupt at start of next frame, so the image never tears.
+// - Returns at start of vertical blanking at the latest, when old buffer is no longer displayed.
+// - If previous swapped buffer is not displayed yet, waits for the next frame first.
+// - New back buffer contains the image before the last one.
+void DispSwapBuffers();
+#endif
+
 // Initialize videomode
 void DispInit();
 
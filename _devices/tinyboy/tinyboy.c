@@ -1,11 +1,17 @@
 
 #include "../../includes.h"
 
+#if USE_HOST
+#include "tinyboy_host.c"
+#include "tinyboy_draw.c"
+#include "tinyboy_snd.c"
+#else
 #include "tinyboy_disp.c"
 #include "tinyboy_draw.c"
 #include "tinyboy_key.c"
 #include "tinyboy_snd.c"
 #include "tinyboy_bat.c"
 #include "tinyboy_init.c"
+#endif
 
 
@@ -171,6 +171,9 @@ Bool KeyNoPressed() {
   return True;
 }
 
+// check if keyboard service needs SysTick time steps (repeat or release is in progress)
+Bool KeyBusy() { return !KeyNoPressed(); }
+
 // wait for no key pressed
 void KeyWaitNoPressed() {
   while (!KeyNoPressed()) {
@@ -34,7 +34,7 @@ extern volatile u8 KeyWriteOff;	// write offset to keyboard buffer
 extern volatile u8 KeyReadOff;	// read offset from keyboard buffer
 
 // check if button KEY_* is currently pressed
-INLINE Bool KeyPressed(u8 key) { return KeyPressMap[key-1]; }
+INLINE Bool KeyPressed(u8 key) { HOST_POLL(); return KeyPressMap[key-1]; }
 
 // scan keyboard (called from SysTick)
 void KeyScan();
@@ -48,6 +48,9 @@ void KeyFlush();
 // check no pressed key
 Bool KeyNoPressed();
 
+// check if keyboard service needs SysTick time steps (repeat or release is in progress)
+Bool KeyBusy();
+
 // wait for no key pressed
 void KeyWaitNoPressed();
 
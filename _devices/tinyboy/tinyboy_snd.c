@@ -19,6 +19,13 @@ const sMelodyNote* volatile SoundMelodyNext;
 // remaining length of current tone (0 = no melody, -1 = start next melody)
 volatile s16 SoundMelodyLen = 0;
 
+// sound effect
+const sMelodyNote* volatile SoundEffPtr;	// pointer to current sound effect
+const sMelodyNote* volatile SoundEffNext;	// pointer to next sound effect
+volatile s16 SoundEffLen = 0;	// remaining length of current tone of sound effect (0 = no effect, -1 = start next effect)
+volatile u8 SoundEffPrio;	// priority of current sound effect
+u16 SoundMelodyDiv;		// divider of current tone of the melody (0 = pause), to resume melody after sound effect
+
 /*
 // Game sound samples
 const sMelodyNote SoundSamp1[] = {
@@ -115,7 +122,17 @@ const sMelodyNote SoundSamp4[] = {
 	{ 0, 0 },
 };
 */
-#endif // USE_SOUND
+#endif // USE_SOUND == 2
+
+#if !USE_HOST		// host build has its own tone output (tinyboy_host.c)
+
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+// update sound timer after change of system clock
+void SoundClock()
+{
+	TIM1_Div(SND_TIM_DIV);
+}
+#endif
 
 // Sound initialize
 // The audio output is via PA1 (pin 1),
@@ -165,11 +182,20 @@ void SoundInit()
 
 	// enable timer
 	TIM1_Enable();
+
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+	// update timer on change of system clock
+	RCC_SpeedNotify(SoundClock);
+#endif
 }
 
 // Sound terminate
 void SoundTerm()
 {
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+	RCC_SpeedUnnotify(SoundClock);
+#endif
+
 	// disable timer
 	TIM1_Disable();
 
@@ -194,24 +220,118 @@ void PlayTone(u32 div)
 	TIM1_CC2Enable();
 }
 
+// stop tone output
+static void SoundToneOff()
+{
+	// disable compare output
+	TIM1_CC2Disable();
+}
+
+#endif // !USE_HOST
+
 // Stop playing tone or melody
 void StopSound()
 {
 #if USE_SOUND == 2	// use sound support 1=tone, 2=melody
-	// stop melody
+	// stop melody and sound effect
 	SoundMelodyLen = 0;
+	SoundEffLen = 0;
 #endif
 
-	// disable compare output
-	TIM1_CC2Disable();
+	// stop tone output
+	SoundToneOff();
 }
 
 #if USE_SOUND == 2	// use sound support 1=tone, 2=melody
+// stop mark of the sound effect
+static const sMelodyNote SoundEffStop[] = { { 0, 0 } };
+
+// output tone of melody, music or sound effect (0 = pause)
+static void SoundOut(u16 div)
+{
+	if (div == 0)
+		SoundToneOff();
+	else
+		PlayTone(div);
+}
+
+// resume tone of melody or music after end of sound effect or melody
+static void SoundResume()
+{
+	// sound effect has priority
+	if (SoundEffLen != 0) return;
+
+	// melody (continues at its current position)
+	if (SoundMelodyLen > 0)
+	{
+		SoundOut(SoundMelodyDiv);
+		return;
+	}
+
+#if USE_MUSIC		// 1=use music player
+	// music
+	if (MusicPlaying())
+	{
+		SoundOut(MusicDiv);
+		return;
+	}
+#endif
+
+	// no sound
+	SoundOut(0);
+}
+
+// scan sound effect (returns True if sound effect is playing and preempts melody)
+static Bool SoundEffScan()
+{
+	// get current sound effect
+	int len = SoundEffLen;
+	if (len == 0) return False; // no sound effect
+
+	// pointer to current sound effect
+	const sMelodyNote* ptr;
+
+	// start next sound effect
+	if (len < 0)
+		ptr = SoundEffNext;
+
+	// continue sound effect - decrease counter of current tone
+	else
+	{
+		len--;
+		SoundEffLen = (s16)len;
+		if (len > 0) return True;
+		ptr = SoundEffPtr + 1;
+	}
+	SoundEffPtr = ptr;
+
+	// start next note
+	len = ptr->len;
+	SoundEffLen = (s16)len;
+	if (len > 0)
+	{
+		SoundOut(ptr->div);
+		return True;
+	}
+
+	// end of sound effect - resume melody or music
+	SoundResume();
+	return False;
+}
+
 // Sound scan melody
 void SoundScan()
 {
-	// get churrent melody
-	int len = SoundMelodyLen;	
+	// sound effect - preempts melody and music
+	Bool eff = SoundEffScan();
+
+#if USE_MUSIC		// 1=use music player
+	// music scan - sound effect and melody have priority
+	if (MusicScan() && !eff && (SoundMelodyLen == 0)) SoundOut(MusicDiv);
+#endif
+
+	// get current melody
+	int len = SoundMelodyLen;
 	if (len == 0) return; // no melody
 
 	// pointer to current melody
@@ -245,30 +365,19 @@ void SoundScan()
 	len = ptr->len;	// get length of the note
 	SoundMelodyLen = (s16)len;	// save length of new note
 
-	// end of melody
+	// end of melody - resume music
 	if (len == 0)
 	{
-		// disable compare output
-		TIM1_CC2Disable();
+		SoundMelodyDiv = 0;
+		if (!eff) SoundResume();
 	}
 
-	// start new note
+	// start new note (or pause), the melody runs silently during sound effect
 	else
 	{
-		// get note divider
 		u16 div = ptr->div;
-
-		// pause
-		if (div == 0)
-		{
-			// disable compare output
-			TIM1_CC2Disable();
-		}
-		else
-		{
-			// start playing tone
-			PlayTone(div);
-		}
+		SoundMelodyDiv = div;
+		if (!eff) SoundOut(div);
 	}
 }
 
@@ -282,7 +391,37 @@ void PlayMelody(const sMelodyNote* melody)
 
 	// request to restart melody
 	SoundMelodyLen = -1;
+	SysTick_Wake();
 }
-#endif // USE_SOUND
+
+// play sound effect with priority - effect preempts melody and music, melody continues after it
+//  effect = pointer to array of notes sMelodyNote (terminated with NOTE_STOP)
+//  prio = priority 0..255 (effect with lower priority than current effect is not played)
+// Returns False if effect was not started.
+Bool PlayEffect(const sMelodyNote* effect, int prio)
+{
+	// current sound effect has higher priority
+	if ((SoundEffLen != 0) && (prio < SoundEffPrio)) return False;
+
+	// set next sound effect
+	SoundEffNext = effect;
+	SoundEffPrio = (u8)prio;
+	cb();
+
+	// request to restart sound effect
+	SoundEffLen = -1;
+	SysTick_Wake();
+	return True;
+}
+
+// stop sound effect (melody or music resumes)
+void StopEffect()
+{
+	if (SoundEffLen == 0) return;
+	SoundEffNext = SoundEffStop;
+	cb();
+	SoundEffLen = -1;
+}
+#endif // USE_SOUND == 2
 
 #endif // USE_SOUND
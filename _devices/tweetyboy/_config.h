@@ -49,7 +49,11 @@
 #endif
 
 #ifndef USE_SOUND
-#define USE_SOUND	2	// use sound support 1=tone, 2=melody
+#define USE_SOUND	2	// use sound support 1=tone, 2=melody, 3=melody with mixer (DMA)
+#endif
+
+#ifndef USE_SNDSTREAM
+#define USE_SNDSTREAM	0	// 1=use streaming of WAV files from SD card (requires USE_SOUND=3 and USE_FAT)
 #endif
 
 #ifndef USE_SCREENSHOT
@@ -74,7 +78,7 @@
 #define SYSTICK_KEYSCAN	0	// 1=call KeyScan() function from SysTick system timer
 #endif
 
-#if USE_SOUND == 2		// use sound support 1=tone, 2=melody
+#if USE_SOUND >= 2		// use sound support 1=tone, 2=melody, 3=melody with mixer (DMA)
 #define SYSTICK_SOUNDSCAN 1	// 1=call SoundScan() function fron SysTick system timer
 #else
 #define SYSTICK_SOUNDSCAN 0	// 1=call SoundScan() function fron SysTick system timer
@@ -96,6 +100,26 @@
 #define USE_FAT		1	// 1=use FAT filesystem
 #endif
 
+#ifndef USE_FIX
+#define USE_FIX		1	// 1=use fixed-point math library
+#endif
+
+#ifndef USE_KVS
+#define USE_KVS		0	// 1=use key/value store in Flash (requires USE_FLASH and USE_CRC)
+#endif
+
+#ifndef USE_MIX
+#if USE_SOUND == 3		// use sound support 1=tone, 2=melody, 3=melody with mixer (DMA)
+#define USE_MIX		1	// 1=use audio mixer
+#else
+#define USE_MIX		0	// 1=use audio mixer
+#endif
+#endif
+
+#ifndef USE_MUSIC
+#define USE_MUSIC	0	// 1=use music player (requires USE_SOUND=2 or higher)
+#endif
+
 #ifndef USE_RAND
 #define USE_RAND	1	// 1=use random number generator
 #endif
@@ -108,10 +132,18 @@
 #define USE_ADC		1	// 1=use ADC peripheral
 #endif
 
+#ifndef USE_ADCSCAN
+#define USE_ADCSCAN	0	// 1=use continuous ADC scanning with DMA and oversampling (requires USE_ADC and USE_DMA)
+#endif
+
 #ifndef USE_DMA
 #define USE_DMA		1	// 1=use DMA peripheral
 #endif
 
+#ifndef USE_DMAQ
+#define USE_DMAQ	0	// 1=use asynchronous DMA memory copy and fill (requires USE_DMA)
+#endif
+
 #ifndef USE_FLASH
 #define USE_FLASH	1	// 1=use Flash programming
 #endif
@@ -120,6 +152,10 @@
 #define USE_I2C		1	// 1=use I2C peripheral
 #endif
 
+#ifndef USE_I2CQ
+#define USE_I2CQ	0	// 1=use interrupt driven I2C master with transaction queue (requires USE_I2C)
+#endif
+
 #ifndef USE_IRQ
 #define USE_IRQ		1	// 1=use IRQ interrupt support
 #endif
@@ -128,10 +164,44 @@
 #define USE_PWR		1	// 1=use power control
 #endif
 
+#ifndef USE_PROF
+#define USE_PROF	0	// 1=use sampling PC profiler (requires USE_TIM and USE_USART)
+#endif
+
+#ifndef PROF_TIM
+#define PROF_TIM	TIM1		// profiler timer (TIM2 is used by sound, TIM3 by display backlight)
+#define PROF_IRQ	IRQ_TIM1_UP	// profiler timer interrupt
+#define PROF_HANDLER	TIM1_UP_IRQHandler // profiler timer interrupt handler
+#endif
+
+#ifndef USE_RCCSPEED
+#define USE_RCCSPEED	0	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+#endif
+
 #ifndef USE_SPI
 #define USE_SPI		1	// 1=use SPI peripheral
 #endif
 
+#ifndef USE_SPIDMA
+#define USE_SPIDMA	0	// 1=use SPI DMA transfer (requires USE_SPI and USE_DMA)
+#endif
+
+#ifndef SPIDMA_RX
+#define SPIDMA_RX	(USE_SOUND != 3) // 1=use SPI1 RX DMA channel 2 (it is used by sound mixer with USE_SOUND=3)
+#endif
+
+#ifndef USE_SWTIMER
+#define USE_SWTIMER	0	// 1=use software timers (timer wheel)
+#endif
+
+#ifndef USE_TASK
+#define USE_TASK	0	// 1=use cooperative task scheduler
+#endif
+
+#ifndef USE_TASK_STACK
+#define USE_TASK_STACK	0	// 1=use tasks with own stack (requires USE_TASK; for CH32V2, CH32V3)
+#endif
+
 #ifndef USE_TIM
 #define USE_TIM		1	// 1=use timers
 #endif
@@ -140,6 +210,10 @@
 #define USE_USART	1	// 1=use USART peripheral
 #endif
 
+#ifndef USE_USARTBUF
+#define USE_USARTBUF	0	// 1=use buffered USART driver with DMA ring buffers (requires USE_USART and USE_DMA)
+#endif
+
 // ----------------------------------------------------------------------------
 //                            Clock Setup
 // ----------------------------------------------------------------------------
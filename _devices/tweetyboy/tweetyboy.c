@@ -1,11 +1,16 @@
 
 #include "../../includes.h"
 
+#if USE_HOST
+#include "tweetyboy_host.c"
+#include "tweetyboy_draw.c"
+#else
 #include "tweetyboy_disp.c"
 #include "tweetyboy_draw.c"
 #include "tweetyboy_key.c"
 #include "tweetyboy_snd.c"
 #include "tweetyboy_ss.c"
 #include "tweetyboy_init.c"
+#endif
 
 
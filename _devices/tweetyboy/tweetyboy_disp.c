@@ -544,6 +544,11 @@ void DispTerm(void)
 	GPIO_PinReset(DISP_SCK_GPIO);
 }
 
+#if (USE_DISP == 2) && USE_SPIDMA	// hardware display driver with SPI DMA transfer
+// line buffers in RGB565 format (one line is converted while the other one is sent by DMA)
+u16 DispLineBuf[2][WIDTH];
+#endif
+
 // set display update window (default full screen is DispUpdateSetup(0, 0, WIDTH, HEIGHT))
 void DispUpdateSetup(int x, int y, int w, int h)
 {
@@ -575,8 +580,32 @@ void DispUpdate()
 	const u16* pal = Palette;
 	const u8* s;
 	int i;
-	u16 ww;
 	DC_DATA;	// set data mode
+#if (USE_DISP == 2) && USE_SPIDMA	// hardware display driver with SPI DMA transfer
+	sSpiDma d;
+	d.next = NULL;
+	d.rx = NULL;
+	d.cnt = w;
+	d.flags = SPIDMA_16BIT;		// 16-bit frames, higher byte first
+	u16* dst;
+	int buf = 0;
+	for (; h > 0; h--)
+	{
+		// convert line to RGB565
+		s = &FrameBuf[x + y*WIDTHBYTE];
+		dst = DispLineBuf[buf];
+		for (i = w; i > 0; i--) *dst++ = pal[*s++];
+
+		// send line by DMA (wait for previous line)
+		SPI1_DmaWait();
+		d.tx = DispLineBuf[buf];
+		SPI1_DmaStart(&d, NULL);
+		buf ^= 1;
+		y++;
+	}
+	SPI1_DmaWait();
+#else
+	u16 ww;
 	for (; h > 0; h--)
 	{
 		s = &FrameBuf[x + y*WIDTHBYTE];
@@ -588,6 +617,7 @@ void DispUpdate()
 		}
 		y++;
 	}
+#endif
 
 	// display disconnect (deactivate chip selection)
 	DispDisconnect();
@@ -0,0 +1,568 @@
+// ****************************************************************************
+//
+//                     TweetyBoy - Host emulation of the device
+//
+// ****************************************************************************
+// Used instead of display, keyboard, sound and init drivers in host build (USE_HOST=1).
+
+#include "../../includes.h"
+
+#if USE_HOST
+
+// names of the keys (index = key code)
+const char* const HostKeyName[] = { "", "RIGHT", "UP", "LEFT", "DOWN", "A", "B", "X", "Y", NULL };
+
+// device time service
+void HostDevTime(void) {}
+
+// ----------------------------------------------------------------------------
+//                               Display
+// ----------------------------------------------------------------------------
+
+#if USE_DISP		// 1=use software display driver, 2=use hardware display driver (0=no driver)
+
+u8 FrameBuf[FRAMESIZE];		// display graphics buffer (1 pixel = 1 byte)
+#include "pal/pal332.h"		// const u16 DefPalette[256];	// default palettes RGB332 in RGB565 format
+const u16* Palette = PALETTE;	// pointer to palettes in RGB565 format
+
+int DispUpdateX = 0;		// display update X coordinate
+int DispUpdateY = 0;		// display update Y coordinate
+int DispUpdateW = WIDTH;	// display update width
+int DispUpdateH = HEIGHT;	// display update height
+
+u8 Disp_OutCol = COL_WHITE; // current output color
+u8 Disp_OutPage = 0;	// current output page (0..7)
+u8 Disp_OutX = 0;	// current output X (0..127)
+
+// emulated display memory in RGB565 format (keeps content outside of update window)
+u16 HostDispMem[WIDTH*HEIGHT];
+
+const int HostDispW = WIDTH;	// width of display image
+const int HostDispH = HEIGHT;	// height of display image
+
+// render display image to RGB buffer
+void HostRender(u8* rgb)
+{
+	int i;
+	u16 c;
+	for (i = 0; i < WIDTH*HEIGHT; i++)
+	{
+		c = HostDispMem[i];
+		*rgb++ = (u8)(((c >> 11) & 0x1f)*255/31);
+		*rgb++ = (u8)(((c >> 5) & 0x3f)*255/63);
+		*rgb++ = (u8)((c & 0x1f)*255/31);
+	}
+}
+
+// Display select simulated I2C page
+void DispI2C_SelectPage(int page)
+{
+	Disp_OutPage = page;
+	Disp_OutX = 0;
+}
+
+// set 8 pixels of simulated I2C byte (col2 = color of '0' bits, or -1 = unchanged)
+static void HostI2C_Byte(int x, int y, u8 data, u8 col, int col2)
+{
+	int i;
+	u8* d = &FrameBuf[x + 16 + (y + 8)*WIDTHBYTE];
+	for (i = 0; i < 8; i++)
+	{
+		if ((data & BIT(i)) != 0)
+			*d = col;
+		else if (col2 >= 0)
+			*d = (u8)col2;
+		d += WIDTHBYTE;
+	}
+}
+
+// write a byte over simulated I2C (write to frame buffer), using Disp_OutCol color
+void DispI2C_Write(u8 data)
+{
+	HostI2C_Byte(Disp_OutX, Disp_OutPage << 3, data, Disp_OutCol, COL_BLACK);
+	int x = Disp_OutX + 1;
+	if (x >= 128)
+	{
+		x = 0;
+		Disp_OutPage = (Disp_OutPage + 1) & 7;
+	}
+	Disp_OutX = x;
+}
+
+// add byte over simulated I2C (write to frame buffer), write only '1' bits
+void DispI2C_Add(int x, int y, u8 data, u8 col) { HostI2C_Byte(x, y << 3, data, col, -1); }
+
+// set byte over simulated I2C (write to frame buffer)
+void DispI2C_Set(int x, int y, u8 data, u8 col) { HostI2C_Byte(x, y << 3, data, col, COL_BLACK); }
+
+// clear byte over simulated I2C (write to frame buffer)
+void DispI2C_Clr(int x, int y) { HostI2C_Byte(x, y << 3, 0, COL_BLACK, COL_BLACK); }
+
+// backlight is not emulated
+void DispBacklight(u8 backlight) { (void)backlight; }
+u8 DispBacklightGet(void) { return BACKLIGHT_DEF; }
+void DispBacklightSet(u8 backlight) { (void)backlight; }
+void DispBacklightSetDef() {}
+void DispBacklightUpdate(void) {}
+
+// Display initialize
+void DispInit(void)
+{
+	memset(HostDispMem, 0, sizeof(HostDispMem));
+}
+
+// Display terminate
+void DispTerm(void) {}
+
+// set display update window (default full screen is DispUpdateSetup(0, 0, WIDTH, HEIGHT))
+void DispUpdateSetup(int x, int y, int w, int h)
+{
+	DispUpdateX = x;	// display update X coordinate
+	DispUpdateY = y;	// display update Y coordinate
+	DispUpdateW = w;	// display update width
+	DispUpdateH = h;	// display update height
+}
+
+// Display update - send frame buffer to the display (SPI 12 Mbps, 16 bits per pixel)
+void DispUpdate()
+{
+	int x = DispUpdateX;
+	int y = DispUpdateY;
+	int w = DispUpdateW;
+	int h = DispUpdateH;
+	const u16* pal = Palette;
+	int i;
+
+	HostTick(w*h*16*HCLK_PER_US/12 + 20*HCLK_PER_US);
+
+	for (; h > 0; h--)
+	{
+		for (i = 0; i < w; i++) HostDispMem[x + i + y*WIDTH] = pal[FrameBuf[x + i + y*WIDTHBYTE]];
+		y++;
+	}
+	HostFrame();
+}
+
+#else
+
+const int HostDispW = 1;
+const int HostDispH = 1;
+void HostRender(u8* rgb) { rgb[0] = rgb[1] = rgb[2] = 0; }
+
+#endif // USE_DISP
+
+// ----------------------------------------------------------------------------
+//                              Keyboard
+// ----------------------------------------------------------------------------
+
+#if USE_KEY		// 1=use keyboard support
+
+Bool KeyInitOk = False;		// keyboard initialized
+u32 KeyLastPress[KEY_NUM];
+u32 KeyLastRelease[KEY_NUM];
+volatile Bool KeyPressMap[KEY_NUM]; // keys are currently pressed (index = button code - 1)
+u8 KeyBuf[KEYBUF_SIZE];		// keyboard buffer
+volatile u8 KeyWriteOff = 0;	// write offset to keyboard buffer
+volatile u8 KeyReadOff = 0;	// read offset from keyboard buffer
+
+// write key to keyboard buffer
+void KeyWriteKey(u8 key)
+{
+	u8 w = KeyWriteOff;
+	u8 w2 = w + 1;
+	if (w2 >= KEYBUF_SIZE) w2 = 0;
+	if (w2 != KeyReadOff)
+	{
+		KeyBuf[w] = key;
+		KeyWriteOff = w2;
+	}
+}
+
+// scan keys (buttons are pressed by the key script)
+void KeyScan()
+{
+	if (!KeyInitOk) return; // keyboard not initialized
+
+	int i;
+	u32 t = (u32)HostClk; // time in ticks
+	for (i = 0; i < KEY_NUM; i++)
+	{
+		// check if button is pressed
+		if ((HostKeys & BIT64(i+1)) != 0)
+		{
+			// button is pressed for the first time
+			if (!KeyPressMap[i])
+			{
+				KeyLastPress[i] = t + (KEYCNT_PRESS - KEYCNT_REPEAT)*1000*HCLK_PER_US;
+				KeyPressMap[i] = True;
+				KeyWriteKey(i+1);
+			}
+
+			// button is already pressed - check repeat interval
+			else
+			{
+				if ((s32)(t - KeyLastPress[i]) >= (s32)(KEYCNT_REPEAT*1000*HCLK_PER_US))
+				{
+					KeyLastPress[i] = t;
+					KeyWriteKey(i+1);
+				}
+			}
+			KeyLastRelease[i] = t;
+		}
+
+		// button is release - check stop of press
+		else
+		{
+			if (KeyPressMap[i])
+			{
+				if ((s32)(t - KeyLastRelease[i]) >= (s32)(KEYCNT_REL*1000*HCLK_PER_US))
+				{
+					KeyPressMap[i] = False;
+				}
+			}
+		}
+	}
+}
+
+// get button from keyboard buffer KEY_* (returns NOKEY if no key)
+u8 KeyGet()
+{
+	HostPoll();
+
+	// check if keyboard buffer is empty
+	u8 r = KeyReadOff;
+	if (r == KeyWriteOff) return NOKEY;
+
+	// get key from keyboard buffer
+	u8 ch = KeyBuf[r];
+
+	// write new read offset
+	r++;
+	if (r >= KEYBUF_SIZE) r = 0;
+	KeyReadOff = r;
+	return ch;
+}
+
+// key flush
+void KeyFlush()
+{
+	while (KeyGet() != NOKEY) {}
+}
+
+// check no pressed key
+Bool KeyNoPressed()
+{
+	HostPoll();
+	int i;
+	for (i = 0; i < KEY_NUM; i++) if (KeyPressMap[i]) return False;
+	return True;
+}
+
+// wait for no key pressed
+void KeyWaitNoPressed()
+{
+	while (!KeyNoPressed()) {}
+}
+
+// Initialize keyboard service
+void KeyInit()
+{
+	KeyWriteOff = 0;
+	KeyReadOff = 0;
+	int i;
+	for (i = 0; i < KEY_NUM; i++) KeyPressMap[i] = False;
+	KeyInitOk = True; // keyboard initialized
+}
+
+// terminate keyboard
+void KeyTerm()
+{
+	KeyInitOk = False; // keyboard not initialized
+}
+
+#endif // USE_KEY
+
+// ----------------------------------------------------------------------------
+//                                Sound
+// ----------------------------------------------------------------------------
+
+#if USE_SOUND		// use sound support 1=tone, 2=melody, 3=melody with mixer
+
+#if USE_SOUND >= 2	// use sound support 1=tone, 2=melody, 3=melody with mixer
+// pointer to current melody
+const sMelodyNote* volatile SoundMelodyPtr;
+
+// pointer to next melody
+const sMelodyNote* volatile SoundMelodyNext;
+
+// remaining length of current tone (0 = no melody, -1 = start next melody)
+volatile s16 SoundMelodyLen = 0;
+
+// sound effect
+const sMelodyNote* volatile SoundEffPtr;	// pointer to current sound effect
+const sMelodyNote* volatile SoundEffNext;	// pointer to next sound effect
+volatile s16 SoundEffLen = 0;	// remaining length of current tone of sound effect (0 = no effect, -1 = start next effect)
+volatile u8 SoundEffPrio;	// priority of current sound effect
+u16 SoundMelodyDiv;		// divider of current tone of the melody (0 = pause), to resume melody after sound effect
+#endif
+
+// Sound initialize
+void SoundInit() {}
+
+// Sound terminate
+void SoundTerm() { HostSound(0); }
+
+// Start playing tone with divider (frequency of time base is 1 MHz)
+void PlayTone(u32 div)
+{
+	HostSound(100000000/(div+1));
+}
+
+// Stop playing tone or melody
+void StopSound()
+{
+#if USE_SOUND >= 2	// use sound support 1=tone, 2=melody, 3=melody with mixer
+	// stop melody and sound effect
+	SoundMelodyLen = 0;
+	SoundEffLen = 0;
+#endif
+
+	// stop tone
+	HostSound(0);
+}
+
+#if USE_SOUND >= 2	// use sound support 1=tone, 2=melody, 3=melody with mixer
+// stop mark of the sound effect
+static const sMelodyNote SoundEffStop[] = { { 0, 0 } };
+
+// output tone of melody, music or sound effect (0 = pause)
+static void SoundOut(u16 div)
+{
+	if (div == 0)
+		HostSound(0);
+	else
+		PlayTone(div);
+}
+
+// The host has no mixer output, sound effect preempts melody also with USE_SOUND=3.
+
+// resume tone of melody or music after end of sound effect or melody
+static void SoundResume()
+{
+	// sound effect has priority
+	if (SoundEffLen != 0) return;
+
+	// melody (continues at its current position)
+	if (SoundMelodyLen > 0)
+	{
+		SoundOut(SoundMelodyDiv);
+		return;
+	}
+
+#if USE_MUSIC		// 1=use music player
+	// music
+	if (MusicPlaying())
+	{
+		SoundOut(MusicDiv);
+		return;
+	}
+#endif
+
+	// no sound
+	SoundOut(0);
+}
+
+// scan sound effect (returns True if sound effect is playing and preempts melody)
+static Bool SoundEffScan()
+{
+	// get current sound effect
+	int len = SoundEffLen;
+	if (len == 0) return False; // no sound effect
+
+	// pointer to current sound effect
+	const sMelodyNote* ptr;
+
+	// start next sound effect
+	if (len < 0)
+		ptr = SoundEffNext;
+
+	// continue sound effect - decrease counter of current tone
+	else
+	{
+		len--;
+		SoundEffLen = (s16)len;
+		if (len > 0) return True;
+		ptr = SoundEffPtr + 1;
+	}
+	SoundEffPtr = ptr;
+
+	// start next note
+	len = ptr->len;
+	SoundEffLen = (s16)len;
+	if (len > 0)
+	{
+		SoundOut(ptr->div);
+		return True;
+	}
+
+	// end of sound effect - resume melody or music
+	SoundResume();
+	return False;
+}
+
+// Sound scan melody
+void SoundScan()
+{
+	// sound effect - preempts melody and music
+	Bool eff = SoundEffScan();
+
+#if USE_MUSIC		// 1=use music player
+	// music scan - sound effect and melody have priority
+	if (MusicScan() && !eff && (SoundMelodyLen == 0)) SoundOut(MusicDiv);
+#endif
+
+	// get current melody
+	int len = SoundMelodyLen;
+	if (len == 0) return; // no melody
+
+	// pointer to current melody
+	const sMelodyNote* ptr;
+
+	// start next melody
+	if (len < 0)
+	{
+		// get pointer to next melody
+		ptr = SoundMelodyNext;
+	}
+
+	// continue melody - decrease counter of current tone
+	else
+	{
+		len--;
+		SoundMelodyLen = (s16)len; // save new tone length
+
+		// continue current tone
+		if (len > 0) return;
+
+		// shift current melody pointer
+		ptr = SoundMelodyPtr;	// get pointer to current melody
+		ptr++;			// shift pointer to next tone
+	}
+
+	// save new pointer to current melody
+	SoundMelodyPtr = ptr;
+
+	// get length of next note
+	len = ptr->len;	// get length of the note
+	SoundMelodyLen = (s16)len;	// save length of new note
+
+	// end of melody - resume music
+	if (len == 0)
+	{
+		SoundMelodyDiv = 0;
+		if (!eff) SoundResume();
+	}
+
+	// start new note (or pause), the melody runs silently during sound effect
+	else
+	{
+		u16 div = ptr->div;
+		SoundMelodyDiv = div;
+		if (!eff) SoundOut(div);
+	}
+}
+
+// play melody
+//  melody = pointer to array of notes sMelodyNote (terminated with NOTE_STOP)
+void PlayMelody(const sMelodyNote* melody)
+{
+	// set next melody
+	SoundMelodyNext = melody;
+	cb();
+
+	// request to restart melody
+	SoundMelodyLen = -1;
+}
+
+// play sound effect with priority - effect preempts melody and music, melody continues after it
+//  effect = pointer to array of notes sMelodyNote (terminated with NOTE_STOP)
+//  prio = priority 0..255 (effect with lower priority than current effect is not played)
+// Returns False if effect was not started.
+Bool PlayEffect(const sMelodyNote* effect, int prio)
+{
+	// current sound effect has higher priority
+	if ((SoundEffLen != 0) && (prio < SoundEffPrio)) return False;
+
+	// set next sound effect
+	SoundEffNext = effect;
+	SoundEffPrio = (u8)prio;
+	cb();
+
+	// request to restart sound effect
+	SoundEffLen = -1;
+	return True;
+}
+
+// stop sound effect (melody or music resumes)
+void StopEffect()
+{
+	if (SoundEffLen == 0) return;
+	SoundEffNext = SoundEffStop;
+	cb();
+	SoundEffLen = -1;
+}
+
+#endif // USE_SOUND >= 2
+
+#if USE_SOUND == 3 && USE_SNDSTREAM && USE_FAT	// 1=use streaming of WAV files from SD card
+// stream statistics
+u32 SoundStreamFills = 0;
+u32 SoundStreamMaxTime = 0;
+
+// WAV streaming is not emulated - the host has no mixer output
+Bool SoundStreamPlay(const char* path, int vol) { return False; }
+void SoundStreamStop() {}
+void SoundStreamLock() {}
+void SoundStreamUnlock() {}
+Bool SoundStreamPlaying() { return False; }
+#endif
+
+#endif // USE_SOUND
+
+// ----------------------------------------------------------------------------
+//                             Device init
+// ----------------------------------------------------------------------------
+
+// Initialize device
+void DevInit()
+{
+#if USE_KEY		// 1=use keyboard support
+	KeyInit();
+#endif
+
+#if USE_SOUND		// use sound support 1=tone, 2=melody, 3=melody with mixer
+	SoundInit();
+#endif
+
+#if USE_DISP		// 1=use display support
+	DispInit();
+#endif
+
+#if USE_DRAW || USE_PRINT
+	DrawClear();
+#endif
+}
+
+// Terminate device
+void DevTerm()
+{
+#if USE_SOUND		// use sound support 1=tone, 2=melody, 3=melody with mixer
+	SoundTerm();
+#endif
+
+#if USE_KEY		// 1=use keyboard support
+	KeyTerm();
+#endif
+}
+
+#endif // USE_HOST
@@ -15,7 +15,7 @@ void DevInit()
 	KeyInit();
 #endif
 
-#if USE_SOUND		// use sound support 1=tone, 2=melody
+#if USE_SOUND		// use sound support 1=tone, 2=melody, 3=melody with mixer
 	// Sound initialize
 	SoundInit();
 #endif
@@ -54,7 +54,7 @@ void DevTerm()
 	SD_Term();
 #endif
 
-#if USE_SOUND		// use sound support 1=tone, 2=melody
+#if USE_SOUND		// use sound support 1=tone, 2=melody, 3=melody with mixer
 	// Sound terminate
 	SoundTerm();
 #endif
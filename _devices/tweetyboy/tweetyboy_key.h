@@ -45,7 +45,7 @@ extern volatile u8 KeyWriteOff;	// write offset to keyboard buffer
 extern volatile u8 KeyReadOff;	// read offset from keyboard buffer
 
 // check if button KEY_* is currently pressed
-INLINE Bool KeyPressed(u8 key) { return KeyPressMap[key-1]; }
+INLINE Bool KeyPressed(u8 key) { HOST_POLL(); return KeyPressMap[key-1]; }
 
 // scan keyboard (called from SysTick)
 void KeyScan();
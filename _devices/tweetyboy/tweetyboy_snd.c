@@ -7,9 +7,13 @@
 
 #include "../../includes.h"
 
-#if USE_SOUND		// use sound support 1=tone, 2=melody
+#if USE_SOUND		// use sound support 1=tone, 2=melody, 3=melody with mixer
 
-#if USE_SOUND == 2	// use sound support 1=tone, 2=melody
+#if (USE_SOUND == 3) && USE_SPIDMA && SPIDMA_RX && (SND_MIX_DMA == 2)
+#error "Sound mixer (USE_SOUND=3) uses DMA channel 2, which is SPI1 RX DMA channel - set SPIDMA_RX to 0"
+#endif
+
+#if USE_SOUND >= 2	// use sound support 1=tone, 2=melody, 3=melody with mixer
 // pointer to current melody
 const sMelodyNote* volatile SoundMelodyPtr;
 
@@ -19,6 +23,13 @@ const sMelodyNote* volatile SoundMelodyNext;
 // remaining length of current tone (0 = no melody, -1 = start next melody)
 volatile s16 SoundMelodyLen = 0;
 
+// sound effect
+const sMelodyNote* volatile SoundEffPtr;	// pointer to current sound effect
+const sMelodyNote* volatile SoundEffNext;	// pointer to next sound effect
+volatile s16 SoundEffLen = 0;	// remaining length of current tone of sound effect (0 = no effect, -1 = start next effect)
+volatile u8 SoundEffPrio;	// priority of current sound effect
+u16 SoundMelodyDiv;		// divider of current tone of the melody (0 = pause), to resume melody after sound effect
+
 // Game sound samples
 const sMelodyNote SoundSamp1[] = {
 	{ 1, NOTE_C6 },
@@ -116,6 +127,482 @@ const sMelodyNote SoundSamp4[] = {
 
 #endif // USE_SOUND
 
+#if USE_SOUND == 3	// use sound support 1=tone, 2=melody, 3=melody with mixer
+
+// sample buffer of the mixer (2 halves, circular DMA)
+u16 SoundMixBuf[SND_MIX_BUF*2];
+
+// DMA interrupt - render samples into the half of buffer, which has just been sent
+HANDLER void DMA1_Channel2_IRQHandler()
+{
+	// first half has been sent
+	if (DMA1_Half(SND_MIX_DMA))
+	{
+		DMA1_HalfClr(SND_MIX_DMA);
+		MixRender(SoundMixBuf, SND_MIX_BUF, SND_MIX_PERIOD);
+	}
+
+	// second half has been sent
+	if (DMA1_Comp(SND_MIX_DMA))
+	{
+		DMA1_CompClr(SND_MIX_DMA);
+		MixRender(SoundMixBuf + SND_MIX_BUF, SND_MIX_BUF, SND_MIX_PERIOD);
+	}
+
+#if USE_SNDSTREAM && USE_FAT	// 1=use streaming of WAV files from SD card
+	// request refill of the stream buffer in low-priority interrupt
+	NVIC_IRQForce(IRQ_SW);
+#endif
+}
+
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+// update sound timer after change of system clock
+void SoundClock()
+{
+	TIM2_Load(SND_MIX_PERIOD - 1);
+}
+#endif
+
+// Sound initialize
+// The audio output is via PB3 (pin 18),
+// Timer 2 channel 3 mapping 2, DMA1 channel 2 (TIM2_UP request).
+void SoundInit()
+{
+	int i;
+
+	// initialize mixer and fill buffer with silence
+	MixInit(SND_MIX_RATE);
+	for (i = 0; i < SND_MIX_BUF*2; i++) SoundMixBuf[i] = SND_MIX_PERIOD/2;
+
+	// setup output pins
+	RCC_AFIClkEnable();
+	RCC_PBClkEnable();
+	GPIO_Mode(PB3, GPIO_MODE_AF);
+
+	// Remap Timer 2
+	GPIO_Remap_TIM2(2);
+
+	// Enable timer clock source
+	TIM2_ClkEnable();
+
+	// Reset timer to default setup
+	TIM2_Reset();
+
+	// select input from internal clock CK_INT
+	TIM2_InMode(TIM_INMODE_INT);
+
+	// PWM period = 1 sample
+	TIM2_Div(1);
+	TIM2_Load(SND_MIX_PERIOD - 1);
+	TIM2_Comp3(SND_MIX_PERIOD/2);
+	TIM2_DirUp();
+	TIM2_Update();
+	TIM2_AutoReloadEnable();
+	TIM2_OC3Mode(TIM_COMP_PWM1);
+	TIM2_OC3PreEnable();
+	TIM2_OCEnable();
+	TIM2_CC3Enable();
+
+	// setup DMA channel - send samples to compare register on timer update
+	RCC_DMA1ClkEnable();
+	DMAchan_t* chan = DMA1_Chan(SND_MIX_DMA);
+	DMA_PerAddr(chan, &TIM2->CH3CVR);
+	DMA_MemAddr(chan, SoundMixBuf);
+	DMA_Cnt(chan, SND_MIX_BUF*2);
+	DMA1_IntClr(SND_MIX_DMA);
+	DMA_Cfg(chan,
+		DMA_CFG_EN |			// channel enable
+		DMA_CFG_COMPINT |		// completion interrupt enable
+		DMA_CFG_HALFINT |		// over half interrupt enable
+		DMA_CFG_DIRFROMMEM |		// transfer direction from memory
+		DMA_CFG_CIRC |			// circular mode enabled
+		DMA_CFG_MEMINC |		// memory address increment
+		DMA_CFG_PSIZE_16 |		// ... peripheral data size 16 bits
+		DMA_CFG_MSIZE_16 |		// ... memory data size 16 bits
+		DMA_CFG_PRIOR_HIGH |		// ... channel priority 2 high
+		0);
+	NVIC_IRQEnable(IRQ_DMA1_CH2);
+
+#if USE_SNDSTREAM && USE_FAT	// 1=use streaming of WAV files from SD card
+	// software interrupt with lowest priority refills the stream buffer
+	NVIC_IRQPriority(IRQ_SW, IRQ_PRIO_LOW);
+	NVIC_IRQEnable(IRQ_SW);
+#endif
+
+	// start timer with DMA request on update
+	TIM2_UDMAReqEnable();
+	TIM2_Enable();
+
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+	// update timer on change of system clock
+	RCC_SpeedNotify(SoundClock);
+#endif
+}
+
+// Sound terminate
+void SoundTerm()
+{
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+	RCC_SpeedUnnotify(SoundClock);
+#endif
+
+	// stop DMA
+	NVIC_IRQDisable(IRQ_DMA1_CH2);
+	TIM2_UDMAReqDisable();
+	DMA_Cfg(DMA1_Chan(SND_MIX_DMA), 0);
+	DMA1_IntClr(SND_MIX_DMA);
+
+#if USE_SNDSTREAM && USE_FAT	// 1=use streaming of WAV files from SD card
+	// stop stream refill
+	SoundStreamStop();
+	NVIC_IRQDisable(IRQ_SW);
+#endif
+
+	// disable timer
+	TIM2_Disable();
+
+	// Reset timer to default setup
+	TIM2_Reset();
+
+	// reset output pins
+	GPIO_PinReset(PB3);
+}
+
+// convert tone divider of 1 MHz time base to phase step of the mixer
+static u32 SoundMixStep(u32 div)
+{
+	return (u32)(((u64)1000000 << 32) / ((u64)(div + 1)*SND_MIX_RATE));
+}
+
+// Start playing tone with divider - use macro SND_GET_DIV(hz01) with
+//  frequency in 0.01 Hz, minimum 15.26Hz, or use constant NOTE_*
+void PlayTone(u32 div)
+{
+	MixTone(SND_MIX_VOICE, MIX_WAVE_SQUARE, SoundMixStep(div), MIX_DUTY_HALF, MIX_VOL_MAX);
+}
+
+// stop tone
+INLINE void SoundToneOff() { MixStop(SND_MIX_VOICE); }
+
+#if USE_SNDSTREAM && USE_FAT	// 1=use streaming of WAV files from SD card
+
+// stream formats
+#define SND_STREAM_NONE		0	// not playing
+#define SND_STREAM_PCM8		1	// 8-bit unsigned PCM
+#define SND_STREAM_ADPCM	2	// 4-bit IMA ADPCM
+
+// stream buffer (2 halves)
+s8 SoundStreamBuf[SND_STREAM_HALF*2];
+
+// stream state
+sFile SoundStreamFile;			// open WAV file
+u8 SoundStreamFormat = SND_STREAM_NONE;	// stream format SND_STREAM_*
+u8 SoundStreamFill;			// index of next half to refill
+Bool SoundStreamEof;			// end of data reached
+u32 SoundStreamRem;			// remaining bytes of data chunk
+u8 SoundStreamLocks = 0;		// nesting counter of SoundStreamLock()
+
+// ADPCM decoder
+s32 SoundStreamPred;			// ADPCM predictor
+u8 SoundStreamIndex;			// ADPCM step index 0..88
+u8 SoundStreamNib;			// ADPCM next nibble (0x10 = none)
+u16 SoundStreamAlign;			// ADPCM block size in bytes
+u16 SoundStreamBlk;			// ADPCM remaining bytes of current block
+u8 SoundStreamRd[64];			// ADPCM read buffer
+u8 SoundStreamRdPos;			// ADPCM read position
+u8 SoundStreamRdNum;			// ADPCM number of bytes in read buffer
+
+// stream statistics
+u32 SoundStreamFills = 0;		// number of refilled halves
+u32 SoundStreamMaxTime = 0;		// max. time of refill of one half in [us] (SD card latency)
+
+// IMA ADPCM step table
+static const u16 SoundImaStep[89] = {
+	7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31,
+	34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143,
+	157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658,
+	724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024,
+	3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+	15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+};
+
+// IMA ADPCM index change (by lower 3 bits of the nibble)
+static const s8 SoundImaIndex[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+// get little-endian u16 and u32
+INLINE u16 SoundStreamU16(const u8* p) { return (u16)(p[0] | ((u16)p[1] << 8)); }
+INLINE u32 SoundStreamU32(const u8* p) { return SoundStreamU16(p) | ((u32)SoundStreamU16(p+2) << 16); }
+
+// read next byte of ADPCM data (returns -1 on end of data)
+static int SoundStreamByte()
+{
+	if (SoundStreamRdPos >= SoundStreamRdNum)
+	{
+		u32 n = SoundStreamRem;
+		if (n > sizeof(SoundStreamRd)) n = sizeof(SoundStreamRd);
+		if (n == 0) return -1;
+		n = FileRead(&SoundStreamFile, SoundStreamRd, n);
+		if (n == 0)
+		{
+			SoundStreamRem = 0;
+			return -1;
+		}
+		SoundStreamRem -= n;
+		SoundStreamRdNum = (u8)n;
+		SoundStreamRdPos = 0;
+	}
+	return SoundStreamRd[SoundStreamRdPos++];
+}
+
+// decode ADPCM samples into buffer (returns number of samples)
+static int SoundStreamAdpcm(s8* dst, int num)
+{
+	int i, b, nib, step, diff;
+	s32 pred = SoundStreamPred;
+	int inx = SoundStreamIndex;
+
+	for (i = 0; i < num; i++)
+	{
+		// start of new block - header with s16 first sample and u8 step index
+		if (SoundStreamBlk == 0)
+		{
+			b = SoundStreamByte();
+			nib = SoundStreamByte();
+			pred = (s16)(b | (nib << 8));
+			inx = SoundStreamByte();
+			if (SoundStreamByte() < 0) break;
+			if (inx > 88) inx = 88;
+			SoundStreamBlk = SoundStreamAlign - 4;
+			SoundStreamNib = 0x10;
+			dst[i] = (s8)(pred >> 8);
+			continue;
+		}
+
+		// get next nibble (lower nibble first)
+		nib = SoundStreamNib;
+		if (nib == 0x10)
+		{
+			b = SoundStreamByte();
+			if (b < 0) break;
+			nib = b & 0x0f;
+			SoundStreamNib = (u8)(b >> 4);
+		}
+		else
+		{
+			SoundStreamNib = 0x10;
+			SoundStreamBlk--;
+		}
+
+		// decode sample
+		step = SoundImaStep[inx];
+		diff = step >> 3;
+		if (nib & 4) diff += step;
+		if (nib & 2) diff += step >> 1;
+		if (nib & 1) diff += step >> 2;
+		if (nib & 8) pred -= diff; else pred += diff;
+		if (pred > 32767) pred = 32767;
+		if (pred < -32768) pred = -32768;
+		inx += SoundImaIndex[nib & 7];
+		if (inx < 0) inx = 0;
+		if (inx > 88) inx = 88;
+		dst[i] = (s8)(pred >> 8);
+	}
+
+	SoundStreamPred = pred;
+	SoundStreamIndex = (u8)inx;
+	return i;
+}
+
+// fill half of the stream buffer (returns True on end of data)
+static Bool SoundStreamLoad(int h)
+{
+	s8* dst = &SoundStreamBuf[h*SND_STREAM_HALF];
+	int i, n;
+
+	if (SoundStreamFormat == SND_STREAM_PCM8)
+	{
+		// read unsigned samples and convert them to signed
+		n = SND_STREAM_HALF;
+		if ((u32)n > SoundStreamRem) n = SoundStreamRem;
+		n = FileRead(&SoundStreamFile, dst, n);
+		SoundStreamRem -= n;
+		if (n < SND_STREAM_HALF) SoundStreamRem = 0;
+		for (i = 0; i < n; i++) dst[i] ^= 0x80;
+	}
+	else
+		n = SoundStreamAdpcm(dst, SND_STREAM_HALF);
+
+	// pad rest of the buffer with silence
+	for (i = n; i < SND_STREAM_HALF; i++) dst[i] = 0;
+
+	// check end of data
+	if (n < SND_STREAM_HALF) return True;
+	if (SoundStreamRem != 0) return False;
+	return (SoundStreamFormat == SND_STREAM_PCM8) ||
+		((SoundStreamRdPos >= SoundStreamRdNum) && (SoundStreamNib == 0x10));
+}
+
+// parse WAV header and find data chunk (returns False if format is not supported)
+static Bool SoundStreamHead(u32* rate)
+{
+	sFile* f = &SoundStreamFile;
+	u8 h[16];
+	u32 id, size;
+	u16 fmt, bits;
+	Bool fmtok = False;
+
+	// RIFF header
+	if ((FileRead(f, h, 12) != 12) ||
+		(SoundStreamU32(h) != 0x46464952) ||	// "RIFF"
+		(SoundStreamU32(h+8) != 0x45564157))	// "WAVE"
+		return False;
+
+	// chunks
+	while (FileRead(f, h, 8) == 8)
+	{
+		id = SoundStreamU32(h);
+		size = SoundStreamU32(h+4);
+
+		// data chunk
+		if (id == 0x61746164) // "data"
+		{
+			SoundStreamRem = size;
+			return fmtok;
+		}
+
+		// format chunk
+		if ((id == 0x20746D66) && (size >= 16)) // "fmt "
+		{
+			if (FileRead(f, h, 16) != 16) return False;
+			fmt = SoundStreamU16(h);
+			*rate = SoundStreamU32(h+4);
+			SoundStreamAlign = SoundStreamU16(h+12);
+			bits = SoundStreamU16(h+14);
+			if ((SoundStreamU16(h+2) != 1) || (*rate == 0) || (*rate > SND_MIX_RATE)) return False;
+			if ((fmt == 1) && (bits == 8))
+				SoundStreamFormat = SND_STREAM_PCM8;
+			else if ((fmt == 0x11) && (bits == 4) && (SoundStreamAlign > 4))
+				SoundStreamFormat = SND_STREAM_ADPCM;
+			else
+				return False;
+			fmtok = True;
+			size -= 16;
+		}
+
+		// skip rest of the chunk (chunks are aligned to 2 bytes)
+		if (!FileSeek(f, f->off + size + (size & 1))) return False;
+	}
+	return False;
+}
+
+// start streaming WAV file from SD card (disk must be mounted), vol = volume 0..255
+//  Supported formats: mono 8-bit unsigned PCM or mono 4-bit IMA ADPCM, sample rate up to SND_MIX_RATE.
+// Returns False if file cannot be opened or format is not supported.
+Bool SoundStreamPlay(const char* path, int vol)
+{
+	u32 rate;
+
+	// stop current stream
+	SoundStreamStop();
+
+	// open file and parse header (refill interrupt is blocked while accessing the disk)
+	SoundStreamLock();
+	if (!FileOpen(&SoundStreamFile, path))
+	{
+		SoundStreamUnlock();
+		return False;
+	}
+	SoundStreamFormat = SND_STREAM_NONE;
+	SoundStreamBlk = 0;
+	SoundStreamRdPos = 0;
+	SoundStreamRdNum = 0;
+	SoundStreamPred = 0;
+	SoundStreamIndex = 0;
+	if (!SoundStreamHead(&rate))
+	{
+		FileClose(&SoundStreamFile);
+		SoundStreamUnlock();
+		return False;
+	}
+
+	// fill both halves and start the voice (second half is silence on short file)
+	SoundStreamLoad(0);
+	SoundStreamEof = SoundStreamLoad(1);
+	SoundStreamFill = 0;
+	MixStream(SND_STREAM_VOICE, SoundStreamBuf, SND_STREAM_HALF, rate, vol, SoundStreamEof);
+	SoundStreamUnlock();
+	return True;
+}
+
+// stop streaming
+void SoundStreamStop()
+{
+	SoundStreamLock();
+	MixStop(SND_STREAM_VOICE);
+	SoundStreamFormat = SND_STREAM_NONE;
+	if (FileIsOpen(&SoundStreamFile)) FileClose(&SoundStreamFile);
+	SoundStreamUnlock();
+}
+
+// block/unblock refill of the stream buffer (main loop must block it while accessing SD card)
+// - Locks can be nested, refill is enabled again by the last unlock.
+void SoundStreamLock()
+{
+	NVIC_IRQDisable(IRQ_SW);
+	SoundStreamLocks++;
+}
+
+void SoundStreamUnlock()
+{
+	if ((SoundStreamLocks > 0) && (--SoundStreamLocks == 0)) NVIC_IRQEnable(IRQ_SW);
+}
+
+// refill stream buffer - software interrupt raised from the mixer DMA interrupt
+HANDLER void SW_Handler()
+{
+	if (SoundStreamFormat == SND_STREAM_NONE) return;
+
+	// end of playing - close file
+	if (!MixPlaying(SND_STREAM_VOICE))
+	{
+		MixStop(SND_STREAM_VOICE);
+		SoundStreamFormat = SND_STREAM_NONE;
+		FileClose(&SoundStreamFile);
+		return;
+	}
+
+	// refill released half
+	int h = SoundStreamFill;
+	if (SoundStreamEof || (MixVoice[SND_STREAM_VOICE].sfull[h] != 0)) return;
+	u32 t = Time();
+	SoundStreamEof = SoundStreamLoad(h);
+	MixStreamFull(SND_STREAM_VOICE, h, SoundStreamEof);
+	SoundStreamFill = (u8)(h ^ 1);
+
+	// statistics
+	t = (Time() - t)/HCLK_PER_US;
+	if (t > SoundStreamMaxTime) SoundStreamMaxTime = t;
+	SoundStreamFills++;
+}
+
+// check if stream is playing
+Bool SoundStreamPlaying()
+{
+	return (SoundStreamFormat != SND_STREAM_NONE) && MixPlaying(SND_STREAM_VOICE);
+}
+
+#endif // USE_SNDSTREAM
+
+#else // USE_SOUND == 3
+
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+// update sound timer after change of system clock
+void SoundClock()
+{
+	TIM2_Div(SND_TIM_DIV);
+}
+#endif
+
 // Sound initialize
 // The audio output is via PB3 (pin 18),
 // Timer 2 channel 3 mapping 2.
@@ -168,11 +655,20 @@ void SoundInit()
 
 	// enable timer
 	TIM2_Enable();
+
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+	// update timer on change of system clock
+	RCC_SpeedNotify(SoundClock);
+#endif
 }
 
 // Sound terminate
 void SoundTerm()
 {
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+	RCC_SpeedUnnotify(SoundClock);
+#endif
+
 	// disable timer
 	TIM2_Disable();
 
@@ -197,24 +693,140 @@ void PlayTone(u32 div)
 	TIM2_CC3Enable();
 }
 
+// stop tone
+INLINE void SoundToneOff() { TIM2_CC3Disable(); }
+
+#endif // USE_SOUND == 3
+
 // Stop playing tone or melody
 void StopSound()
 {
-#if USE_SOUND == 2	// use sound support 1=tone, 2=melody
-	// stop melody
+#if USE_SOUND >= 2	// use sound support 1=tone, 2=melody, 3=melody with mixer
+	// stop melody and sound effect
 	SoundMelodyLen = 0;
+	SoundEffLen = 0;
 #endif
 
-	// disable compare output
-	TIM2_CC3Disable();
+	// stop tone
+	SoundToneOff();
+
+#if USE_SOUND == 3	// use sound support 1=tone, 2=melody, 3=melody with mixer
+	// stop sound effect voice
+	MixStop(SND_MIX_VOICE_EFF);
+#endif
+}
+
+#if USE_SOUND >= 2	// use sound support 1=tone, 2=melody, 3=melody with mixer
+// stop mark of the sound effect
+static const sMelodyNote SoundEffStop[] = { { 0, 0 } };
+
+// output tone of melody, music or sound effect (0 = pause)
+static void SoundOut(u16 div)
+{
+	if (div == 0)
+		SoundToneOff();
+	else
+		PlayTone(div);
+}
+
+#if USE_SOUND == 3	// use sound support 1=tone, 2=melody, 3=melody with mixer
+// output tone of sound effect to its own mixer voice, plays together with melody (0 = pause)
+static void SoundEffOut(u16 div)
+{
+	if (div == 0)
+		MixStop(SND_MIX_VOICE_EFF);
+	else
+		MixTone(SND_MIX_VOICE_EFF, MIX_WAVE_SQUARE, SoundMixStep(div), MIX_DUTY_HALF, MIX_VOL_MAX);
+}
+#define SOUND_EFF_PREEMPT 0	// sound effect does not preempt melody
+#else
+#define SoundEffOut(div) SoundOut(div)
+#define SOUND_EFF_PREEMPT 1	// sound effect preempts melody
+#endif
+
+// resume tone of melody or music after end of sound effect or melody
+static void SoundResume()
+{
+#if SOUND_EFF_PREEMPT
+	// sound effect has priority
+	if (SoundEffLen != 0) return;
+#endif
+
+	// melody (continues at its current position)
+	if (SoundMelodyLen > 0)
+	{
+		SoundOut(SoundMelodyDiv);
+		return;
+	}
+
+#if USE_MUSIC		// 1=use music player
+	// music
+	if (MusicPlaying())
+	{
+		SoundOut(MusicDiv);
+		return;
+	}
+#endif
+
+	// no sound
+	SoundOut(0);
+}
+
+// scan sound effect (returns True if sound effect is playing and preempts melody)
+static Bool SoundEffScan()
+{
+	// get current sound effect
+	int len = SoundEffLen;
+	if (len == 0) return False; // no sound effect
+
+	// pointer to current sound effect
+	const sMelodyNote* ptr;
+
+	// start next sound effect
+	if (len < 0)
+		ptr = SoundEffNext;
+
+	// continue sound effect - decrease counter of current tone
+	else
+	{
+		len--;
+		SoundEffLen = (s16)len;
+		if (len > 0) return SOUND_EFF_PREEMPT;
+		ptr = SoundEffPtr + 1;
+	}
+	SoundEffPtr = ptr;
+
+	// start next note
+	len = ptr->len;
+	SoundEffLen = (s16)len;
+	if (len > 0)
+	{
+		SoundEffOut(ptr->div);
+		return SOUND_EFF_PREEMPT;
+	}
+
+	// end of sound effect - resume melody or music
+#if SOUND_EFF_PREEMPT
+	SoundResume();
+#else
+	SoundEffOut(0);
+#endif
+	return False;
 }
 
-#if USE_SOUND == 2	// use sound support 1=tone, 2=melody
 // Sound scan melody
 void SoundScan()
 {
-	// get churrent melody
-	int len = SoundMelodyLen;	
+	// sound effect - preempts melody and music
+	Bool eff = SoundEffScan();
+
+#if USE_MUSIC		// 1=use music player
+	// music scan - sound effect and melody have priority
+	if (MusicScan() && !eff && (SoundMelodyLen == 0)) SoundOut(MusicDiv);
+#endif
+
+	// get current melody
+	int len = SoundMelodyLen;
 	if (len == 0) return; // no melody
 
 	// pointer to current melody
@@ -248,30 +860,19 @@ void SoundScan()
 	len = ptr->len;	// get length of the note
 	SoundMelodyLen = (s16)len;	// save length of new note
 
-	// end of melody
+	// end of melody - resume music
 	if (len == 0)
 	{
-		// disable compare output
-		TIM2_CC3Disable();
+		SoundMelodyDiv = 0;
+		if (!eff) SoundResume();
 	}
 
-	// start new note
+	// start new note (or pause), the melody runs silently during sound effect
 	else
 	{
-		// get note divider
 		u16 div = ptr->div;
-
-		// pause
-		if (div == 0)
-		{
-			// disable compare output
-			TIM2_CC3Disable();
-		}
-		else
-		{
-			// start playing tone
-			PlayTone(div);
-		}
+		SoundMelodyDiv = div;
+		if (!eff) SoundOut(div);
 	}
 }
 
@@ -286,6 +887,34 @@ void PlayMelody(const sMelodyNote* melody)
 	// request to restart melody
 	SoundMelodyLen = -1;
 }
+
+// play sound effect with priority - effect preempts melody and music, melody continues after it
+//  effect = pointer to array of notes sMelodyNote (terminated with NOTE_STOP)
+//  prio = priority 0..255 (effect with lower priority than current effect is not played)
+// Returns False if effect was not started.
+Bool PlayEffect(const sMelodyNote* effect, int prio)
+{
+	// current sound effect has higher priority
+	if ((SoundEffLen != 0) && (prio < SoundEffPrio)) return False;
+
+	// set next sound effect
+	SoundEffNext = effect;
+	SoundEffPrio = (u8)prio;
+	cb();
+
+	// request to restart sound effect
+	SoundEffLen = -1;
+	return True;
+}
+
+// stop sound effect (melody or music resumes)
+void StopEffect()
+{
+	if (SoundEffLen == 0) return;
+	SoundEffNext = SoundEffStop;
+	cb();
+	SoundEffLen = -1;
+}
 #endif // USE_SOUND
 
 #endif // USE_SOUND
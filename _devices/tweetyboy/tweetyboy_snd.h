@@ -6,8 +6,16 @@
 // ****************************************************************************
 // The audio output is via PB3 (pin 18),
 // Timer 2 channel 3 mapping 2.
+// With USE_SOUND=3, the timer generates PWM at the sample rate and the samples
+// from the mixer (lib_mix) are sent by DMA to the compare register. Tones and
+// melodies are played on voice SND_MIX_VOICE, other voices are free for effects.
+// With USE_SNDSTREAM, WAV file from SD card can be streamed on voice SND_STREAM_VOICE.
+// The stream is refilled in the background from the software interrupt IRQ_SW with
+// lowest priority, which is raised from the mixer DMA interrupt. SD card and FAT access
+// are not reentrant - the main loop must enclose its own disk access between
+// SoundStreamLock() and SoundStreamUnlock() while the stream is playing.
 
-#if USE_SOUND		// use sound support 1=tone, 2=melody
+#if USE_SOUND		// use sound support 1=tone, 2=melody, 3=melody with mixer
 
 #ifndef _TWEETYBOY_SND_H
 #define _TWEETYBOY_SND_H
@@ -19,6 +27,55 @@ extern "C" {
 // Timer divider, frequency of time base is 50000000/50 = 1000000 = 1 MHz
 #define SND_TIM_DIV	HCLK_PER_US	// timer divider
 
+#if USE_SOUND == 3	// use sound support 1=tone, 2=melody, 3=melody with mixer
+#ifndef SND_MIX_RATE
+#define SND_MIX_RATE	22000		// mixer sample rate in [Hz] (= PWM frequency)
+#endif
+
+#ifndef SND_MIX_BUF
+#define SND_MIX_BUF	64		// number of samples in half of the DMA buffer
+#endif
+
+#define SND_MIX_PERIOD	((HCLK_PER_US*1000000 + SND_MIX_RATE/2)/SND_MIX_RATE) // PWM period in HCLK clock cycles
+#define SND_MIX_DMA	2		// DMA channel (request TIM2_UP)
+#define SND_MIX_VOICE	0		// mixer voice of tones and melodies
+#define SND_MIX_VOICE_EFF 1		// mixer voice of sound effects
+
+// sample buffer of the mixer (2 halves, circular DMA)
+extern u16 SoundMixBuf[SND_MIX_BUF*2];
+
+#if USE_SNDSTREAM && USE_FAT	// 1=use streaming of WAV files from SD card
+#ifndef SND_STREAM_HALF
+#define SND_STREAM_HALF	512		// number of samples in half of the stream buffer (512 = 32..64 ms)
+#endif
+
+#define SND_STREAM_VOICE 2		// mixer voice of the stream
+
+// stream statistics
+extern u32 SoundStreamFills;		// number of refilled halves
+extern u32 SoundStreamMaxTime;		// max. time of refill of one half in [us] (SD card latency)
+
+// get number of stream underruns (buffer was not refilled in time)
+INLINE u32 SoundStreamUnder() { return MixStreamUnder; }
+
+// start streaming WAV file from SD card (disk must be mounted), vol = volume 0..255
+//  Supported formats: mono 8-bit unsigned PCM or mono 4-bit IMA ADPCM, sample rate up to SND_MIX_RATE.
+// Returns False if file cannot be opened or format is not supported.
+Bool SoundStreamPlay(const char* path, int vol);
+
+// stop streaming
+void SoundStreamStop();
+
+// block/unblock refill of the stream buffer (main loop must block it while accessing SD card)
+// - Locks can be nested (e.g. SoundStreamPlay() inside locked region), last unlock enables refill.
+void SoundStreamLock();
+void SoundStreamUnlock();
+
+// check if stream is playing
+Bool SoundStreamPlaying();
+#endif // USE_SNDSTREAM
+#endif
+
 // note length in 1/60 sec
 #define NOTE_LEN1DOT	96		// 1.
 #define NOTE_LEN1	64		// 1
@@ -171,7 +228,7 @@ extern "C" {
 
 #define NOTE_R		0			// pause
 
-#if USE_SOUND == 2	// use sound support 1=tone, 2=melody
+#if USE_SOUND >= 2	// use sound support 1=tone, 2=melody, 3=melody with mixer
 // one note of the melody
 typedef struct {
 	u16	len;		// length of the note in 1/60 sec - use macro NOTE_LEN*; 0 = stop melody
@@ -188,7 +245,16 @@ extern const sMelodyNote* volatile SoundMelodyNext;
 extern volatile s16 SoundMelodyLen;
 
 // check if sound of channel 0 is playing
-INLINE Bool PlayingSound() { return SoundMelodyLen != 0; }
+INLINE Bool PlayingSound() { HOST_POLL(); return SoundMelodyLen != 0; }
+
+// pointer to next sound effect
+extern const sMelodyNote* volatile SoundEffNext;
+
+// remaining length of current tone of sound effect (0 = no effect, -1 = start next effect)
+extern volatile s16 SoundEffLen;
+
+// check if sound effect is playing
+INLINE Bool PlayingEffect() { HOST_POLL(); return SoundEffLen != 0; }
 
 // Game sound samples
 extern const sMelodyNote SoundSamp1[];
@@ -204,6 +270,11 @@ void SoundInit();
 // Sound terminate
 void SoundTerm();
 
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+// update sound timer after change of system clock (registered by SoundInit)
+void SoundClock();
+#endif
+
 // Start playing tone with divider - use macro SND_GET_DIV(hz01) with
 //  frequency in 0.01 Hz, minimum 15.26Hz, or use constant NOTE_*
 void PlayTone(u32 div);
@@ -211,13 +282,22 @@ void PlayTone(u32 div);
 // Stop playing tone or melody
 void StopSound();
 
-#if USE_SOUND == 2	// use sound support 1=tone, 2=melody
+#if USE_SOUND >= 2	// use sound support 1=tone, 2=melody, 3=melody with mixer
 // Sound scan melody
 void SoundScan();
 
 // play music
 //  melody = pointer to array of notes sMelodyNote (terminated with NOTE_STOP)
 void PlayMelody(const sMelodyNote* melody);
+
+// play sound effect with priority - effect preempts melody and music, melody continues after it
+//  effect = pointer to array of notes sMelodyNote (terminated with NOTE_STOP)
+//  prio = priority 0..255 (effect with lower priority than current effect is not played)
+// Returns False if effect was not started.
+Bool PlayEffect(const sMelodyNote* effect, int prio);
+
+// stop sound effect (melody or music resumes)
+void StopEffect();
 #endif
 
 #ifdef __cplusplus
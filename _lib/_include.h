@@ -13,12 +13,20 @@
 
 //#define INCLUDE_SDK_FILE(file) STRINGIFY(SDK_SUBDIR/file)
 
+#if USE_HOST
+#include "../_sdk/host/sdk_host.h"	// host emulation
+#else
 #include STRINGIFY(../_sdk/SDK_SUBDIR/sdk_cpu.h) // CPU control
+#endif
 
 #include "inc/lib_decnum.h"		// decode number
 #include "inc/lib_rand.h"		// random generator
 #include "inc/lib_sd.h"			// SD card
 #include "inc/lib_fat.h"		// FAT file system
 #include "inc/lib_crc.h"		// check sum
+#include "inc/lib_kvs.h"		// key/value store in Flash
+#include "inc/lib_fix.h"		// fixed-point math
+#include "inc/lib_mix.h"		// audio mixer
+#include "inc/lib_music.h"		// music player
 
 #endif // _LIB_INCLUDE_H
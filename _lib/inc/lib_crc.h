@@ -292,6 +292,16 @@ u32 Crc32ATab(const void* buf, int len);
 //   Calculation speed: 790 us per 1 KB
 u32 Crc32ASlow(const void* buf, int len);
 
+#if USE_CRC_HW	// 1=use hardware CRC unit for CRC-32 (CH32V2, CH32V3)
+// Calculate CRC-32 Normal (CRC32A), buffer - hardware version (CRC unit)
+//   Aligned 32-bit words are calculated by the CRC unit, byte-swapped into MSB first
+//   order. Unaligned start and end of the buffer are calculated by the table.
+u32 Crc32ABufHw(u32 crc, const void* buf, int len);
+
+// Calculate CRC-32 Normal (CRC32A) - hardware version (CRC unit)
+u32 Crc32AHw(const void* buf, int len);
+#endif
+
 // Check CRC-32 Normal (CRC32A) calculations (returns False on error)
 Bool Crc32ACheck(void);
 
@@ -336,6 +346,16 @@ u32 Crc32BTab(const void* buf, int len);
 //   Calculation speed: 900 us per 1 KB
 u32 Crc32BSlow(const void* buf, int len); 
 
+#if USE_CRC_HW	// 1=use hardware CRC unit for CRC-32 (CH32V2, CH32V3)
+// Calculate CRC-32 Reversed (CRC32B), buffer - hardware version (CRC unit)
+//   The CRC unit calculates only normal CRC. Words are fed bit-reversed and the
+//   result is bit-reversed back, so the result is identical to Crc32BBufTab().
+u32 Crc32BBufHw(u32 crc, const void* buf, int len);
+
+// Calculate CRC-32 Reversed (CRC32B) - hardware version (CRC unit)
+u32 Crc32BHw(const void* buf, int len);
+#endif
+
 // Check CRC-32 Reversed (CRC32B) calculations (returns False on error)
 Bool Crc32BCheck(void);
 
@@ -343,6 +363,9 @@ Bool Crc32BCheck(void);
 //                            CRC-32 Common
 // ============================================================================
 // Default CRC-32 functions: CRC-32 Reversed CRC32B with DMA preferred
+// Buffer functions use the hardware CRC unit if available (USE_CRC_HW).
+// The CRC unit is shared - do not use it from interrupt and main code at the same time.
+// DMA transfer into the CRC unit is not used, words must be bit-reversed on the way.
 //  Sample "123456789" -> 0xCBF43926
 //  Sample 0xFC 0x05 0x4A -> 0xA8E10F6D
 //  Sample CRC32BTable 1KB -> 0x6FCF9E13
@@ -353,6 +376,16 @@ Bool Crc32BCheck(void);
 // Calculate CRC-32, 1 byte
 INLINE u32 Crc32Byte(u32 crc, u8 data) { return Crc32BByteSlow(crc, data); }
 
+#if USE_CRC_HW	// 1=use hardware CRC unit for CRC-32 (CH32V2, CH32V3)
+
+// Calculate CRC-32, buffer
+INLINE u32 Crc32Buf(u32 crc, const void* buf, int len) { return Crc32BBufHw(crc, buf, len); }
+
+// Calculate CRC-32
+INLINE u32 Crc32(const void* buf, int len) { return Crc32BHw(buf, len); }
+
+#else // USE_CRC_HW
+
 // Calculate CRC-32, buffer
 INLINE u32 Crc32Buf(u32 crc, const void* buf, int len) { return Crc32BBufTab(crc, buf, len); }
  
@@ -360,6 +393,8 @@ INLINE u32 Crc32Buf(u32 crc, const void* buf, int len) { return Crc32BBufTab(crc
 //   Calculation speed: 160 us per 1 KB
 INLINE u32 Crc32(const void* buf, int len) { return Crc32BTab(buf, len); }
 
+#endif // USE_CRC_HW
+
 // ============================================================================
 //                       CRC-16 CCITT Normal (CRC16A)
 // ============================================================================
@@ -0,0 +1,170 @@
+// ****************************************************************************
+//
+//                             Fixed-point math
+//
+// ****************************************************************************
+// PicoLibSDK - Alternative SDK library for Raspberry Pico and RP2040
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz, hardyplotter2@gmail.com
+// 	https://github.com/Panda381/PicoLibSDK
+//	https://www.breatharian.eu/hw/picolibsdk/index_en.html
+//	https://github.com/pajenicko/picopad
+//	https://picopad.eu/en/
+// License:
+//	This source code is freely available for any purpose, including commercial.
+//	It is possible to take and modify the code or parts of it, without restriction.
+
+// CH32V003 (RV32EC) has no FPU, no multiplier and no divider, CH32V002/V006 have only
+// multiplier (zmmul). Every float operation and every integer division is therefore
+// a call of the libgcc library. This module provides fixed-point replacements:
+//  - Q16.16 numbers (fix16, range -32768..+32767.99998, step 0.000015)
+//  - Q8.8 numbers (fix8, range -128..+127.996, step 0.0039)
+//  - angles in binary units (u16, 0x10000 = full circle 360 degrees)
+//  - table sine/cosine, CORDIC atan2, integer square root, division by reciprocal
+
+#ifndef _LIB_FIX_H
+#define _LIB_FIX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if USE_FIX		// 1=use fixed-point math library
+
+// ============================================================================
+//                             Q16.16 numbers
+// ============================================================================
+
+typedef s32 fix16;			// Q16.16 fixed-point number
+
+#define FIX16_SHIFT	16		// number of fractional bits
+#define FIX16_ONE	0x00010000	// fix16 number 1.0
+#define FIX16_HALF	0x00008000	// fix16 number 0.5
+#define FIX16_MAX	0x7FFFFFFF	// max. fix16 number
+#define FIX16_MIN	(-0x7FFFFFFF-1)	// min. fix16 number
+#define FIX16_PI	205887		// fix16 number PI
+#define FIX16_PI2	411775		// fix16 number 2*PI
+
+// fix16 constant from float constant (compile-time only, do not use with variables)
+#define FIX16(f) ((fix16)((f)*65536.0 + (((f) >= 0) ? 0.5 : -0.5)))
+
+// convert integer to fix16
+INLINE fix16 FixFromInt(int n) { return (fix16)((u32)n << FIX16_SHIFT); }
+
+// convert fix16 to integer, round down (toward minus infinity)
+INLINE int FixToInt(fix16 a) { return a >> FIX16_SHIFT; }
+
+// convert fix16 to integer, round to nearest
+INLINE int FixRound(fix16 a) { return (a + FIX16_HALF) >> FIX16_SHIFT; }
+
+// fraction part of fix16 number (0..0xffff)
+INLINE fix16 FixFrac(fix16 a) { return a & (FIX16_ONE - 1); }
+
+// absolute value of fix16 number
+INLINE fix16 FixAbs(fix16 a) { return (a < 0) ? -a : a; }
+
+// multiply fix16 numbers (without 64-bit arithmetic; overflow is not checked)
+fix16 FixMul(fix16 a, fix16 b);
+
+// divide fix16 numbers (without 64-bit arithmetic; on overflow or division by 0 returns FIX16_MAX or FIX16_MIN)
+fix16 FixDiv(fix16 a, fix16 b);
+
+// square root of fix16 number (returns 0 for negative numbers)
+fix16 FixSqrt(fix16 a);
+
+// ============================================================================
+//                              Q8.8 numbers
+// ============================================================================
+
+typedef s16 fix8;			// Q8.8 fixed-point number
+
+#define FIX8_SHIFT	8		// number of fractional bits
+#define FIX8_ONE	0x0100		// fix8 number 1.0
+
+// fix8 constant from float constant (compile-time only, do not use with variables)
+#define FIX8(f) ((fix8)((f)*256.0 + (((f) >= 0) ? 0.5 : -0.5)))
+
+// convert integer to fix8
+INLINE fix8 Fix8FromInt(int n) { return (fix8)(n << FIX8_SHIFT); }
+
+// convert fix8 to integer, round down (toward minus infinity)
+INLINE int Fix8ToInt(fix8 a) { return a >> FIX8_SHIFT; }
+
+// convert fix8 to fix16 and back
+INLINE fix16 Fix8To16(fix8 a) { return (fix16)a << (FIX16_SHIFT - FIX8_SHIFT); }
+INLINE fix8 Fix16To8(fix16 a) { return (fix8)(a >> (FIX16_SHIFT - FIX8_SHIFT)); }
+
+// multiply fix8 numbers (one 32-bit multiplication)
+INLINE fix8 Fix8Mul(fix8 a, fix8 b) { return (fix8)(((s32)a * b) >> FIX8_SHIFT); }
+
+// divide fix8 numbers (uses fix16 division without 64-bit arithmetic)
+INLINE fix8 Fix8Div(fix8 a, fix8 b) { return Fix16To8(FixDiv(Fix8To16(a), Fix8To16(b))); }
+
+// ============================================================================
+//                          Angles, sine, cosine
+// ============================================================================
+// Angle is u16 number in binary units: 0x10000 = 360 degrees, 0x4000 = 90 degrees.
+// The angle overflows naturally, so there is no need to normalize it.
+
+#define FIXANG_90	0x4000		// angle 90 degrees
+#define FIXANG_180	0x8000		// angle 180 degrees
+#define FIXANG_270	0xC000		// angle 270 degrees
+
+// angle from integer degrees, rounded (compile-time or run-time)
+#define FIXANG_DEG(d) ((u16)((((s32)(d) << 16) + 180) / 360))
+
+// convert angle to radians in fix16 format
+INLINE fix16 FixAngToRad(u16 ang) { return FixMul(ang, FIX16_PI2); }
+
+// sine table, quarter wave, 257 entries in Q16 format (last entry 0xFFFF represents 1.0)
+extern const u16 FixSinTab[257];
+
+// sine of angle, with linear interpolation (returns fix16 -1.0..+1.0, max. error 2 LSB)
+fix16 FixSin(u16 ang);
+
+// cosine of angle, with linear interpolation (returns fix16 -1.0..+1.0, max. error 2 LSB)
+INLINE fix16 FixCos(u16 ang) { return FixSin((u16)(ang + FIXANG_90)); }
+
+// sine of angle, table only without interpolation (returns fix16 -1.0..+1.0, error up to 0.31%)
+fix16 FixSinFast(u16 ang);
+
+// cosine of angle, table only without interpolation (returns fix16 -1.0..+1.0, error up to 0.31%)
+INLINE fix16 FixCosFast(u16 ang) { return FixSinFast((u16)(ang + FIXANG_90)); }
+
+// arc tangent of y/x with CORDIC, returns angle 0..0xFFFF (x and y can be in any scale, max. error 0.03 degree)
+u16 FixAtan2(s32 y, s32 x);
+
+// ============================================================================
+//                       Integer square root, division
+// ============================================================================
+
+// integer square root of 32-bit unsigned number (rounded down, without multiplication)
+u16 ISqrt(u32 n);
+
+// reciprocal table: FixRecipTab[d] = 0x10000/d (d >= 2; entries 0 and 1 are not used)
+extern const u16 FixRecipTab[256];
+
+// divide 16-bit unsigned number by 8-bit divisor, using reciprocal table (division by 0 returns 0xFFFF)
+u16 DivU16U8(u16 num, u8 den);
+
+// precomputed reciprocal, for repeated division by the same divisor
+typedef struct {
+	u32	mul;		// reciprocal 0x10000/div
+	u16	div;		// divisor
+} sFixRecip;
+
+// prepare reciprocal of 16-bit divisor (1 real division; divisor 0 is replaced by 1)
+void FixRecipInit(sFixRecip* r, u16 div);
+
+// divide 16-bit unsigned number by precomputed reciprocal (2 multiplications, no division)
+u16 FixRecipDiv(const sFixRecip* r, u16 num);
+
+// check fixed-point functions (returns False on error)
+Bool FixCheck(void);
+
+#endif // USE_FIX
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _LIB_FIX_H
@@ -0,0 +1,131 @@
+// ****************************************************************************
+//
+//                    Wear-leveled key/value store in Flash
+//
+// ****************************************************************************
+// PicoLibSDK - Alternative SDK library for Raspberry Pico and RP2040
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz, hardyplotter2@gmail.com
+// 	https://github.com/Panda381/PicoLibSDK
+//	https://www.breatharian.eu/hw/picolibsdk/index_en.html
+//	https://github.com/pajenicko/picopad
+//	https://picopad.eu/en/
+// License:
+//	This source code is freely available for any purpose, including commercial.
+//	It is possible to take and modify the code or parts of it, without restriction.
+
+// Log-structured store of small records (save games, high scores, settings) in
+// a reserved Flash region at the end of the Flash memory. The region is divided
+// into KVS_BANKS banks of KVS_BANKSIZE bytes. Every record takes one program page
+// (256 B on CH32V00x/CH32X035, 64 B on CH32V003) and it is appended into the next
+// erased page of the active bank - saving a value is a single page program without
+// erase. The record is protected by CRC-16 and by sequence number, the newest
+// valid record of the key wins. Lookup uses index of records in RAM.
+//
+// When the active bank is full, the next bank is erased and the newest records of
+// all keys are copied into it (garbage collection). Data of the old bank stay valid
+// until the bank is erased again in the next round, so power failure during save or
+// during garbage collection loses at most the value being saved. Interrupted copy
+// is completed by KvsInit().
+//
+// The application must not reach the region KVS_ADDR - KvsInit() checks the end of
+// the image (linker symbol _eflashslot) and keeps the store disabled on overlap.
+// The boot loader erases the region when it loads a different application. The host
+// build keeps data in RAM.
+
+#ifndef _LIB_KVS_H
+#define _LIB_KVS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if USE_KVS		// 1=use key/value store in Flash (requires USE_FLASH and USE_CRC)
+
+#ifndef KVS_BANKS
+#define KVS_BANKS	2		// number of banks (min. 2)
+#endif
+
+#ifndef KVS_BANKSIZE
+#define KVS_BANKSIZE	2048		// size of one bank in bytes (multiply of Flash erase page)
+#endif
+
+#ifndef KVS_KEYS
+#define KVS_KEYS	6		// number of keys 0..KVS_KEYS-1 (max. pages per bank - 1)
+#endif
+
+#ifndef KVS_PAGE
+#if USE_HOST
+#define KVS_PAGE	256		// size of one record page
+#else
+#define KVS_PAGE	FLASH_PAGEPG_SIZE // size of one record page
+#endif
+#endif
+
+#ifndef KVS_ADDR
+#if USE_HOST
+#define KVS_ADDR	0		// start address of the region (not used by host)
+#else
+#define KVS_ADDR	(FLASH_BASE+FLASHSIZE-KVS_BANKS*KVS_BANKSIZE) // start address of the region
+#endif
+#endif
+
+#define KVS_BANKPAGES	(KVS_BANKSIZE/KVS_PAGE)	// number of pages per bank
+#define KVS_PAGES	(KVS_BANKS*KVS_BANKPAGES) // total number of pages
+#define KVS_DATAMAX	(KVS_PAGE-8)	// max. size of data of one record
+#define KVS_NONE	0xffff		// index entry is not used
+#define KVS_DEL		0xff		// length of record of deleted key
+
+// record header (on start of the page)
+typedef struct {
+	u16	crc;		// 0x00: CRC-16 CCITT of following header and data (key..data; Crc16CFast)
+	u8	key;		// 0x02: key 0..KVS_KEYS-1 (0xff = erased page)
+	u8	len;		// 0x03: length of data (KVS_DEL = key is deleted)
+	u32	seq;		// 0x04: sequence number
+				// 0x08: data follow
+} sKvsRec;
+
+// index of the newest record of the keys (page number, KVS_NONE = none)
+extern u16 KvsIndex[KVS_KEYS];
+
+// active bank
+extern u8 KvsBank;
+
+// next free page in active bank (KVS_BANKPAGES = bank is full)
+extern u16 KvsNext;
+
+// last sequence number
+extern u32 KvsSeq;
+
+// store is ready (KvsInit() passed)
+extern Bool KvsReady;
+
+// initialize key/value store - scan Flash and build index (call once on start)
+// - Returns False if application image overlaps the region; the store stays disabled.
+Bool KvsInit(void);
+
+// erase all records (requires KvsInit() first)
+void KvsFormat(void);
+
+// get pointer to data of the key in Flash, or NULL if not found (len = pointer to get length, can be NULL)
+const void* KvsPtr(int key, int* len);
+
+// get length of data of the key (-1 = not found)
+int KvsLen(int key);
+
+// read data of the key into buffer (max = size of buffer; returns length of data, -1 = not found)
+int KvsGet(int key, void* buf, int max);
+
+// save data of the key (len = 0..KVS_DATAMAX; returns False on error)
+// - Equal data are not saved again.
+Bool KvsSet(int key, const void* data, int len);
+
+// delete the key (returns False on error)
+Bool KvsDel(int key);
+
+#endif // USE_KVS
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _LIB_KVS_H
@@ -0,0 +1,130 @@
+// ****************************************************************************
+//
+//                             Audio mixer
+//
+// ****************************************************************************
+// PicoLibSDK - Alternative SDK library for Raspberry Pico and RP2040
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz, hardyplotter2@gmail.com
+// 	https://github.com/Panda381/PicoLibSDK
+//	https://www.breatharian.eu/hw/picolibsdk/index_en.html
+//	https://github.com/pajenicko/picopad
+//	https://picopad.eu/en/
+// License:
+//	This source code is freely available for any purpose, including commercial.
+//	It is possible to take and modify the code or parts of it, without restriction.
+
+// Software mixer of MIX_VOICES voices (square with duty, triangle, noise, 8-bit PCM
+// sample) with volume of every voice. The device sound driver calls MixRender() to fill
+// a half of the circular sample buffer, which is sent by DMA to the PWM compare register
+// of the timer at the sample rate. Phase of the voices is 32-bit accumulator, so the
+// frequency step of the voice is freq * 2^32 / sample_rate.
+
+#ifndef _LIB_MIX_H
+#define _LIB_MIX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if USE_MIX		// 1=use audio mixer
+
+#ifndef MIX_VOICES
+#define MIX_VOICES	4		// number of mixer voices
+#endif
+
+#ifndef MIX_SHIFT
+#define MIX_SHIFT	1		// output shift of the sum of voices (0=max. loudness, 2=no clipping of 4 voices)
+#endif
+
+// voice waveform
+#define MIX_WAVE_OFF		0	// voice is off
+#define MIX_WAVE_SQUARE		1	// square with duty
+#define MIX_WAVE_TRIANGLE	2	// triangle
+#define MIX_WAVE_NOISE		3	// noise (frequency = rate of new random values)
+#define MIX_WAVE_PCM		4	// 8-bit signed PCM sample
+#define MIX_WAVE_STREAM		5	// 8-bit signed PCM stream from double buffer
+
+#define MIX_VOL_MAX		255	// max. volume of the voice
+#define MIX_DUTY_HALF		128	// duty 50% of the square wave (range 1..255)
+
+// mixer voice
+typedef struct {
+	volatile u8	wave;		// voice waveform MIX_WAVE_* (MIX_WAVE_OFF = voice is off)
+	u8		vol;		// volume 0..255
+	u8		duty;		// duty of the square wave 1..255 (128 = 50%)
+	u8		shalf;		// stream: index of the half being played
+	u16		lfsr;		// noise generator shift register
+	volatile u8	sfull[2];	// stream: flags of full halves of the buffer
+	u8		sunder;		// stream: underrun in progress (waiting for refill)
+	u32		phase;		// phase accumulator (PCM: sample index in 16.16 format)
+	u32		step;		// phase increment per output sample (PCM: 16.16 format)
+	const s8*	pcm;		// PCM sample data (stream: double buffer)
+	u32		len;		// length of PCM sample in 16.16 format (stream: length of half)
+	volatile u32	loop;		// length of PCM loop in 16.16 format, 0 = no loop (stream: 1 = end of data)
+} sMixVoice;
+
+// mixer voices
+extern sMixVoice MixVoice[MIX_VOICES];
+
+// counter of stream underruns (render found next half of stream buffer empty; counted once per underrun)
+extern volatile u32 MixStreamUnder;
+
+// output sample rate in [Hz]
+extern u32 MixRate;
+
+// Initialize mixer (rate = output sample rate in Hz)
+void MixInit(u32 rate);
+
+// get phase step of the voice from frequency in 0.01 Hz
+u32 MixStep(u32 hz01);
+
+// start tone on the voice (wave = MIX_WAVE_SQUARE, MIX_WAVE_TRIANGLE or MIX_WAVE_NOISE,
+//  step = phase step - use MixStep(), duty = square duty 1..255, vol = volume 0..255)
+void MixTone(int voice, int wave, u32 step, int duty, int vol);
+
+// start PCM sample on the voice
+//  pcm = 8-bit signed samples, len = number of samples (max. 65535)
+//  rate = sample rate of the PCM data in Hz, loop = length of loop from end of sample (0 = no loop)
+void MixSample(int voice, const s8* pcm, int len, u32 rate, int loop, int vol);
+
+// start PCM stream on the voice (double buffer, both halves must be filled before start)
+//  buf = buffer of 2 halves with 8-bit signed samples, half = number of samples in one half
+//  rate = sample rate of the stream in Hz, vol = volume 0..255, end = buffer contains last data
+// Refill half of the buffer after its flag MixVoice[voice].sfull[] is cleared and call MixStreamFull().
+void MixStream(int voice, const s8* buf, int half, u32 rate, int vol, Bool end);
+
+// mark half 0 or 1 of the stream buffer as filled (end = this is the last data, stop at the end)
+INLINE void MixStreamFull(int voice, int h, Bool end)
+{
+	MixVoice[voice].sfull[h] = 1;
+	if (end) MixVoice[voice].loop = 1;
+}
+
+// set volume of the voice 0..255
+INLINE void MixVolume(int voice, int vol) { MixVoice[voice].vol = (u8)vol; }
+
+// set phase step of the voice (change frequency without restart)
+INLINE void MixSetStep(int voice, u32 step) { MixVoice[voice].step = step; }
+
+// stop voice
+INLINE void MixStop(int voice) { MixVoice[voice].wave = MIX_WAVE_OFF; }
+
+// stop all voices
+void MixStopAll();
+
+// check if voice is playing
+INLINE Bool MixPlaying(int voice) { return MixVoice[voice].wave != MIX_WAVE_OFF; }
+
+// render samples to output buffer
+//  buf = destination buffer of PWM compare values
+//  n = number of samples
+//  period = PWM period (timer reload value + 1); output value is in range 0..period-1
+void MixRender(u16* buf, int n, u32 period);
+
+#endif // USE_MIX
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _LIB_MIX_H
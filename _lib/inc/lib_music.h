@@ -0,0 +1,101 @@
+// ****************************************************************************
+//
+//                             Music player
+//
+// ****************************************************************************
+// PicoLibSDK - Alternative SDK library for Raspberry Pico and RP2040
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz, hardyplotter2@gmail.com
+// 	https://github.com/Panda381/PicoLibSDK
+//	https://www.breatharian.eu/hw/picolibsdk/index_en.html
+//	https://github.com/pajenicko/picopad
+//	https://picopad.eu/en/
+// License:
+//	This source code is freely available for any purpose, including commercial.
+//	It is possible to take and modify the code or parts of it, without restriction.
+
+// Compact tracker-style music format. Song consists of patterns (byte streams of
+// notes and commands) and order list, which plays patterns in sequence, with
+// transposition and with loop. One note takes 1 byte (+1 byte if length changes),
+// compared to 4 bytes of sMelodyNote. Use tool _tools/melconv to convert existing
+// sMelodyNote tables.
+//
+// Pattern byte codes:
+//   0x00..0x77 ... note index 0..119 (C0..B9), played with current length
+//   0x80..0xBF ... set current length 1..64 (in units of NOTE_LEN64 = 1/60 sec at tempo 16)
+//   0xC0 ......... rest (pause) with current length
+//   0xC1, n ...... set current length n = 1..255
+//   0xC2, n ...... set tempo n = 1..255 (16 = normal speed, note length = len*tempo/16 ticks)
+//   0xFF ......... end of pattern
+//
+// Order list: pairs of bytes {pattern index 0..254, transposition s8 in semitones},
+//   terminated with MUS_ORD_END and loop index of the order list (MUS_NOLOOP = stop).
+//
+// MusicScan() is called from the SoundScan() melody service of the device, once per
+// tick of the melody (1/60 sec). It processes max. MUSIC_MAX_EVENTS pattern codes
+// per tick, so its time is bounded even with corrupted data. Dividers of the notes
+// are for time base of the sound timer 1 MHz, as used by PlayTone() of all devices.
+
+#ifndef _LIB_MUSIC_H
+#define _LIB_MUSIC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if USE_MUSIC		// 1=use music player
+
+#ifndef MUSIC_MAX_EVENTS
+#define MUSIC_MAX_EVENTS	8	// max. number of pattern codes processed per tick
+#endif
+
+// pattern codes
+#define MUS_NOTE_NUM	120		// number of notes (C0..B9)
+#define MUS_NOTE(oct,semi) ((oct)*12+(semi)) // note index from octave 0..9 and semitone 0..11
+#define MUS_LEN(len)	(0x80+(len)-1)	// set current length 1..64
+#define MUS_REST	0xC0		// rest with current length
+#define MUS_LENX	0xC1		// set current length, next byte = length 1..255
+#define MUS_TEMPO	0xC2		// set tempo, next byte = tempo 1..255 (16 = normal)
+#define MUS_END		0xFF		// end of pattern
+
+// order list codes
+#define MUS_ORD_END	0xFF		// end of order list, next byte = loop index
+#define MUS_NOLOOP	0xFF		// no loop, stop playing at end of order list
+
+#define MUS_TEMPO_NORM	16		// normal tempo (1 tick per 1 length unit)
+
+// song
+typedef struct {
+	const u8* const* pat;		// table of patterns
+	const u8*	order;		// order list
+	u8		tempo;		// initial tempo (16 = normal)
+} sMusic;
+
+// current song (NULL = not playing)
+extern const sMusic* volatile MusicSong;
+
+// divider of the current note (0 = rest)
+extern volatile u16 MusicDiv;
+
+// play song (restarts current song)
+void MusicPlay(const sMusic* song);
+
+// stop playing song (the tone is stopped in next tick)
+void MusicStop();
+
+// check if song is playing
+INLINE Bool MusicPlaying() { return MusicSong != NULL; }
+
+// get divider of the note 0..119 (time base 1 MHz)
+u16 MusicNoteDiv(int note);
+
+// Music scan, called every tick of the melody. Returns True if the current note changed
+//  (then play MusicDiv divider, or stop the tone if MusicDiv is 0).
+Bool MusicScan();
+
+#endif // USE_MUSIC
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _LIB_MUSIC_H
@@ -53,6 +53,16 @@ extern "C" {
 #endif
 */
 
+#ifndef SD_HOOK
+#define SD_HOOK		0	// 1=call SD_Hook between bytes of received data block (data are received by function in RAM)
+#endif
+
+#if SD_HOOK
+// callback between bytes of received data block (NULL = none; function must run from RAM, see NOFLASH)
+typedef Bool (*pSDHook)(void);
+extern pSDHook SD_Hook;
+#endif
+
 // SD card type
 enum {
 	SD_NONE = 0,	// unknown type
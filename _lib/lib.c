@@ -6,3 +6,7 @@
 #include "src/lib_sd.c"		// SD card
 #include "src/lib_fat.c"	// FAT file system
 #include "src/lib_crc.c"	// FAT file system
+#include "src/lib_kvs.c"	// key/value store in Flash
+#include "src/lib_fix.c"	// fixed-point math
+#include "src/lib_mix.c"	// audio mixer
+#include "src/lib_music.c"	// music player
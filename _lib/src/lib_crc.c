@@ -1020,6 +1020,66 @@ u32 Crc32ASlow(const void* buf, int len)
 	return Crc32ABufSlow(CRC32A_INIT, buf, len);
 }
 
+#if USE_CRC_HW	// 1=use hardware CRC unit for CRC-32 (CH32V2, CH32V3)
+
+// start CRC unit with CRC-32 Normal state 'crc'
+//  The CRC unit cannot be loaded with initial value, reset always sets 0xFFFFFFFF. Other
+//  state is prepared by writing one seed word - the seed is found by running 32 steps of
+//  the CRC backwards from the required state (CRC unit calculates crc = CRC(crc ^ data)).
+static void Crc32HwStart(u32 crc)
+{
+	int i;
+
+	RCC_CRCClkEnable();
+	CRC_Reset();
+	if (crc == 0xFFFFFFFF) return;
+
+	for (i = 32; i > 0; i--)
+	{
+		if ((crc & 1) == 0)
+			crc >>= 1;
+		else
+			crc = ((crc ^ CRC32A_POLY) >> 1) | 0x80000000;
+	}
+	CRC_Write(~crc);
+}
+
+// Calculate CRC-32 Normal (CRC32A), buffer - hardware version (CRC unit)
+//   Aligned 32-bit words are calculated by the CRC unit, byte-swapped into MSB first
+//   order. Unaligned start and end of the buffer are calculated by the table.
+u32 Crc32ABufHw(u32 crc, const void* buf, int len)
+{
+	const u8* s = (const u8*)buf;
+
+	// unaligned start of the buffer
+	int n = (-(u32)s) & 3;
+	if (n > len) n = len;
+	crc = Crc32ABufTab(crc, s, n);
+	s += n;
+	len -= n;
+
+	// aligned words
+	if (len >= 4)
+	{
+		const u32* w = (const u32*)s;
+		Crc32HwStart(crc);
+		for (; len >= 4; len -= 4) CRC_Write(Endian(*w++));
+		crc = CRC_Read();
+		s = (const u8*)w;
+	}
+
+	// rest of the buffer
+	return Crc32ABufTab(crc, s, len);
+}
+
+// Calculate CRC-32 Normal (CRC32A) - hardware version (CRC unit)
+u32 Crc32AHw(const void* buf, int len)
+{
+	return Crc32ABufHw(CRC32A_INIT, buf, len);
+}
+
+#endif // USE_CRC_HW
+
 // Check CRC-32 Normal (CRC32A) calculations (returns False on error)
 Bool Crc32ACheck()
 {
@@ -1051,6 +1111,18 @@ Bool Crc32ACheck()
 	crc = Crc32ABufSlow(CRC32A_INIT, CrcPat3, CRC32A_SPLIT);
 	crc = Crc32ABufSlow(crc, (const u8*)CrcPat3+CRC32A_SPLIT, CRCPAT3LEN-CRC32A_SPLIT);
 	if (crc != CRC32A_RES3) return False;
+
+#if USE_CRC_HW	// 1=use hardware CRC unit for CRC-32 (CH32V2, CH32V3)
+	// CRC-32 hardware version
+	if (Crc32AHw(CrcPat1, CRCPAT1LEN) != CRC32A_RES1) return False;
+	if (Crc32AHw(CrcPat2, CRCPAT2LEN) != CRC32A_RES2) return False;
+	if (Crc32AHw(CrcPat3, CRCPAT3LEN) != CRC32A_RES3) return False;
+	if (Crc32AHw((const u8*)CrcPat3+1, CRCPAT3LEN-2) != Crc32ATab((const u8*)CrcPat3+1, CRCPAT3LEN-2)) return False;
+
+	crc = Crc32ABufHw(CRC32A_INIT, CrcPat3, CRC32A_SPLIT);
+	crc = Crc32ABufHw(crc, (const u8*)CrcPat3+CRC32A_SPLIT, CRCPAT3LEN-CRC32A_SPLIT);
+	if (crc != CRC32A_RES3) return False;
+#endif
 	
 	// CRC-32 byte version
 	crc = CRC32A_INIT;
@@ -1201,6 +1273,45 @@ u32 Crc32BSlow(const void* buf, int len)
 	return Crc32BBufSlow(CRC32B_INIT, buf, len);
 }
 
+#if USE_CRC_HW	// 1=use hardware CRC unit for CRC-32 (CH32V2, CH32V3)
+
+// Calculate CRC-32 Reversed (CRC32B), buffer - hardware version (CRC unit)
+//   The CRC unit calculates only normal CRC. Reversed CRC of the data is equal to
+//   bit-reversed normal CRC of bit-reversed data - little-endian word with reversed
+//   bits gives bytes in MSB first order, each with reversed bits.
+u32 Crc32BBufHw(u32 crc, const void* buf, int len)
+{
+	const u8* s = (const u8*)buf;
+
+	// unaligned start of the buffer
+	int n = (-(u32)s) & 3;
+	if (n > len) n = len;
+	crc = Crc32BBufTab(crc, s, n);
+	s += n;
+	len -= n;
+
+	// aligned words
+	if (len >= 4)
+	{
+		const u32* w = (const u32*)s;
+		Crc32HwStart(Reverse32(~crc));
+		for (; len >= 4; len -= 4) CRC_Write(Reverse32(*w++));
+		crc = ~Reverse32(CRC_Read());
+		s = (const u8*)w;
+	}
+
+	// rest of the buffer
+	return Crc32BBufTab(crc, s, len);
+}
+
+// Calculate CRC-32 Reversed (CRC32B) - hardware version (CRC unit)
+u32 Crc32BHw(const void* buf, int len)
+{
+	return Crc32BBufHw(CRC32B_INIT, buf, len);
+}
+
+#endif // USE_CRC_HW
+
 // Check CRC-32 Reversed (CRC32B) calculations (returns False on error)
 Bool Crc32BCheck()
 {
@@ -1233,6 +1344,18 @@ Bool Crc32BCheck()
 	crc = Crc32BBufSlow(crc, (const u8*)CrcPat3+CRC32B_SPLIT, CRCPAT3LEN-CRC32B_SPLIT);
 	if (crc != CRC32B_RES3) return False;
 
+#if USE_CRC_HW	// 1=use hardware CRC unit for CRC-32 (CH32V2, CH32V3)
+	// CRC-32 hardware version
+	if (Crc32BHw(CrcPat1, CRCPAT1LEN) != CRC32B_RES1) return False;
+	if (Crc32BHw(CrcPat2, CRCPAT2LEN) != CRC32B_RES2) return False;
+	if (Crc32BHw(CrcPat3, CRCPAT3LEN) != CRC32B_RES3) return False;
+	if (Crc32BHw((const u8*)CrcPat3+1, CRCPAT3LEN-2) != Crc32BTab((const u8*)CrcPat3+1, CRCPAT3LEN-2)) return False;
+
+	crc = Crc32BBufHw(CRC32B_INIT, CrcPat3, CRC32B_SPLIT);
+	crc = Crc32BBufHw(crc, (const u8*)CrcPat3+CRC32B_SPLIT, CRCPAT3LEN-CRC32B_SPLIT);
+	if (crc != CRC32B_RES3) return False;
+#endif
+
 	// CRC-32 byte version
 	crc = CRC32B_INIT;
 	src = (const u8*)CrcPat3;
@@ -0,0 +1,394 @@
+// ****************************************************************************
+//
+//                             Fixed-point math
+//
+// ****************************************************************************
+// PicoLibSDK - Alternative SDK library for Raspberry Pico and RP2040
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz, hardyplotter2@gmail.com
+// 	https://github.com/Panda381/PicoLibSDK
+//	https://www.breatharian.eu/hw/picolibsdk/index_en.html
+//	https://github.com/pajenicko/picopad
+//	https://picopad.eu/en/
+// License:
+//	This source code is freely available for any purpose, including commercial.
+//	It is possible to take and modify the code or parts of it, without restriction.
+
+#include "../../includes.h"	// globals
+
+#if USE_FIX		// 1=use fixed-point math library
+
+// sine table, quarter wave, 257 entries in Q16 format (last entry 0xFFFF represents 1.0)
+const u16 FixSinTab[257] = {
+	0x0000, 0x0192, 0x0324, 0x04B6, 0x0648, 0x07DA, 0x096C, 0x0AFE, 0x0C90, 0x0E21, 0x0FB3, 0x1144, 0x12D5, 0x1466, 0x15F7, 0x1787,
+	0x1918, 0x1AA8, 0x1C38, 0x1DC7, 0x1F56, 0x20E5, 0x2274, 0x2402, 0x2590, 0x271E, 0x28AB, 0x2A38, 0x2BC4, 0x2D50, 0x2EDC, 0x3067,
+	0x31F1, 0x337C, 0x3505, 0x368E, 0x3817, 0x399F, 0x3B27, 0x3CAE, 0x3E34, 0x3FBA, 0x413F, 0x42C3, 0x4447, 0x45CB, 0x474D, 0x48CF,
+	0x4A50, 0x4BD1, 0x4D50, 0x4ECF, 0x504D, 0x51CB, 0x5348, 0x54C3, 0x563E, 0x57B9, 0x5932, 0x5AAA, 0x5C22, 0x5D99, 0x5F0F, 0x6084,
+	0x61F8, 0x636B, 0x64DD, 0x664E, 0x67BE, 0x692D, 0x6A9B, 0x6C08, 0x6D74, 0x6EDF, 0x7049, 0x71B2, 0x731A, 0x7480, 0x75E6, 0x774A,
+	0x78AD, 0x7A10, 0x7B70, 0x7CD0, 0x7E2F, 0x7F8C, 0x80E8, 0x8243, 0x839C, 0x84F5, 0x864C, 0x87A1, 0x88F6, 0x8A49, 0x8B9A, 0x8CEB,
+	0x8E3A, 0x8F88, 0x90D4, 0x921F, 0x9368, 0x94B0, 0x95F7, 0x973C, 0x9880, 0x99C2, 0x9B03, 0x9C42, 0x9D80, 0x9EBC, 0x9FF7, 0xA130,
+	0xA268, 0xA39E, 0xA4D2, 0xA605, 0xA736, 0xA866, 0xA994, 0xAAC1, 0xABEB, 0xAD14, 0xAE3C, 0xAF62, 0xB086, 0xB1A8, 0xB2C9, 0xB3E8,
+	0xB505, 0xB620, 0xB73A, 0xB852, 0xB968, 0xBA7D, 0xBB8F, 0xBCA0, 0xBDAF, 0xBEBC, 0xBFC7, 0xC0D1, 0xC1D8, 0xC2DE, 0xC3E2, 0xC4E4,
+	0xC5E4, 0xC6E2, 0xC7DE, 0xC8D9, 0xC9D1, 0xCAC7, 0xCBBC, 0xCCAE, 0xCD9F, 0xCE8E, 0xCF7A, 0xD065, 0xD14D, 0xD234, 0xD318, 0xD3FB,
+	0xD4DB, 0xD5BA, 0xD696, 0xD770, 0xD848, 0xD91E, 0xD9F2, 0xDAC4, 0xDB94, 0xDC62, 0xDD2D, 0xDDF7, 0xDEBE, 0xDF83, 0xE046, 0xE107,
+	0xE1C6, 0xE282, 0xE33C, 0xE3F4, 0xE4AA, 0xE55E, 0xE610, 0xE6BF, 0xE76C, 0xE817, 0xE8BF, 0xE966, 0xEA0A, 0xEAAB, 0xEB4B, 0xEBE8,
+	0xEC83, 0xED1C, 0xEDB3, 0xEE47, 0xEED9, 0xEF68, 0xEFF5, 0xF080, 0xF109, 0xF18F, 0xF213, 0xF295, 0xF314, 0xF391, 0xF40C, 0xF484,
+	0xF4FA, 0xF56E, 0xF5DF, 0xF64E, 0xF6BA, 0xF724, 0xF78C, 0xF7F1, 0xF854, 0xF8B4, 0xF913, 0xF96E, 0xF9C8, 0xFA1F, 0xFA73, 0xFAC5,
+	0xFB15, 0xFB62, 0xFBAD, 0xFBF5, 0xFC3B, 0xFC7F, 0xFCC0, 0xFCFE, 0xFD3B, 0xFD74, 0xFDAC, 0xFDE1, 0xFE13, 0xFE43, 0xFE71, 0xFE9C,
+	0xFEC4, 0xFEEB, 0xFF0E, 0xFF30, 0xFF4E, 0xFF6B, 0xFF85, 0xFF9C, 0xFFB1, 0xFFC4, 0xFFD4, 0xFFE1, 0xFFEC, 0xFFF5, 0xFFFB, 0xFFFF,
+	0xFFFF,
+};
+
+// reciprocal table: FixRecipTab[d] = 0x10000/d (d >= 2; entries 0 and 1 are not used)
+const u16 FixRecipTab[256] = {
+	0x0000, 0xFFFF, 0x8000, 0x5555, 0x4000, 0x3333, 0x2AAA, 0x2492, 0x2000, 0x1C71, 0x1999, 0x1745, 0x1555, 0x13B1, 0x1249, 0x1111,
+	0x1000, 0x0F0F, 0x0E38, 0x0D79, 0x0CCC, 0x0C30, 0x0BA2, 0x0B21, 0x0AAA, 0x0A3D, 0x09D8, 0x097B, 0x0924, 0x08D3, 0x0888, 0x0842,
+	0x0800, 0x07C1, 0x0787, 0x0750, 0x071C, 0x06EB, 0x06BC, 0x0690, 0x0666, 0x063E, 0x0618, 0x05F4, 0x05D1, 0x05B0, 0x0590, 0x0572,
+	0x0555, 0x0539, 0x051E, 0x0505, 0x04EC, 0x04D4, 0x04BD, 0x04A7, 0x0492, 0x047D, 0x0469, 0x0456, 0x0444, 0x0432, 0x0421, 0x0410,
+	0x0400, 0x03F0, 0x03E0, 0x03D2, 0x03C3, 0x03B5, 0x03A8, 0x039B, 0x038E, 0x0381, 0x0375, 0x0369, 0x035E, 0x0353, 0x0348, 0x033D,
+	0x0333, 0x0329, 0x031F, 0x0315, 0x030C, 0x0303, 0x02FA, 0x02F1, 0x02E8, 0x02E0, 0x02D8, 0x02D0, 0x02C8, 0x02C0, 0x02B9, 0x02B1,
+	0x02AA, 0x02A3, 0x029C, 0x0295, 0x028F, 0x0288, 0x0282, 0x027C, 0x0276, 0x0270, 0x026A, 0x0264, 0x025E, 0x0259, 0x0253, 0x024E,
+	0x0249, 0x0243, 0x023E, 0x0239, 0x0234, 0x0230, 0x022B, 0x0226, 0x0222, 0x021D, 0x0219, 0x0214, 0x0210, 0x020C, 0x0208, 0x0204,
+	0x0200, 0x01FC, 0x01F8, 0x01F4, 0x01F0, 0x01EC, 0x01E9, 0x01E5, 0x01E1, 0x01DE, 0x01DA, 0x01D7, 0x01D4, 0x01D0, 0x01CD, 0x01CA,
+	0x01C7, 0x01C3, 0x01C0, 0x01BD, 0x01BA, 0x01B7, 0x01B4, 0x01B2, 0x01AF, 0x01AC, 0x01A9, 0x01A6, 0x01A4, 0x01A1, 0x019E, 0x019C,
+	0x0199, 0x0197, 0x0194, 0x0192, 0x018F, 0x018D, 0x018A, 0x0188, 0x0186, 0x0183, 0x0181, 0x017F, 0x017D, 0x017A, 0x0178, 0x0176,
+	0x0174, 0x0172, 0x0170, 0x016E, 0x016C, 0x016A, 0x0168, 0x0166, 0x0164, 0x0162, 0x0160, 0x015E, 0x015C, 0x015A, 0x0158, 0x0157,
+	0x0155, 0x0153, 0x0151, 0x0150, 0x014E, 0x014C, 0x014A, 0x0149, 0x0147, 0x0146, 0x0144, 0x0142, 0x0141, 0x013F, 0x013E, 0x013C,
+	0x013B, 0x0139, 0x0138, 0x0136, 0x0135, 0x0133, 0x0132, 0x0130, 0x012F, 0x012E, 0x012C, 0x012B, 0x0129, 0x0128, 0x0127, 0x0125,
+	0x0124, 0x0123, 0x0121, 0x0120, 0x011F, 0x011E, 0x011C, 0x011B, 0x011A, 0x0119, 0x0118, 0x0116, 0x0115, 0x0114, 0x0113, 0x0112,
+	0x0111, 0x010F, 0x010E, 0x010D, 0x010C, 0x010B, 0x010A, 0x0109, 0x0108, 0x0107, 0x0106, 0x0105, 0x0104, 0x0103, 0x0102, 0x0101,
+};
+
+// CORDIC arc tangent table: atan(2^-i) in angle units (0x10000 = 360 degrees)
+static const u16 FixAtanTab[15] = {
+	8192, 4836, 2555, 1297, 651, 326, 163, 81, 41, 20, 10, 5, 3, 1, 1,
+};
+
+// multiply fix16 numbers (without 64-bit arithmetic; overflow is not checked)
+fix16 FixMul(fix16 a, fix16 b)
+{
+	// absolute values (in unsigned arithmetic, FIX16_MIN cannot be negated in s32)
+	Bool neg = False;
+	u32 ua = (u32)a;
+	if (a < 0) { ua = 0u - ua; neg = True; }
+	u32 ub = (u32)b;
+	if (b < 0) { ub = 0u - ub; neg = !neg; }
+
+	// split to 16-bit halves and multiply by 32-bit multiplications only
+	u32 ah = ua >> 16;
+	u32 al = ua & 0xffff;
+	u32 bh = ub >> 16;
+	u32 bl = ub & 0xffff;
+	u32 res = ((ah*bh) << 16) + ah*bl + al*bh + ((al*bl) >> 16);
+
+	return neg ? (fix16)(0u - res) : (fix16)res;
+}
+
+// divide fix16 numbers (without 64-bit arithmetic; on overflow or division by 0 returns FIX16_MAX or FIX16_MIN)
+fix16 FixDiv(fix16 a, fix16 b)
+{
+	// absolute values (in unsigned arithmetic, FIX16_MIN cannot be negated in s32)
+	Bool neg = False;
+	u32 rem = (u32)a;
+	if (a < 0) { rem = 0u - rem; neg = True; }
+	u32 div = (u32)b;
+	if (b < 0) { div = 0u - div; neg = !neg; }
+
+	// division by zero
+	if (div == 0) return neg ? FIX16_MIN : FIX16_MAX;
+
+	// align divisor to the remainder
+	u32 bit = FIX16_ONE;
+	u32 quot = 0;
+	while ((div < rem) && ((div & B31) == 0))
+	{
+		div <<= 1;
+		bit <<= 1;
+	}
+
+	// overflow
+	if (bit == 0) return neg ? FIX16_MIN : FIX16_MAX;
+
+	// divisor has highest bit set, so remainder cannot be shifted left
+	if ((div & B31) != 0)
+	{
+		if (rem >= div)
+		{
+			quot |= bit;
+			rem -= div;
+		}
+		div >>= 1;
+		bit >>= 1;
+	}
+
+	// long division (remainder < divisor < 2^31)
+	while ((bit != 0) && (rem != 0))
+	{
+		if (rem >= div)
+		{
+			quot |= bit;
+			rem -= div;
+		}
+		rem <<= 1;
+		bit >>= 1;
+	}
+
+	// overflow
+	if ((s32)quot < 0) return neg ? FIX16_MIN : FIX16_MAX;
+
+	return neg ? (fix16)(0u - quot) : (fix16)quot;
+}
+
+// square root of fix16 number (returns 0 for negative numbers)
+//  Result is sqrt(a * 2^16), calculated digit by digit in 2 passes to fit into 32 bits.
+fix16 FixSqrt(fix16 a)
+{
+	if (a <= 0) return 0;
+
+	u32 num = (u32)a;
+	u32 res = 0;
+	u32 bit = (num & 0xFFF00000) ? B30 : B18;
+	while (bit > num) bit >>= 2;
+
+	int pass;
+	for (pass = 0; pass < 2; pass++)
+	{
+		// get bits of result
+		while (bit != 0)
+		{
+			if (num >= res + bit)
+			{
+				num -= res + bit;
+				res = (res >> 1) + bit;
+			}
+			else
+				res >>= 1;
+			bit >>= 2;
+		}
+
+		// shift remainder and result by 16 bits for second pass
+		if (pass == 0)
+		{
+			if (num > 0xffff)
+			{
+				// remainder does not fit - use rounding trick to prevent overflow
+				num -= res;
+				num = (num << 16) - 0x8000;
+				res = (res << 16) + 0x8000;
+			}
+			else
+			{
+				num <<= 16;
+				res <<= 16;
+			}
+			bit = B14;
+		}
+	}
+
+	// round to nearest
+	if (num > res) res++;
+
+	return (fix16)res;
+}
+
+// sine of angle, with linear interpolation (returns fix16 -1.0..+1.0, max. error 2 LSB)
+fix16 FixSin(u16 ang)
+{
+	// angle in quadrant 0..0x3fff, mirrored in quadrant 1 and 3
+	u32 q = ang & 0x3fff;
+	if ((ang & FIXANG_90) != 0) q = 0x4000 - q;
+
+	// top of the wave
+	fix16 res;
+	if (q == 0x4000)
+		res = FIX16_ONE;
+	else
+	{
+		// table index and interpolation (6 bits)
+		int i = q >> 6;
+		const u16* t = &FixSinTab[i];
+		u32 a = t[0];
+		res = (fix16)(a + (((t[1] - a) * (q & 0x3f)) >> 6));
+	}
+
+	// negative half wave
+	return ((ang & FIXANG_180) != 0) ? -res : res;
+}
+
+// sine of angle, table only without interpolation (returns fix16 -1.0..+1.0, error up to 0.31%)
+fix16 FixSinFast(u16 ang)
+{
+	// angle in quadrant rounded to table entries 0..256
+	u32 q = ((ang & 0x3fff) + 0x20) >> 6;
+	if ((ang & FIXANG_90) != 0) q = 256 - q;
+	fix16 res = (q == 256) ? FIX16_ONE : (fix16)FixSinTab[q];
+
+	// negative half wave
+	return ((ang & FIXANG_180) != 0) ? -res : res;
+}
+
+// arc tangent of y/x with CORDIC, returns angle 0..0xFFFF (x and y can be in any scale, max. error 0.03 degree)
+u16 FixAtan2(s32 y, s32 x)
+{
+	// zero vector
+	if ((x == 0) && (y == 0)) return 0;
+
+	// scale down big numbers, CORDIC gain is 1.65 and we need 2 bits reserve
+	while ((x > 0x1fffffff) || (x < -0x1fffffff) || (y > 0x1fffffff) || (y < -0x1fffffff))
+	{
+		x >>= 1;
+		y >>= 1;
+	}
+
+	// scale up small numbers to get precision
+	while ((x < 0x4000) && (x > -0x4000) && (y < 0x4000) && (y > -0x4000))
+	{
+		x *= 16;
+		y *= 16;
+	}
+
+	// rotate vector into right half-plane
+	u16 ang = 0;
+	if (x < 0)
+	{
+		x = -x;
+		y = -y;
+		ang = FIXANG_180;
+	}
+
+	// CORDIC vectoring - rotate vector to X axis
+	int i;
+	s32 xx;
+	for (i = 0; i < (int)count_of(FixAtanTab); i++)
+	{
+		xx = x;
+		if (y > 0)
+		{
+			x += y >> i;
+			y -= xx >> i;
+			ang += FixAtanTab[i];
+		}
+		else
+		{
+			x -= y >> i;
+			y += xx >> i;
+			ang -= FixAtanTab[i];
+		}
+	}
+
+	return ang;
+}
+
+// integer square root of 32-bit unsigned number (rounded down, without multiplication)
+u16 ISqrt(u32 n)
+{
+	u32 res = 0;
+	u32 bit = B30;
+	while (bit > n) bit >>= 2;
+
+	while (bit != 0)
+	{
+		if (n >= res + bit)
+		{
+			n -= res + bit;
+			res = (res >> 1) + bit;
+		}
+		else
+			res >>= 1;
+		bit >>= 2;
+	}
+	return (u16)res;
+}
+
+// divide 16-bit unsigned number by 8-bit divisor, using reciprocal table (division by 0 returns 0xFFFF)
+u16 DivU16U8(u16 num, u8 den)
+{
+	if (den <= 1) return (den == 0) ? 0xffff : num;
+
+	// estimate result (reciprocal is rounded down, so result can be lower by max. 2)
+	u32 q = ((u32)num * FixRecipTab[den]) >> 16;
+
+	// correction
+	u32 r = num - q*den;
+	while (r >= den)
+	{
+		q++;
+		r -= den;
+	}
+	return (u16)q;
+}
+
+// prepare reciprocal of 16-bit divisor (1 real division; divisor 0 is replaced by 1)
+void FixRecipInit(sFixRecip* r, u16 div)
+{
+	if (div == 0) div = 1;
+	r->div = div;
+	r->mul = 0x10000UL / div;
+}
+
+// divide 16-bit unsigned number by precomputed reciprocal (2 multiplications, no division)
+u16 FixRecipDiv(const sFixRecip* r, u16 num)
+{
+	// estimate result (reciprocal is rounded down, so result can be lower by max. 2)
+	u32 q = ((u32)num * r->mul) >> 16;
+
+	// correction
+	u32 div = r->div;
+	u32 rem = num - q*div;
+	while (rem >= div)
+	{
+		q++;
+		rem -= div;
+	}
+	return (u16)q;
+}
+
+// check fixed-point functions (returns False on error)
+Bool FixCheck(void)
+{
+	// multiplication
+	if (FixMul(FIX16(1.5), FIX16(-2.25)) != FIX16(-3.375)) return False;
+	if (FixMul(FIX16(-0.5), FIX16(-0.5)) != FIX16(0.25)) return False;
+	if (FixMul(FIX16(100), FIX16(200)) != FIX16(20000)) return False;
+
+	// division
+	if (FixDiv(FIX16(1), FIX16(4)) != FIX16(0.25)) return False;
+	if (FixDiv(FIX16(-7.5), FIX16(2.5)) != FIX16(-3)) return False;
+	if (FixDiv(FIX16(1), 0) != FIX16_MAX) return False;
+	if (FixDiv(FIX16(20000), FIX16(0.25)) != FIX16_MAX) return False;
+
+	// square root
+	if (FixSqrt(FIX16(4)) != FIX16(2)) return False;
+	if (FixSqrt(FIX16(0.25)) != FIX16(0.5)) return False;
+	if (FixAbs(FixSqrt(FIX16(2)) - FIX16(1.41421356)) > 1) return False;
+	if (ISqrt(1000000) != 1000) return False;
+	if (ISqrt(0xffffffff) != 0xffff) return False;
+
+	// sine and cosine
+	if (FixSin(0) != 0) return False;
+	if (FixSin(FIXANG_90) != FIX16_ONE) return False;
+	if (FixSin(FIXANG_270) != -FIX16_ONE) return False;
+	if (FixAbs(FixSin(FIXANG_DEG(30)) - FIX16(0.5)) > 3) return False;
+	if (FixAbs(FixCos(FIXANG_DEG(60)) - FIX16(0.5)) > 3) return False;
+
+	// arc tangent
+	if (FixAtan2(0, 100) != 0) return False;
+	if ((u16)(FixAtan2(100, 100) - FIXANG_DEG(45) + 8) > 16) return False;
+	if ((u16)(FixAtan2(100, -100) - FIXANG_DEG(135) + 8) > 16) return False;
+	if ((u16)(FixAtan2(-1, 0) - FIXANG_270 + 8) > 16) return False;
+
+	// division by reciprocal
+	int i;
+	for (i = 1; i < 256; i++)
+	{
+		if (DivU16U8(0xffff, (u8)i) != 0xffff/i) return False;
+		if (DivU16U8(12345, (u8)i) != 12345/i) return False;
+	}
+	sFixRecip r;
+	FixRecipInit(&r, 1000);
+	if (FixRecipDiv(&r, 65535) != 65) return False;
+	if (FixRecipDiv(&r, 999) != 0) return False;
+
+	return True;
+}
+
+#endif // USE_FIX
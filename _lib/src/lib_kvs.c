@@ -0,0 +1,290 @@
+// ****************************************************************************
+//
+//                    Wear-leveled key/value store in Flash
+//
+// ****************************************************************************
+// PicoLibSDK - Alternative SDK library for Raspberry Pico and RP2040
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz, hardyplotter2@gmail.com
+// 	https://github.com/Panda381/PicoLibSDK
+//	https://www.breatharian.eu/hw/picolibsdk/index_en.html
+//	https://github.com/pajenicko/picopad
+//	https://picopad.eu/en/
+// License:
+//	This source code is freely available for any purpose, including commercial.
+//	It is possible to take and modify the code or parts of it, without restriction.
+
+#include "../../includes.h"	// globals
+
+#if USE_KVS		// 1=use key/value store in Flash (requires USE_FLASH and USE_CRC)
+
+#if !USE_CRC || (!USE_FLASH && !USE_HOST)
+#error "Key/value store (USE_KVS) requires USE_FLASH and USE_CRC"
+#endif
+
+STATIC_ASSERT(KVS_BANKS >= 2, "KVS_BANKS must be at least 2!");
+STATIC_ASSERT(KVS_KEYS < KVS_BANKSIZE/KVS_PAGE, "KVS_KEYS must be less than number of pages per bank!");
+STATIC_ASSERT(KVS_KEYS < 0xff, "Too many KVS_KEYS!");
+
+// index of the newest record of the keys (page number, KVS_NONE = none)
+u16 KvsIndex[KVS_KEYS];
+
+// active bank
+u8 KvsBank = 0;
+
+// next free page in active bank (KVS_BANKPAGES = bank is full)
+u16 KvsNext = 0;
+
+// last sequence number
+u32 KvsSeq = 0;
+
+// store is ready (KvsInit() passed)
+Bool KvsReady = False;
+
+#if USE_HOST
+
+// emulated Flash region
+u32 KvsMem[KVS_PAGES*KVS_PAGE/4];
+Bool KvsMemInit = False;
+
+// get pointer to the page
+#define KVS_PTR(page) ((const sKvsRec*)((const u8*)KvsMem + (page)*KVS_PAGE))
+
+// erase bank (returns False on error)
+static Bool KvsErase(int bank)
+{
+	memset((u8*)KvsMem + bank*KVS_BANKSIZE, 0xff, KVS_BANKSIZE);
+	return True;
+}
+
+// program page (returns False on error)
+static Bool KvsProgram(int page, const u32* src)
+{
+	memcpy((u8*)KvsMem + page*KVS_PAGE, src, KVS_PAGE);
+	return True;
+}
+
+#else // USE_HOST
+
+// end of application image in Flash (linker symbol, offset from start of Flash)
+extern u8 _eflashslot;
+
+// get pointer to the page
+#define KVS_PTR(page) ((const sKvsRec*)(KVS_ADDR + (page)*KVS_PAGE))
+
+// erase bank (returns False on error)
+static Bool KvsErase(int bank)
+{
+	return Flash_Erase(KVS_ADDR + bank*KVS_BANKSIZE, KVS_BANKSIZE, 1000);
+}
+
+// program page (returns False on error)
+static Bool KvsProgram(int page, const u32* src)
+{
+	return Flash_Program(KVS_ADDR + page*KVS_PAGE, src, KVS_PAGE, 1000);
+}
+
+#endif // USE_HOST
+
+// check if record is valid
+static Bool KvsValid(const sKvsRec* r)
+{
+	int len = r->len;
+	if (len == KVS_DEL) len = 0;
+	return (r->key < KVS_KEYS) && (len <= KVS_DATAMAX) && (r->crc == Crc16CFast(&r->key, len + 6));
+}
+
+// check if page is erased
+static Bool KvsErased(int page)
+{
+	const u32* s = (const u32*)KVS_PTR(page);
+	int i;
+	for (i = KVS_PAGE/4; i > 0; i--) if (*s++ != 0xffffffff) return False;
+	return True;
+}
+
+// write record into next free page of active bank (returns False on error)
+static Bool KvsWrite(int key, const void* data, int len)
+{
+	// bank is full
+	if (KvsNext >= KVS_BANKPAGES) return False;
+
+	// prepare record
+	u32 buf[KVS_PAGE/4];
+	sKvsRec* r = (sKvsRec*)buf;
+	memset(buf, 0xff, KVS_PAGE);
+	r->key = (u8)key;
+	r->len = (u8)len;
+	r->seq = ++KvsSeq;
+	if (len == KVS_DEL) len = 0;
+	if (len > 0) memcpy(r + 1, data, len);
+	r->crc = Crc16CFast(&r->key, len + 6);
+
+	// program page and verify it (bad page stays skipped)
+	int page = KvsBank*KVS_BANKPAGES + KvsNext;
+	KvsNext++;
+	if (!KvsProgram(page, buf) || !KvsValid(KVS_PTR(page))) return False;
+
+	// update index
+	KvsIndex[key] = (u16)page;
+	return True;
+}
+
+// copy records of keys from other banks into active bank (skip = key not to copy, -1 = none; returns False on error)
+static Bool KvsCopy(int skip)
+{
+	int key, page;
+	const sKvsRec* r;
+	for (key = 0; key < KVS_KEYS; key++)
+	{
+		page = KvsIndex[key];
+		if ((key != skip) && (page != KVS_NONE) && (page/KVS_BANKPAGES != KvsBank))
+		{
+			r = KVS_PTR(page);
+			if (!KvsWrite(key, r + 1, r->len)) return False;
+		}
+	}
+	return True;
+}
+
+// garbage collection - erase next bank and move newest records of keys into it
+// (skip = key not to copy, -1 = none; returns False on error)
+static Bool KvsCollect(int skip)
+{
+	// erase next bank
+	int bank = KvsBank + 1;
+	if (bank >= KVS_BANKS) bank = 0;
+	if (!KvsErase(bank)) return False;
+
+	// copy records
+	KvsBank = (u8)bank;
+	KvsNext = 0;
+	return KvsCopy(skip);
+}
+
+// append new record of the key (start garbage collection if bank is full; returns False on error)
+static Bool KvsPut(int key, const void* data, int len)
+{
+	if (!KvsReady) return False;
+	if ((KvsNext >= KVS_BANKPAGES) && !KvsCollect(key)) return False;
+	return KvsWrite(key, data, len);
+}
+
+// initialize key/value store - scan Flash and build index (call once on start)
+// - Returns False if application image overlaps the region; the store stays disabled.
+Bool KvsInit(void)
+{
+	int page, key;
+	const sKvsRec* r;
+
+#if USE_HOST
+	// emulated Flash is erased on first use
+	if (!KvsMemInit)
+	{
+		memset(KvsMem, 0xff, sizeof(KvsMem));
+		KvsMemInit = True;
+	}
+#endif
+
+	// clear index
+	for (key = 0; key < KVS_KEYS; key++) KvsIndex[key] = KVS_NONE;
+	KvsSeq = 0;
+	KvsBank = 0;
+	KvsNext = KVS_BANKPAGES;
+	KvsReady = False;
+
+#if !USE_HOST
+	// application image must not reach the region (do not read or erase program code)
+	if ((u32)&_eflashslot > (u32)(KVS_ADDR - FLASH_BASE)) return False;
+#endif
+
+	// scan all pages - find newest record of every key and newest record at all
+	for (page = 0; page < KVS_PAGES; page++)
+	{
+		r = KVS_PTR(page);
+		if (!KvsValid(r)) continue;
+
+		key = r->key;
+		if ((KvsIndex[key] == KVS_NONE) || (r->seq > KVS_PTR(KvsIndex[key])->seq)) KvsIndex[key] = (u16)page;
+
+		if (r->seq > KvsSeq)
+		{
+			KvsSeq = r->seq;
+			KvsBank = (u8)(page/KVS_BANKPAGES);
+		}
+	}
+
+	// next free page of active bank follows last used page (skip partially programmed pages)
+	KvsNext = KVS_BANKPAGES;
+	while ((KvsNext > 0) && KvsErased(KvsBank*KVS_BANKPAGES + KvsNext - 1)) KvsNext--;
+
+	// complete interrupted garbage collection
+	KvsReady = True;
+	KvsCopy(-1);
+	return True;
+}
+
+// erase all records
+void KvsFormat(void)
+{
+	int i;
+	if (!KvsReady) return;
+	for (i = 0; i < KVS_BANKS; i++) KvsErase(i);
+	for (i = 0; i < KVS_KEYS; i++) KvsIndex[i] = KVS_NONE;
+	KvsBank = 0;
+	KvsNext = 0;
+	KvsSeq = 0;
+}
+
+// get pointer to data of the key in Flash, or NULL if not found (len = pointer to get length, can be NULL)
+const void* KvsPtr(int key, int* len)
+{
+	if ((u32)key >= (u32)KVS_KEYS) return NULL;
+	int page = KvsIndex[key];
+	if (page == KVS_NONE) return NULL;
+	const sKvsRec* r = KVS_PTR(page);
+	if (r->len == KVS_DEL) return NULL;
+	if (len != NULL) *len = r->len;
+	return r + 1;
+}
+
+// get length of data of the key (-1 = not found)
+int KvsLen(int key)
+{
+	int len;
+	if (KvsPtr(key, &len) == NULL) return -1;
+	return len;
+}
+
+// read data of the key into buffer (max = size of buffer; returns length of data, -1 = not found)
+int KvsGet(int key, void* buf, int max)
+{
+	int len;
+	const void* s = KvsPtr(key, &len);
+	if (s == NULL) return -1;
+	if (max > len) max = len;
+	if (max > 0) memcpy(buf, s, max);
+	return len;
+}
+
+// save data of the key (len = 0..KVS_DATAMAX; returns False on error)
+// - Equal data are not saved again.
+Bool KvsSet(int key, const void* data, int len)
+{
+	if (((u32)key >= (u32)KVS_KEYS) || ((u32)len > (u32)KVS_DATAMAX)) return False;
+
+	// equal data are already saved
+	int oldlen;
+	const void* old = KvsPtr(key, &oldlen);
+	if ((old != NULL) && (oldlen == len) && (memcmp(old, data, len) == 0)) return True;
+
+	return KvsPut(key, data, len);
+}
+
+// delete the key (returns False on error)
+Bool KvsDel(int key)
+{
+	if (KvsPtr(key, NULL) == NULL) return True;
+	return KvsPut(key, NULL, KVS_DEL);
+}
+
+#endif // USE_KVS
@@ -0,0 +1,272 @@
+// ****************************************************************************
+//
+//                             Audio mixer
+//
+// ****************************************************************************
+// PicoLibSDK - Alternative SDK library for Raspberry Pico and RP2040
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz, hardyplotter2@gmail.com
+// 	https://github.com/Panda381/PicoLibSDK
+//	https://www.breatharian.eu/hw/picolibsdk/index_en.html
+//	https://github.com/pajenicko/picopad
+//	https://picopad.eu/en/
+// License:
+//	This source code is freely available for any purpose, including commercial.
+//	It is possible to take and modify the code or parts of it, without restriction.
+
+#include "../../includes.h"	// globals
+
+#if USE_MIX		// 1=use audio mixer
+
+// mixer voices
+sMixVoice MixVoice[MIX_VOICES];
+
+// output sample rate in [Hz]
+u32 MixRate = 22050;
+
+// counter of stream underruns (render found next half of stream buffer empty)
+volatile u32 MixStreamUnder = 0;
+
+// Initialize mixer (rate = output sample rate in Hz)
+void MixInit(u32 rate)
+{
+	MixRate = rate;
+	memset(MixVoice, 0, sizeof(MixVoice));
+	int i;
+	for (i = 0; i < MIX_VOICES; i++)
+	{
+		MixVoice[i].duty = MIX_DUTY_HALF;
+		MixVoice[i].lfsr = 0xACE1 + i;
+	}
+}
+
+// get phase step of the voice from frequency in 0.01 Hz
+u32 MixStep(u32 hz01)
+{
+	return (u32)(((u64)hz01 << 32) / ((u64)MixRate*100));
+}
+
+// start tone on the voice (wave = MIX_WAVE_SQUARE, MIX_WAVE_TRIANGLE or MIX_WAVE_NOISE,
+//  step = phase step - use MixStep(), duty = square duty 1..255, vol = volume 0..255)
+void MixTone(int voice, int wave, u32 step, int duty, int vol)
+{
+	sMixVoice* v = &MixVoice[voice];
+
+	// stop the voice while setting parameters (it can be rendered in interrupt)
+	v->wave = MIX_WAVE_OFF;
+	cb();
+
+	v->step = step;
+	v->duty = (u8)duty;
+	v->vol = (u8)vol;
+	if (v->lfsr == 0) v->lfsr = 0xACE1;
+	cb();
+
+	// start the voice
+	v->wave = (u8)wave;
+}
+
+// start PCM sample on the voice
+//  pcm = 8-bit signed samples, len = number of samples (max. 65535)
+//  rate = sample rate of the PCM data in Hz, loop = length of loop from end of sample (0 = no loop)
+void MixSample(int voice, const s8* pcm, int len, u32 rate, int loop, int vol)
+{
+	sMixVoice* v = &MixVoice[voice];
+
+	// stop the voice while setting parameters (it can be rendered in interrupt)
+	v->wave = MIX_WAVE_OFF;
+	cb();
+
+	v->pcm = pcm;
+	v->len = (u32)len << 16;
+	v->loop = (u32)loop << 16;
+	v->phase = 0;
+	v->step = (u32)(((u64)rate << 16) / MixRate);
+	v->vol = (u8)vol;
+	cb();
+
+	// start the voice
+	v->wave = MIX_WAVE_PCM;
+}
+
+// start PCM stream on the voice (double buffer, both halves must be filled before start)
+//  buf = buffer of 2 halves with 8-bit signed samples, half = number of samples in one half
+//  rate = sample rate of the stream in Hz, vol = volume 0..255, end = buffer contains last data
+// Refill half of the buffer after its flag MixVoice[voice].sfull[] is cleared and call MixStreamFull().
+void MixStream(int voice, const s8* buf, int half, u32 rate, int vol, Bool end)
+{
+	sMixVoice* v = &MixVoice[voice];
+
+	// stop the voice while setting parameters (it can be rendered in interrupt)
+	v->wave = MIX_WAVE_OFF;
+	cb();
+
+	v->pcm = buf;
+	v->len = (u32)half << 16;
+	v->loop = end ? 1 : 0;
+	v->phase = 0;
+	v->shalf = 0;
+	v->sfull[0] = 1;
+	v->sfull[1] = 1;
+	v->sunder = 0;
+	v->step = (u32)(((u64)rate << 16) / MixRate);
+	v->vol = (u8)vol;
+	cb();
+
+	// start the voice
+	v->wave = MIX_WAVE_STREAM;
+}
+
+// stop all voices
+void MixStopAll()
+{
+	int i;
+	for (i = 0; i < MIX_VOICES; i++) MixStop(i);
+}
+
+// render samples to output buffer
+//  buf = destination buffer of PWM compare values
+//  n = number of samples
+//  period = PWM period (timer reload value + 1); output value is in range 0..period-1
+void MixRender(u16* buf, int n, u32 period)
+{
+	int i, k, s;
+	s16* d;
+
+	// clear accumulator (the output buffer is used as accumulator of the voices)
+	s16* acc = (s16*)buf;
+	memset(acc, 0, n*sizeof(s16));
+
+	// add voices - rendered voice by voice, so the state of the voice stays in registers
+	sMixVoice* v = MixVoice;
+	for (k = MIX_VOICES; k > 0; k--, v++)
+	{
+		int wave = v->wave;
+		if (wave == MIX_WAVE_OFF) continue;
+
+		int vol = v->vol;
+		u32 phase = v->phase;
+		u32 step = v->step;
+		d = acc;
+
+		switch (wave)
+		{
+		// square with duty
+		case MIX_WAVE_SQUARE:
+			{
+				u32 duty = (u32)v->duty << 24;
+				int hi = (127*vol) >> 8;
+				int lo = -((128*vol) >> 8);
+				for (i = n; i > 0; i--)
+				{
+					*d++ += (phase < duty) ? hi : lo;
+					phase += step;
+				}
+			}
+			break;
+
+		// triangle
+		case MIX_WAVE_TRIANGLE:
+			for (i = n; i > 0; i--)
+			{
+				s = phase >> 24;
+				s = (s < 128) ? (s*2 - 128) : (383 - s*2);
+				*d++ += (s*vol) >> 8;
+				phase += step;
+			}
+			break;
+
+		// noise - shift LFSR on every overflow of the phase
+		case MIX_WAVE_NOISE:
+			{
+				u32 lfsr = v->lfsr;
+				int hi = (127*vol) >> 8;
+				int lo = -((128*vol) >> 8);
+				for (i = n; i > 0; i--)
+				{
+					u32 p = phase;
+					phase += step;
+					if (phase < p) lfsr = (lfsr >> 1) ^ ((0u - (lfsr & 1)) & 0xB400);
+					*d++ += (lfsr & 1) ? hi : lo;
+				}
+				v->lfsr = (u16)lfsr;
+			}
+			break;
+
+		// 8-bit PCM sample
+		case MIX_WAVE_PCM:
+			{
+				const s8* pcm = v->pcm;
+				u32 len = v->len;
+				u32 loop = v->loop;
+				for (i = n; i > 0; i--)
+				{
+					// end of sample - repeat loop or stop
+					if (phase >= len)
+					{
+						if (loop == 0)
+						{
+							v->wave = MIX_WAVE_OFF;
+							break;
+						}
+						do phase -= loop; while (phase >= len);
+					}
+					*d++ += (pcm[phase >> 16]*vol) >> 8;
+					phase += step;
+				}
+			}
+			break;
+
+		// 8-bit PCM stream from double buffer
+		case MIX_WAVE_STREAM:
+			{
+				u32 len = v->len;
+				int half = v->shalf;
+				const s8* pcm = v->pcm + (half ? (len >> 16) : 0);
+				if (v->sfull[half] != 0) v->sunder = 0; // refilled after underrun
+				for (i = n; i > 0; i--)
+				{
+					// end of half - release it and continue with the other half
+					if (phase >= len)
+					{
+						v->sfull[half] = 0;
+						half ^= 1;
+						phase -= len;
+						pcm = v->pcm + (half ? (len >> 16) : 0);
+					}
+
+					// half is not filled - end of stream or underrun
+					if (v->sfull[half] == 0)
+					{
+						if (v->loop != 0)
+							v->wave = MIX_WAVE_OFF;
+						else if (v->sunder == 0)
+						{
+							v->sunder = 1;
+							MixStreamUnder++;
+						}
+						break;
+					}
+
+					*d++ += (pcm[phase >> 16]*vol) >> 8;
+					phase += step;
+				}
+				v->shalf = (u8)half;
+			}
+			break;
+		}
+
+		v->phase = phase;
+	}
+
+	// convert to PWM compare values
+	d = acc;
+	for (i = n; i > 0; i--)
+	{
+		s = *d >> MIX_SHIFT;
+		if (s > 127) s = 127;
+		if (s < -128) s = -128;
+		*d++ = (s16)(((u32)(s + 128)*period) >> 8);
+	}
+}
+
+#endif // USE_MIX
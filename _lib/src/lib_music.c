@@ -0,0 +1,216 @@
+// ****************************************************************************
+//
+//                             Music player
+//
+// ****************************************************************************
+// PicoLibSDK - Alternative SDK library for Raspberry Pico and RP2040
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz, hardyplotter2@gmail.com
+// 	https://github.com/Panda381/PicoLibSDK
+//	https://www.breatharian.eu/hw/picolibsdk/index_en.html
+//	https://github.com/pajenicko/picopad
+//	https://picopad.eu/en/
+// License:
+//	This source code is freely available for any purpose, including commercial.
+//	It is possible to take and modify the code or parts of it, without restriction.
+
+#include "../../includes.h"	// globals
+
+#if USE_MUSIC		// 1=use music player
+
+// periods of notes of octave 0 in 1/16 us (time base 1 MHz with 4 fractional bits)
+const u32 MusicOctTab[12] = {
+	978498,	// C0 (16.3516 Hz)
+	923579,	// C#0 (17.3239 Hz)
+	871742,	// D0 (18.3540 Hz)
+	822815,	// D#0 (19.4454 Hz)
+	776634,	// E0 (20.6017 Hz)
+	733045,	// F0 (21.8268 Hz)
+	691902,	// F#0 (23.1247 Hz)
+	653069,	// G0 (24.4997 Hz)
+	616415,	// G#0 (25.9565 Hz)
+	581818,	// A0 (27.5000 Hz)
+	549163,	// A#0 (29.1352 Hz)
+	518341,	// B0 (30.8677 Hz)
+};
+
+// current song (NULL = not playing)
+const sMusic* volatile MusicSong = NULL;
+
+// divider of the current note (0 = rest)
+volatile u16 MusicDiv = 0;
+
+// player state
+const u8* MusicOrd;		// pointer to current entry of order list
+const u8* MusicPat;		// pointer to current pattern code
+u16 MusicCnt;			// remaining ticks of current note
+s8 MusicTrans;			// current transposition
+u8 MusicLen;			// current length of notes
+u8 MusicTempo;			// current tempo (16 = normal)
+
+// get divider of the note 0..119 (time base 1 MHz)
+u16 MusicNoteDiv(int note)
+{
+	// limit note range
+	if (note < 0) note = 0;
+	if (note >= MUS_NOTE_NUM) note = MUS_NOTE_NUM-1;
+
+	// split to octave and semitone (without division, max. 9 steps)
+	int oct = 0;
+	while (note >= 12)
+	{
+		note -= 12;
+		oct++;
+	}
+
+	// period in 1/16 us -> divider
+	return (u16)((((MusicOctTab[note] >> oct) + 8) >> 4) - 1);
+}
+
+// start pattern of current order entry (returns False on end of song)
+static Bool MusicStartPat()
+{
+	const u8* ord = MusicOrd;
+
+	// end of order list - loop or stop
+	if (ord[0] == MUS_ORD_END)
+	{
+		u8 loop = ord[1];
+		if (loop == MUS_NOLOOP) return False;
+		ord = MusicSong->order + loop*2;
+		MusicOrd = ord;
+		if (ord[0] == MUS_ORD_END) return False; // empty song
+	}
+
+	// start pattern
+	MusicPat = MusicSong->pat[ord[0]];
+	MusicTrans = (s8)ord[1];
+	return True;
+}
+
+// play song (restarts current song)
+void MusicPlay(const sMusic* song)
+{
+	// stop current song (player is called from interrupt)
+	MusicSong = NULL;
+	cb();
+
+	// initialize player
+	MusicOrd = song->order;
+	MusicCnt = 0;		// start first pattern in next tick
+	MusicLen = 4;		// default length 1/16 note
+	MusicTempo = song->tempo;
+	MusicDiv = 0;
+	cb();
+
+	// start song
+	MusicSong = song;
+
+#if SYSTICK_TICKLESS	// 1=tickless mode, SysTick interrupt only when needed
+	// restart SysTick time steps
+	SysTick_Wake();
+#endif
+}
+
+// stop playing song (the tone is stopped in next tick)
+void MusicStop()
+{
+	MusicSong = NULL;
+}
+
+// end of song
+static Bool MusicEnd()
+{
+	MusicSong = NULL;
+	MusicDiv = 0;
+	return True;
+}
+
+// Music scan, called every tick of the melody. Returns True if the current note changed
+//  (then play MusicDiv divider, or stop the tone if MusicDiv is 0).
+Bool MusicScan()
+{
+	// not playing (stop the tone after MusicStop)
+	if (MusicSong == NULL)
+	{
+		if (MusicDiv == 0) return False;
+		MusicDiv = 0;
+		return True;
+	}
+
+	// continue current note
+	if (MusicCnt > 1)
+	{
+		MusicCnt--;
+		return False;
+	}
+
+	// start first pattern
+	const u8* pat = MusicPat;
+	if (MusicCnt == 0)
+	{
+		MusicCnt = 1;
+		if (!MusicStartPat()) return MusicEnd();
+		pat = MusicPat;
+	}
+
+	// process pattern codes (limited number per tick)
+	int i, note;
+	u8 c;
+	for (i = MUSIC_MAX_EVENTS; i > 0; i--)
+	{
+		c = *pat++;
+
+		// note
+		if (c < MUS_NOTE_NUM)
+		{
+			note = c + MusicTrans;
+			MusicDiv = MusicNoteDiv(note);
+			break;
+		}
+
+		// set current length 1..64
+		if ((c & 0xC0) == 0x80)
+		{
+			MusicLen = c - MUS_LEN(1) + 1;
+			continue;
+		}
+
+		// rest
+		if (c == MUS_REST)
+		{
+			MusicDiv = 0;
+			break;
+		}
+
+		// set current length 1..255
+		if (c == MUS_LENX)
+		{
+			MusicLen = *pat++;
+			continue;
+		}
+
+		// set tempo
+		if (c == MUS_TEMPO)
+		{
+			MusicTempo = *pat++;
+			continue;
+		}
+
+		// end of pattern (or invalid code) - next entry of order list
+		MusicOrd += 2;
+		if (!MusicStartPat()) return MusicEnd();
+		pat = MusicPat;
+	}
+	MusicPat = pat;
+
+	// limit of codes reached - continue in next tick
+	if (i == 0) return False;
+
+	// length of the note in ticks
+	int cnt = (MusicLen*MusicTempo + MUS_TEMPO_NORM/2) >> 4;
+	if (cnt <= 0) cnt = 1;
+	MusicCnt = (u16)cnt;
+	return True;
+}
+
+#endif // USE_MUSIC
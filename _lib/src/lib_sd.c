@@ -111,8 +111,17 @@ u8 SD_Buf[16];
 
 // current SD speed - number of HCLK cycles of one half-pulse
 #if USE_SD == 1		// 1=use software SD card driver, 2=use hardware SD card driver (0=no driver)
+#if USE_RCCSPEED	// HCLK_PER_US is variable, speed is set by SD_Connect()
+int SD_SpeedDelay;
+#else
 int SD_SpeedDelay = SD_SPEED_INIT;
 #endif
+#endif
+
+#if SD_HOOK
+// callback between bytes of received data block (NULL = none; function must run from RAM, see NOFLASH)
+pSDHook SD_Hook = NULL;
+#endif
 
 // get SD card type name
 const char* SD_GetName()
@@ -387,6 +396,65 @@ void SD_Disconnect()
 	SD_Type = SD_NONE;
 }
 
+#if SD_HOOK
+// receive data bytes and call hook between them
+// - Runs from RAM, so the hook can keep flash controller busy (programming flash in
+//   background) while the data are received; CPU is not stalled by the flash.
+void NOFLASH(SD_ReadData)(u8* buffer, int num)
+{
+	pSDHook hook = SD_Hook;
+	u8 res;
+	for (; num > 0; num--)
+	{
+
+#if USE_SD == 1		// 1=use software SD card driver, 2=use hardware SD card driver (0=no driver)
+// Software driver:
+
+		// output data bits are HIGH (sending 0xff)
+		GPIO_Out1(SD_MOSI_GPIO);
+
+		int i;
+		u32 start;
+		res = 0;
+		for (i = 8; i > 0; i--)
+		{
+			// shift clock - leading edge rising (WaitClk() cannot be used, it is in flash)
+			GPIO_Out1(SD_CLK_GPIO);
+			start = Time();
+			while ((u32)(Time() - start) < (u32)SD_SpeedDelay) {}
+
+			// read input data bit
+			res <<= 1;
+			cb();
+			res |= GPIO_In(SD_MISO_GPIO);
+
+			// shift clock - trailing edge falling
+			GPIO_Out0(SD_CLK_GPIO);
+			start = Time();
+			while ((u32)(Time() - start) < (u32)SD_SpeedDelay) {}
+		}
+
+#else
+// Hardware driver:
+
+		// send data
+		while (!SPI1_TxEmpty()) {}
+		SPI1_Write(0xff);
+
+		// receive data
+		while (!SPI1_RxReady()) {}
+		res = (u8)SPI1_Read();
+
+#endif
+
+		*buffer++ = res;
+
+		// call hook
+		if (hook != NULL) hook();
+	}
+}
+#endif
+
 // read data block (returns False on error)
 Bool SD_ReadBlock(u8* buffer, int num)
 {
@@ -397,12 +465,19 @@ Bool SD_ReadBlock(u8* buffer, int num)
 	{
 		res = SD_Byte(0xff);
 		if (res != 0xff) break;
+#if SD_HOOK
+		if (SD_Hook != NULL) SD_Hook();
+#endif
 	}
 
 	if (res != 0xfe) return False;
 
 	// read data
+#if SD_HOOK
+	SD_ReadData(buffer, num);
+#else
 	for (n = 0; n < num; n++) buffer[n] = SD_Byte(0xff);
+#endif
 
 	// get CRC16
 	SD_Byte(0xff);
@@ -56,6 +56,7 @@
 //#define SD_SPI_DIV_READ	4		// hardware SD card driver: SPI baud divider 0..7 (means div=2..256) on read
 //#define SD_SPI_DIV_WRITE	6		// hardware SD card driver: SPI baud divider 0..7 (means div=2..256) on write
 //#define USE_SD		1		// 1=use software SD card driver, 2=use hardware SD card driver (0=no driver)
+#define SD_HOOK			1		// 1=call SD_Hook between bytes of received data block (to program flash in background)
 
 #define USE_DRAW		1		// 1=use graphics drawing functions
 #define USE_PRINT		1		// 1=use text printing functions
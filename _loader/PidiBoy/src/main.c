@@ -33,6 +33,7 @@ sFileInfo FileI; // search file info
 // temporary buffer
 #define TEMPBUF	SECT_SIZE	// size must be multiply of FLASH_PAGEPG_SIZE (= 256 B)
 ALIGNED char TempBuf[TEMPBUF];
+ALIGNED char TempBuf2[TEMPBUF]; // second buffer, read from SD card while first one is programmed
 
 // seek cursor to last name
 char LastName[8];
@@ -343,21 +344,24 @@ void SetLastName()
 	LastNameLen = 0;
 }
 
-// clear program memory
-void ClearApp()
+// check if the same application is already in program memory (header with length and CRC matches)
+Bool SameApp()
 {
-	// display info
-	DispInfo("Erasing...");
+	return CheckApp() && (memcmp(AppInfo, &App, sizeof(sAppInfoHeader)) == 0);
+}
 
+// clear rest of program memory behind the application
+void ClearApp(u32 addr)
+{
 	// find end of memory
-	const u32* end = Flash_Check(FLASH_BASE+BOOTLOADER_SIZE, FLASHSIZE-BOOTLOADER_SIZE);
+	const u32* end = Flash_Check(addr, FLASH_BASE+FLASHSIZE-addr);
 
 	// align to 256 B
-	int size = (u32)end - (FLASH_BASE+BOOTLOADER_SIZE);
+	int size = (u32)end - addr;
 	size = (size + FLASH_PAGEER_SIZE-1) & ~(FLASH_PAGEER_SIZE-1);
 
 	// erase memory
-	Flash_Erase(FLASH_BASE+BOOTLOADER_SIZE, size, 1000);
+	if (size > 0) Flash_Erase(addr, size, 1000);
 }
 
 /*
@@ -496,7 +500,8 @@ void SysSetup()
 
 int main(void)
 {
-	int i, j, n, size;
+	int i, j, k, n, size;
+	char* buf;
 	u32 t;
 	sFileDesc* fd;
 
@@ -783,32 +788,46 @@ int main(void)
 							}
 							else
 							{
-								// clear program memory
-								ClearApp();
-								WaitMs(10);
+								// the same application is already in program memory - run it
+								if (SameApp()) RunApp();
+
 								DispInfo("Loading...");
 								WaitMs(10);
 
-								// load program
+								// load program (next block is read from SD card while previous block is programmed in background)
 								FileSeek(&FileF, BOOTLOADER_SIZE); // reset file pointer
 								size -= BOOTLOADER_SIZE;
 								i = FLASH_BASE+BOOTLOADER_SIZE;
+								buf = TempBuf;
+								Flash_BgInit();
+								SD_Hook = Flash_BgPump;
 								while (size > 0)
 								{
 									// read block from the file
 									n = size;
 									if (n > TEMPBUF) n = TEMPBUF;
-									FileRead(&FileF, TempBuf, n);
+									FileRead(&FileF, buf, n);
 
-									// write block to the flash
-									n = (n + FLASH_PAGEPG_SIZE-1) & ~(FLASH_PAGEPG_SIZE-1);
-									Flash_Program(i, (const u32*)TempBuf, n, 1000);
+									// pad last page with erased state
+									k = (n + FLASH_PAGEER_SIZE-1) & ~(FLASH_PAGEER_SIZE-1);
+									memset(&buf[n], 0xff, k - n);
+
+									// start programming changed pages of the block in background (waits for previous block)
+									Flash_BgSet(i, (const u32*)buf, k);
 
 									// shift
-									i += TEMPBUF;
+									i += k;
 									size -= TEMPBUF;
+									buf = (buf == TempBuf) ? TempBuf2 : TempBuf;
 								}
 
+								// finish programming
+								Flash_BgTerm();
+								SD_Hook = NULL;
+
+								// erase old data behind the application
+								ClearApp(i);
+
 								// check checksum
 								if (CheckApp())
 								{
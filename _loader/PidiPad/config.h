@@ -168,6 +168,7 @@
 #define USE_FAT		1	// 1=use FAT filesystem
 #define USE_RAND	0	// 1=use random number generator
 #define USE_SD		1	// 1=use SD card driver
+#define SD_HOOK		1	// 1=call SD_Hook between bytes of received data block (to program flash in background)
 
 // ----------------------------------------------------------------------------
 //                             Device setup
@@ -56,6 +56,7 @@
 //#define SD_SPEED_READ		(HCLK_PER_US/4)	// SD speed on read: wait delay "HCLK_PER_US/4" = 2 Mbps
 //#define SD_SPEED_WRITE	(HCLK_PER_US/1)	// SD speed on write: wait delay "HCLK_PER_US/1" = 500 kbps
 //#define USE_SD		1		// 1=use SD card driver
+#define SD_HOOK			1		// 1=call SD_Hook between bytes of received data block (to program flash in background)
 
 #define USE_DRAW		1		// 1=use graphics drawing functions
 #define USE_PRINT		1		// 1=use text printing functions
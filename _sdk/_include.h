@@ -15,6 +15,9 @@
 
 #define INCLUDE_SDK_FILE(file) STRINGIFY(SDK_SUBDIR/file)
 
+#if USE_HOST
+#include "host/sdk_host.h"			// host emulation (instead of MCU SDK)
+#else
 #include INCLUDE_SDK_FILE(sdk_addressmap.h)	// Register address offsets
 #include INCLUDE_SDK_FILE(sdk_cpu.h)		// CPU control
 #include INCLUDE_SDK_FILE(sdk_rcc.h)		// Reset and clock control
@@ -32,5 +35,18 @@
 #include INCLUDE_SDK_FILE(sdk_systick.h)	// SysTick system counter
 #include INCLUDE_SDK_FILE(sdk_tim.h)		// TIM
 #include INCLUDE_SDK_FILE(sdk_usart.h)		// USART
+#if CH32V2 || CH32V3
+#include INCLUDE_SDK_FILE(sdk_crc.h)		// CRC calculation unit
+#endif
+#endif
+
+#include "sdk_swtimer.h"			// software timers (timer wheel)
+#include "sdk_task.h"			// cooperative task scheduler
+#include "sdk_dmaq.h"			// asynchronous DMA memory copy and fill
+#include "sdk_prof.h"			// sampling PC profiler
+#include "sdk_usartbuf.h"		// buffered USART driver
+#include "sdk_i2cq.h"			// interrupt driven I2C master with transaction queue
+#include "sdk_adcscan.h"		// continuous ADC scanning with DMA
+#include "sdk_rccspeed.h"		// run-time change of system clock
 
 #endif // _SDK_INCLUDE_H
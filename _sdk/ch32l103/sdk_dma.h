@@ -26,6 +26,23 @@ channel8: USART4_RX, TIM2_TRIG
 extern "C" {
 #endif
 
+// DMA channels of buffered USART (sdk_usartbuf.c) by USARTBUF_PORT
+#ifndef USARTBUF_TXDMA
+#if USARTBUF_PORT == 2
+#define USARTBUF_TXDMA	6		// DMA channel of USART2_TX
+#else
+#define USARTBUF_TXDMA	4		// DMA channel of USART1_TX
+#endif
+#endif
+
+#ifndef USARTBUF_RXDMA
+#if USARTBUF_PORT == 2
+#define USARTBUF_RXDMA	7		// DMA channel of USART2_RX
+#else
+#define USARTBUF_RXDMA	5		// DMA channel of USART1_RX
+#endif
+#endif
+
 // DMA control
 typedef struct {
 	io32	INTFR;		// 0x00: DMA interrupt status regiser
@@ -25,6 +25,15 @@ channel7: I2C1_RX, TIM2_CH2, TIM2_CH4
 extern "C" {
 #endif
 
+// DMA channels of buffered USART (sdk_usartbuf.c, USART1)
+#ifndef USARTBUF_TXDMA
+#define USARTBUF_TXDMA	4		// DMA channel of USART1_TX
+#endif
+
+#ifndef USARTBUF_RXDMA
+#define USARTBUF_RXDMA	5		// DMA channel of USART1_RX
+#endif
+
 // DMA control
 typedef struct {
 	io32	INTFR;		// 0x00: DMA interrupt status regiser
@@ -20,6 +20,11 @@ u32 RCC_FreqTab[CLK_NUM] = {
 	HSI_VALUE/6,	// #define CLK_ADCCLK	5	// ADCCLK frequency index (ADC clock, HCLK divided) (default 4000000=HCLK/2)
 };
 
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+// number of HCLK clock cycles per 1 us (HCLK_PER_US; updated by RCC_UpdateFreq())
+u32 RCC_HclkPerUs = HSI_VALUE/3/MHZ;
+#endif
+
 // AHB clock divider table
 const u16 RCC_AHBClkDivTab[16] = {
 	1,	// #define RCC_SYSCLK_DIV1	0	// prescaler off
@@ -140,6 +145,12 @@ void RCC_UpdateFreq(void)
 	u32 f = RCC_FreqTab[CLK_SYSCLK] / ahbdiv;
 	RCC_FreqTab[CLK_HCLK] = f;
 
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+	// number of HCLK clock cycles per 1 us (min. 1, SysTick time base must not be 0)
+	RCC_HclkPerUs = f / MHZ;
+	if (RCC_HclkPerUs == 0) RCC_HclkPerUs = 1;
+#endif
+
 	// get ADC clock divider 2..128
 	u8 adcdiv = RCC_GetADCDivVal();
 
@@ -260,6 +271,75 @@ void RCC_ClockInit(void)
 	Flash_Latency((RCC_FreqTab[CLK_HCLK] >= 26*MHZ) ? 1 : 0);
 }
 
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+// find smallest AHB clock divider RCC_SYSCLK_DIV*, not exceeding required frequency
+// - Only dividers giving whole number of MHz, min. 1 MHz, are used (HCLK_PER_US must be exact).
+//   If required frequency is lower, the lowest such frequency is used.
+static int RCC_FindAHBDiv(u32 base, u32 freq)
+{
+	int div = 0;
+	int best = 0;
+	for (;;)
+	{
+		u32 d = RCC_AHBClkDivTab[div];
+		u32 f = base / d;
+		if (f < MHZ) break;
+		if (((base % d) == 0) && ((f % MHZ) == 0))
+		{
+			best = div;
+			if (f <= freq) break;
+		}
+		if (div >= 15) break;
+		div = (div == 7) ? 11 : (div + 1);
+	}
+	return best;
+}
+
+// Switch system clock at run-time to nearest lower possible frequency in [Hz] (HSI or PLL (HSI*2) as clock source)
+// - Only clock source and AHB divider are changed, use RCC_SetSpeed() to update SysTick and peripherals.
+void RCC_SwitchClock(u32 freq)
+{
+	// base clocks - HSI and PLL (PLL source stays as selected by RCC_ClockInit())
+	u32 hsi = RCC_FreqTab[CLK_HSI];
+	u32 pll = ((RCC_GetPLLSrc() == RCC_PLLSRC_HSI) ? hsi : RCC_FreqTab[CLK_HSE]) * 2;
+
+	// find dividers, use PLL only if it gives higher frequency than HSI
+	int div = RCC_FindAHBDiv(hsi, freq);
+	int div2 = RCC_FindAHBDiv(pll, freq);
+	Bool usepll = (pll / RCC_AHBClkDivTab[div2] > hsi / RCC_AHBClkDivTab[div]);
+	if (usepll) div = div2;
+
+	// set flash slow wait state
+	Flash_Latency(1);
+
+	if (usepll)
+	{
+		// set divider first, then start PLL and select PLL as clock source
+		RCC_AHBDiv(div);
+		RCC_PLLEnable();
+		while (!RCC_PLLIsReady()) {}
+		RCC_SysClkSrc(RCC_SYSCLKSRC_PLL);
+		while (RCC_SysClk() != RCC_SYSCLKSRC_PLL) {}
+	}
+	else
+	{
+		// select HSI as clock source first, then set divider and stop PLL
+		RCC_HSIEnable();
+		while (!RCC_HSIIsStable()) {}
+		RCC_SysClkSrc(RCC_SYSCLKSRC_HSI);
+		while (RCC_SysClk() != RCC_SYSCLKSRC_HSI) {}
+		RCC_AHBDiv(div);
+		RCC_PLLDisable();
+	}
+
+	// Update frequencies in clock frequency table
+	RCC_UpdateFreq();
+
+	// Set flash wait state
+	Flash_Latency((RCC_FreqTab[CLK_HCLK] >= 26*MHZ) ? 1 : 0);
+}
+#endif
+
 // Reset system clock to default configuration (select HSI oscillator/3)
 void RCC_ClockReset(void)
 {
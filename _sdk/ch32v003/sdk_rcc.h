@@ -279,6 +279,12 @@ void RCC_UpdateFreq(void);
 // Initialize system clock to default configuration
 void RCC_ClockInit(void);
 
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+// Switch system clock at run-time to nearest lower possible frequency in [Hz] (HSI or PLL (HSI*2) as clock source)
+// - Only clock source and AHB divider are changed, use RCC_SetSpeed() to update SysTick and peripherals.
+void RCC_SwitchClock(u32 freq);
+#endif
+
 // Reset system clock to default configuration (select HSI oscillator/3)
 void RCC_ClockReset(void);
 
@@ -18,7 +18,125 @@ volatile u16 CurTimeMs = 0;	// current time in [ms] 0..999
 
 u32 SysTick_OldCnt;		// old SysTick counter
 
-#if SYSTICK_MS > 0 // 0=do not use SysTick interrupt
+#if SYSTICK_TICKLESS && (SYSTICK_MS > 0) // 1=tickless mode, SysTick interrupt only on demand
+
+volatile u32 SysTick_WaitEnd;	// end time of WaitMs() in ticks
+volatile Bool SysTick_Waiting = False; // WaitMs() is waiting for SysTick_WaitEnd
+static u32 SysTick_Pend = 0;	// time steps counted by SysTick_Sync(), not yet processed by services
+static Bool SysTick_Idle = False; // last interval was idle (services were not running)
+
+// update system time from free-running counter (returns number of elapsed SYSTICK_MS steps)
+// - Call with disabled interrupts, or from interrupt with priority of SysTick.
+u32 SysTick_Update(void)
+{
+	// load current time
+	u32 sys = SysTime;
+	u16 ms = CurTimeMs;
+	u32 old = SysTick_OldCnt;
+	u32 n = 0;
+
+	// increase time
+	u32 dif = SysTick_Get() - old;
+	while (dif >= SYSTICK_HCLK)
+	{
+		dif -= SYSTICK_HCLK;
+		old += SYSTICK_HCLK;
+		sys += SYSTICK_MS;
+		ms += SYSTICK_MS;
+		if (ms >= 1000)
+		{
+			UnixTime++;
+			ms -= 1000;
+		}
+		n++;
+	}
+
+	// save new current time
+	SysTime = sys;
+	CurTimeMs = ms;
+	SysTick_OldCnt = old;
+	return n;
+}
+
+// update SysTime, CurTimeMs and UnixTime from the counter and return SysTime
+// (in tickless mode the time is otherwise updated only by SysTick interrupt)
+u32 SysTick_Sync(void)
+{
+	IRQ_LOCK;
+	SysTick_Pend += SysTick_Update();
+	u32 t = SysTime;
+	IRQ_UNLOCK;
+	return t;
+}
+
+// SysTick handler - on time step with running service, on end of idle interval,
+// on end of WaitMs() or on SysTick_Wake() request
+HANDLER void SysTick_Handler()
+{
+	// clear interrupt request and software wake request
+	SysTick_Unforce();
+	SysTick_ClrCmp();
+
+	// update system time (SysTick_OldCnt is aligned to start of current time step)
+	u32 n = SysTick_Update() + SysTick_Pend;
+	SysTick_Pend = 0;
+
+	// Services are called once per passed time step. After idle interval the services
+	// were not running - passed steps are dropped, so new melody started by SysTick_Wake()
+	// does not lose its first ticks. Otherwise max. SYSTICK_SCAN_MAX steps are caught up.
+	u32 skip = 0;
+	if (SysTick_Idle)
+	{
+		if (n > 1) skip = n - 1;
+	}
+	else if (n > SYSTICK_SCAN_MAX)
+		skip = n - SYSTICK_SCAN_MAX;
+	n -= skip;
+
+	Bool busy = SysTick_Waiting;
+#if USE_SWTIMER		// 1=use software timers
+	// timer wheel with keyboard and sound scan (dropped steps do not repeat deferrable timers)
+	TimerSkip(skip);
+	for (; n > 0; n--) TimerTick();
+#else
+	// keyboard and sound scan
+	for (; n > 0; n--)
+	{
+#if SYSTICK_KEYSCAN	// call KeyScan() function from SysTick system timer
+		KeyScan();
+#endif
+
+#if SYSTICK_SOUNDSCAN	// 1=call SoundScan() function fron SysTick system timer
+		SoundScan();
+#endif
+	}
+#endif
+
+#if SYSTICK_KEYSCAN	// call KeyScan() function from SysTick system timer
+	if (KeyBusy()) busy = True;
+#endif
+
+#if SYSTICK_SOUNDSCAN	// 1=call SoundScan() function fron SysTick system timer
+	if (SoundBusy()) busy = True;
+#endif
+
+	// next time step, or end of idle interval if no service needs the time step
+	u32 steps = busy ? 1 : (SYSTICK_IDLE_MS/SYSTICK_MS);
+	SysTick_Idle = !busy;
+#if USE_SWTIMER		// 1=use software timers
+	steps = TimerNext(steps);
+#endif
+	u32 cnt = SysTick_OldCnt + steps*SYSTICK_HCLK;
+
+	// end of WaitMs() comes earlier
+	if (SysTick_Waiting && ((s32)(SysTick_WaitEnd - cnt) < 0)) cnt = SysTick_WaitEnd;
+
+	// set new interrupt time (not too close to current time)
+	if ((s32)(cnt - SysTick_Get()) < (s32)(100*HCLK_PER_US)) cnt = SysTick_Get() + 100*HCLK_PER_US;
+	SysTick_SetCmp(cnt);
+}
+
+#elif SYSTICK_MS > 0 // 0=do not use SysTick interrupt
 // SysTick handler
 HANDLER void SysTick_Handler()
 {
@@ -32,6 +150,7 @@ HANDLER void SysTick_Handler()
 	u32 sys = SysTime;
 	u16 ms = CurTimeMs;
 	u32 old = SysTick_OldCnt;
+	u32 n = 0;
 
 	// increase time
 	u32 dif = cnt - old;
@@ -40,6 +159,7 @@ HANDLER void SysTick_Handler()
 		dif -= SYSTICK_HCLK;
 		old += SYSTICK_HCLK;
 		sys += SYSTICK_MS;
+		n++;
 		ms += SYSTICK_MS;
 		if (ms >= 1000)
 		{
@@ -58,6 +178,10 @@ HANDLER void SysTick_Handler()
 	if (dif >= SYSTICK_HCLK - 100*HCLK_PER_US) cnt += SYSTICK_HCLK;
 	SysTick_SetCmp(cnt);
 
+#if USE_SWTIMER		// 1=use software timers
+	// timer wheel with keyboard and sound scan, once per time step
+	for (; n > 0; n--) TimerTick();
+#else
 #if SYSTICK_KEYSCAN	// call KeyScan() function from SysTick system timer
 	KeyScan();
 #endif
@@ -65,6 +189,7 @@ HANDLER void SysTick_Handler()
 #if SYSTICK_SOUNDSCAN	// 1=call SoundScan() function fron SysTick system timer
 	SoundScan();
 #endif
+#endif
 }
 #endif // SYSTICK_MS > 0
 
@@ -81,6 +206,9 @@ void SysTick_Init(void)
 	SysTick_ResetDisable();	// not reseting to 0
 	SysTick_OldCnt = 0;	// update current counter
 	SysTick_Enable();	// enable counter
+#if USE_SWTIMER		// 1=use software timers
+	TimerInit();		// initialize timer wheel
+#endif
 #if SYSTICK_MS > 0 // 0=do not use SysTick interrupt
 	NVIC_IRQEnable(IRQ_SYSTICK); // IRQ enable
 	SysTick_IntEnable();	// interrupt enable
@@ -133,6 +261,20 @@ void WaitMs(u32 ms)
 	// get start time
 	u32 start = Time();
 
+#if SYSTICK_TICKLESS && (SYSTICK_MS > 0) // 1=tickless mode, SysTick interrupt only on demand
+	// sleep until SysTick wakes up on end of wait (not in interrupt, not nested)
+	if (!NVIC_IsActive() && !SysTick_Waiting)
+	{
+		SysTick_WaitEnd = start + ms;
+		cb();
+		SysTick_Waiting = True;
+		SysTick_Wake();
+		while ((u32)(Time() - start) < ms) wfi();
+		SysTick_Waiting = False;
+		return;
+	}
+#endif
+
 	// wait
 	while ((u32)(Time() - start) < ms) {}
 }
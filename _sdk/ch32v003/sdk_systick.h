@@ -35,6 +35,29 @@ extern "C" {
 #define SYSTICK_HCLK	(SYSTICK_MS*HCLK_PER_MS)
 #endif
 
+// 1=tickless mode - SysTick interrupt is generated only when needed: every SYSTICK_MS while
+// KeyBusy() or SoundBusy() of the device service returns True, on end of WaitMs() (which
+// sleeps with wfi()), on SysTick_Wake() request, and once per SYSTICK_IDLE_MS otherwise.
+#ifndef SYSTICK_TICKLESS
+#define SYSTICK_TICKLESS 0
+#endif
+
+// idle interval of SysTick interrupt in tickless mode in [ms] (must be multiply of SYSTICK_MS)
+#ifndef SYSTICK_IDLE_MS
+#define SYSTICK_IDLE_MS	(SYSTICK_MS*64)
+#endif
+
+// number of HCLK clock cycles per idle interval of SysTick interrupt in tickless mode
+#ifndef SYSTICK_IDLE_HCLK
+#define SYSTICK_IDLE_HCLK (SYSTICK_IDLE_MS*HCLK_PER_MS)
+#endif
+
+// max. number of calls of KeyScan() and SoundScan() per SysTick interrupt in tickless mode
+// (services catch up passed time steps with delayed interrupt; steps of idle interval are dropped)
+#ifndef SYSTICK_SCAN_MAX
+#define SYSTICK_SCAN_MAX 8
+#endif
+
 // SysTick System counter
 typedef struct {
 	io32	CTLR;			// 0x00: system count control register
@@ -55,6 +78,9 @@ extern volatile u32 UnixTime;	// current date and time in Unix format
 				// - number of seconds since 1/1/1970 (thursday) up to 12/31/2099
 extern volatile u16 CurTimeMs;	// current time in [ms] 0..999
 
+// SysTick counter on start of current time step (old SysTick counter)
+extern u32 SysTick_OldCnt;
+
 // Enable/Disable System counter
 INLINE void SysTick_Enable(void) { SysTick->CTLR |= B0; }
 INLINE void SysTick_Disable(void) { SysTick->CTLR &= ~B0; }
@@ -88,6 +114,26 @@ INLINE u32 SysTick_Get(void) { return SysTick->CNT; }
 INLINE void SysTick_SetCmp(u32 cmp) { SysTick->CMP = cmp; }
 INLINE u32 SysTick_GetCmp(void) { return SysTick->CMP; }
 
+#if SYSTICK_TICKLESS && (SYSTICK_MS > 0) // 1=tickless mode, SysTick interrupt only on demand
+// update system time from free-running counter (returns number of elapsed SYSTICK_MS steps)
+// - Call with disabled interrupts, or from interrupt with priority of SysTick.
+u32 SysTick_Update(void);
+
+// update SysTime, CurTimeMs and UnixTime from the counter and return SysTime
+// - In tickless mode the variables are updated only by SysTick interrupt, so they can be
+//   up to SYSTICK_IDLE_MS old. Call this function to get current time.
+u32 SysTick_Sync(void);
+
+// request SysTick interrupt to restart time steps (call after start of service, e.g. new melody or key edge)
+INLINE void SysTick_Wake(void) { SysTick_Force(); }
+#else
+// update SysTime, CurTimeMs and UnixTime from the counter and return SysTime (only in tickless mode)
+INLINE u32 SysTick_Sync(void) { return SysTime; }
+
+// request SysTick interrupt to restart time steps (only in tickless mode)
+INLINE void SysTick_Wake(void) {}
+#endif
+
 // Initialize SysTick
 void SysTick_Init(void);
 
@@ -346,7 +346,7 @@ INLINE void TIM1_CCDMAOnComp(void) { TIMx_CCDMAOnComp(TIM1); }
 INLINE void TIM2_CCDMAOnComp(void) { TIMx_CCDMAOnComp(TIM2); }
 
 // Select master to slave synchronization mode TIM_MSSYNC_* (select trigger output signal; default reset; register CTLR2.MMS[2:0])
-INLINE void TIMx_MSSync(TIM_t* tim, int sync) { tim->CTLR2 = (tim->CTLR1 & ~(7<<4)) | (sync<<4); }
+INLINE void TIMx_MSSync(TIM_t* tim, int sync) { tim->CTLR2 = (tim->CTLR2 & ~(7<<4)) | (sync<<4); }
 INLINE void TIM1_MSSync(int sync) { TIMx_MSSync(TIM1, sync); }
 INLINE void TIM2_MSSync(int sync) { TIMx_MSSync(TIM2, sync); }
 
@@ -338,4 +338,150 @@ void Flash_OBWrite(const OB_t* ob)
 	Flash_OBProgram(ob, 1000);
 }
 
+// --- Background programming
+
+// state of background programming
+#define FLASH_BG_NEXT	0	// check next page
+#define FLASH_BG_ERASE	1	// page is being erased
+#define FLASH_BG_PROG	2	// page is being programmed
+
+u32 Flash_BgAddr;		// address of current page
+const u32* Flash_BgSrc;		// source data of current page
+volatile int Flash_BgNum = 0;	// number of remaining pages
+u8 Flash_BgState = FLASH_BG_NEXT; // state of current page FLASH_BG_*
+
+// start background programming (unlocks flash programming controller)
+void Flash_BgInit(void)
+{
+	// Unlock flash programming controller
+	Flash_Unlock();
+
+	// Unlock fast programming
+	Flash_FastUnlock();
+
+	// clear write protection error
+	Flash_WProtErrClr();
+
+	// no pages
+	Flash_BgNum = 0;
+	Flash_BgState = FLASH_BG_NEXT;
+}
+
+// set block for background programming, waits for previous block (address and size must
+// be multiply of 256 B = 0x100; source address must be u32 aligned and data must be valid
+// until the block is done)
+void Flash_BgSet(u32 addr, const u32* src, u32 size)
+{
+	// wait for previous block
+	Flash_BgFlush();
+
+	// setup new block
+	Flash_BgAddr = addr;
+	Flash_BgSrc = src;
+	Flash_BgState = FLASH_BG_NEXT;
+	Flash_BgNum = size / FLASH_PAGEER_SIZE;
+}
+
+// continue background programming - starts next erase or program operation if the flash
+// controller is not busy (runs from RAM; returns False if all pages are done)
+Bool NOFLASH(Flash_BgPump)(void)
+{
+	// all pages are done
+	if (Flash_BgNum <= 0) return False;
+
+	// operation is in progress
+	if (Flash_Busy()) return True;
+
+	// write protection error - stop programming
+	if (Flash_WProtErr())
+	{
+		Flash_BgNum = 0;
+		return False;
+	}
+
+	// page has been programmed - shift to next page
+	if (Flash_BgState == FLASH_BG_PROG)
+	{
+		Flash_FastProgDisable();
+		Flash_BgAddr += FLASH_PAGEER_SIZE;
+		Flash_BgSrc += FLASH_PAGEER_SIZE/4;
+		Flash_BgState = FLASH_BG_NEXT;
+		if (--Flash_BgNum <= 0) return False;
+	}
+
+	// page has been erased - load data into internal buffer and start programming
+	else if (Flash_BgState == FLASH_BG_ERASE)
+	{
+		// disable fast page erase, enable fast programming
+		Flash_FastEraseDisable();
+		Flash_FastProgEnable();
+
+		// clear internal 256-byte buffer
+		Flash_BufReset();
+		while (Flash_Busy()) {}
+
+		// process 256 bytes (as 64 words u32)
+		u32 addr = Flash_BgAddr;
+		const u32* src = Flash_BgSrc;
+		int i;
+		for (i = FLASH_PAGEPG_SIZE/4; i > 0; i--)
+		{
+			// write 32-bit word to the cache and load it to the buffer
+			*(u32*)addr = *src;
+			Flash_BufLoad();
+			while (Flash_Busy()) {}
+
+			// shift to next word
+			addr += 4;
+			src++;
+		}
+
+		// start programming the page
+		Flash_Addr(Flash_BgAddr);
+		Flash_Start();
+		Flash_BgState = FLASH_BG_PROG;
+		return True;
+	}
+
+	// skip pages equal to the source data (flash is not busy, it can be read)
+	while (Flash_Verify(Flash_BgAddr, Flash_BgSrc, FLASH_PAGEER_SIZE) == NULL)
+	{
+		Flash_BgAddr += FLASH_PAGEER_SIZE;
+		Flash_BgSrc += FLASH_PAGEER_SIZE/4;
+		if (--Flash_BgNum <= 0) return False;
+	}
+
+	// disable option byte erase B5, disable 1K sector erase B1, enable fast page erase B17
+	FLASH->CTLR = (FLASH_GETCTLR & ~(B5|B1)) | B17;
+
+	// start erasing the page
+	Flash_Addr(Flash_BgAddr);
+	Flash_Start();
+	Flash_BgState = FLASH_BG_ERASE;
+	return True;
+}
+
+// wait for background programming to finish
+void Flash_BgFlush(void)
+{
+	while (Flash_BgPump()) {}
+}
+
+// terminate background programming (waits for last block and locks flash programming controller)
+void Flash_BgTerm(void)
+{
+	// wait for last block
+	Flash_BgFlush();
+
+	// disable fast operations
+	Flash_FastEraseDisable();
+	Flash_FastProgDisable();
+
+	// Lock fast programing
+	Flash_FastLock();
+
+	// Lock flash programming controller
+	Flash_Lock();
+}
+
 #endif // USE_FLASH
@@ -274,6 +274,33 @@ Bool Flash_OBVerify(OB_t* ob);
 // Write option bytes from buffer to flash
 void Flash_OBWrite(const OB_t* ob);
 
+// --- Background programming
+// Pages are erased and programmed by the flash controller while the CPU continues
+// with other work. The CPU is stalled on every access to the flash during erasing
+// or programming, so the work must run from RAM (functions marked with NOFLASH)
+// and must call Flash_BgPump() often. Pages equal to the source data are skipped.
+
+// number of remaining pages of background programming
+extern volatile int Flash_BgNum;
+
+// start background programming (unlocks flash programming controller)
+void Flash_BgInit(void);
+
+// set block for background programming, waits for previous block (address and size must
+// be multiply of 256 B = 0x100; source address must be u32 aligned and data must be valid
+// until the block is done)
+void Flash_BgSet(u32 addr, const u32* src, u32 size);
+
+// continue background programming - starts next erase or program operation if the flash
+// controller is not busy (runs from RAM; returns False if all pages are done)
+Bool Flash_BgPump(void);
+
+// wait for background programming to finish
+void Flash_BgFlush(void);
+
+// terminate background programming (waits for last block and locks flash programming controller)
+void Flash_BgTerm(void);
+
 #endif // USE_FLASH
 
 #ifdef __cplusplus
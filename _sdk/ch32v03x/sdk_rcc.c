@@ -18,6 +18,11 @@ u32 RCC_FreqTab[CLK_NUM] = {
 	HSI_VALUE/12,	// #define CLK_ADCCLK	3	// ADCCLK frequency index (ADC clock, HCLK divided) (default 4000000=HCLK/12)
 };
 
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+// number of HCLK clock cycles per 1 us (HCLK_PER_US; updated by RCC_UpdateFreq())
+u32 RCC_HclkPerUs = HSI_VALUE/6/MHZ;
+#endif
+
 // AHB clock divider table
 const u16 RCC_AHBClkDivTab[16] = {
 	1,	// #define RCC_SYSCLK_DIV1	0	// prescaler off
@@ -52,6 +57,12 @@ void RCC_UpdateFreq(void)
 	u32 f = RCC_FreqTab[CLK_SYSCLK] / ahbdiv;
 	RCC_FreqTab[CLK_HCLK] = f;
 
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+	// number of HCLK clock cycles per 1 us (min. 1, SysTick time base must not be 0)
+	RCC_HclkPerUs = f / MHZ;
+	if (RCC_HclkPerUs == 0) RCC_HclkPerUs = 1;
+#endif
+
 	// get ADC clock divider 2..128
 //	u8 adcdiv = RCC_GetADCDivTab();
 // @TODO
@@ -94,6 +105,46 @@ void RCC_ClockInit(void)
 	Flash_Latency((RCC_FreqTab[CLK_HCLK] >= 26*MHZ) ? 2 : ((RCC_FreqTab[CLK_HCLK] >= 13*MHZ) ? 1 : 0));
 }
 
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+// find smallest AHB clock divider RCC_SYSCLK_DIV*, not exceeding required frequency
+// - Only dividers giving whole number of MHz, min. 1 MHz, are used (HCLK_PER_US must be exact).
+//   If required frequency is lower, the lowest such frequency is used.
+static int RCC_FindAHBDiv(u32 base, u32 freq)
+{
+	int div = 0;
+	int best = 0;
+	for (;;)
+	{
+		u32 d = RCC_AHBClkDivTab[div];
+		u32 f = base / d;
+		if (f < MHZ) break;
+		if (((base % d) == 0) && ((f % MHZ) == 0))
+		{
+			best = div;
+			if (f <= freq) break;
+		}
+		if (div >= 15) break;
+		div = (div == 7) ? 11 : (div + 1);
+	}
+	return best;
+}
+
+// Switch system clock at run-time to nearest lower possible frequency in [Hz] (HSI as clock source)
+// - Only clock source and AHB divider are changed, use RCC_SetSpeed() to update SysTick and peripherals.
+void RCC_SwitchClock(u32 freq)
+{
+	// set flash slow wait state, set divider
+	Flash_Latency(2);
+	RCC_AHBDiv(RCC_FindAHBDiv(RCC_FreqTab[CLK_HSI], freq));
+
+	// Update frequencies in clock frequency table
+	RCC_UpdateFreq();
+
+	// Set flash wait state
+	Flash_Latency((RCC_FreqTab[CLK_HCLK] >= 26*MHZ) ? 2 : ((RCC_FreqTab[CLK_HCLK] >= 13*MHZ) ? 1 : 0));
+}
+#endif
+
 // Reset system clock to default configuration (select HSI oscillator/3)
 void RCC_ClockReset(void)
 {
@@ -32,6 +32,7 @@ HANDLER void SysTick_Handler()
 	u32 sys = SysTime;
 	u16 ms = CurTimeMs;
 	u64 old = SysTick_OldCnt;
+	u32 n = 0;
 
 	// increase time
 	int dif = (int)(cnt - old);
@@ -40,6 +41,7 @@ HANDLER void SysTick_Handler()
 		dif -= SYSTICK_HCLK;
 		old += SYSTICK_HCLK;
 		sys += SYSTICK_MS;
+		n++;
 		ms += SYSTICK_MS;
 		if (ms >= 1000)
 		{
@@ -58,6 +60,10 @@ HANDLER void SysTick_Handler()
 	if (dif >= SYSTICK_HCLK - 100*HCLK_PER_US) cnt += SYSTICK_HCLK;
 	SysTick_SetCmp(cnt);
 
+#if USE_SWTIMER		// 1=use software timers
+	// timer wheel with keyboard and sound scan, once per time step
+	for (; n > 0; n--) TimerTick();
+#else
 #if SYSTICK_KEYSCAN	// call KeyScan() function from SysTick system timer
 	KeyScan();
 #endif
@@ -65,6 +71,7 @@ HANDLER void SysTick_Handler()
 #if SYSTICK_SOUNDSCAN	// 1=call SoundScan() function fron SysTick system timer
 	SoundScan();
 #endif
+#endif
 }
 #endif // SYSTICK_MS > 0
 
@@ -83,6 +90,9 @@ void SysTick_Init(void)
 	SysTick_ResetDisable();	// not reseting to 0
 	SysTick_OldCnt = 0;	// update current counter
 	SysTick_Enable();	// enable counter
+#if USE_SWTIMER		// 1=use software timers
+	TimerInit();		// initialize timer wheel
+#endif
 #if SYSTICK_MS > 0 // 0=do not use SysTick interrupt
 	NVIC_IRQEnable(IRQ_SYSTICK); // IRQ enable
 	SysTick_IntEnable();	// interrupt enable
@@ -56,6 +56,9 @@ extern volatile u32 UnixTime;	// current date and time in Unix format
 				// - number of seconds since 1/1/1970 (thursday) up to 12/31/2099
 extern volatile u16 CurTimeMs;	// current time in [ms] 0..999
 
+// SysTick counter on start of current time step (old SysTick counter)
+extern u64 SysTick_OldCnt;
+
 // Enable/Disable System counter
 INLINE void SysTick_Enable(void) { SysTick->CTLR |= B0; }
 INLINE void SysTick_Disable(void) { SysTick->CTLR &= ~B0; }
@@ -25,6 +25,23 @@ channel7: USART2_TX, TIM2_CH2, TIM2_CH4
 extern "C" {
 #endif
 
+// DMA channels of buffered USART (sdk_usartbuf.c) by USARTBUF_PORT
+#ifndef USARTBUF_TXDMA
+#if USARTBUF_PORT == 2
+#define USARTBUF_TXDMA	7		// DMA channel of USART2_TX
+#else
+#define USARTBUF_TXDMA	4		// DMA channel of USART1_TX
+#endif
+#endif
+
+#ifndef USARTBUF_RXDMA
+#if USARTBUF_PORT == 2
+#define USARTBUF_RXDMA	6		// DMA channel of USART2_RX
+#else
+#define USARTBUF_RXDMA	5		// DMA channel of USART1_RX
+#endif
+#endif
+
 // DMA control
 typedef struct {
 	io32	INTFR;		// 0x00: DMA interrupt status regiser
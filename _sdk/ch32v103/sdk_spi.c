@@ -23,4 +23,248 @@ u16 SPIx_RecvWait(SPI_t* spi)
 	return SPIx_Read(spi);
 }
 
+#if USE_SPIDMA		// 1=use SPI DMA transfer (requires USE_DMA)
+
+#if !USE_DMA
+#error "SPI DMA transfer (USE_SPIDMA) requires USE_DMA"
+#endif
+
+// state of SPI DMA transfer
+typedef struct {
+	SPI_t*		spi;		// SPI port
+	sSpiDma* volatile head;		// first descriptor of running transfer (NULL = idle)
+	sSpiDma*	cur;		// current descriptor
+	pSpiDmaCb	cb;		// completion callback
+	u16		dff;		// frame format before transfer (register CTLR1.DFF)
+	u8		rxch;		// RX DMA channel
+	u8		txch;		// TX DMA channel
+	u8		irq;		// interrupt of TX DMA channel
+	Bool		rxon;		// RX DMA channel is armed
+} sSpiDmaState;
+
+sSpiDmaState SpiDma1 = { SPI1, NULL, NULL, NULL, 0, 2, 3, IRQ_DMA1_CH3, False };
+
+#if SPIDMA_SPI2
+
+#if USE_USARTBUF && (USARTBUF_PORT != 2)
+#error "SPI2 DMA transfer (SPIDMA_SPI2) needs DMA channels 4 and 5 used by USARTBUF_PORT 1"
+#endif
+
+sSpiDmaState SpiDma2 = { SPI2, NULL, NULL, NULL, 0, 4, 5, IRQ_DMA1_CH5, False };
+
+// get state of SPI DMA transfer
+INLINE sSpiDmaState* SPIx_DmaState(SPI_t* spi) { return (spi == SPI2) ? &SpiDma2 : &SpiDma1; }
+
+#else
+
+// get state of SPI DMA transfer
+INLINE sSpiDmaState* SPIx_DmaState(SPI_t* spi) { return &SpiDma1; }
+
+#endif
+
+// set frame format of idle SPI (dff = B11 for 16-bit frames)
+static void SPIx_DmaFormat(SPI_t* spi, u16 dff)
+{
+	if ((spi->CTLR1 & B11) != dff)
+	{
+		SPIx_Disable(spi);
+		spi->CTLR1 = (spi->CTLR1 & ~B11) | dff;
+		SPIx_Enable(spi);
+	}
+}
+
+// start transfer of next non-empty descriptor (returns False on end of chain)
+static Bool SPIx_DmaNext(sSpiDmaState* s, sSpiDma* d)
+{
+	while ((d != NULL) && (d->cnt == 0)) d = d->next;
+	s->cur = d;
+	if (d == NULL) return False;
+
+	SPI_t* spi = s->spi;
+	DMAchan_t* rx = DMA1_Chan(s->rxch);
+	DMAchan_t* tx = DMA1_Chan(s->txch);
+	Bool bit16 = (d->flags & SPIDMA_16BIT) != 0;
+	int size = bit16 ? DMA_SIZE_16 : DMA_SIZE_8;
+	u32 cfg = DMA_CFG_PSIZE(size) | DMA_CFG_MSIZE(size);
+
+	// set frame format
+	SPIx_DmaFormat(spi, bit16 ? B11 : 0);
+
+	// discard old received data and overrun flag
+	(void)spi->DATAR;
+	(void)spi->STATR;
+
+	// RX DMA, from SPI data register to memory (channel is touched only if it is used)
+	if (s->rxon)
+	{
+		SPIx_RxDMADisable(spi);
+		DMA_ChanDisable(rx);
+		s->rxon = False;
+	}
+#if SPIDMA_RX		// 1=use RX DMA channel to receive data
+	if (d->rx != NULL)
+	{
+		DMA_PerAddr(rx, &spi->DATAR);
+		DMA_MemAddr(rx, d->rx);
+		DMA_Cnt(rx, d->cnt);
+		DMA_Cfg(rx, cfg | DMA_CFG_DIRFROMPER | DMA_CFG_MEMINC | DMA_CFG_PRIOR_HIGH | DMA_CFG_EN);
+		SPIx_RxDMAEnable(spi);
+		s->rxon = True;
+	}
+#endif
+
+	// TX DMA, from memory to SPI data register (constant is sent without memory increment)
+	DMA_ChanDisable(tx);
+	DMA_PerAddr(tx, &spi->DATAR);
+	if (d->tx != NULL)
+	{
+		DMA_MemAddr(tx, d->tx);
+		cfg |= DMA_CFG_MEMINC;
+	}
+	else
+		DMA_MemAddr(tx, &d->fill);
+	DMA_Cnt(tx, d->cnt);
+	DMA1_CompClr(s->txch);
+	DMA_Cfg(tx, cfg | DMA_CFG_DIRFROMMEM | DMA_CFG_COMPINT | DMA_CFG_PRIOR_MED | DMA_CFG_EN);
+	SPIx_TxDMAEnable(spi);
+	return True;
+}
+
+// finish DMA transfer
+static void SPIx_DmaEnd(sSpiDmaState* s)
+{
+	SPI_t* spi = s->spi;
+	SPIx_TxDMADisable(spi);
+	DMA_ChanDisable(DMA1_Chan(s->txch));
+	if (s->rxon)
+	{
+		SPIx_RxDMADisable(spi);
+		DMA_ChanDisable(DMA1_Chan(s->rxch));
+		s->rxon = False;
+	}
+	(void)spi->DATAR;
+	(void)spi->STATR;
+	SPIx_DmaFormat(spi, s->dff);
+
+	sSpiDma* d = s->head;
+	s->head = NULL;
+	if (s->cb != NULL) s->cb(d);
+}
+
+// TX DMA interrupt - wait for the last frame and continue with next descriptor
+static void SPIx_DmaIrq(sSpiDmaState* s)
+{
+	SPI_t* spi = s->spi;
+	DMA1_CompClr(s->txch);
+	sSpiDma* d = s->cur;
+	if (d == NULL) return;
+
+	// wait for transmission of the last frame
+	if (s->rxon) while (DMA_GetCnt(DMA1_Chan(s->rxch)) != 0) {}
+	while (!SPIx_TxEmpty(spi) || SPIx_Busy(spi)) {}
+
+	// next descriptor or end of transfer
+	if (!SPIx_DmaNext(s, d->next)) SPIx_DmaEnd(s);
+}
+
+// SPI1 TX DMA interrupt
+HANDLER void DMA1_Channel3_IRQHandler()
+{
+	SPIx_DmaIrq(&SpiDma1);
+}
+
+#if SPIDMA_SPI2
+// SPI2 TX DMA interrupt
+HANDLER void DMA1_Channel5_IRQHandler()
+{
+	SPIx_DmaIrq(&SpiDma2);
+}
+#endif
+
+// Start DMA transfer of chain of descriptors (waits for end of previous transfer; cb = callback or NULL)
+void SPIx_DmaStart(SPI_t* spi, sSpiDma* d, pSpiDmaCb cb)
+{
+	sSpiDmaState* s = SPIx_DmaState(spi);
+
+	// wait for end of previous transfer, including polled transfer
+	SPIx_DmaWait(spi);
+	while (!SPIx_TxEmpty(spi) || SPIx_Busy(spi)) {}
+
+	// start transfer
+	RCC_DMA1ClkEnable();
+	NVIC_IRQEnable(s->irq);
+	s->cb = cb;
+	s->dff = spi->CTLR1 & B11;
+	s->head = d;
+	IRQ_LOCK;
+	if (!SPIx_DmaNext(s, d)) SPIx_DmaEnd(s);
+	IRQ_UNLOCK;
+}
+
+// Check if DMA transfer is running
+Bool SPIx_DmaBusy(SPI_t* spi)
+{
+	return SPIx_DmaState(spi)->head != NULL;
+}
+
+// Wait for end of DMA transfer
+void SPIx_DmaWait(SPI_t* spi)
+{
+	while (SPIx_DmaBusy(spi)) {}
+}
+
+// run simple DMA transfer and wait
+static void SPIx_DmaRun(SPI_t* spi, const u8* tx, u8* rx, int cnt, u16 fill, Bool bit16)
+{
+	sSpiDma d;
+	d.next = NULL;
+	d.fill = fill;
+	d.flags = bit16 ? SPIDMA_16BIT : 0;
+
+	// transfer in parts of max. 32K frames
+	int n;
+	for (; cnt > 0; cnt -= n)
+	{
+		n = cnt;
+		if (n > 0x8000) n = 0x8000;
+		d.tx = tx;
+		d.rx = rx;
+		d.cnt = (u16)n;
+		SPIx_DmaStart(spi, &d, NULL);
+		SPIx_DmaWait(spi);
+
+		int bytes = bit16 ? n*2 : n;
+		if (tx != NULL) tx += bytes;
+		if (rx != NULL) rx += bytes;
+	}
+}
+
+// Send data by DMA and wait (cnt = number of frames, bit16 = use 16-bit frames)
+void SPIx_DmaSend(SPI_t* spi, const void* buf, int cnt, Bool bit16)
+{
+	SPIx_DmaRun(spi, (const u8*)buf, NULL, cnt, 0, bit16);
+}
+
+// Send repeated constant by DMA and wait (cnt = number of frames, bit16 = use 16-bit frames)
+void SPIx_DmaFill(SPI_t* spi, u16 val, int cnt, Bool bit16)
+{
+	SPIx_DmaRun(spi, NULL, NULL, cnt, val, bit16);
+}
+
+#if SPIDMA_RX		// 1=use RX DMA channel to receive data
+// Receive data by DMA while sending constant 'fill' (e.g. 0xff) and wait
+void SPIx_DmaRecv(SPI_t* spi, void* buf, int cnt, u16 fill, Bool bit16)
+{
+	SPIx_DmaRun(spi, NULL, (u8*)buf, cnt, fill, bit16);
+}
+
+// Transfer data in full-duplex mode by DMA and wait
+void SPIx_DmaXfer(SPI_t* spi, const void* tx, void* rx, int cnt, Bool bit16)
+{
+	SPIx_DmaRun(spi, (const u8*)tx, (u8*)rx, cnt, 0, bit16);
+}
+#endif
+
+#endif // USE_SPIDMA
+
 #endif // USE_SPI
@@ -343,6 +343,74 @@ INLINE void SPIx_HSDisable(SPI_t* spi) { spi->HSCR = 0; }
 INLINE void SPI1_HSDisable(void) { SPIx_HSDisable(SPI1); }
 INLINE void SPI2_HSDisable(void) { SPIx_HSDisable(SPI2); }
 
+// === DMA transfer
+
+#if USE_SPIDMA		// 1=use SPI DMA transfer (requires USE_DMA)
+
+#ifndef SPIDMA_SPI2
+#define SPIDMA_SPI2	0		// 1=use DMA transfer also on SPI2 with SPIx_Dma* functions (DMA channels 4 and 5)
+#endif
+
+// SPI DMA descriptor flags
+#define SPIDMA_16BIT	B0		// 16-bit frames (default 8-bit frames)
+
+#ifndef SPIDMA_RX
+#define SPIDMA_RX	1		// 1=use RX DMA channel to receive data (0=transmit only, descriptors must have rx = NULL)
+#endif
+
+struct sSpiDma_;
+
+// SPI DMA completion callback (called from the interrupt with first descriptor of the chain)
+typedef void (*pSpiDmaCb)(struct sSpiDma_* d);
+
+// SPI DMA descriptor (owned by the caller, must exist until the transfer is done)
+typedef struct sSpiDma_ {
+	struct sSpiDma_* next;		// next descriptor of the chain (NULL = last descriptor)
+	const void*	tx;		// data to send (NULL = repeat constant 'fill')
+	void*		rx;		// buffer to receive data (NULL = received data are discarded)
+	u16		cnt;		// number of frames (0 = skip descriptor)
+	u16		fill;		// constant frame to send if tx = NULL
+	u8		flags;		// flags SPIDMA_*
+} sSpiDma;
+
+// Start DMA transfer of chain of descriptors (waits for end of previous transfer; cb = callback or NULL)
+//  SPI must be initialized in master mode. Frame size is switched by descriptor flags and restored
+//  on end of transfer. Descriptors without receive buffer do not use RX DMA channel, so they can
+//  be used in 1-line transmit mode. RX DMA channel is touched only while it is armed by
+//  a descriptor with receive buffer, so another user of the channel is not disturbed by TX-only
+//  transfers. SPI1 uses DMA channels 2 (RX) and 3 (TX), end of descriptor
+//  is signaled by interrupt of TX channel, which waits for transmission of the last frame.
+void SPIx_DmaStart(SPI_t* spi, sSpiDma* d, pSpiDmaCb cb);
+INLINE void SPI1_DmaStart(sSpiDma* d, pSpiDmaCb cb) { SPIx_DmaStart(SPI1, d, cb); }
+
+// Check if DMA transfer is running
+Bool SPIx_DmaBusy(SPI_t* spi);
+INLINE Bool SPI1_DmaBusy(void) { return SPIx_DmaBusy(SPI1); }
+
+// Wait for end of DMA transfer
+void SPIx_DmaWait(SPI_t* spi);
+INLINE void SPI1_DmaWait(void) { SPIx_DmaWait(SPI1); }
+
+// Send data by DMA and wait (cnt = number of frames, bit16 = use 16-bit frames)
+void SPIx_DmaSend(SPI_t* spi, const void* buf, int cnt, Bool bit16);
+INLINE void SPI1_DmaSend(const void* buf, int cnt, Bool bit16) { SPIx_DmaSend(SPI1, buf, cnt, bit16); }
+
+// Send repeated constant by DMA and wait (cnt = number of frames, bit16 = use 16-bit frames)
+void SPIx_DmaFill(SPI_t* spi, u16 val, int cnt, Bool bit16);
+INLINE void SPI1_DmaFill(u16 val, int cnt, Bool bit16) { SPIx_DmaFill(SPI1, val, cnt, bit16); }
+
+#if SPIDMA_RX		// 1=use RX DMA channel to receive data
+// Receive data by DMA while sending constant 'fill' (e.g. 0xff) and wait
+void SPIx_DmaRecv(SPI_t* spi, void* buf, int cnt, u16 fill, Bool bit16);
+INLINE void SPI1_DmaRecv(void* buf, int cnt, u16 fill, Bool bit16) { SPIx_DmaRecv(SPI1, buf, cnt, fill, bit16); }
+
+// Transfer data in full-duplex mode by DMA and wait
+void SPIx_DmaXfer(SPI_t* spi, const void* tx, void* rx, int cnt, Bool bit16);
+INLINE void SPI1_DmaXfer(const void* tx, void* rx, int cnt, Bool bit16) { SPIx_DmaXfer(SPI1, tx, rx, cnt, bit16); }
+#endif
+
+#endif // USE_SPIDMA
+
 #ifdef __cplusplus
 }
 #endif
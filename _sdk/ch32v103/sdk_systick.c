@@ -29,6 +29,7 @@ HANDLER void SysTick_Handler()
 	u32 sys = SysTime;
 	u16 ms = CurTimeMs;
 	u64 old = SysTick_OldCnt;
+	u32 n = 0;
 
 	// increase time
 	int dif = (int)(cnt - old);
@@ -37,6 +38,7 @@ HANDLER void SysTick_Handler()
 		dif -= SYSTICK_HCLK;
 		old += SYSTICK_HCLK;
 		sys += SYSTICK_MS;
+		n++;
 		ms += SYSTICK_MS;
 		if (ms >= 1000)
 		{
@@ -54,6 +56,11 @@ HANDLER void SysTick_Handler()
 	cnt += SYSTICK_HCLK - dif;
 	if (dif >= SYSTICK_HCLK - 100*HCLK_PER_US) cnt += SYSTICK_HCLK;
 	SysTick_SetCmp(cnt);
+
+#if USE_SWTIMER		// 1=use software timers
+	// timer wheel with keyboard and sound scan, once per time step
+	for (; n > 0; n--) TimerTick();
+#endif
 }
 #endif // SYSTICK_MS > 0
 
@@ -65,6 +72,9 @@ void SysTick_Init(void)
 	SysTick_SetCmp(HCLK_PER_MS/2-1); // set next compare value
 	SysTick_OldCnt = 0;	// update current counter
 	SysTick_Enable();	// enable counter
+#if USE_SWTIMER		// 1=use software timers
+	TimerInit();		// initialize timer wheel
+#endif
 #if SYSTICK_MS > 0 // 0=do not use SysTick interrupt
 	NVIC_IRQEnable(IRQ_SYSTICK); // IRQ enable
 #endif
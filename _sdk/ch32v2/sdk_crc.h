@@ -0,0 +1,50 @@
+// ****************************************************************************
+//
+//                             CRC calculation unit
+//
+// ****************************************************************************
+// The unit calculates CRC-32 Normal (polynomial 0x04C11DB7) of 32-bit words,
+// MSB first. Reset sets the data register to 0xFFFFFFFF, the initial value cannot
+// be set. Writing a word to the data register performs crc = CRC(crc ^ data),
+// reading the data register returns current CRC. Enable the clock of the unit
+// with RCC_CRCClkEnable() before use.
+
+#if USE_CRC_HW		// 1=use hardware CRC unit for CRC-32 (CH32V2, CH32V3)
+
+#ifndef _SDK_CRC_H
+#define _SDK_CRC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// CRC calculation unit 0x40023000
+typedef struct {
+	io32	DATAR;		// 0x00: data register
+	io8	IDATAR;		// 0x04: independent data register (8-bit general purpose register)
+	io8	res[3];		// 0x05: reserved
+	io32	CTLR;		// 0x08: control register
+} CRC_t;
+STATIC_ASSERT(sizeof(CRC_t) == 0x0C, "Incorrect CRC_t!");
+#define CRC	((CRC_t*)CRC_BASE)
+
+// reset CRC unit - set data register to 0xFFFFFFFF (register CTLR.RESET)
+INLINE void CRC_Reset(void) { CRC->CTLR = B0; }
+
+// write 32-bit data word into CRC unit
+INLINE void CRC_Write(u32 data) { CRC->DATAR = data; }
+
+// read current CRC value
+INLINE u32 CRC_Read(void) { return CRC->DATAR; }
+
+// write/read independent 8-bit data register
+INLINE void CRC_SetIData(u8 data) { CRC->IDATAR = data; }
+INLINE u8 CRC_IData(void) { return CRC->IDATAR; }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _SDK_CRC_H
+
+#endif // USE_CRC_HW
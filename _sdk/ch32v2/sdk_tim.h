@@ -558,7 +558,7 @@ INLINE void TIM9_CCDMAOnComp(void) { TIMx_CCDMAOnComp(TIM9); }
 INLINE void TIM10_CCDMAOnComp(void) { TIMx_CCDMAOnComp(TIM10); }
 
 // Select master to slave synchronization mode TIM_MSSYNC_* (select trigger output signal; default reset; register CTLR2.MMS[2:0])
-INLINE void TIMx_MSSync(TIM_t* tim, int sync) { tim->CTLR2 = (tim->CTLR1 & ~(7<<4)) | (sync<<4); }
+INLINE void TIMx_MSSync(TIM_t* tim, int sync) { tim->CTLR2 = (tim->CTLR2 & ~(7<<4)) | (sync<<4); }
 INLINE void TIM1_MSSync(int sync) { TIMx_MSSync(TIM1, sync); }
 INLINE void TIM2_MSSync(int sync) { TIMx_MSSync(TIM2, sync); }
 INLINE void TIM3_MSSync(int sync) { TIMx_MSSync(TIM3, sync); }
@@ -0,0 +1,420 @@
+// ****************************************************************************
+//
+//                     Host emulation of the SDK (Linux)
+//
+// ****************************************************************************
+
+#include "../../includes.h"	// globals
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+// system time counter, counts time from system start in [ms]
+volatile u32 SysTime = 0;
+volatile u32 UnixTime = 0;	// current date and time in Unix format
+volatile u16 CurTimeMs = 0;	// current time in [ms] 0..999
+
+u64 HostClk = 0;		// emulated HCLK clock counter
+volatile u64 HostKeys = 0;	// currently pressed keys by the script (bit = key code)
+
+#if SYSTICK_MS > 0
+u64 HostSysTickNext = SYSTICK_HCLK; // time of next SysTick interrupt
+#endif
+Bool HostInTick = False;	// inside emulated interrupt
+
+// key script
+#define HOSTKEY_RELEASE	0	// release key
+#define HOSTKEY_PRESS	1	// press key
+#define HOSTKEY_QUIT	2	// quit program
+
+typedef struct {
+	u32	time;		// time in [ms]
+	u8	key;		// key code
+	u8	cmd;		// command HOSTKEY_*
+} sHostKeyEvent;
+
+sHostKeyEvent* HostKeyEvents = NULL; // key events, sorted by time
+int HostKeyEventNum = 0;	// number of key events
+int HostKeyEventInx = 0;	// index of next key event
+
+// options
+const char* HostOutDir = NULL;	// output directory of frames (NULL = do not save)
+const char* HostGoldDir = NULL;	// directory with golden frames (NULL = do not compare)
+u32 HostTimeMax = 60000;	// stop after time in [ms]
+u32 HostFrameMax = 0;		// stop after number of frames (0 = no limit)
+Bool HostAllFrames = False;	// save all frames, not only changed
+Bool HostSoundLog = False;	// print played tones
+Bool HostQuiet = False;		// do not print summary
+
+// frames
+u8* HostPpm = NULL;		// current frame in PPM format (header + RGB data)
+u8* HostPpmOld = NULL;		// previous saved frame
+int HostPpmHead = 0;		// size of PPM header
+int HostPpmSize = 0;		// total size of PPM image
+u32 HostFrameNum = 0;		// number of displayed frames
+u32 HostFrameOut = 0;		// number of saved frames
+u32 HostFrameBad = 0;		// number of frames different from golden frames
+Bool HostExited = False;	// summary already printed
+
+// print summary and check golden frames (returns exit code)
+static int HostSummary(int code)
+{
+	if (HostExited) return code;
+	HostExited = True;
+
+	// golden directory must not have more frames
+	if (HostGoldDir != NULL)
+	{
+		char path[1024];
+		snprintf(path, sizeof(path), "%s/frame%05u.ppm", HostGoldDir, HostFrameOut);
+		if (access(path, F_OK) == 0)
+		{
+			printf("golden frame %s was not displayed\n", path);
+			HostFrameBad++;
+		}
+		if (HostFrameBad > 0) code = 1;
+	}
+
+	if (!HostQuiet)
+	{
+		printf("time %u ms, frames %u, saved %u", (u32)(HostClk/HCLK_PER_MS), HostFrameNum, HostFrameOut);
+		if (HostGoldDir != NULL) printf(", golden mismatch %u", HostFrameBad);
+		printf(", host CPU %.3f s\n", (double)clock()/CLOCKS_PER_SEC);
+	}
+	fflush(stdout);
+	return code;
+}
+
+// stop emulation and terminate the program
+void HostExit(int code)
+{
+	exit(HostSummary(code));
+}
+
+// program returned from main()
+static void HostAtExit(void)
+{
+	if (!HostExited && (HostSummary(0) != 0)) _exit(1);
+}
+
+// process key script up to current time
+static void HostKeyScript(void)
+{
+	u32 ms = (u32)(HostClk / HCLK_PER_MS);
+	while ((HostKeyEventInx < HostKeyEventNum) && (HostKeyEvents[HostKeyEventInx].time <= ms))
+	{
+		sHostKeyEvent* e = &HostKeyEvents[HostKeyEventInx++];
+		if (e->cmd == HOSTKEY_QUIT)
+			HostExit(0);
+		else if (e->cmd == HOSTKEY_PRESS)
+			HostKeys |= BIT64(e->key);
+		else
+			HostKeys &= ~BIT64(e->key);
+	}
+}
+
+// advance emulated time by number of HCLK clock cycles (calls emulated interrupts and devices)
+void HostTick(u32 clk)
+{
+	// inside emulated interrupt, only count time
+	if (HostInTick)
+	{
+		HostClk += clk;
+		return;
+	}
+	HostInTick = True;
+
+	while (clk > 0)
+	{
+		// time step, max. 1 ms
+		u32 step = clk;
+		if (step > HCLK_PER_MS) step = HCLK_PER_MS;
+		clk -= step;
+		HostClk += step;
+
+		// key script
+		HostKeyScript();
+
+#if SYSTICK_MS > 0
+		// SysTick interrupt
+		while (HostClk >= HostSysTickNext)
+		{
+			HostSysTickNext += SYSTICK_HCLK;
+			SysTime += SYSTICK_MS;
+			u16 ms = CurTimeMs + SYSTICK_MS;
+			if (ms >= 1000)
+			{
+				UnixTime++;
+				ms -= 1000;
+			}
+			CurTimeMs = ms;
+
+#if USE_SWTIMER		// 1=use software timers
+			// timer wheel with keyboard and sound scan
+			TimerTick();
+#else
+#if SYSTICK_KEYSCAN	// call KeyScan() function from SysTick system timer
+			KeyScan();
+#endif
+
+#if SYSTICK_SOUNDSCAN	// 1=call SoundScan() function fron SysTick system timer
+			SoundScan();
+#endif
+#endif
+		}
+#endif // SYSTICK_MS > 0
+
+		// device service
+		HostDevTime();
+
+		// time limit
+		if (HostClk >= (u64)HostTimeMax*HCLK_PER_MS) HostExit(0);
+	}
+
+	HostInTick = False;
+}
+
+// give time to emulated interrupts in a polling loop
+void HostPoll(void)
+{
+	HostTick(HOST_POLL_CLK);
+}
+
+// get current time in HCLK clock cycles (emulated SysTick counter)
+u32 Time(void)
+{
+	HostTick(HOST_TIME_CLK);
+	return (u32)HostClk;
+}
+
+// Wait for delay in CPU clock cycles
+void WaitClk(u32 clk)
+{
+	HostTick(clk);
+}
+
+// Wait for delay in [us]
+void WaitUs(u32 us)
+{
+	HostTick(us*HCLK_PER_US);
+}
+
+// Wait for delay in [ms]
+void WaitMs(u32 ms)
+{
+	while (ms > 0)
+	{
+		HostTick(HCLK_PER_MS);
+		ms--;
+	}
+}
+
+// software reset - terminates the host program
+void ResetCPU(void)
+{
+	HostExit(0);
+}
+
+// exit application and reset to boot loader - terminates the host program
+void ResetToBootLoader(void)
+{
+	HostExit(0);
+}
+
+// display new frame (called by the device on display update or on new VGA frame)
+void HostFrame(void)
+{
+	HostFrameNum++;
+
+	// render frame
+	HostRender(HostPpm + HostPpmHead);
+
+	// skip unchanged frame
+	if (!HostAllFrames && (HostFrameOut > 0) && (memcmp(HostPpm, HostPpmOld, HostPpmSize) == 0)) return;
+	memcpy(HostPpmOld, HostPpm, HostPpmSize);
+
+	char path[1024];
+	FILE* f;
+
+	// save frame
+	if (HostOutDir != NULL)
+	{
+		snprintf(path, sizeof(path), "%s/frame%05u.ppm", HostOutDir, HostFrameOut);
+		f = fopen(path, "wb");
+		if ((f == NULL) || (fwrite(HostPpm, 1, HostPpmSize, f) != (size_t)HostPpmSize))
+		{
+			printf("cannot write %s\n", path);
+			HostExit(2);
+		}
+		fclose(f);
+	}
+
+	// compare with golden frame
+	if (HostGoldDir != NULL)
+	{
+		snprintf(path, sizeof(path), "%s/frame%05u.ppm", HostGoldDir, HostFrameOut);
+		Bool ok = False;
+		f = fopen(path, "rb");
+		if (f != NULL)
+		{
+			u8* buf = (u8*)malloc(HostPpmSize + 1);
+			ok = (fread(buf, 1, HostPpmSize + 1, f) == (size_t)HostPpmSize) &&
+				(memcmp(buf, HostPpm, HostPpmSize) == 0);
+			free(buf);
+			fclose(f);
+		}
+		if (!ok)
+		{
+			printf("frame %05u at %u ms differs from golden frame %s\n",
+				HostFrameOut, (u32)(HostClk/HCLK_PER_MS), path);
+			HostFrameBad++;
+		}
+	}
+
+	HostFrameOut++;
+
+	// frame limit
+	if ((HostFrameMax > 0) && (HostFrameOut >= HostFrameMax)) HostExit(0);
+}
+
+// play tone (called by the device; frequency in 0.01 Hz, 0 = stop sound)
+void HostSound(u32 hz01)
+{
+	if (HostSoundLog)
+	{
+		if (hz01 == 0)
+			printf("%8u ms: sound off\n", (u32)(HostClk/HCLK_PER_MS));
+		else
+			printf("%8u ms: tone %u.%02u Hz\n", (u32)(HostClk/HCLK_PER_MS), hz01/100, hz01%100);
+	}
+}
+
+// find key by name (returns 0 if not found)
+static int HostKeyFind(const char* name)
+{
+	int i;
+	for (i = 1; HostKeyName[i] != NULL; i++)
+	{
+		if (strcasecmp(name, HostKeyName[i]) == 0) return i;
+	}
+	return 0;
+}
+
+// add key event
+static void HostKeyAdd(u32 time, u8 key, u8 cmd)
+{
+	HostKeyEvents = (sHostKeyEvent*)realloc(HostKeyEvents, (HostKeyEventNum+1)*sizeof(sHostKeyEvent));
+
+	// insert sorted by time, keep order of events with the same time
+	int i = HostKeyEventNum++;
+	while ((i > 0) && (HostKeyEvents[i-1].time > time))
+	{
+		HostKeyEvents[i] = HostKeyEvents[i-1];
+		i--;
+	}
+	HostKeyEvents[i].time = time;
+	HostKeyEvents[i].key = key;
+	HostKeyEvents[i].cmd = cmd;
+}
+
+// load key script
+static void HostKeyLoad(const char* filename)
+{
+	FILE* f = fopen(filename, "r");
+	if (f == NULL)
+	{
+		printf("cannot open key script %s\n", filename);
+		exit(2);
+	}
+
+	char line[256];
+	int n = 0;
+	while (fgets(line, sizeof(line), f) != NULL)
+	{
+		n++;
+		char* c = strchr(line, '#');
+		if (c != NULL) *c = 0;
+
+		unsigned int time, hold = 100;
+		char name[32];
+		int k = sscanf(line, "%u %31s %u", &time, name, &hold);
+		if (k <= 0) continue;
+		if (k == 1)
+		{
+			printf("%s:%d: missing key name\n", filename, n);
+			exit(2);
+		}
+
+		if (strcasecmp(name, "QUIT") == 0)
+		{
+			HostKeyAdd(time, 0, HOSTKEY_QUIT);
+			continue;
+		}
+
+		int key = HostKeyFind(name);
+		if (key == 0)
+		{
+			printf("%s:%d: unknown key %s, valid keys are:", filename, n, name);
+			for (key = 1; HostKeyName[key] != NULL; key++) printf(" %s", HostKeyName[key]);
+			printf("\n");
+			exit(2);
+		}
+		HostKeyAdd(time, (u8)key, HOSTKEY_PRESS);
+		HostKeyAdd(time + hold, (u8)key, HOSTKEY_RELEASE);
+	}
+	fclose(f);
+}
+
+// start of host program, called before main() (glibc passes program arguments to constructors)
+__attribute__((constructor)) static void HostStart(int argc, char* argv[])
+{
+	int i;
+	for (i = 1; i < argc; i++)
+	{
+		const char* a = argv[i];
+		if ((a[0] != '-') || (a[1] == 0) || (a[2] != 0)) goto help;
+		switch (a[1])
+		{
+		case 'a': HostAllFrames = True; continue;
+		case 's': HostSoundLog = True; continue;
+		case 'q': HostQuiet = True; continue;
+		}
+
+		if (i+1 >= argc) goto help;
+		const char* p = argv[++i];
+		switch (a[1])
+		{
+		case 'k': HostKeyLoad(p); break;
+		case 'o': HostOutDir = p; break;
+		case 'g': HostGoldDir = p; break;
+		case 't': HostTimeMax = (u32)strtoul(p, NULL, 0); break;
+		case 'f': HostFrameMax = (u32)strtoul(p, NULL, 0); break;
+		default: goto help;
+		}
+	}
+
+	// prepare frame buffers
+	char head[32];
+	HostPpmHead = snprintf(head, sizeof(head), "P6\n%d %d\n255\n", HostDispW, HostDispH);
+	HostPpmSize = HostPpmHead + HostDispW*HostDispH*3;
+	HostPpm = (u8*)malloc(HostPpmSize);
+	HostPpmOld = (u8*)malloc(HostPpmSize);
+	memcpy(HostPpm, head, HostPpmHead);
+
+	atexit(HostAtExit);
+
+#if USE_SWTIMER		// 1=use software timers
+	// initialize timer wheel (instead of SysTick_Init)
+	TimerInit();
+#endif
+
+	// initialize device
+	DevInit();
+	return;
+
+help:
+	printf("usage: %s [-k keyscript] [-o outdir] [-g goldendir] [-t ms] [-f frames] [-a] [-s] [-q]\n", argv[0]);
+	exit(2);
+}
@@ -0,0 +1,181 @@
+// ****************************************************************************
+//
+//                     Host emulation of the SDK (Linux)
+//
+// ****************************************************************************
+// Compiled instead of the MCU SDK when USE_HOST=1 (project command "make host").
+// The program runs natively on PC, with emulated time and with emulated devices:
+//  - Time is virtual, in HCLK clock cycles. It advances by waiting functions and
+//    by polling (Time(), KeyGet(), HOST_POLL()), so every run is reproducible.
+//  - SysTick interrupt (KeyScan/SoundScan) and display frames are called on time.
+//  - Keys are replayed from a script file, displayed frames are saved as PPM images
+//    and can be compared with golden images (regression test).
+//
+// Command line of the compiled program (Project_host):
+//   -k file ... key script; one event per line "time_ms key [hold_ms]"
+//               (key = name of the button, e.g. A or LEFT; default hold 100 ms),
+//               or "time_ms QUIT" to stop the program; '#' starts a comment
+//   -o dir .... save frames to directory as "frame00000.ppm", "frame00001.ppm", ...
+//   -g dir .... compare frames with golden images in the directory (exit code 1 on mismatch)
+//   -t ms ..... stop after virtual time in [ms] (default 60000)
+//   -f num .... stop after number of frames
+//   -a ........ save all frames (default only changed frames)
+//   -s ........ print played tones
+//   -q ........ quiet, do not print summary
+
+#ifndef _SDK_HOST_H
+#define _SDK_HOST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// number of HCLK clock cycles per 1 us
+#ifndef HCLK_PER_US
+#define HCLK_PER_US	48
+#endif
+
+// number of HCLK clock cycles per 1 ms
+#ifndef HCLK_PER_MS
+#define HCLK_PER_MS	(HCLK_PER_US*1000)
+#endif
+
+// increment of system time in [ms] on SysTick interrupt (0=do not use SysTick interrupt)
+#ifndef SYSTICK_MS
+#define SYSTICK_MS	16
+#endif
+
+// number of HCLK clock cycles per SysTick interrupt
+#ifndef SYSTICK_HCLK
+#define SYSTICK_HCLK	(SYSTICK_MS*HCLK_PER_MS)
+#endif
+
+// emulated time spent by one call of Time() and by one polling HOST_POLL(), in HCLK clock cycles
+#define HOST_TIME_CLK	(HCLK_PER_US/2 + 1)
+#define HOST_POLL_CLK	(HCLK_PER_US*10)
+
+// ----------------------------------------------------------------------------
+//                          Emulated CPU and time
+// ----------------------------------------------------------------------------
+
+// system time counter, counts time from system start in [ms]
+extern volatile u32 SysTime;
+extern volatile u32 UnixTime;	// current date and time in Unix format
+extern volatile u16 CurTimeMs;	// current time in [ms] 0..999
+
+// emulated HCLK clock counter
+extern u64 HostClk;
+
+// compiler barrier
+INLINE void cb(void) { __asm volatile ("" ::: "memory"); }
+INLINE void isb(void) { cb(); }
+INLINE void dmb(void) { cb(); }
+INLINE void dsb(void) { cb(); }
+INLINE void nop(void) { cb(); }
+INLINE void nop2(void) { cb(); }
+
+// interrupts (emulated interrupts are called synchronously, so there is nothing to lock)
+INLINE void di(void) { cb(); }
+INLINE void ei(void) { cb(); }
+INLINE Bool geti(void) { return True; }
+INLINE void seti(Bool enable) { (void)enable; cb(); }
+INLINE Bool LockIRQ(void) { cb(); return True; }
+INLINE void UnlockIRQ(Bool state) { (void)state; cb(); }
+
+// wait for interrupt - pass time to the next emulated event
+INLINE void wfi(void) { HostPoll(); }
+INLINE void wfe(void) { HostPoll(); }
+
+// bit operations
+INLINE u32 Endian(u32 val) { return __builtin_bswap32(val); }
+INLINE u16 Swap(u16 val) { return __builtin_bswap16(val); }
+INLINE u32 Swap2(u32 val) { return __builtin_bswap16((u16)val) | ((u32)__builtin_bswap16((u16)(val >> 16)) << 16); }
+INLINE u32 Ror(u32 val, u8 num) { num &= 0x1f; return (val >> num) | (val << ((32 - num) & 0x1f)); }
+INLINE u32 Rol(u32 val, u8 num) { num &= 0x1f; return (val << num) | (val >> ((32 - num) & 0x1f)); }
+INLINE u8 Reverse8(u8 val)
+{
+	val = (u8)((val >> 4) | (val << 4));
+	val = (u8)(((val >> 2) & 0x33) | ((val & 0x33) << 2));
+	return (u8)(((val >> 1) & 0x55) | ((val & 0x55) << 1));
+}
+INLINE u16 Reverse16(u16 val) { return (u16)((Reverse8((u8)val) << 8) | Reverse8((u8)(val >> 8))); }
+INLINE u32 Reverse32(u32 val) { return ((u32)Reverse16((u16)val) << 16) | Reverse16((u16)(val >> 16)); }
+INLINE u32 reverse(u32 val) { return Reverse32(val); }
+INLINE u64 Reverse64(u64 val) { return ((u64)Reverse32((u32)val) << 32) | Reverse32((u32)(val >> 32)); }
+INLINE u32 Clz(u32 val) { return (val == 0) ? 32 : __builtin_clz(val); }
+INLINE u32 clz(u32 val) { return Clz(val); }
+INLINE u32 Clz64(u64 num) { return (num >= 0x100000000ULL) ? Clz((u32)(num >> 32)) : (Clz((u32)num) + 32); }
+INLINE u32 Ctz(u32 val) { return (val == 0) ? 32 : __builtin_ctz(val); }
+INLINE u32 ctz(u32 val) { return Ctz(val); }
+INLINE u32 Popcount(u32 val) { return __builtin_popcount(val); }
+INLINE u32 popcount(u32 val) { return Popcount(val); }
+INLINE u32 Order8(u8 val) { return 32 - Clz((u32)(u8)val); }
+INLINE u32 Order(u32 val) { return 32 - Clz(val); }
+INLINE u32 Mask(u32 val) { return ((u32)-1) >> Clz(val); }
+INLINE u32 RangeMask(int first, int last) { return (~(((u32)-1) << (last+1))) & (((u32)-1) << first); }
+INLINE Bool IsPow2(u32 a) { return ((a & (a-1)) == 0); }
+
+// advance emulated time by number of HCLK clock cycles (calls emulated interrupts and devices)
+void HostTick(u32 clk);
+
+// give time to emulated interrupts in a polling loop
+void HostPoll(void);
+
+// get current time in HCLK clock cycles (emulated SysTick counter)
+u32 Time(void);
+
+// request SysTick interrupt to restart time steps (emulated SysTick runs all the time)
+INLINE void SysTick_Wake(void) {}
+
+// update SysTime from the counter and return it (emulated SysTick updates it all the time)
+INLINE u32 SysTick_Sync(void) { return SysTime; }
+
+// Wait for delay in CPU clock cycles
+void WaitClk(u32 clk);
+
+// Wait for delay in [us]
+void WaitUs(u32 us);
+
+// Wait for delay in [ms]
+void WaitMs(u32 ms);
+
+// software reset - terminates the host program
+void ResetCPU(void);
+
+// exit application and reset to boot loader - terminates the host program
+void ResetToBootLoader(void);
+
+// ----------------------------------------------------------------------------
+//                 Interface to the device emulation (_devices/*/*_host.c)
+// ----------------------------------------------------------------------------
+
+// size of the display image in pixels (defined by the device)
+extern const int HostDispW;
+extern const int HostDispH;
+
+// render current display image to RGB buffer, 3 bytes per pixel (defined by the device)
+void HostRender(u8* rgb);
+
+// names of the keys, index = key code, terminated with NULL (defined by the device)
+extern const char* const HostKeyName[];
+
+// device time service, called after every time advance (defined by the device)
+void HostDevTime(void);
+
+// currently pressed keys by the script (bit = key code)
+extern volatile u64 HostKeys;
+
+// display new frame (called by the device on display update or on new VGA frame)
+void HostFrame(void);
+
+// play tone (called by the device; frequency in 0.01 Hz, 0 = stop sound)
+void HostSound(u32 hz01);
+
+// stop emulation and terminate the program
+void HostExit(int code);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _SDK_HOST_H
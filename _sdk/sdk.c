@@ -14,6 +14,9 @@
 #define STRINGIFYC(x) STRINGIFYC_HELPER(x)
 #define INCLUDEC_SDK_FILE(file) STRINGIFYC(SDK_SUBDIR/file)
 
+#if USE_HOST
+#include "host/sdk_host.c"		// host emulation (instead of MCU SDK)
+#else
 #include INCLUDEC_SDK_FILE(sdk_adc.c)		// ADC
 #include INCLUDEC_SDK_FILE(sdk_cpu.c)		// CPU control
 #include INCLUDEC_SDK_FILE(sdk_dma.c)		// DMA
@@ -28,3 +31,13 @@
 #include INCLUDEC_SDK_FILE(sdk_systick.c)	// SysTick system counter
 #include INCLUDEC_SDK_FILE(sdk_tim.c)		// TIM
 #include INCLUDEC_SDK_FILE(sdk_usart.c)		// USART
+#endif
+
+#include "sdk_swtimer.c"			// software timers (timer wheel)
+#include "sdk_task.c"			// cooperative task scheduler
+#include "sdk_dmaq.c"			// asynchronous DMA memory copy and fill
+#include "sdk_prof.c"			// sampling PC profiler
+#include "sdk_usartbuf.c"		// buffered USART driver
+#include "sdk_i2cq.c"			// interrupt driven I2C master with transaction queue
+#include "sdk_adcscan.c"		// continuous ADC scanning with DMA
+#include "sdk_rccspeed.c"		// run-time change of system clock
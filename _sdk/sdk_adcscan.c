@@ -0,0 +1,170 @@
+// ****************************************************************************
+//
+//               Continuous ADC scanning with DMA and oversampling
+//
+// ****************************************************************************
+
+#include "../includes.h"	// globals
+
+#if USE_ADCSCAN		// 1=use continuous ADC scanning with DMA (requires USE_ADC and USE_DMA)
+
+// DMA buffer with 2 halves of ADCSCAN_OVER scans
+u16 AdcScanBuf[2*ADCSCAN_OVER*ADCSCAN_MAX];
+
+// sums of ADCSCAN_OVER samples of the channels (updated by the DMA interrupt)
+volatile u16 AdcScanVal[ADCSCAN_MAX];
+
+// counter of updates of the results
+volatile u32 AdcScanCnt = 0;
+
+// number of channels in the scan list
+u8 AdcScanNum = 0;
+
+#if USE_HOST
+
+// start continuous scanning of channels from the list (num = 1..ADCSCAN_MAX, hz = scans per second)
+void AdcScanInit(const u8* chan, int num, int hz)
+{
+	AdcScanNum = (u8)num;
+	memset((void*)AdcScanVal, 0, sizeof(AdcScanVal));
+}
+
+// stop continuous scanning
+void AdcScanTerm(void) {}
+
+// wait for next update of the results
+void AdcScanWait(void) { AdcScanCnt++; }
+
+#else // USE_HOST
+
+#if !USE_ADC || !USE_DMA
+#error "ADC scanning (USE_ADCSCAN) requires USE_ADC and USE_DMA"
+#endif
+
+#if !CH32V0
+#error "ADC scanning (USE_ADCSCAN) is supported only on CH32V0 family"
+#endif
+
+#if USE_DMAQ && (DMAQ_CHAN == 1)
+#error "ADC scanning (USE_ADCSCAN) needs DMA channel 1"
+#endif
+
+#if (ADCSCAN_MAX < 1) || (ADCSCAN_MAX > 16) || (ADCSCAN_OVER > 16) || ((ADCSCAN_OVER & (ADCSCAN_OVER-1)) != 0)
+#error "Invalid ADCSCAN_MAX or ADCSCAN_OVER"
+#endif
+
+#if ADCSCAN_TIM == 1
+#define ADCSCAN_TIMER	TIM1			// trigger timer
+#define ADCSCAN_EXT	ADC_EXT_T1_TRGO		// ADC trigger
+#else
+#define ADCSCAN_TIMER	TIM2			// trigger timer
+#define ADCSCAN_EXT	ADC_EXT_T2_TRGO		// ADC trigger
+#endif
+
+#define ADCSCAN_DMA	1			// DMA channel of ADC1
+
+// DMA interrupt - half or whole buffer is filled
+HANDLER void DMA1_Channel1_IRQHandler()
+{
+	// select finished half of the buffer
+	const u16* s = AdcScanBuf;
+	if (DMA1_Comp(ADCSCAN_DMA))
+	{
+		DMA1_CompClr(ADCSCAN_DMA);
+		s += ADCSCAN_OVER*AdcScanNum;
+	}
+	DMA1_HalfClr(ADCSCAN_DMA);
+
+	// accumulate samples of the channels
+	int num = AdcScanNum;
+	int i, j;
+	for (i = 0; i < num; i++)
+	{
+		const u16* s2 = &s[i];
+		u16 sum = 0;
+		for (j = ADCSCAN_OVER; j > 0; j--)
+		{
+			sum += *s2;
+			s2 += num;
+		}
+		AdcScanVal[i] = sum;
+	}
+	AdcScanCnt++;
+}
+
+// start continuous scanning of channels from the list (num = 1..ADCSCAN_MAX, hz = scans per second)
+void AdcScanInit(const u8* chan, int num, int hz)
+{
+	int i;
+	if (num < 1) num = 1;
+	if (num > ADCSCAN_MAX) num = ADCSCAN_MAX;
+	AdcScanNum = (u8)num;
+	memset((void*)AdcScanVal, 0, sizeof(AdcScanVal));
+
+	// initialize ADC (resets ADC module and wakes it up)
+	ADC1_InitSingle();
+
+	// scan list of the channels
+	ADC1_RNum(num);
+	for (i = 0; i < num; i++)
+	{
+		ADC1_RSeq(i+1, chan[i]);
+		ADC1_SampTime(chan[i], ADCSCAN_SAMP);
+	}
+
+	// scan mode, one scan per trigger of the timer, results by DMA
+	ADC1_ScanEnable();
+	ADC1_Single();
+	ADC1_ExtSel(ADCSCAN_EXT);
+	ADC1_ExtTrigEnable();
+	ADC1_DMAEnable();
+
+	// DMA from ADC data register to memory, circular mode, interrupts on half and end
+	RCC_DMA1ClkEnable();
+	DMAchan_t* ch = DMA1_Chan(ADCSCAN_DMA);
+	DMA_Cfg(ch, 0);
+	DMA1_IntClr(ADCSCAN_DMA);
+	DMA_PerAddr(ch, &ADC1->RDATAR);
+	DMA_MemAddr(ch, AdcScanBuf);
+	DMA_Cnt(ch, 2*ADCSCAN_OVER*num);
+	DMA_Cfg(ch, DMA_CFG_EN | DMA_CFG_COMPINT | DMA_CFG_HALFINT | DMA_CFG_DIRFROMPER |
+		DMA_CFG_CIRC | DMA_CFG_MEMINC | DMA_CFG_PSIZE_32 | DMA_CFG_MSIZE_16 | DMA_CFG_PRIOR_HIGH);
+	NVIC_IRQEnable(IRQ_DMA1_CH1);
+
+	// trigger timer (update event as TRGO output)
+	u32 clk = HCLK_PER_US*1000000 / hz;
+	int div = clk/65536 + 1;
+	TIM_t* tim = ADCSCAN_TIMER;
+	TIMx_ClkEnable(tim);
+	TIMx_Reset(tim);
+	TIMx_InMode(tim, TIM_INMODE_INT);
+	TIMx_Div(tim, div);
+	TIMx_Load(tim, clk/div - 1);
+	TIMx_Update(tim);
+	TIMx_MSSync(tim, TIM_MSSYNC_UPDATE);
+	TIMx_Enable(tim);
+}
+
+// stop continuous scanning
+void AdcScanTerm(void)
+{
+	TIMx_Disable(ADCSCAN_TIMER);
+	TIMx_MSSync(ADCSCAN_TIMER, TIM_MSSYNC_RESET);
+	NVIC_IRQDisable(IRQ_DMA1_CH1);
+	ADC1_ExtTrigDisable();
+	ADC1_DMADisable();
+	ADC1_ScanDisable();
+	DMA_Cfg(DMA1_Chan(ADCSCAN_DMA), 0);
+	DMA1_IntClr(ADCSCAN_DMA);
+}
+
+// wait for next update of the results
+void AdcScanWait(void)
+{
+	u32 cnt = AdcScanCnt;
+	while (AdcScanCnt == cnt) {}
+}
+
+#endif // USE_HOST
+
+#endif // USE_ADCSCAN
@@ -0,0 +1,94 @@
+// ****************************************************************************
+//
+//               Continuous ADC scanning with DMA and oversampling
+//
+// ****************************************************************************
+// ADC1 converts a list of up to ADCSCAN_MAX channels in scan mode. Every scan is
+// started by the TRGO update event of the timer ADCSCAN_TIM at the rate given to
+// AdcScanInit(). DMA channel 1 stores the results in circular mode into a double
+// buffer, each half holds ADCSCAN_OVER scans. On half and complete interrupt of
+// the DMA, the samples of the finished half are accumulated per channel, so the
+// oversampled result is updated at rate hz/ADCSCAN_OVER and the application reads
+// the latest filtered value at zero cost with AdcScanGet() or AdcScanSum().
+//
+// The ADC has no hardware oversampler, the samples are accumulated in software
+// in the DMA interrupt. The sum of ADCSCAN_OVER samples gives the result with
+// extra resolution (12 + log2(ADCSCAN_OVER) bits).
+//
+// Do not use single conversions (ADC1_GetSingle) while the scan is running. The
+// application must set the channel pins to GPIO_MODE_AIN. Each scan must finish
+// before the next trigger - conversion time of one channel is sampling time
+// ADCSCAN_SAMP + 12.5 ADC clock cycles. The host build returns zero values.
+
+#if USE_ADCSCAN		// 1=use continuous ADC scanning with DMA (requires USE_ADC and USE_DMA)
+
+#ifndef _SDK_ADCSCAN_H
+#define _SDK_ADCSCAN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef ADCSCAN_MAX
+#define ADCSCAN_MAX	8		// max. number of channels in the scan list (max. 16)
+#endif
+
+#ifndef ADCSCAN_OVER
+#define ADCSCAN_OVER	16		// oversampling - number of accumulated scans (power of 2, max. 16)
+#endif
+
+#ifndef ADCSCAN_TIM
+#define ADCSCAN_TIM	2		// timer used to trigger the scan (1 or 2)
+#endif
+
+#ifndef ADCSCAN_SAMP
+#define ADCSCAN_SAMP	7		// sampling time of channels 0..7 (see ADCx_SampTime())
+#endif
+
+// shift of the sum to get 12-bit average
+#if ADCSCAN_OVER >= 16
+#define ADCSCAN_SHIFT	4
+#elif ADCSCAN_OVER >= 8
+#define ADCSCAN_SHIFT	3
+#elif ADCSCAN_OVER >= 4
+#define ADCSCAN_SHIFT	2
+#elif ADCSCAN_OVER >= 2
+#define ADCSCAN_SHIFT	1
+#else
+#define ADCSCAN_SHIFT	0
+#endif
+
+// DMA buffer with 2 halves of ADCSCAN_OVER scans
+extern u16 AdcScanBuf[2*ADCSCAN_OVER*ADCSCAN_MAX];
+
+// sums of ADCSCAN_OVER samples of the channels (updated by the DMA interrupt)
+extern volatile u16 AdcScanVal[ADCSCAN_MAX];
+
+// counter of updates of the results
+extern volatile u32 AdcScanCnt;
+
+// number of channels in the scan list
+extern u8 AdcScanNum;
+
+// start continuous scanning of channels from the list (num = 1..ADCSCAN_MAX, hz = scans per second)
+void AdcScanInit(const u8* chan, int num, int hz);
+
+// stop continuous scanning
+void AdcScanTerm(void);
+
+// get sum of ADCSCAN_OVER samples of the channel with index inx in the scan list (12 + log2(ADCSCAN_OVER) bits)
+INLINE u16 AdcScanSum(int inx) { return AdcScanVal[inx]; }
+
+// get average value of the channel with index inx in the scan list (12 bits, 0..ADC_MAXVAL)
+INLINE u16 AdcScanGet(int inx) { return AdcScanVal[inx] >> ADCSCAN_SHIFT; }
+
+// wait for next update of the results
+void AdcScanWait(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _SDK_ADCSCAN_H
+
+#endif // USE_ADCSCAN
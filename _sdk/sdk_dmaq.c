@@ -0,0 +1,228 @@
+// ****************************************************************************
+//
+//                   Asynchronous DMA memory copy and fill
+//
+// ****************************************************************************
+
+#include "../includes.h"	// globals
+
+#if USE_DMAQ		// 1=use asynchronous DMA memory copy and fill (requires USE_DMA)
+
+// queue of descriptors
+sDmaqDesc DmaqDesc[DMAQ_NUM];
+
+// number of queued operations (= ticket of next operation)
+volatile u32 DmaqPut = 0;
+
+// number of finished operations
+volatile u32 DmaqGet = 0;
+
+#if USE_HOST
+
+// initialize DMA memory queue
+void DmaqInit(void) {}
+
+// terminate DMA memory queue (waits for queued operations)
+void DmaqTerm(void) {}
+
+// copy memory (returns ticket of the operation)
+u32 DmaqCopy(void* dst, const void* src, u32 len)
+{
+	memmove(dst, src, len);
+	DmaqGet++;
+	return DmaqPut++;
+}
+
+// fill memory with byte (returns ticket of the operation)
+u32 DmaqFill(void* dst, u8 val, u32 len)
+{
+	memset(dst, val, len);
+	DmaqGet++;
+	return DmaqPut++;
+}
+
+// fill memory with 32-bit word (returns ticket of the operation)
+u32 DmaqFill32(u32* dst, u32 val, u32 cnt)
+{
+	for (; cnt > 0; cnt--) *dst++ = val;
+	DmaqGet++;
+	return DmaqPut++;
+}
+
+#else // USE_HOST
+
+#if !USE_DMA
+#error "DMA memory queue (USE_DMAQ) requires USE_DMA"
+#endif
+
+#define DMAQ_IRQ_(ch)		IRQ_DMA1_CH ## ch
+#define DMAQ_IRQ(ch)		DMAQ_IRQ_(ch)
+#define DMAQ_HANDLER_(ch)	DMA1_Channel ## ch ## _IRQHandler
+#define DMAQ_HANDLER(ch)	DMAQ_HANDLER_(ch)
+
+// max. number of transfers of one DMA run
+#define DMAQ_MAXCNT	65535
+
+// start next part of operation (called with locked interrupt or from the interrupt)
+static void DmaqStart(sDmaqDesc* d)
+{
+	DMAchan_t* chan = DMA1_Chan(DMAQ_CHAN);
+
+	// size of this part
+	u32 n = d->cnt;
+	if (n > DMAQ_MAXCNT) n = DMAQ_MAXCNT;
+	d->cnt -= n;
+
+	// setup addresses (source as peripheral address)
+	DMA_ChanDisable(chan);
+	DMA_PerAddr(chan, d->src);
+	DMA_MemAddr(chan, d->dst);
+	DMA_Cnt(chan, n);
+
+	// shift addresses to next part
+	int shift = (d->cfg >> 10) & 3;
+	d->dst += n << shift;
+	if ((d->cfg & DMA_CFG_PERINC) != 0) d->src += n << shift;
+
+	// start transfer
+	DMA1_CompClr(DMAQ_CHAN);
+	DMA_Cfg(chan, d->cfg | DMA_CFG_COMPINT | DMA_CFG_DIRFROMPER | DMA_CFG_MEMINC |
+		DMA_CFG_PRIOR_LOW | DMA_CFG_MERM2MEM | DMA_CFG_EN);
+}
+
+// DMA completion interrupt - continue with next part or next operation
+HANDLER void DMAQ_HANDLER(DMAQ_CHAN)()
+{
+	DMA1_CompClr(DMAQ_CHAN);
+	DMA_ChanDisable(DMA1_Chan(DMAQ_CHAN));
+
+	// continue with next part of current operation
+	u32 get = DmaqGet;
+	sDmaqDesc* d = &DmaqDesc[get % DMAQ_NUM];
+	if (d->cnt > 0)
+	{
+		DmaqStart(d);
+		return;
+	}
+
+	// operation is finished, start next operation
+	get++;
+	DmaqGet = get;
+	if (get != DmaqPut) DmaqStart(&DmaqDesc[get % DMAQ_NUM]);
+}
+
+// initialize DMA memory queue
+void DmaqInit(void)
+{
+	RCC_DMA1ClkEnable();
+	DMA_Cfg(DMA1_Chan(DMAQ_CHAN), 0);
+	DMA1_IntClr(DMAQ_CHAN);
+	DmaqGet = DmaqPut;
+	NVIC_IRQEnable(DMAQ_IRQ(DMAQ_CHAN));
+}
+
+// terminate DMA memory queue (waits for queued operations)
+void DmaqTerm(void)
+{
+	DmaqFence();
+	NVIC_IRQDisable(DMAQ_IRQ(DMAQ_CHAN));
+	DMA_Cfg(DMA1_Chan(DMAQ_CHAN), 0);
+	DMA1_IntClr(DMAQ_CHAN);
+}
+
+// put operation into queue (returns ticket of the operation)
+//  src ... source address, NULL = fill from 'fill'
+//  cnt ... number of transfers
+//  size ... transfer size DMA_SIZE_*
+static u32 DmaqAdd(void* dst, const void* src, u32 cnt, int size, u32 fill)
+{
+	// nothing to do - return ticket of previous operation
+	if (cnt == 0) return DmaqPut - 1;
+
+	// wait for free descriptor
+	while ((u32)(DmaqPut - DmaqGet) >= DMAQ_NUM) {}
+
+	// prepare descriptor
+	u32 put = DmaqPut;
+	sDmaqDesc* d = &DmaqDesc[put % DMAQ_NUM];
+	d->dst = (u8*)dst;
+	d->cnt = cnt;
+	d->fill = fill;
+	d->cfg = DMA_CFG_PSIZE(size) | DMA_CFG_MSIZE(size);
+	if (src == NULL)
+		d->src = (const u8*)&d->fill;
+	else
+	{
+		d->src = (const u8*)src;
+		d->cfg |= DMA_CFG_PERINC;
+	}
+
+	// queue the operation, start it if DMA is idle
+	IRQ_LOCK;
+	if (DmaqGet == put) DmaqStart(d);
+	DmaqPut = put + 1;
+	IRQ_UNLOCK;
+	return put;
+}
+
+// copy memory (returns ticket of the operation)
+//  Transfer uses 32-bit or 16-bit words if addresses and length are aligned.
+u32 DmaqCopy(void* dst, const void* src, u32 len)
+{
+	// short operation with idle queue is done by the CPU
+	if ((len < DMAQ_MIN) && !DmaqBusy())
+	{
+		memmove(dst, src, len);
+		DmaqGet++;
+		return DmaqPut++;
+	}
+
+	// select transfer size
+	u32 a = (u32)dst | (u32)src | len;
+	if ((a & 3) == 0) return DmaqAdd(dst, src, len >> 2, DMA_SIZE_32, 0);
+	if ((a & 1) == 0) return DmaqAdd(dst, src, len >> 1, DMA_SIZE_16, 0);
+	return DmaqAdd(dst, src, len, DMA_SIZE_8, 0);
+}
+
+// fill memory with byte (returns ticket of the operation)
+u32 DmaqFill(void* dst, u8 val, u32 len)
+{
+	// short operation with idle queue is done by the CPU
+	if ((len < DMAQ_MIN) && !DmaqBusy())
+	{
+		memset(dst, val, len);
+		DmaqGet++;
+		return DmaqPut++;
+	}
+
+	// select transfer size
+	u32 fill = val * 0x01010101;
+	u32 a = (u32)dst | len;
+	if ((a & 3) == 0) return DmaqAdd(dst, NULL, len >> 2, DMA_SIZE_32, fill);
+	if ((a & 1) == 0) return DmaqAdd(dst, NULL, len >> 1, DMA_SIZE_16, fill);
+	return DmaqAdd(dst, NULL, len, DMA_SIZE_8, fill);
+}
+
+// fill memory with 32-bit word (returns ticket of the operation)
+//  dst ... destination address (must be 32-bit aligned)
+//  cnt ... number of 32-bit words
+u32 DmaqFill32(u32* dst, u32 val, u32 cnt)
+{
+	return DmaqAdd(dst, NULL, cnt, DMA_SIZE_32, val);
+}
+
+#endif // USE_HOST
+
+// wait for operation with the ticket
+void DmaqWait(u32 ticket)
+{
+	while (!DmaqDone(ticket)) {}
+}
+
+// wait for all queued operations
+void DmaqFence(void)
+{
+	while (DmaqBusy()) {}
+}
+
+#endif // USE_DMAQ
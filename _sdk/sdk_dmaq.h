@@ -0,0 +1,92 @@
+// ****************************************************************************
+//
+//                   Asynchronous DMA memory copy and fill
+//
+// ****************************************************************************
+// Operations are put into a queue of DMAQ_NUM descriptors and they are processed
+// one by one by the DMA channel DMAQ_CHAN in memory-to-memory mode. Completion
+// interrupt of the channel starts the next operation, so the CPU can do other work
+// during the transfer. Every operation returns a ticket, which can be checked with
+// DmaqDone() (e.g. in TASK_WAIT_UNTIL) or waited for with DmaqWait(). DmaqFence()
+// waits for all queued operations.
+//
+// Data must not be touched by the CPU until the operation is done. Overlapping copy
+// is only possible to lower address (e.g. scrolling of the frame buffer up).
+// The host build does the operations immediately with memcpy() and memset().
+
+#if USE_DMAQ		// 1=use asynchronous DMA memory copy and fill (requires USE_DMA)
+
+#ifndef _SDK_DMAQ_H
+#define _SDK_DMAQ_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DMAQ_CHAN
+#define DMAQ_CHAN	7		// DMA1 channel used for memory operations
+#endif
+
+#ifndef DMAQ_NUM
+#define DMAQ_NUM	4		// number of descriptors in the queue
+#endif
+
+#ifndef DMAQ_MIN
+#define DMAQ_MIN	16		// min. length in bytes, shorter operation on idle queue is done by the CPU
+#endif
+
+// queue descriptor
+typedef struct {
+	u8*		dst;		// destination address
+	const u8*	src;		// source address (fill: address of 'fill')
+	u32		cnt;		// remaining number of transfers
+	u32		cfg;		// DMA channel configuration (data size and source increment)
+	u32		fill;		// fill value (repeated byte or 32-bit word)
+} sDmaqDesc;
+
+// queue of descriptors
+extern sDmaqDesc DmaqDesc[DMAQ_NUM];
+
+// number of queued operations (= ticket of next operation)
+extern volatile u32 DmaqPut;
+
+// number of finished operations
+extern volatile u32 DmaqGet;
+
+// initialize DMA memory queue
+void DmaqInit(void);
+
+// terminate DMA memory queue (waits for queued operations)
+void DmaqTerm(void);
+
+// copy memory (returns ticket of the operation)
+//  Transfer uses 32-bit or 16-bit words if addresses and length are aligned.
+u32 DmaqCopy(void* dst, const void* src, u32 len);
+
+// fill memory with byte (returns ticket of the operation)
+u32 DmaqFill(void* dst, u8 val, u32 len);
+
+// fill memory with 32-bit word (returns ticket of the operation)
+//  dst ... destination address (must be 32-bit aligned)
+//  cnt ... number of 32-bit words
+u32 DmaqFill32(u32* dst, u32 val, u32 cnt);
+
+// check if operation with the ticket is done
+INLINE Bool DmaqDone(u32 ticket) { return (s32)(DmaqGet - ticket) > 0; }
+
+// check if some operation is in progress
+INLINE Bool DmaqBusy(void) { return DmaqGet != DmaqPut; }
+
+// wait for operation with the ticket
+void DmaqWait(u32 ticket);
+
+// wait for all queued operations
+void DmaqFence(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _SDK_DMAQ_H
+
+#endif // USE_DMAQ
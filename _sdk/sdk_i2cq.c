@@ -0,0 +1,490 @@
+// ****************************************************************************
+//
+//                  Interrupt driven I2C master with transaction queue
+//
+// ****************************************************************************
+
+#include "../includes.h"	// globals
+
+#if USE_I2CQ		// 1=use interrupt driven I2C master with transaction queue (requires USE_I2C)
+
+// queue of transactions
+sI2cqTrans* I2cqQueue[I2CQ_NUM];
+
+// number of queued transactions
+volatile u32 I2cqPut = 0;
+
+// number of finished transactions
+volatile u32 I2cqGet = 0;
+
+#if USE_HOST
+
+// initialize I2C1 transaction queue (sda, scl = pins used to recover the bus)
+void I2cqInit(int speed, int sda, int scl) {}
+
+// terminate I2C1 transaction queue (waits for queued transactions)
+void I2cqTerm(void) {}
+
+// check time-out of running transaction (call it from the main loop)
+void I2cqPoll(void) {}
+
+// put transaction into queue, wait for free entry (host: no device is connected)
+void I2cqAdd(sI2cqTrans* t)
+{
+	I2cqPut++;
+	t->res = I2CQ_ERR_NACK;
+	I2cqGet++;
+	if (t->cb != NULL) t->cb(t);
+}
+
+#else // USE_HOST
+
+#if !USE_I2C
+#error "I2C transaction queue (USE_I2CQ) requires USE_I2C"
+#endif
+
+#if !CH32V0
+#error "I2C transaction queue (USE_I2CQ) is supported only on CH32V0 family"
+#endif
+
+#if I2CQ_DMA && !USE_DMA
+#error "I2C transaction queue with DMA (I2CQ_DMA) requires USE_DMA"
+#endif
+
+#if I2CQ_DMA && ((USE_DMAQ && ((DMAQ_CHAN == 6) || (DMAQ_CHAN == 7))) || (USE_USARTBUF && (USARTBUF_PORT == 2)))
+#error "I2C transaction queue with DMA (I2CQ_DMA) needs DMA channels 6 and 7"
+#endif
+
+#define I2CQ_TXDMA	6		// DMA channel of I2C1 TX
+#define I2CQ_RXDMA	7		// DMA channel of I2C1 RX
+
+// transaction is running on the bus
+static Bool I2cqRun = False;
+
+// receive phase of the transaction
+static Bool I2cqRx;
+
+// number of transferred bytes of current phase
+static u16 I2cqPos;
+
+// start time of current transaction
+static u32 I2cqStart;
+
+// setup
+static int I2cqSpeed;		// I2C speed in Hz
+static int I2cqSda;		// SDA pin
+static int I2cqScl;		// SCL pin
+
+// alternate function mode of I2C pins
+#ifdef GPIO_MODE_AFOD
+#define I2CQ_MODE_AF	GPIO_MODE_AFOD
+#else
+#define I2CQ_MODE_AF	GPIO_MODE_AF	// CH32X035: I2C sets open drain automatically
+#endif
+
+// release SDA pin to high with pull-up (bus recovery)
+static void I2cqSdaHigh(void) { GPIO_Out1(I2cqSda); GPIO_Mode(I2cqSda, GPIO_MODE_IN_PU); }
+
+// drive SDA pin low (bus recovery)
+static void I2cqSdaLow(void) { GPIO_Out0(I2cqSda); GPIO_Mode(I2cqSda, GPIO_MODE_OUT); }
+
+// get current transaction
+INLINE sI2cqTrans* I2cqCur(void) { return I2cqQueue[I2cqGet & (I2CQ_NUM - 1)]; }
+
+// start condition of current phase
+static void I2cqRestart(void)
+{
+	I2cqPos = 0;
+
+	// wait for end of stop condition of previous transaction
+	u32 start = Time();
+	while (((I2C1->CTLR1 & B9) != 0) && ((u32)(Time() - start) < 100*HCLK_PER_US)) {}
+
+	I2C1_StartEnable();
+}
+
+// begin current transaction (called with locked interrupt or from the interrupt)
+static void I2cqBegin(void)
+{
+	sI2cqTrans* t = I2cqCur();
+	t->res = I2CQ_BUSY;
+	I2cqRun = True;
+	I2cqRx = (t->wlen == 0) && (t->rlen != 0);
+	I2cqStart = Time();
+
+	// interrupts are enabled only during the transaction, blocking functions can be used on idle queue
+	I2C1_IntEvtEnable();
+	I2C1_IntErrEnable();
+	I2cqRestart();
+}
+
+// finish current transaction and begin next one
+static void I2cqFinish(sI2cqTrans* t, int res)
+{
+	// disable interrupts, DMA requests and DMA last transfer
+	I2C1->CTLR2 &= ~(B8|B9|B10|B11|B12);
+#if I2CQ_DMA
+	DMA_ChanDisable(DMA1_Chan(I2CQ_TXDMA));
+	DMA_ChanDisable(DMA1_Chan(I2CQ_RXDMA));
+#endif
+
+	// release transaction
+	I2cqRun = False;
+	t->res = res;
+	I2cqGet++;
+	if (t->cb != NULL) t->cb(t);
+
+	// begin next transaction (callback could already begin it)
+	if (!I2cqRun && I2cqBusy()) I2cqBegin();
+}
+
+// address sent in write direction - start transmit phase
+static void I2cqTxStart(sI2cqTrans* t)
+{
+	int n = t->wlen;
+
+	// address only, no data
+	if (n == 0)
+	{
+		(void)I2C1->STAR2;
+		I2C1_StopEnable();
+		I2cqFinish(t, I2CQ_OK);
+		return;
+	}
+
+#if I2CQ_DMA
+	// send data by DMA
+	if (n >= I2CQ_DMAMIN)
+	{
+		DMAchan_t* chan = DMA1_Chan(I2CQ_TXDMA);
+		DMA_ChanDisable(chan);
+		DMA_MemAddr(chan, t->wbuf);
+		DMA_Cnt(chan, n);
+		DMA_ChanEnable(chan);
+		I2cqPos = n;
+		I2C1_DMAEnable();
+	}
+	else
+#endif
+		// send data by buffer interrupt
+		I2C1_IntBufEnable();
+
+	// clear ADDR flag
+	(void)I2C1->STAR2;
+}
+
+// all data sent - continue with receive phase or stop
+static void I2cqTxEnd(sI2cqTrans* t)
+{
+	I2C1_DMADisable();
+	if (t->rlen > 0)
+	{
+		I2cqRx = True;
+		I2cqRestart();
+	}
+	else
+	{
+		I2C1_StopEnable();
+		I2cqFinish(t, I2CQ_OK);
+	}
+}
+
+// address sent in read direction - start receive phase
+static void I2cqRxStart(sI2cqTrans* t)
+{
+	int n = t->rlen;
+
+	// one byte - NACK and stop must be set just after clearing ADDR flag
+	if (n == 1)
+	{
+		I2C1_AckDisable();
+		(void)I2C1->STAR2;
+		I2C1_StopEnable();
+		I2C1_IntBufEnable();
+		return;
+	}
+
+	I2C1_AckEnable();
+
+#if I2CQ_DMA
+	// receive data by DMA, hardware sends NACK after last byte
+	if (n >= I2CQ_DMAMIN)
+	{
+		DMAchan_t* chan = DMA1_Chan(I2CQ_RXDMA);
+		DMA_ChanDisable(chan);
+		DMA_MemAddr(chan, t->rbuf);
+		DMA_Cnt(chan, n);
+		DMA_ChanEnable(chan);
+		I2C1_LastEnable();
+		I2C1_DMAEnable();
+	}
+	else
+#endif
+		// receive data by buffer interrupt
+		I2C1_IntBufEnable();
+
+	// clear ADDR flag
+	(void)I2C1->STAR2;
+}
+
+// I2C1 event interrupt
+HANDLER void I2C1_EV_IRQHandler()
+{
+	u16 s = I2C1->STAR1;
+
+	// no transaction is running
+	if (!I2cqRun)
+	{
+		I2C1->CTLR2 &= ~(B8|B9|B10);
+		return;
+	}
+	sI2cqTrans* t = I2cqCur();
+
+	// start condition sent - send address
+	if ((s & B0) != 0)
+	{
+		I2C1_Write((t->addr << 1) | (I2cqRx ? I2C_DIR_READ : I2C_DIR_WRITE));
+		return;
+	}
+
+	// address acknowledged - start data phase
+	if ((s & B1) != 0)
+	{
+		if (I2cqRx)
+			I2cqRxStart(t);
+		else
+			I2cqTxStart(t);
+		return;
+	}
+
+	// receive phase - byte received
+	if (I2cqRx)
+	{
+		if ((s & B6) != 0)
+		{
+			t->rbuf[I2cqPos++] = I2C1_Read();
+			int rem = t->rlen - I2cqPos;
+
+			// NACK and stop after next byte
+			if (rem == 1)
+			{
+				I2C1_AckDisable();
+				I2C1_StopEnable();
+			}
+			else if (rem == 0)
+				I2cqFinish(t, I2CQ_OK);
+		}
+		return;
+	}
+
+	// transmit phase - send next byte
+	if (((s & B7) != 0) && (I2cqPos < t->wlen))
+	{
+		I2C1_Write(t->wbuf[I2cqPos++]);
+		if (I2cqPos == t->wlen) I2C1_IntBufDisable();
+		return;
+	}
+
+	// last byte transmitted
+	if ((s & B2) != 0)
+	{
+#if I2CQ_DMA
+		if (DMA_GetCnt(DMA1_Chan(I2CQ_TXDMA)) != 0) return;
+#endif
+		I2cqTxEnd(t);
+	}
+}
+
+// I2C1 error interrupt
+HANDLER void I2C1_ER_IRQHandler()
+{
+	u16 s = I2C1->STAR1;
+	I2C1->STAR1 &= ~(B8|B9|B10|B11|B12);
+	if (!I2cqRun) return;
+
+	// release the bus (on arbitration loss the bus is already released)
+	if ((s & B9) == 0) I2C1_StopEnable();
+	I2cqFinish(I2cqCur(), ((s & B10) != 0) ? I2CQ_ERR_NACK : I2CQ_ERR_BUS);
+}
+
+#if I2CQ_DMA
+// DMA interrupt of I2C1 RX - all data received
+HANDLER void DMA1_Channel7_IRQHandler()
+{
+	DMA1_CompClr(I2CQ_RXDMA);
+	if (I2cqRun && I2cqRx)
+	{
+		I2C1_StopEnable();
+		I2cqFinish(I2cqCur(), I2CQ_OK);
+	}
+}
+#endif
+
+// recover the bus - release stuck slave by clock pulses, send stop condition and reset I2C1
+static void I2cqRecover(void)
+{
+	int i;
+
+#if I2CQ_DMA
+	DMA_ChanDisable(DMA1_Chan(I2CQ_TXDMA));
+	DMA_ChanDisable(DMA1_Chan(I2CQ_RXDMA));
+#endif
+
+	// SDA released with pull-up, SCL driven by push-pull output
+	I2cqSdaHigh();
+	GPIO_Out1(I2cqScl);
+	GPIO_Mode(I2cqScl, GPIO_MODE_OUT);
+	WaitUs(5);
+
+	// clock pulses until slave releases SDA
+	for (i = 0; (i < 9) && (GPIO_In(I2cqSda) == 0); i++)
+	{
+		GPIO_Out0(I2cqScl);
+		WaitUs(5);
+		GPIO_Out1(I2cqScl);
+		WaitUs(5);
+	}
+
+	// stop condition
+	GPIO_Out0(I2cqScl);
+	WaitUs(5);
+	I2cqSdaLow();
+	WaitUs(5);
+	GPIO_Out1(I2cqScl);
+	WaitUs(5);
+	I2cqSdaHigh();
+	WaitUs(5);
+
+	// return pins to I2C and initialize I2C1 again
+	GPIO_Mode(I2cqSda, I2CQ_MODE_AF);
+	GPIO_Mode(I2cqScl, I2CQ_MODE_AF);
+	I2C1_Init(0, I2cqSpeed);
+}
+
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+// update I2C speed after change of system clock (waits for queued transactions)
+static void I2cqClock(void)
+{
+	I2cqFlush();
+	I2C1_Init(0, I2cqSpeed);
+}
+#endif
+
+// initialize I2C1 transaction queue (sda, scl = pins used to recover the bus)
+void I2cqInit(int speed, int sda, int scl)
+{
+	I2cqSpeed = speed;
+	I2cqSda = sda;
+	I2cqScl = scl;
+	I2cqRun = False;
+	I2cqGet = I2cqPut;
+
+#if I2CQ_DMA
+	// TX DMA, from memory to I2C data register
+	RCC_DMA1ClkEnable();
+	DMAchan_t* chan = DMA1_Chan(I2CQ_TXDMA);
+	DMA_Cfg(chan, 0);
+	DMA_PerAddr(chan, &I2C1->DATAR);
+	DMA_Cfg(chan, DMA_CFG_DIRFROMMEM | DMA_CFG_MEMINC | DMA_CFG_PSIZE_8 | DMA_CFG_MSIZE_8 | DMA_CFG_PRIOR_MED);
+	DMA1_IntClr(I2CQ_TXDMA);
+
+	// RX DMA, from I2C data register to memory
+	chan = DMA1_Chan(I2CQ_RXDMA);
+	DMA_Cfg(chan, 0);
+	DMA_PerAddr(chan, &I2C1->DATAR);
+	DMA_Cfg(chan, DMA_CFG_COMPINT | DMA_CFG_DIRFROMPER | DMA_CFG_MEMINC | DMA_CFG_PSIZE_8 |
+		DMA_CFG_MSIZE_8 | DMA_CFG_PRIOR_HIGH);
+	DMA1_IntClr(I2CQ_RXDMA);
+	NVIC_IRQEnable(IRQ_DMA1_CH7);
+#endif
+
+	// initialize I2C1
+	I2C1_Init(0, speed);
+	NVIC_IRQEnable(IRQ_I2C1_EV);
+	NVIC_IRQEnable(IRQ_I2C1_ER);
+
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+	RCC_SpeedNotify(I2cqClock);
+#endif
+}
+
+// terminate I2C1 transaction queue (waits for queued transactions)
+void I2cqTerm(void)
+{
+	I2cqFlush();
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+	RCC_SpeedUnnotify(I2cqClock);
+#endif
+	NVIC_IRQDisable(IRQ_I2C1_EV);
+	NVIC_IRQDisable(IRQ_I2C1_ER);
+	I2C1->CTLR2 &= ~(B8|B9|B10|B11|B12);
+#if I2CQ_DMA
+	NVIC_IRQDisable(IRQ_DMA1_CH7);
+	DMA_Cfg(DMA1_Chan(I2CQ_TXDMA), 0);
+	DMA_Cfg(DMA1_Chan(I2CQ_RXDMA), 0);
+	DMA1_IntClr(I2CQ_TXDMA);
+	DMA1_IntClr(I2CQ_RXDMA);
+#endif
+}
+
+// check time-out of running transaction (call it from the main loop)
+void I2cqPoll(void)
+{
+	IRQ_LOCK;
+	if (I2cqRun && ((u32)(Time() - I2cqStart) >= (u32)I2CQ_TIMEOUT*HCLK_PER_MS))
+	{
+		I2cqRecover();
+		I2cqFinish(I2cqCur(), I2CQ_ERR_TIMEOUT);
+	}
+	IRQ_UNLOCK;
+}
+
+// put transaction into queue, wait for free entry (sets res = I2CQ_PEND)
+//  Callback can add next transaction only if the queue has free entry.
+void I2cqAdd(sI2cqTrans* t)
+{
+	t->res = I2CQ_PEND;
+
+	// wait for free entry
+	while ((u32)(I2cqPut - I2cqGet) >= I2CQ_NUM) I2cqPoll();
+
+	// queue the transaction, begin it if the bus is idle
+	IRQ_LOCK;
+	u32 put = I2cqPut;
+	I2cqQueue[put & (I2CQ_NUM - 1)] = t;
+	I2cqPut = put + 1;
+	if (!I2cqRun) I2cqBegin();
+	IRQ_UNLOCK;
+}
+
+#endif // USE_HOST
+
+// wait for transaction to finish (returns result I2CQ_OK or error I2CQ_ERR_*)
+int I2cqWait(sI2cqTrans* t)
+{
+	while (!I2cqDone(t)) I2cqPoll();
+	return t->res;
+}
+
+// wait for all queued transactions
+void I2cqFlush(void)
+{
+	while (I2cqBusy()) I2cqPoll();
+}
+
+// transfer data and wait (returns result I2CQ_OK or error I2CQ_ERR_*)
+int I2cqTransfer(int addr, const void* wbuf, int wlen, void* rbuf, int rlen)
+{
+	sI2cqTrans t;
+	t.wbuf = (const u8*)wbuf;
+	t.rbuf = (u8*)rbuf;
+	t.wlen = (u16)wlen;
+	t.rlen = (u16)rlen;
+	t.cb = NULL;
+	t.arg = NULL;
+	t.addr = (u8)addr;
+	I2cqAdd(&t);
+	return I2cqWait(&t);
+}
+
+#endif // USE_I2CQ
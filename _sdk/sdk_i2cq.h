@@ -0,0 +1,123 @@
+// ****************************************************************************
+//
+//                  Interrupt driven I2C master with transaction queue
+//
+// ****************************************************************************
+// Transactions are put into a queue of I2CQ_NUM entries and processed one by one
+// by the I2C1 event interrupt, so the CPU can do other work during the transfer.
+// Transaction writes 'wlen' bytes from 'wbuf', then (with repeated start) reads
+// 'rlen' bytes into 'rbuf'. Longer data parts are transferred by DMA (channel 6
+// for TX, channel 7 for RX) if I2CQ_DMA is enabled (by default with USE_DMA, unless
+// the channel is taken by DMA memory queue DMAQ_CHAN). Callback of the transaction
+// is called from the interrupt on completion, before the next transaction starts.
+//
+// Transaction descriptor and its buffers are owned by the caller and must not be
+// changed until the transaction is done. Result I2CQ_OK or error I2CQ_ERR_* is
+// stored in 'res'. Time-out of the transaction is checked by I2cqPoll(), which is
+// called by the waiting functions - the application should call it from the main
+// loop if it does not wait. On time-out the bus is recovered by 9 clock pulses
+// on the SCL pin and the I2C peripheral is initialized again.
+//
+// I2C interrupts are enabled only during the transaction, so blocking I2C functions
+// (I2C1_SendAddr ...) can be used while the queue is idle (e.g. after I2cqFlush()).
+// The application must set I2C mapping and SDA and SCL pins to GPIO_MODE_AFOD mode
+// (GPIO_MODE_AF on CH32X035).
+// The host build finishes transactions immediately with I2CQ_ERR_NACK.
+
+#if USE_I2CQ		// 1=use interrupt driven I2C master with transaction queue (requires USE_I2C)
+
+#ifndef _SDK_I2CQ_H
+#define _SDK_I2CQ_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef I2CQ_NUM
+#define I2CQ_NUM	4		// number of entries in the queue (power of 2)
+#endif
+
+#ifndef I2CQ_DMA
+#if USE_DMAQ && ((DMAQ_CHAN == 6) || (DMAQ_CHAN == 7))
+#define I2CQ_DMA	0		// DMA channel 6 or 7 is used by DMA memory queue (sdk_dmaq.h)
+#else
+#define I2CQ_DMA	USE_DMA		// 1=use DMA channels 6 and 7 to transfer longer data
+#endif
+#endif
+
+#ifndef I2CQ_DMAMIN
+#define I2CQ_DMAMIN	4		// min. length of data part to be transferred by DMA
+#endif
+
+#ifndef I2CQ_TIMEOUT
+#define I2CQ_TIMEOUT	20		// time-out of one transaction in [ms]
+#endif
+
+// transaction result
+#define I2CQ_PEND	2		// transaction is waiting in the queue
+#define I2CQ_BUSY	1		// transaction is running
+#define I2CQ_OK		0		// transaction is finished OK
+#define I2CQ_ERR_NACK	-1		// slave does not acknowledge address or data
+#define I2CQ_ERR_BUS	-2		// bus error or arbitration loss
+#define I2CQ_ERR_TIMEOUT -3		// transaction time-out, bus has been recovered
+
+struct sI2cqTrans_;
+
+// transaction callback (called from the interrupt)
+typedef void (*pI2cqCb)(struct sI2cqTrans_* t);
+
+// transaction descriptor (owned by the caller, must exist until the transaction is done)
+typedef struct sI2cqTrans_ {
+	const u8*	wbuf;		// data to write (can be NULL if wlen = 0)
+	u8*		rbuf;		// buffer to read into (can be NULL if rlen = 0)
+	u16		wlen;		// number of bytes to write
+	u16		rlen;		// number of bytes to read (after repeated start)
+	pI2cqCb		cb;		// callback on completion (NULL = none)
+	void*		arg;		// user argument
+	u8		addr;		// 7-bit slave address
+	volatile s8	res;		// result I2CQ_* (set by the driver)
+} sI2cqTrans;
+
+// queue of transactions
+extern sI2cqTrans* I2cqQueue[I2CQ_NUM];
+
+// number of queued transactions
+extern volatile u32 I2cqPut;
+
+// number of finished transactions
+extern volatile u32 I2cqGet;
+
+// initialize I2C1 transaction queue (sda, scl = pins used to recover the bus)
+void I2cqInit(int speed, int sda, int scl);
+
+// terminate I2C1 transaction queue (waits for queued transactions)
+void I2cqTerm(void);
+
+// check if transaction is done (result is I2CQ_OK or error I2CQ_ERR_*)
+INLINE Bool I2cqDone(const sI2cqTrans* t) { return t->res <= I2CQ_OK; }
+
+// check if queue is busy
+INLINE Bool I2cqBusy(void) { return I2cqPut != I2cqGet; }
+
+// check time-out of running transaction (call it from the main loop)
+void I2cqPoll(void);
+
+// put transaction into queue, wait for free entry (sets res = I2CQ_PEND)
+void I2cqAdd(sI2cqTrans* t);
+
+// wait for transaction to finish (returns result I2CQ_OK or error I2CQ_ERR_*)
+int I2cqWait(sI2cqTrans* t);
+
+// wait for all queued transactions
+void I2cqFlush(void);
+
+// transfer data and wait (returns result I2CQ_OK or error I2CQ_ERR_*)
+int I2cqTransfer(int addr, const void* wbuf, int wlen, void* rbuf, int rlen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _SDK_I2CQ_H
+
+#endif // USE_I2CQ
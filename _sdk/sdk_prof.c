@@ -0,0 +1,180 @@
+// ****************************************************************************
+//
+//                        Sampling PC profiler
+//
+// ****************************************************************************
+
+#include "../includes.h"	// globals
+
+#if USE_PROF		// 1=use sampling PC profiler
+
+// number of taken samples
+volatile u32 ProfSamples = 0;
+
+// number of dropped samples (ring buffer was full)
+volatile u32 ProfDrops = 0;
+
+#if USE_HOST
+
+// start profiler (initializes timer and USART)
+void ProfStart(void) {}
+
+// stop profiler (remaining samples in the buffer are not sent)
+void ProfStop(void) {}
+
+#else // USE_HOST
+
+#if !USE_TIM || !USE_USART
+#error "Profiler (USE_PROF) requires USE_TIM and USE_USART"
+#endif
+
+#if PROF_DMA && !USE_DMA
+#error "Profiler with DMA (PROF_DMA) requires USE_DMA"
+#endif
+
+STATIC_ASSERT((PROF_BUF & (PROF_BUF - 1)) == 0, "PROF_BUF must be power of 2!");
+
+// ring buffer
+u8 ProfBuf[PROF_BUF];
+u16 ProfHead;			// write index
+u16 ProfTail;			// read index
+#if PROF_DMA
+u16 ProfDmaLen;			// length of running DMA transfer (0 = DMA is idle)
+#endif
+
+// start sending data from ring buffer (called from timer interrupt)
+static void ProfSend(void)
+{
+	u16 tail = ProfTail;
+
+#if PROF_DMA
+	DMAchan_t* chan = DMA1_Chan(PROF_DMA);
+
+	// DMA transfer is running
+	if (ProfDmaLen != 0)
+	{
+		if (DMA_GetCnt(chan) != 0) return;
+		tail += ProfDmaLen;
+		if (tail >= PROF_BUF) tail = 0;
+		ProfTail = tail;
+		ProfDmaLen = 0;
+	}
+
+	// start new DMA transfer of continuous part of the buffer
+	u16 head = ProfHead;
+	if (head == tail) return;
+	u16 len = ((head > tail) ? head : PROF_BUF) - tail;
+	DMA_ChanDisable(chan);
+	DMA_MemAddr(chan, &ProfBuf[tail]);
+	DMA_Cnt(chan, len);
+	ProfDmaLen = len;
+	DMA_ChanEnable(chan);
+#else
+	// send data by USART transmit interrupt
+	if (tail != ProfHead) USARTx_TxEmptyIntEnable(PROF_USART);
+#endif
+}
+
+#if !PROF_DMA
+// USART transmit interrupt - send next byte from ring buffer
+HANDLER void PROF_USART_HANDLER()
+{
+	u16 tail = ProfTail;
+	if (tail == ProfHead)
+	{
+		// buffer is empty - stop sending (timer interrupt restarts it)
+		USARTx_TxEmptyIntDisable(PROF_USART);
+		return;
+	}
+	USARTx_TxWrite(PROF_USART, ProfBuf[tail]);
+	tail++;
+	if (tail >= PROF_BUF) tail = 0;
+	ProfTail = tail;
+}
+#endif
+
+// profiler timer interrupt - sample interrupted program counter
+HANDLER void PROF_HANDLER()
+{
+	TIMx_UpIntClr(PROF_TIM);
+
+	// prepare sample - pc >> 1 in 7-bit groups, bit 27 = RAM
+	u32 pc = get_MEPC();
+	u32 v = (pc >> 1) & 0x07ffffff;
+	if (pc >= 0x20000000) v |= B27;
+
+	// store sample into ring buffer (drop it if less than 4 bytes are free;
+	// without DMA the tail moves by single bytes)
+	u16 head = ProfHead;
+	u16 next = head + 4;
+	if (next >= PROF_BUF) next = 0;
+	if (((ProfTail - head - 1) & (PROF_BUF - 1)) < 4)
+		ProfDrops++;
+	else
+	{
+		u8* d = &ProfBuf[head];
+		d[0] = (u8)((v >> 21) | 0x80);
+		d[1] = (u8)((v >> 14) & 0x7f);
+		d[2] = (u8)((v >> 7) & 0x7f);
+		d[3] = (u8)(v & 0x7f);
+		ProfHead = next;
+		ProfSamples++;
+	}
+
+	// send data
+	ProfSend();
+}
+
+// start profiler (initializes timer and USART)
+void ProfStart(void)
+{
+	ProfStop();
+	ProfHead = 0;
+	ProfTail = 0;
+	ProfSamples = 0;
+	ProfDrops = 0;
+
+	// initialize USART
+	USARTx_Init(PROF_USART, PROF_BAUD, USART_WORDLEN_8, USART_PARITY_NONE, USART_STOP_1);
+
+#if PROF_DMA
+	// initialize DMA channel
+	ProfDmaLen = 0;
+	RCC_DMA1ClkEnable();
+	DMAchan_t* chan = DMA1_Chan(PROF_DMA);
+	DMA_PerAddr(chan, &PROF_USART->DATAR);
+	DMA_Cfg(chan, DMA_CFG_DIRFROMMEM | DMA_CFG_MEMINC | DMA_CFG_PSIZE_32 |
+		DMA_CFG_MSIZE_8 | DMA_CFG_PRIOR_LOW);
+	USARTx_TxDMAEnable(PROF_USART);
+#else
+	// enable USART interrupt (transmit interrupt is enabled when there are data to send)
+	NVIC_IRQPriority(PROF_USART_IRQ, IRQ_PRIO_HIGH);
+	NVIC_IRQEnable(PROF_USART_IRQ);
+#endif
+
+	// start timer with 1 MHz clock
+	TIMx_InitInt(PROF_TIM, HCLK_PER_US, 1000000/PROF_HZ - 1);
+	NVIC_IRQPriority(PROF_IRQ, IRQ_PRIO_VERYHIGH);
+	NVIC_IRQEnable(PROF_IRQ);
+}
+
+// stop profiler (remaining samples in the buffer are not sent)
+void ProfStop(void)
+{
+	NVIC_IRQDisable(PROF_IRQ);
+	TIMx_UpIntDisable(PROF_TIM);
+	TIMx_Disable(PROF_TIM);
+	TIMx_UpIntClr(PROF_TIM);
+
+#if PROF_DMA
+	DMA_ChanDisable(DMA1_Chan(PROF_DMA));
+	ProfDmaLen = 0;
+#else
+	NVIC_IRQDisable(PROF_USART_IRQ);
+	USARTx_TxEmptyIntDisable(PROF_USART);
+#endif
+}
+
+#endif // USE_HOST
+
+#endif // USE_PROF
@@ -0,0 +1,88 @@
+// ****************************************************************************
+//
+//                        Sampling PC profiler
+//
+// ****************************************************************************
+// Interrupt of timer PROF_TIM samples the interrupted program counter (mepc)
+// PROF_HZ times per second into the ring buffer, which is sent out over USART
+// PROF_USART (by DMA channel PROF_DMA, or by the USART transmit interrupt if
+// PROF_DMA = 0). Samples are dropped if the ring buffer is full, so the real sample
+// rate is limited by the baudrate (4 bytes per sample, 460800 Bd = about 11000 samples
+// per second). Profiler interrupt has the highest priority, so it samples
+// inside interrupt handlers too.
+//
+// Sample is 4 bytes: 7-bit groups of the value (pc >> 1), first byte with bit 7 set.
+// Bit 27 of the value marks address in RAM (0x20000000). Use _tools/prof/prof.c to
+// convert the captured stream to a flat profile of functions of the .elf file.
+//
+// Timer and USART are used exclusively by the profiler. The device configuration
+// selects a timer free of the device drivers, if the default one is not. The application must set
+// the TX pin of the USART to alternate function (e.g. GPIO_Mode(PD5, GPIO_MODE_AF)).
+
+#if USE_PROF		// 1=use sampling PC profiler
+
+#ifndef _SDK_PROF_H
+#define _SDK_PROF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef PROF_HZ
+#define PROF_HZ		1000		// sample rate in [Hz]
+#endif
+
+#ifndef PROF_BAUD
+#define PROF_BAUD	460800		// baudrate of the USART
+#endif
+
+#ifndef PROF_USART
+#define PROF_USART	USART1		// USART used to send samples
+#define PROF_USART_IRQ	IRQ_USART1	// USART interrupt (used if PROF_DMA = 0)
+#define PROF_USART_HANDLER USART1_IRQHandler // USART interrupt handler (used if PROF_DMA = 0)
+#endif
+
+#ifndef PROF_DMA
+#if USE_DMA
+#define PROF_DMA	4		// DMA1 channel with TX request of PROF_USART (0 = do not use DMA)
+#else
+#define PROF_DMA	0		// DMA1 channel with TX request of PROF_USART (0 = do not use DMA)
+#endif
+#endif
+
+#ifndef PROF_BUF
+#define PROF_BUF	128		// size of ring buffer in bytes (power of 2, min. 8)
+#endif
+
+// timer with update interrupt
+#ifndef PROF_TIM
+#if CH32V03X
+#define PROF_TIM	TIM3		// timer
+#define PROF_IRQ	IRQ_TIM3	// timer interrupt
+#define PROF_HANDLER	TIM3_IRQHandler	// timer interrupt handler
+#else
+#define PROF_TIM	TIM2		// timer
+#define PROF_IRQ	IRQ_TIM2	// timer interrupt
+#define PROF_HANDLER	TIM2_IRQHandler	// timer interrupt handler
+#endif
+#endif
+
+// number of taken samples
+extern volatile u32 ProfSamples;
+
+// number of dropped samples (ring buffer was full)
+extern volatile u32 ProfDrops;
+
+// start profiler (initializes timer and USART)
+void ProfStart(void);
+
+// stop profiler (remaining samples in the buffer are not sent)
+void ProfStop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _SDK_PROF_H
+
+#endif // USE_PROF
@@ -0,0 +1,123 @@
+// ****************************************************************************
+//
+//                     Run-time change of system clock
+//
+// ****************************************************************************
+
+#include "../includes.h"	// globals
+
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+
+// registered notifications (NULL = unused entry)
+pRCCSpeedNotify RCC_SpeedNotifyTab[RCCSPEED_NOTIFY];
+
+// register notification on change of system clock (returns False if table is full)
+Bool RCC_SpeedNotify(pRCCSpeedNotify fnc)
+{
+	int i;
+
+	// already registered
+	for (i = 0; i < RCCSPEED_NOTIFY; i++) if (RCC_SpeedNotifyTab[i] == fnc) return True;
+
+	// find free entry
+	for (i = 0; i < RCCSPEED_NOTIFY; i++)
+	{
+		if (RCC_SpeedNotifyTab[i] == NULL)
+		{
+			RCC_SpeedNotifyTab[i] = fnc;
+			return True;
+		}
+	}
+	return False;
+}
+
+// unregister notification
+void RCC_SpeedUnnotify(pRCCSpeedNotify fnc)
+{
+	int i;
+	for (i = 0; i < RCCSPEED_NOTIFY; i++) if (RCC_SpeedNotifyTab[i] == fnc) RCC_SpeedNotifyTab[i] = NULL;
+}
+
+// call registered notifications
+static void RCC_SpeedCall(void)
+{
+	int i;
+	pRCCSpeedNotify fnc;
+	for (i = 0; i < RCCSPEED_NOTIFY; i++)
+	{
+		fnc = RCC_SpeedNotifyTab[i];
+		if (fnc != NULL) fnc();
+	}
+}
+
+#if USE_HOST
+
+// current system clock (emulated clock is not changed)
+u32 RCC_SpeedFreq = HCLK_PER_US*MHZ;
+
+// set system clock to frequency in [Hz] (nearest lower possible frequency is used; returns new HCLK frequency)
+u32 RCC_SetSpeed(u32 freq)
+{
+	RCC_SpeedFreq = freq;
+	RCC_SpeedCall();
+	return freq;
+}
+
+// get current system clock HCLK frequency in [Hz]
+u32 RCC_GetSpeed(void) { return RCC_SpeedFreq; }
+
+#else // USE_HOST
+
+#if !CH32V0
+#error "Run-time change of system clock (USE_RCCSPEED) is supported only on CH32V0 family"
+#endif
+
+// set system clock to frequency in [Hz] (nearest lower possible frequency is used; returns new HCLK frequency)
+u32 RCC_SetSpeed(u32 freq)
+{
+	// min. frequency 1 MHz (HCLK_PER_US must not be 0)
+	if (freq < MHZ) freq = MHZ;
+
+	// SysTick time base must not run during the change
+	IRQ_LOCK;
+
+	// switch system clock
+	u32 oldus = HCLK_PER_US;
+	RCC_SwitchClock(freq);
+	u32 newus = HCLK_PER_US;
+
+	// re-scale time elapsed from start of current time step to new clock
+	if (newus != oldus)
+	{
+#if CH32V03X
+		u64 cnt = SysTick_Get64();
+#else
+		u32 cnt = SysTick_Get();
+#endif
+		u32 dif = (u32)(cnt - SysTick_OldCnt)/oldus*newus;
+		SysTick_OldCnt = cnt - dif;
+
+#if SYSTICK_MS > 0 // 0=do not use SysTick interrupt
+		// set new interrupt time on end of time step (not too close to current time)
+		SysTick_SetCmp(cnt + ((dif < SYSTICK_HCLK - 100*HCLK_PER_US) ? (SYSTICK_HCLK - dif) : 100*HCLK_PER_US));
+#endif
+
+#if SYSTICK_TICKLESS && !CH32V03X // 1=tickless mode, SysTick interrupt only on demand
+		// reschedule next interrupt
+		SysTick_Wake();
+#endif
+	}
+
+	IRQ_UNLOCK;
+
+	// notify peripherals
+	RCC_SpeedCall();
+	return RCC_FreqTab[CLK_HCLK];
+}
+
+// get current system clock HCLK frequency in [Hz]
+u32 RCC_GetSpeed(void) { return RCC_FreqTab[CLK_HCLK]; }
+
+#endif // USE_HOST
+
+#endif // USE_RCCSPEED
@@ -0,0 +1,69 @@
+// ****************************************************************************
+//
+//                     Run-time change of system clock
+//
+// ****************************************************************************
+// RCC_ClockInit() sets the system clock on start. RCC_SetSpeed() switches it later,
+// e.g. menus and idle screens can drop to 8 MHz to save power, while games and SD
+// card loading run at full speed. The nearest lower possible frequency is selected
+// (HSI or PLL divided by the AHB divider).
+//
+// Allowed range is 1 MHz up to the max. system clock. Only frequencies with whole
+// number of MHz are selected, so that HCLK_PER_US is exact: HSI 24 MHz (CH32V0) gives
+// 24, 12, 8, 6, 4 or 3 MHz, PLL 48 MHz also 48 and 16 MHz, HSI 48 MHz (CH32X035) gives
+// 48, 24, 16, 12, 8, 6 or 3 MHz. Lower request is raised to the lowest such frequency.
+//
+// HCLK_PER_US is a variable RCC_HclkPerUs, updated by RCC_UpdateFreq(), so WaitUs(),
+// WaitMs(), time-outs, SD card delays and other code using HCLK_PER_US follow the new
+// frequency. The SysTick time base is re-scaled by RCC_SetSpeed(). Peripherals with
+// dividers computed on initialization (sound timer, USART baudrate, I2C speed) register
+// a notification with RCC_SpeedNotify() - it is called after each change of the clock.
+// The buffered USART (USE_USARTBUF), I2C queue (USE_I2CQ) and device sound register
+// their notifications automatically.
+//
+// Notes:
+// - Call RCC_SetSpeed() from the main loop (not from an interrupt) while no transfer
+//   is running - flush USART and I2C transfers before changing the clock.
+// - Intervals measured with Time() across the change are not valid. Timers running
+//   from HCLK with fixed setup (e.g. ADC scan trigger) change their rate.
+// - The host build does not change the emulated clock, it only calls notifications.
+
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+
+#ifndef _SDK_RCCSPEED_H
+#define _SDK_RCCSPEED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef RCCSPEED_NOTIFY
+#define RCCSPEED_NOTIFY	8		// max. number of registered notifications
+#endif
+
+// notification callback, called after change of system clock
+typedef void (*pRCCSpeedNotify)(void);
+
+// registered notifications (NULL = unused entry)
+extern pRCCSpeedNotify RCC_SpeedNotifyTab[RCCSPEED_NOTIFY];
+
+// register notification on change of system clock (returns False if table is full)
+Bool RCC_SpeedNotify(pRCCSpeedNotify fnc);
+
+// unregister notification
+void RCC_SpeedUnnotify(pRCCSpeedNotify fnc);
+
+// set system clock to frequency in [Hz] (nearest lower possible frequency is used; returns new HCLK frequency)
+//  freq ... required frequency, min. 1 MHz (lower values are raised)
+u32 RCC_SetSpeed(u32 freq);
+
+// get current system clock HCLK frequency in [Hz]
+u32 RCC_GetSpeed(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _SDK_RCCSPEED_H
+
+#endif // USE_RCCSPEED
@@ -0,0 +1,205 @@
+// ****************************************************************************
+//
+//                        Software timers (timer wheel)
+//
+// ****************************************************************************
+
+#include "../includes.h"	// globals
+
+#if USE_SWTIMER		// 1=use software timers
+
+// current time step of the timer wheel
+volatile u32 TimerNow = 0;
+
+// slots of the timer wheel
+sTimer* TimerWheel[TIMER_LEVELS][TIMER_SLOTS];
+
+// number of not deferrable timers on higher levels (level 1 and more)
+u16 TimerHiNum = 0;
+
+#if SYSTICK_KEYSCAN	// call KeyScan() function from SysTick system timer
+sTimer TimerKeyScan;	// timer of keyboard scan
+#endif
+
+#if SYSTICK_SOUNDSCAN	// call SoundScan() function from SysTick system timer
+sTimer TimerSoundScan;	// timer of sound scan
+#endif
+
+// insert timer into the wheel by its expiration time (interrupts must be disabled)
+static void TimerInsert(sTimer* t)
+{
+	u32 now = TimerNow;
+	s32 d = (s32)(t->expire - now);
+
+	// find level, where the timer fits (timer with late expiration goes into current slot of level 0,
+	// too far timer goes into the farthest slot of last level and will be moved later again)
+	int level = 0;
+	u32 inx = t->expire;
+	if (d > 0)
+	{
+		while ((level < TIMER_LEVELS-1) && ((u32)d >= ((u32)TIMER_SLOTS << (level*TIMER_SLOTS_BITS))))
+		{
+			level++;
+			inx >>= TIMER_SLOTS_BITS;
+		}
+
+		if ((u32)d >= ((u32)TIMER_SLOTS << (level*TIMER_SLOTS_BITS))) inx = now >> (level*TIMER_SLOTS_BITS);
+	}
+	else
+		inx = now;
+
+	// link timer at start of the slot
+	sTimer** slot = &TimerWheel[level][inx & TIMER_SLOTS_MASK];
+	sTimer* next = *slot;
+	t->next = next;
+	if (next != NULL) next->pprev = &t->next;
+	*slot = t;
+	t->pprev = slot;
+	t->level = (u8)level;
+	if ((level > 0) && ((t->flags & TIMER_DEFER) == 0)) TimerHiNum++;
+}
+
+// remove timer from the wheel (interrupts must be disabled)
+static void TimerRemove(sTimer* t)
+{
+	sTimer** pprev = t->pprev;
+	if (pprev == NULL) return;
+	sTimer* next = t->next;
+	*pprev = next;
+	if (next != NULL) next->pprev = pprev;
+	t->pprev = NULL;
+	if ((t->level > 0) && ((t->flags & TIMER_DEFER) == 0)) TimerHiNum--;
+}
+
+// initialize timer wheel (called from SysTick_Init)
+void TimerInit(void)
+{
+	memset(TimerWheel, 0, sizeof(TimerWheel));
+	TimerHiNum = 0;
+
+#if SYSTICK_KEYSCAN	// call KeyScan() function from SysTick system timer
+	// keyboard scan on every time step
+	TimerKeyScan.pprev = NULL;
+	TimerStart(&TimerKeyScan, SYSTICK_MS, KeyScan, TIMER_PERIODIC | TIMER_DEFER);
+#endif
+
+#if SYSTICK_SOUNDSCAN	// call SoundScan() function from SysTick system timer
+	// sound scan on every time step
+	TimerSoundScan.pprev = NULL;
+	TimerStart(&TimerSoundScan, SYSTICK_MS, SoundScan, TIMER_PERIODIC | TIMER_DEFER);
+#endif
+}
+
+// start timer (restarts the timer if it is already running)
+//  t ... timer descriptor
+//  ms ... time interval in [ms] (rounded up to multiply of SYSTICK_MS)
+//  cb ... callback, called from SysTick interrupt
+//  mode ... timer mode TIMER_ONESHOT or TIMER_PERIODIC, optionally with TIMER_DEFER flag
+void TimerStart(sTimer* t, u32 ms, pTimerCb cb, int mode)
+{
+	u32 steps = TimerMsToSteps(ms);
+
+	Bool irq = LockIRQ();
+	TimerRemove(t);
+	t->cb = cb;
+	t->period = ((mode & TIMER_PERIODIC) != 0) ? steps : 0;
+	t->flags = (u8)mode;
+	t->expire = TimerNow + steps;
+	TimerInsert(t);
+	UnlockIRQ(irq);
+
+#if SYSTICK_TICKLESS	// 1=tickless mode, SysTick interrupt only when needed
+	// restart time steps
+	if ((mode & TIMER_DEFER) == 0) SysTick_Wake();
+#endif
+}
+
+// stop timer (can be called from its callback)
+void TimerStop(sTimer* t)
+{
+	Bool irq = LockIRQ();
+	TimerRemove(t);
+	UnlockIRQ(irq);
+}
+
+// move timers from slot of higher level to lower levels
+static void TimerCascade(int level)
+{
+	sTimer** slot = &TimerWheel[level][(TimerNow >> (level*TIMER_SLOTS_BITS)) & TIMER_SLOTS_MASK];
+	sTimer* t = *slot;
+	*slot = NULL;
+	while (t != NULL)
+	{
+		sTimer* next = t->next;
+		if ((t->flags & TIMER_DEFER) == 0) TimerHiNum--;
+		TimerInsert(t);
+		t = next;
+	}
+}
+
+// skipping time steps - deferrable periodic timers are not called
+static Bool TimerSkipping = False;
+
+// timer wheel service - called from SysTick interrupt once per time step
+void TimerTick(void)
+{
+	u32 now = TimerNow + 1;
+	TimerNow = now;
+
+	// move timers from higher levels on overflow of lower level (start with highest level)
+	int level;
+	for (level = TIMER_LEVELS-1; level > 0; level--)
+	{
+		if ((now & (((u32)1 << (level*TIMER_SLOTS_BITS)) - 1)) == 0) TimerCascade(level);
+	}
+
+	// call expired timers of current slot
+	sTimer** slot = &TimerWheel[0][now & TIMER_SLOTS_MASK];
+	sTimer* t;
+	while ((t = *slot) != NULL)
+	{
+		// remove timer, periodic timer is inserted again before callback, so it can stop itself
+		TimerRemove(t);
+		if (t->period != 0)
+		{
+			t->expire += t->period;
+			TimerInsert(t);
+			if (TimerSkipping && ((t->flags & TIMER_DEFER) != 0)) continue;
+		}
+		t->cb();
+	}
+}
+
+// skip time steps after idle interval (tickless mode) - deferrable periodic timers
+// are not called (e.g. KeyScan and SoundScan), other timers are called as by TimerTick()
+void TimerSkip(u32 n)
+{
+	TimerSkipping = True;
+	for (; n > 0; n--) TimerTick();
+	TimerSkipping = False;
+}
+
+// get number of time steps to next time step, which must be processed (max. 'max')
+//  Deferrable timers are not counted. Used in tickless mode.
+u32 TimerNext(u32 max)
+{
+	u32 now = TimerNow;
+	u32 d;
+
+	// timers of higher levels - wait max. to next overflow of level 0
+	if (TimerHiNum > 0)
+	{
+		d = TIMER_SLOTS - (now & TIMER_SLOTS_MASK);
+		if (max > d) max = d;
+	}
+
+	// search nearest slot of level 0 with not deferrable timer
+	for (d = 1; (d < max) && (d < TIMER_SLOTS); d++)
+	{
+		const sTimer* t = TimerWheel[0][(now + d) & TIMER_SLOTS_MASK];
+		for (; t != NULL; t = t->next) if ((t->flags & TIMER_DEFER) == 0) return d;
+	}
+	return max;
+}
+
+#endif // USE_SWTIMER
@@ -0,0 +1,94 @@
+// ****************************************************************************
+//
+//                        Software timers (timer wheel)
+//
+// ****************************************************************************
+// Timers count time steps of the SysTick interrupt (SYSTICK_MS). Running timers
+// are stored in hierarchical timer wheel with TIMER_LEVELS levels of TIMER_SLOTS
+// slots. Level 0 has slot per time step, level 1 slot per TIMER_SLOTS steps, etc.
+// Timer is inserted directly into its slot and removed from the doubly linked list,
+// so start and stop take constant time. On every step, TimerTick() calls timers of
+// one slot of level 0, and once per TIMER_SLOTS steps moves one slot of higher
+// level to the lower level.
+//
+// The callbacks are called from the SysTick interrupt. With SYSTICK_KEYSCAN and
+// SYSTICK_SOUNDSCAN, KeyScan() and SoundScan() run as periodic timers.
+// Timer with TIMER_DEFER flag does not wake up the system in tickless mode
+// (SYSTICK_TICKLESS), it is called on next time step, which occurs anyway.
+
+#if USE_SWTIMER		// 1=use software timers
+
+#ifndef _SDK_SWTIMER_H
+#define _SDK_SWTIMER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef TIMER_LEVELS
+#define TIMER_LEVELS	3		// number of levels of the timer wheel
+#endif
+
+#define TIMER_SLOTS_BITS 5		// number of bits of slot index
+#define TIMER_SLOTS	(1<<TIMER_SLOTS_BITS) // number of slots per level (= 32)
+#define TIMER_SLOTS_MASK (TIMER_SLOTS-1) // mask of slot index
+
+// timer mode flags
+#define TIMER_ONESHOT	0		// one-shot timer
+#define TIMER_PERIODIC	B0		// periodic timer
+#define TIMER_DEFER	B1		// deferrable timer - does not wake up system in tickless mode
+
+// timer callback (called from SysTick interrupt)
+typedef void (*pTimerCb)(void);
+
+// timer descriptor (owned by the caller, must exist while the timer is running)
+typedef struct sTimer_ {
+	struct sTimer_*	next;		// next timer in the slot
+	struct sTimer_** pprev;		// pointer to link to this timer (NULL = timer is not running)
+	pTimerCb	cb;		// callback
+	u32		expire;		// time step of expiration
+	u32		period;		// period in time steps (0 = one-shot timer)
+	u8		flags;		// mode flags TIMER_*
+	u8		level;		// level of the wheel with this timer
+} sTimer;
+
+// current time step of the timer wheel
+extern volatile u32 TimerNow;
+
+// initialize timer wheel (called from SysTick_Init)
+void TimerInit(void);
+
+// convert time in [ms] to number of time steps (rounded up, min. 1)
+INLINE u32 TimerMsToSteps(u32 ms) { ms = (ms + SYSTICK_MS - 1)/SYSTICK_MS; return (ms == 0) ? 1 : ms; }
+
+// start timer (restarts the timer if it is already running)
+//  t ... timer descriptor
+//  ms ... time interval in [ms] (rounded up to multiply of SYSTICK_MS)
+//  cb ... callback, called from SysTick interrupt
+//  mode ... timer mode TIMER_ONESHOT or TIMER_PERIODIC, optionally with TIMER_DEFER flag
+void TimerStart(sTimer* t, u32 ms, pTimerCb cb, int mode);
+
+// stop timer (can be called from its callback)
+void TimerStop(sTimer* t);
+
+// check if timer is running
+INLINE Bool TimerRunning(const sTimer* t) { return t->pprev != NULL; }
+
+// timer wheel service - called from SysTick interrupt once per time step
+void TimerTick(void);
+
+// skip time steps after idle interval (tickless mode) - deferrable periodic timers
+// are not called (e.g. KeyScan and SoundScan), other timers are called as by TimerTick()
+void TimerSkip(u32 n);
+
+// get number of time steps to next time step, which must be processed (max. 'max')
+//  Deferrable timers are not counted. Used in tickless mode.
+u32 TimerNext(u32 max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _SDK_SWTIMER_H
+
+#endif // USE_SWTIMER
@@ -0,0 +1,251 @@
+// ****************************************************************************
+//
+//                       Cooperative task scheduler
+//
+// ****************************************************************************
+
+#include "../includes.h"	// globals
+
+#if USE_TASK		// 1=use cooperative task scheduler
+
+// list of tasks
+sTask* TaskList = NULL;
+
+// currently running task (NULL = scheduler)
+sTask* TaskCur = NULL;
+
+// add task to the scheduler and start it from the beginning (restarts the task if it is already running)
+//  t ... task descriptor
+//  fn ... task function
+//  arg ... user argument (t->arg)
+void TaskAdd(sTask* t, pTaskFn fn, void* arg)
+{
+	t->fn = fn;
+	t->arg = arg;
+	t->lc = 0;
+	t->state = TASK_RUN;
+
+	// task is already in the list (finished task is removed by the scheduler later)
+	sTask** pp = &TaskList;
+	sTask* t2;
+	while ((t2 = *pp) != NULL)
+	{
+		if (t2 == t) return;
+		pp = &t2->next;
+	}
+
+	// append task to the end of the list
+	t->next = NULL;
+	*pp = t;
+}
+
+// run one turn of the scheduler - call all tasks, which are not sleeping
+//  Returns False if there are no tasks.
+Bool TaskPoll(void)
+{
+	sTask** pp = &TaskList;
+	sTask* t;
+	while ((t = *pp) != NULL)
+	{
+		// call task, if it is not sleeping
+		u8 state = t->state;
+		if ((state == TASK_RUN) || ((state == TASK_SLEEP) && ((s32)(Time() - t->wake) >= 0)))
+		{
+			TaskCur = t;
+			t->state = TASK_RUN;
+			state = t->fn(t);
+			TaskCur = NULL;
+
+			// task could be killed during its run
+			if (t->state != TASK_DONE) t->state = state;
+		}
+
+		// remove finished task
+		if (t->state == TASK_DONE)
+			*pp = t->next;
+		else
+			pp = &t->next;
+	}
+	return TaskList != NULL;
+}
+
+// sleep while all tasks are sleeping (called from TaskRun)
+void TaskIdle(void)
+{
+	// find nearest wake time (do not sleep if some task is running)
+	sTask* t = TaskList;
+	if (t == NULL) return;
+	s32 rem = 0x7fffffff;
+	u32 now = Time();
+	for (; t != NULL; t = t->next)
+	{
+		if (t->state == TASK_RUN) return;
+		if (t->state == TASK_SLEEP)
+		{
+			s32 d = (s32)(t->wake - now);
+			if (d < rem) rem = d;
+		}
+	}
+
+#if SYSTICK_TICKLESS && (SYSTICK_MS > 0) // 1=tickless mode, SysTick interrupt only on demand
+	// sleep until wake time, SysTick wakes up CPU at the end of WaitMs()
+	if (rem >= (s32)HCLK_PER_MS) WaitMs((u32)rem/HCLK_PER_MS);
+#elif SYSTICK_MS > 0 // 0=do not use SysTick interrupt
+	// sleep until next SysTick interrupt (or other interrupt)
+	if (rem >= (s32)SYSTICK_HCLK) wfi();
+#endif
+}
+
+// run scheduler until all tasks are finished
+void TaskRun(void)
+{
+	while (TaskPoll()) TaskIdle();
+}
+
+#if USE_TASK_STACK	// 1=use tasks with own stack
+
+#if USE_HOST
+#error "Stack tasks (USE_TASK_STACK) are not supported in the host build"
+#endif
+
+// saved stack pointer of the scheduler
+u32* TaskMainSp;
+
+// switch stack - save registers on current stack and its pointer into *save, load registers from new stack
+//  RV32I saves ra and s0..s11 into frame of 64 bytes, RV32E saves ra, s0 and s1 into frame of 16 bytes.
+void TaskSwitch(u32** save, u32* sp);
+
+#ifdef __riscv_32e
+#define TASK_FRAME	16		// size of stack frame of TaskSwitch in bytes
+#else
+#define TASK_FRAME	64		// size of stack frame of TaskSwitch in bytes
+#endif
+
+__asm__ (
+"	.section .text.TaskSwitch,\"ax\",@progbits\n"
+"	.align	1\n"
+"	.global	TaskSwitch\n"
+"	.type	TaskSwitch, @function\n"
+"TaskSwitch:\n"
+#ifdef __riscv_32e
+"	addi	sp,sp,-16\n"
+"	sw	ra,0(sp)\n"
+"	sw	s0,4(sp)\n"
+"	sw	s1,8(sp)\n"
+"	sw	sp,0(a0)\n"
+"	mv	sp,a1\n"
+"	lw	ra,0(sp)\n"
+"	lw	s0,4(sp)\n"
+"	lw	s1,8(sp)\n"
+"	addi	sp,sp,16\n"
+#else
+"	addi	sp,sp,-64\n"
+"	sw	ra,0(sp)\n"
+"	sw	s0,4(sp)\n"
+"	sw	s1,8(sp)\n"
+"	sw	s2,12(sp)\n"
+"	sw	s3,16(sp)\n"
+"	sw	s4,20(sp)\n"
+"	sw	s5,24(sp)\n"
+"	sw	s6,28(sp)\n"
+"	sw	s7,32(sp)\n"
+"	sw	s8,36(sp)\n"
+"	sw	s9,40(sp)\n"
+"	sw	s10,44(sp)\n"
+"	sw	s11,48(sp)\n"
+"	sw	sp,0(a0)\n"
+"	mv	sp,a1\n"
+"	lw	ra,0(sp)\n"
+"	lw	s0,4(sp)\n"
+"	lw	s1,8(sp)\n"
+"	lw	s2,12(sp)\n"
+"	lw	s3,16(sp)\n"
+"	lw	s4,20(sp)\n"
+"	lw	s5,24(sp)\n"
+"	lw	s6,28(sp)\n"
+"	lw	s7,32(sp)\n"
+"	lw	s8,36(sp)\n"
+"	lw	s9,40(sp)\n"
+"	lw	s10,44(sp)\n"
+"	lw	s11,48(sp)\n"
+"	addi	sp,sp,64\n"
+#endif
+"	ret\n"
+"	.size	TaskSwitch, .-TaskSwitch\n"
+"	.text\n"
+);
+
+// return from stack task to the scheduler with new task state
+static void TaskStackBack(u8 state)
+{
+	sTaskStack* ts = (sTaskStack*)TaskCur;
+	ts->task.lc = state;
+	TaskSwitch(&ts->sp, TaskMainSp);
+}
+
+// start of stack task (first switch to the task continues here)
+static void TaskStackStart(void)
+{
+	sTaskStack* ts = (sTaskStack*)TaskCur;
+	ts->entry(ts->task.arg);
+
+	// task is finished, it will not be called again
+	for (;;) TaskStackBack(TASK_DONE);
+}
+
+// task function of stack task - switch to the task stack
+static u8 TaskStackFn(sTask* t)
+{
+	sTaskStack* ts = (sTaskStack*)t;
+	TaskSwitch(&TaskMainSp, ts->sp);
+	return (u8)t->lc;
+}
+
+// add stack task to the scheduler and start it
+//  ts ... stack task descriptor
+//  entry ... entry function (the task is finished by return from this function)
+//  arg ... user argument
+//  stack ... stack of the task (aligned to 4 bytes)
+//  size ... size of the stack in bytes (min. TASK_STACK_MIN)
+void TaskStackAdd(sTaskStack* ts, pTaskEntry entry, void* arg, u32* stack, u32 size)
+{
+	// fill stack with pattern, to check stack reserve
+	ts->stack = stack;
+	ts->size = size;
+	ts->entry = entry;
+	memset(stack, 0xa5, size);
+
+	// prepare initial frame of TaskSwitch on top of the stack (aligned to 16 bytes)
+	u32* sp = (u32*)(((u32)stack + size) & ~15) - TASK_FRAME/4;
+	memset(sp, 0, TASK_FRAME);
+	sp[0] = (u32)TaskStackStart;	// ra = start of the task
+	ts->sp = sp;
+
+	TaskAdd(&ts->task, TaskStackFn, arg);
+}
+
+// give control to other tasks (call from stack task)
+void TaskYield(void)
+{
+	TaskStackBack(TASK_RUN);
+}
+
+// sleep for delay in CPU clock cycles (call from stack task)
+void TaskSleepClk(u32 clk)
+{
+	TaskCur->wake = Time() + clk;
+	TaskStackBack(TASK_SLEEP);
+}
+
+// get number of never used bytes of the task stack (to check stack reserve)
+u32 TaskStackFree(const sTaskStack* ts)
+{
+	const u8* s = (const u8*)ts->stack;
+	u32 n = 0;
+	while ((n < ts->size) && (s[n] == 0xa5)) n++;
+	return n;
+}
+
+#endif // USE_TASK_STACK
+
+#endif // USE_TASK
@@ -0,0 +1,172 @@
+// ****************************************************************************
+//
+//                       Cooperative task scheduler
+//
+// ****************************************************************************
+// Tasks are run in turn by TaskRun() or TaskPoll() from the main loop. Task gives
+// control back to the scheduler when it waits - for time (TASK_SLEEP_MS), for condition
+// (TASK_WAIT_UNTIL, e.g. end of DMA transfer) or voluntarily (TASK_YIELD). Sleeping
+// task is not called until its wake time comes; time is measured by Time() of the
+// SysTick counter. If all tasks are sleeping, the scheduler sleeps with wfi().
+//
+// Stackless task (protothread) is a function, which is called again on every turn and
+// continues after the last wait point, using switch() on line number stored in sTask.
+// Local variables of the task function are not preserved across wait points - use static
+// variables or a structure referenced by 'arg'. Do not use switch() around wait points
+// and do not put two wait points on the same line.
+//
+//	u8 BlinkTask(sTask* t)
+//	{
+//		TASK_BEGIN(t);
+//		while (True)
+//		{
+//			LedFlip(LED1);
+//			TASK_SLEEP_MS(t, 500);
+//		}
+//		TASK_END(t);
+//	}
+//
+//	sTask Blink;
+//	TaskAdd(&Blink, BlinkTask, NULL);
+//	TaskRun();
+//
+// Stack task (USE_TASK_STACK) has its own stack, so it can wait inside nested functions
+// with TaskYield() and TaskSleepMs(). It is intended for MCUs with more RAM (CH32V2, CH32V3).
+// The stack must have reserve for interrupt handlers, which use the stack of the current task.
+
+#if USE_TASK		// 1=use cooperative task scheduler
+
+#ifndef _SDK_TASK_H
+#define _SDK_TASK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// task state (= return value of the task function)
+#define TASK_DONE	0		// task is finished (or not started), remove it from the scheduler
+#define TASK_RUN	1		// task is running (or waiting for a condition), call it on next turn
+#define TASK_SLEEP	2		// task is sleeping until its wake time
+
+struct sTask_;
+
+// task function (returns new task state TASK_*)
+typedef u8 (*pTaskFn)(struct sTask_* t);
+
+// task descriptor (owned by the caller, must exist while the task is running)
+typedef struct sTask_ {
+	struct sTask_*	next;		// next task in the list of tasks
+	pTaskFn		fn;		// task function
+	void*		arg;		// user argument
+	u32		wake;		// wake time of the sleeping task, in Time() clock cycles
+	u16		lc;		// local continuation - line number of the wait point (0 = start; stack task: state for scheduler)
+	volatile u8	state;		// task state TASK_*
+	u8		res;		// ... reserved (align)
+} sTask;
+
+// list of tasks
+extern sTask* TaskList;
+
+// currently running task (NULL = scheduler)
+extern sTask* TaskCur;
+
+// start of stackless task
+#define TASK_BEGIN(t)		switch ((t)->lc) { case 0:
+
+// end of stackless task - task is finished
+#define TASK_END(t)		} (t)->lc = 0; return TASK_DONE
+
+// finish stackless task
+#define TASK_EXIT(t)		do { (t)->lc = 0; return TASK_DONE; } while (0)
+
+// give control to other tasks
+#define TASK_YIELD(t)		do { (t)->lc = __LINE__; return TASK_RUN; case __LINE__:; } while (0)
+
+// wait until condition is true (condition is tested on every turn of the scheduler)
+#define TASK_WAIT_UNTIL(t, cond) do { (t)->lc = __LINE__; case __LINE__: if (!(cond)) return TASK_RUN; } while (0)
+
+// wait while condition is true
+#define TASK_WAIT_WHILE(t, cond) TASK_WAIT_UNTIL(t, !(cond))
+
+// sleep for delay in CPU clock cycles (max. half of Time() overflow period, i.e. 44 seconds on 48 MHz)
+#define TASK_SLEEP_CLK(t, clk)	do { (t)->wake = Time() + (u32)(clk); (t)->lc = __LINE__; \
+					return TASK_SLEEP; case __LINE__:; } while (0)
+
+// sleep for delay in [us]
+#define TASK_SLEEP_US(t, us)	TASK_SLEEP_CLK(t, (u32)(us)*HCLK_PER_US)
+
+// sleep for delay in [ms]
+#define TASK_SLEEP_MS(t, ms)	TASK_SLEEP_CLK(t, (u32)(ms)*HCLK_PER_MS)
+
+// add task to the scheduler and start it from the beginning (restarts the task if it is already running)
+//  t ... task descriptor
+//  fn ... task function
+//  arg ... user argument (t->arg)
+void TaskAdd(sTask* t, pTaskFn fn, void* arg);
+
+// stop the task (can be called from the task itself)
+INLINE void TaskKill(sTask* t) { t->state = TASK_DONE; }
+
+// check if task is running
+INLINE Bool TaskRunning(const sTask* t) { return t->state != TASK_DONE; }
+
+// run one turn of the scheduler - call all tasks, which are not sleeping
+//  Returns False if there are no tasks.
+Bool TaskPoll(void);
+
+// sleep while all tasks are sleeping (called from TaskRun)
+void TaskIdle(void);
+
+// run scheduler until all tasks are finished
+void TaskRun(void);
+
+#if USE_TASK_STACK	// 1=use tasks with own stack
+
+#ifndef TASK_STACK_MIN
+#define TASK_STACK_MIN	256		// minimal size of the task stack in bytes
+#endif
+
+// stack task entry function
+typedef void (*pTaskEntry)(void* arg);
+
+// stack task descriptor
+typedef struct {
+	sTask		task;		// base task (must be first)
+	u32*		sp;		// saved stack pointer of the task
+	u32*		stack;		// stack of the task
+	u32		size;		// size of the stack in bytes
+	pTaskEntry	entry;		// entry function
+} sTaskStack;
+
+// add stack task to the scheduler and start it
+//  ts ... stack task descriptor
+//  entry ... entry function (the task is finished by return from this function)
+//  arg ... user argument
+//  stack ... stack of the task (aligned to 4 bytes)
+//  size ... size of the stack in bytes (min. TASK_STACK_MIN)
+void TaskStackAdd(sTaskStack* ts, pTaskEntry entry, void* arg, u32* stack, u32 size);
+
+// give control to other tasks (call from stack task)
+void TaskYield(void);
+
+// sleep for delay in CPU clock cycles (call from stack task)
+void TaskSleepClk(u32 clk);
+
+// sleep for delay in [us] (call from stack task)
+INLINE void TaskSleepUs(u32 us) { TaskSleepClk(us*HCLK_PER_US); }
+
+// sleep for delay in [ms] (call from stack task)
+INLINE void TaskSleepMs(u32 ms) { TaskSleepClk(ms*HCLK_PER_MS); }
+
+// get number of never used bytes of the task stack (to check stack reserve)
+u32 TaskStackFree(const sTaskStack* ts);
+
+#endif // USE_TASK_STACK
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _SDK_TASK_H
+
+#endif // USE_TASK
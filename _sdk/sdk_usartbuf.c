@@ -0,0 +1,282 @@
+// ****************************************************************************
+//
+//                  Buffered USART driver with DMA ring buffers
+//
+// ****************************************************************************
+
+#include "../includes.h"	// globals
+
+#if USE_USARTBUF	// 1=use buffered USART driver (requires USE_USART and USE_DMA)
+
+// TX ring buffer
+u8 UsartBufTx[USARTBUF_TXSIZE];
+volatile u16 UsartBufTxHead = 0;	// write index (main loop)
+volatile u16 UsartBufTxTail = 0;	// read index (DMA interrupt)
+
+// RX ring buffer
+u8 UsartBufRx[USARTBUF_RXSIZE];
+volatile u16 UsartBufRxTail = 0;	// read index (main loop), write index is given by DMA counter
+
+// counter of idle line events (end of received packet)
+volatile u32 UsartBufRxIdle = 0;
+
+#if USE_HOST
+
+// initialize buffered USART (8 bits, no parity, 1 stop bit)
+void UsartBufInit(int baud) {}
+
+// terminate buffered USART (waits for end of transmission)
+void UsartBufTerm(void) {}
+
+// request to send data from TX buffer (host: data are discarded)
+static void UsartBufKick(void) { UsartBufTxTail = UsartBufTxHead; }
+
+// get current write index of RX buffer
+INLINE u16 UsartBufRxHead(void) { return UsartBufRxTail; }
+
+#else // USE_HOST
+
+#if !USE_USART || !USE_DMA
+#error "Buffered USART (USE_USARTBUF) requires USE_USART and USE_DMA"
+#endif
+
+#if USARTBUF_PORT == 2
+#define USARTBUF_USART		USART2			// USART
+#define USARTBUF_IRQ		IRQ_USART2		// USART interrupt
+#define USARTBUF_HANDLER	USART2_IRQHandler	// USART interrupt handler
+#else
+#define USARTBUF_USART		USART1			// USART
+#define USARTBUF_IRQ		IRQ_USART1		// USART interrupt
+#define USARTBUF_HANDLER	USART1_IRQHandler	// USART interrupt handler
+#endif
+
+// DMA channels USARTBUF_TXDMA and USARTBUF_RXDMA are defined by sdk_dma.h of the MCU
+#define USARTBUF_DMAIRQ_(ch)		IRQ_DMA1_CH ## ch
+#define USARTBUF_DMAIRQ(ch)		USARTBUF_DMAIRQ_(ch)
+#define USARTBUF_DMAHANDLER_(ch)	DMA1_Channel ## ch ## _IRQHandler
+#define USARTBUF_DMAHANDLER(ch)		USARTBUF_DMAHANDLER_(ch)
+#define USARTBUF_TXIRQ		USARTBUF_DMAIRQ(USARTBUF_TXDMA)		// DMA interrupt of TX
+#define USARTBUF_TXHANDLER	USARTBUF_DMAHANDLER(USARTBUF_TXDMA)	// DMA interrupt handler of TX
+
+#if USE_DMAQ && ((DMAQ_CHAN == USARTBUF_TXDMA) || (DMAQ_CHAN == USARTBUF_RXDMA))
+#error "Buffered USART (USE_USARTBUF) and DMA memory queue (USE_DMAQ) use the same DMA channel - change DMAQ_CHAN"
+#endif
+
+// length of running TX transfer (0 = TX DMA is idle)
+u16 UsartBufTxLen = 0;
+
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+// baudrate
+static int UsartBufBaud;
+
+// update baudrate after change of system clock
+static void UsartBufClock(void)
+{
+	USARTx_Baud(USARTBUF_USART, UsartBufBaud);
+}
+#endif
+
+// TX DMA interrupt - on end of transfer or on request from UsartBufKick()
+HANDLER void USARTBUF_TXHANDLER()
+{
+	DMAchan_t* chan = DMA1_Chan(USARTBUF_TXDMA);
+	DMA1_CompClr(USARTBUF_TXDMA);
+
+	// transfer is still running
+	u16 tail = UsartBufTxTail;
+	u16 len = UsartBufTxLen;
+	if (len != 0)
+	{
+		if (DMA_GetCnt(chan) != 0) return;
+
+		// release sent data
+		tail = (tail + len) & (USARTBUF_TXSIZE - 1);
+		UsartBufTxTail = tail;
+		UsartBufTxLen = 0;
+	}
+
+	// start next continuous part of the buffer
+	u16 head = UsartBufTxHead;
+	if (head == tail) return;
+	len = ((head > tail) ? head : USARTBUF_TXSIZE) - tail;
+	DMA_ChanDisable(chan);
+	DMA_MemAddr(chan, &UsartBufTx[tail]);
+	DMA_Cnt(chan, len);
+	UsartBufTxLen = len;
+	DMA_ChanEnable(chan);
+}
+
+// USART interrupt - idle line
+HANDLER void USARTBUF_HANDLER()
+{
+	// clear idle flag by reading status and data register
+	if (USARTx_IdleError(USARTBUF_USART))
+	{
+		(void)USARTBUF_USART->DATAR;
+		UsartBufRxIdle++;
+	}
+}
+
+// request to send data from TX buffer
+static void UsartBufKick(void)
+{
+	NVIC_IRQForce(USARTBUF_TXIRQ);
+}
+
+// get current write index of RX buffer
+INLINE u16 UsartBufRxHead(void)
+{
+	return (u16)((USARTBUF_RXSIZE - DMA_GetCnt(DMA1_Chan(USARTBUF_RXDMA))) & (USARTBUF_RXSIZE - 1));
+}
+
+// initialize buffered USART (8 bits, no parity, 1 stop bit)
+void UsartBufInit(int baud)
+{
+	UsartBufTxHead = 0;
+	UsartBufTxTail = 0;
+	UsartBufTxLen = 0;
+	UsartBufRxTail = 0;
+	UsartBufRxIdle = 0;
+
+	// initialize USART
+	USARTx_Init(USARTBUF_USART, baud, USART_WORDLEN_8, USART_PARITY_NONE, USART_STOP_1);
+
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+	UsartBufBaud = baud;
+	RCC_SpeedNotify(UsartBufClock);
+#endif
+
+	// TX DMA, from memory to USART data register
+	RCC_DMA1ClkEnable();
+	DMAchan_t* chan = DMA1_Chan(USARTBUF_TXDMA);
+	DMA_Cfg(chan, 0);
+	DMA_PerAddr(chan, &USARTBUF_USART->DATAR);
+	DMA_Cfg(chan, DMA_CFG_COMPINT | DMA_CFG_DIRFROMMEM | DMA_CFG_MEMINC |
+		DMA_CFG_PSIZE_32 | DMA_CFG_MSIZE_8 | DMA_CFG_PRIOR_MED);
+	DMA1_IntClr(USARTBUF_TXDMA);
+
+	// RX DMA, from USART data register to memory, circular mode
+	chan = DMA1_Chan(USARTBUF_RXDMA);
+	DMA_Cfg(chan, 0);
+	DMA_PerAddr(chan, &USARTBUF_USART->DATAR);
+	DMA_MemAddr(chan, UsartBufRx);
+	DMA_Cnt(chan, USARTBUF_RXSIZE);
+	DMA_Cfg(chan, DMA_CFG_EN | DMA_CFG_DIRFROMPER | DMA_CFG_CIRC | DMA_CFG_MEMINC |
+		DMA_CFG_PSIZE_32 | DMA_CFG_MSIZE_8 | DMA_CFG_PRIOR_HIGH);
+
+	// enable DMA requests and idle line interrupt
+	USARTx_TxDMAEnable(USARTBUF_USART);
+	USARTx_RxDMAEnable(USARTBUF_USART);
+	USARTx_IdleIntEnable(USARTBUF_USART);
+	NVIC_IRQEnable(USARTBUF_TXIRQ);
+	NVIC_IRQEnable(USARTBUF_IRQ);
+}
+
+// terminate buffered USART (waits for end of transmission)
+void UsartBufTerm(void)
+{
+	UsartBufFlush();
+#if USE_RCCSPEED	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+	RCC_SpeedUnnotify(UsartBufClock);
+#endif
+	NVIC_IRQDisable(USARTBUF_IRQ);
+	NVIC_IRQDisable(USARTBUF_TXIRQ);
+	USARTx_IdleIntDisable(USARTBUF_USART);
+	USARTx_TxDMADisable(USARTBUF_USART);
+	USARTx_RxDMADisable(USARTBUF_USART);
+	DMA_Cfg(DMA1_Chan(USARTBUF_TXDMA), 0);
+	DMA_Cfg(DMA1_Chan(USARTBUF_RXDMA), 0);
+	DMA1_IntClr(USARTBUF_TXDMA);
+	DMA1_IntClr(USARTBUF_RXDMA);
+}
+
+#endif // USE_HOST
+
+// write data into TX buffer without waiting (returns number of written bytes)
+int UsartBufWrite(const void* buf, int len)
+{
+	const u8* s = (const u8*)buf;
+	int free = UsartBufTxFree();
+	if (len > free) len = free;
+	if (len <= 0) return 0;
+
+	// copy data in max. 2 parts
+	u16 head = UsartBufTxHead;
+	int n = USARTBUF_TXSIZE - head;
+	if (n > len) n = len;
+	memcpy(&UsartBufTx[head], s, n);
+	if (len > n) memcpy(UsartBufTx, s + n, len - n);
+	cb();
+
+	// shift head and start transfer
+	UsartBufTxHead = (head + len) & (USARTBUF_TXSIZE - 1);
+	UsartBufKick();
+	return len;
+}
+
+// send data, wait for free space in TX buffer
+void UsartBufSend(const void* buf, int len)
+{
+	const u8* s = (const u8*)buf;
+	while (len > 0)
+	{
+		int n = UsartBufWrite(s, len);
+		s += n;
+		len -= n;
+	}
+}
+
+// send character, wait for free space in TX buffer
+void UsartBufSendChar(char ch)
+{
+	UsartBufSend(&ch, 1);
+}
+
+// send ASCIIZ text, wait for free space in TX buffer
+void UsartBufSendText(const char* txt)
+{
+	UsartBufSend(txt, strlen(txt));
+}
+
+// wait until all data are sent
+void UsartBufFlush(void)
+{
+	while (!UsartBufTxEmpty()) {}
+}
+
+// get number of bytes in RX buffer
+int UsartBufRxNum(void)
+{
+	return (UsartBufRxHead() - UsartBufRxTail) & (USARTBUF_RXSIZE - 1);
+}
+
+// read data from RX buffer without waiting (returns number of read bytes)
+int UsartBufRead(void* buf, int len)
+{
+	u8* d = (u8*)buf;
+	int num = UsartBufRxNum();
+	if (len > num) len = num;
+	if (len <= 0) return 0;
+
+	// copy data in max. 2 parts
+	u16 tail = UsartBufRxTail;
+	int n = USARTBUF_RXSIZE - tail;
+	if (n > len) n = len;
+	memcpy(d, &UsartBufRx[tail], n);
+	if (len > n) memcpy(d + n, UsartBufRx, len - n);
+	cb();
+
+	// shift tail
+	UsartBufRxTail = (tail + len) & (USARTBUF_RXSIZE - 1);
+	return len;
+}
+
+// receive character without waiting (returns -1 if no character)
+int UsartBufRecvChar(void)
+{
+	u8 ch;
+	if (UsartBufRead(&ch, 1) == 0) return -1;
+	return ch;
+}
+
+#endif // USE_USARTBUF
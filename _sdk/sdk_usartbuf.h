@@ -0,0 +1,94 @@
+// ****************************************************************************
+//
+//                  Buffered USART driver with DMA ring buffers
+//
+// ****************************************************************************
+// Transmitted data are written into the TX ring buffer and sent by DMA from the
+// buffer. Received data are written by DMA in circular mode into the RX ring buffer.
+// Every buffer has one producer and one consumer (main loop and DMA), so the head
+// and tail indices need no critical section. The main loop only requests the DMA
+// interrupt to start the transfer, the DMA interrupt starts the next continuous part
+// of the TX buffer after completion of the previous one. Idle line interrupt of the
+// USART counts the end of received packets (UsartBufRxIdle).
+//
+// DMA channels USARTBUF_TXDMA and USARTBUF_RXDMA are given by sdk_dma.h of the MCU (USART1:
+// TX 4, RX 5; USART2: TX 6, RX 7, on CH32V103 and CH32V2 TX 7, RX 6). Do not use together with
+// the profiler (USE_PROF) on the same USART. The application must set the TX and RX
+// pins to alternate function and input. The host build discards sent data.
+
+#if USE_USARTBUF	// 1=use buffered USART driver (requires USE_USART and USE_DMA)
+
+#ifndef _SDK_USARTBUF_H
+#define _SDK_USARTBUF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef USARTBUF_PORT
+#define USARTBUF_PORT	1		// USART port 1 or 2
+#endif
+
+#ifndef USARTBUF_TXSIZE
+#define USARTBUF_TXSIZE	256		// size of TX ring buffer (power of 2)
+#endif
+
+#ifndef USARTBUF_RXSIZE
+#define USARTBUF_RXSIZE	256		// size of RX ring buffer (power of 2)
+#endif
+
+// TX ring buffer
+extern u8 UsartBufTx[USARTBUF_TXSIZE];
+extern volatile u16 UsartBufTxHead;	// write index (main loop)
+extern volatile u16 UsartBufTxTail;	// read index (DMA interrupt)
+
+// RX ring buffer
+extern u8 UsartBufRx[USARTBUF_RXSIZE];
+extern volatile u16 UsartBufRxTail;	// read index (main loop), write index is given by DMA counter
+
+// counter of idle line events (end of received packet)
+extern volatile u32 UsartBufRxIdle;
+
+// initialize buffered USART (8 bits, no parity, 1 stop bit)
+void UsartBufInit(int baud);
+
+// terminate buffered USART (waits for end of transmission)
+void UsartBufTerm(void);
+
+// get free space in TX buffer
+INLINE int UsartBufTxFree(void) { return (USARTBUF_TXSIZE - 1) - ((UsartBufTxHead - UsartBufTxTail) & (USARTBUF_TXSIZE - 1)); }
+
+// check if TX buffer is empty (last data can still be in the shift register)
+INLINE Bool UsartBufTxEmpty(void) { return UsartBufTxHead == UsartBufTxTail; }
+
+// write data into TX buffer without waiting (returns number of written bytes)
+int UsartBufWrite(const void* buf, int len);
+
+// send data, wait for free space in TX buffer
+void UsartBufSend(const void* buf, int len);
+
+// send character, wait for free space in TX buffer
+void UsartBufSendChar(char ch);
+
+// send ASCIIZ text, wait for free space in TX buffer
+void UsartBufSendText(const char* txt);
+
+// wait until all data are sent
+void UsartBufFlush(void);
+
+// get number of bytes in RX buffer
+int UsartBufRxNum(void);
+
+// read data from RX buffer without waiting (returns number of read bytes)
+int UsartBufRead(void* buf, int len);
+
+// receive character without waiting (returns -1 if no character)
+int UsartBufRecvChar(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _SDK_USARTBUF_H
+
+#endif // USE_USARTBUF
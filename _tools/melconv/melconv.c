@@ -0,0 +1,414 @@
+// ****************************************************************************
+//
+//                Melody converter sMelodyNote -> sMusic (lib_music)
+//
+// ****************************************************************************
+// Compile on Linux: gcc -O2 -o melconv melconv.c -lm
+// Usage: melconv [-b bar] [-l] [-t tempo] [-n] source.c > music.c
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+#define MAXNOTES	4096	// max. notes of one melody
+#define MAXPAT		255	// max. number of patterns
+#define NOTE_NUM	120	// number of notes C0..B9
+#define REST		-1	// rest note
+
+// note of the melody
+typedef struct {
+	int	len;		// length in 1/60 sec
+	int	note;		// note index 0..119, or REST
+} sNote;
+
+// pattern
+typedef struct {
+	int	first;		// index of first note in melody
+	int	num;		// number of notes
+} sPat;
+
+// order entry
+typedef struct {
+	int	pat;		// pattern index
+	int	trans;		// transposition
+} sOrd;
+
+// parameters
+int Bar = 64;			// pattern length in 1/60 sec (64 = NOTE_LEN1)
+int Loop = 0;			// 1 = loop song
+int Tempo = 16;			// tempo (16 = normal)
+int Trans = 1;			// 1 = reuse transposed patterns
+
+// source text
+char* Text;
+char* Ptr;
+
+// current melody
+char Name[256];
+sNote Notes[MAXNOTES];
+int NoteNum;
+
+sPat Pat[MAXPAT];
+int PatNum;
+sOrd Ord[MAXNOTES];
+int OrdNum;
+
+// note names
+const char* NoteName[12] = { "C", "CS", "D", "DS", "E", "F", "FS", "G", "GS", "A", "AS", "B" };
+
+// note lengths
+const struct { const char* name; int len; } LenTab[] = {
+	{ "NOTE_LEN1DOT", 96 }, { "NOTE_LEN1", 64 }, { "NOTE_LEN2DOT", 48 }, { "NOTE_LEN2", 32 },
+	{ "NOTE_LEN4DOT", 24 }, { "NOTE_LEN4", 16 }, { "NOTE_LEN8DOT", 12 }, { "NOTE_LEN8", 8 },
+	{ "NOTE_LEN16DOT", 6 }, { "NOTE_LEN16", 4 }, { "NOTE_LEN32DOT", 3 }, { "NOTE_LEN32", 2 },
+	{ "NOTE_LEN64", 1 }, { "NOTE_STOP", 0 }, { NULL, 0 },
+};
+
+// load text file and remove comments
+char* LoadText(const char* filename)
+{
+	FILE* f = fopen(filename, "rb");
+	if (f == NULL) { fprintf(stderr, "Cannot open %s\n", filename); exit(1); }
+	fseek(f, 0, SEEK_END);
+	long n = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	char* t = (char*)malloc(n + 1);
+	if ((t == NULL) || (fread(t, 1, n, f) != (size_t)n)) { fprintf(stderr, "Cannot read %s\n", filename); exit(1); }
+	fclose(f);
+	t[n] = 0;
+
+	// remove comments
+	char* s = t;
+	char* d = t;
+	while (*s != 0)
+	{
+		if ((s[0] == '/') && (s[1] == '/'))
+			while ((*s != 0) && (*s != '\n')) s++;
+		else if ((s[0] == '/') && (s[1] == '*'))
+		{
+			s += 2;
+			while ((*s != 0) && !((s[0] == '*') && (s[1] == '/'))) s++;
+			if (*s != 0) s += 2;
+			*d++ = ' ';
+		}
+		else
+			*d++ = *s++;
+	}
+	*d = 0;
+	return t;
+}
+
+// skip spaces
+void SkipSpace()
+{
+	while (isspace((unsigned char)*Ptr)) Ptr++;
+}
+
+// get token (identifier or number) into buffer, returns length
+int GetToken(char* buf, int size)
+{
+	SkipSpace();
+	int n = 0;
+	while ((isalnum((unsigned char)*Ptr) || (*Ptr == '_')) && (n < size-1)) buf[n++] = *Ptr++;
+	buf[n] = 0;
+	return n;
+}
+
+// check character and skip it
+int Check(char ch)
+{
+	SkipSpace();
+	if (*Ptr != ch) return 0;
+	Ptr++;
+	return 1;
+}
+
+// convert frequency in Hz to note index
+int FreqToNote(double hz)
+{
+	int n = (int)floor(12*log2(hz/16.3516) + 0.5);
+	if (n < 0) n = 0;
+	if (n >= NOTE_NUM) n = NOTE_NUM-1;
+	return n;
+}
+
+// parse note length
+int ParseLen()
+{
+	char tok[64];
+	if (GetToken(tok, sizeof(tok)) == 0) return -1;
+	if (isdigit((unsigned char)tok[0])) return (int)strtol(tok, NULL, 0);
+	int i;
+	for (i = 0; LenTab[i].name != NULL; i++) if (strcmp(tok, LenTab[i].name) == 0) return LenTab[i].len;
+	fprintf(stderr, "%s: unknown length %s\n", Name, tok);
+	return -1;
+}
+
+// parse note (returns REST, note index, or -2 on error)
+int ParseNote()
+{
+	char tok[64];
+	if (GetToken(tok, sizeof(tok)) == 0) return -2;
+
+	// divider with time base 1 MHz
+	if (isdigit((unsigned char)tok[0]))
+	{
+		long div = strtol(tok, NULL, 0);
+		if (div == 0) return REST;
+		return FreqToNote(1000000.0/(div + 1));
+	}
+
+	// frequency in 0.01 Hz
+	if (strcmp(tok, "SND_GET_DIV") == 0)
+	{
+		if (!Check('(') || (GetToken(tok, sizeof(tok)) == 0) || !Check(')')) return -2;
+		return FreqToNote(strtol(tok, NULL, 0)/100.0);
+	}
+
+	// rest
+	if (strcmp(tok, "NOTE_R") == 0) return REST;
+
+	// note name NOTE_xxN
+	if (strncmp(tok, "NOTE_", 5) == 0)
+	{
+		int i, oct;
+		for (i = 11; i >= 0; i--)
+		{
+			int n = (int)strlen(NoteName[i]);
+			if ((strncmp(tok+5, NoteName[i], n) == 0) && isdigit((unsigned char)tok[5+n]) && (tok[6+n] == 0))
+			{
+				oct = tok[5+n] - '0';
+				return oct*12 + i;
+			}
+		}
+	}
+	fprintf(stderr, "%s: unknown note %s\n", Name, tok);
+	return -2;
+}
+
+// parse melody table (Ptr points after "{"), returns 0 on error
+int ParseMelody()
+{
+	NoteNum = 0;
+	for (;;)
+	{
+		if (Check('}')) return 1;
+		if (!Check('{')) return 0;
+		int len = ParseLen();
+		if ((len < 0) || !Check(',')) return 0;
+		int note = ParseNote();
+		if ((note == -2) || !Check('}')) return 0;
+		Check(',');
+
+		// end of melody (rest of the table is ignored)
+		if (len == 0)
+		{
+			while ((*Ptr != 0) && (*Ptr != '}')) Ptr++;
+			if (*Ptr != 0) Ptr++;
+			return 1;
+		}
+
+		if (NoteNum >= MAXNOTES) { fprintf(stderr, "%s: too many notes\n", Name); return 0; }
+		if (len > 255)
+		{
+			fprintf(stderr, "%s: note length %d limited to 255\n", Name, len);
+			len = 255;
+		}
+		Notes[NoteNum].len = len;
+		Notes[NoteNum].note = note;
+		NoteNum++;
+	}
+}
+
+// compare pattern with notes, returns 1 if equal and sets transposition
+int ComparePat(const sPat* p, int first, int num, int* trans)
+{
+	if (p->num != num) return 0;
+	int i, d = 0, dset = 0;
+	for (i = 0; i < num; i++)
+	{
+		const sNote* a = &Notes[p->first + i];
+		const sNote* b = &Notes[first + i];
+		if (a->len != b->len) return 0;
+		if ((a->note == REST) != (b->note == REST)) return 0;
+		if (a->note == REST) continue;
+		if (!dset)
+		{
+			d = b->note - a->note;
+			dset = 1;
+			if ((d != 0) && !Trans) return 0;
+			if ((d < -128) || (d > 127)) return 0;
+		}
+		else if (b->note - a->note != d)
+			return 0;
+	}
+	*trans = d;
+	return 1;
+}
+
+// split melody into patterns and order list
+void Split()
+{
+	PatNum = 0;
+	OrdNum = 0;
+	int first = 0;
+	while (first < NoteNum)
+	{
+		// collect notes of one bar
+		int num = 0, sum = 0;
+		while ((first + num < NoteNum) && (sum < Bar))
+		{
+			sum += Notes[first + num].len;
+			num++;
+		}
+
+		// search pattern
+		int i, trans = 0;
+		for (i = 0; i < PatNum; i++) if (ComparePat(&Pat[i], first, num, &trans)) break;
+
+		// new pattern
+		if (i == PatNum)
+		{
+			if (PatNum >= MAXPAT) { fprintf(stderr, "%s: too many patterns, increase -b\n", Name); exit(1); }
+			Pat[i].first = first;
+			Pat[i].num = num;
+			PatNum++;
+			trans = 0;
+		}
+
+		Ord[OrdNum].pat = i;
+		Ord[OrdNum].trans = trans;
+		OrdNum++;
+		first += num;
+	}
+}
+
+// write one item of the pattern
+int ItemNum;
+void Item(const char* txt)
+{
+	printf("%s%s,", ((ItemNum & 7) == 0) ? "\n\t" : " ", txt);
+	ItemNum++;
+}
+
+// write music
+void Write()
+{
+	int i, j, len, size = 0;
+	char buf[32];
+
+	printf("// Music %s_Mus converted from melody %s\n", Name, Name);
+	for (i = 0; i < PatNum; i++)
+	{
+		printf("const u8 %s_Pat%d[] = {", Name, i);
+		ItemNum = 0;
+		len = -1;
+		for (j = 0; j < Pat[i].num; j++)
+		{
+			const sNote* n = &Notes[Pat[i].first + j];
+			if (n->len != len)
+			{
+				len = n->len;
+				if (len <= 64)
+				{
+					sprintf(buf, "MUS_LEN(%d)", len);
+					size++;
+				}
+				else
+				{
+					sprintf(buf, "MUS_LENX, %d", len);
+					size += 2;
+				}
+				Item(buf);
+			}
+			if (n->note == REST)
+				strcpy(buf, "MUS_REST");
+			else
+				sprintf(buf, "MUS_NOTE(%d,%d)", n->note/12, n->note%12);
+			Item(buf);
+			size++;
+		}
+		printf("\n\tMUS_END,\n};\n\n");
+		size++;
+	}
+
+	printf("const u8* const %s_PatTab[%d] = {", Name, PatNum);
+	for (i = 0; i < PatNum; i++) printf("%s%s_Pat%d,", ((i & 3) == 0) ? "\n\t" : " ", Name, i);
+	printf("\n};\n\n");
+	size += PatNum*4;
+
+	printf("const u8 %s_Ord[] = {", Name);
+	for (i = 0; i < OrdNum; i++) printf("%s%d,%s%d,", ((i & 7) == 0) ? "\n\t" : " ",
+		Ord[i].pat, (Ord[i].trans < 0) ? "(u8)" : "", Ord[i].trans);
+	printf("\n\tMUS_ORD_END, %s,\n};\n\n", Loop ? "0" : "MUS_NOLOOP");
+	size += OrdNum*2 + 2;
+
+	printf("const sMusic %s_Mus = { %s_PatTab, %s_Ord, %d };\n\n", Name, Name, Name, Tempo);
+	size += 12;
+
+	fprintf(stderr, "%s: %d notes, %d patterns, %d orders, %d -> %d bytes\n",
+		Name, NoteNum, PatNum, OrdNum, NoteNum*4 + 4, size);
+}
+
+int main(int argc, char* argv[])
+{
+	int i;
+	const char* filename = NULL;
+	for (i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "-b") == 0) && (i+1 < argc))
+			Bar = atoi(argv[++i]);
+		else if ((strcmp(argv[i], "-t") == 0) && (i+1 < argc))
+			Tempo = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-l") == 0)
+			Loop = 1;
+		else if (strcmp(argv[i], "-n") == 0)
+			Trans = 0;
+		else if (argv[i][0] != '-')
+			filename = argv[i];
+		else
+			filename = NULL, i = argc;
+	}
+
+	if ((filename == NULL) || (Bar < 1) || (Tempo < 1) || (Tempo > 255))
+	{
+		fprintf(stderr,
+			"Melody converter sMelodyNote -> sMusic (lib_music)\n"
+			"Usage: melconv [-b bar] [-l] [-t tempo] [-n] source.c > music.c\n"
+			"  -b bar ..... pattern length in 1/60 sec (default 64 = NOTE_LEN1)\n"
+			"  -l ......... loop song\n"
+			"  -t tempo ... tempo 1..255 (default 16 = normal)\n"
+			"  -n ......... do not reuse transposed patterns\n");
+		return 1;
+	}
+
+	Text = LoadText(filename);
+	Ptr = Text;
+	int cnt = 0;
+
+	// search melody tables "sMelodyNote Name[] = {"
+	while ((Ptr = strstr(Ptr, "sMelodyNote")) != NULL)
+	{
+		Ptr += 11;
+		if (GetToken(Name, sizeof(Name)) == 0) continue;
+		if (!Check('[')) continue;
+		while ((*Ptr != 0) && (*Ptr != ']')) Ptr++;
+		if (!Check(']') || !Check('=') || !Check('{')) continue;
+
+		if (!ParseMelody())
+		{
+			fprintf(stderr, "%s: syntax error\n", Name);
+			return 1;
+		}
+		if (NoteNum == 0) continue;
+
+		Split();
+		Write();
+		cnt++;
+	}
+
+	if (cnt == 0) fprintf(stderr, "No melody found in %s\n", filename);
+	return 0;
+}
@@ -0,0 +1,318 @@
+// ****************************************************************************
+//
+//               Flat profile from samples of the PC profiler (Linux)
+//
+// ****************************************************************************
+// Reads the stream of samples sent by the SDK profiler (USE_PROF, sdk_prof.c)
+// from captured file or serial port and prints number of samples per function
+// of the .elf file. Compile on Linux:
+//	gcc -O2 -o prof prof.c
+// Run:
+//	stty -F /dev/ttyUSB0 460800 raw
+//	./prof [options] Program.elf /dev/ttyUSB0     (stop with Ctrl+C)
+//	./prof [options] Program.elf capture.bin
+//
+// Options:
+//   -s num ..... stop after number of samples (default 0 = until end of input)
+//   -n num ..... number of functions in the report (default 30, 0 = all)
+//   -a ......... print also the hottest addresses
+//
+// Sample is 4 bytes: 7-bit groups of the value (pc >> 1), first byte with bit 7 set.
+// Bit 27 of the value marks address in RAM (0x20000000).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+
+// base types (see global.h)
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef unsigned char Bool;
+#define True 1
+#define False 0
+#define INLINE static inline
+
+// ----------------------------------------------------------------------------
+//                               Symbols
+// ----------------------------------------------------------------------------
+
+// function symbol with statistics
+typedef struct {
+	char*	name;		// name of the function
+	u32	addr;		// start address
+	u32	size;		// size in bytes
+	u64	samples;	// number of samples
+} sFunc;
+
+sFunc* Func = NULL;		// list of functions, sorted by address
+int FuncNum = 0;		// number of functions
+
+// sampled address
+typedef struct {
+	u32	addr;		// address
+	u64	samples;	// number of samples
+} sAddr;
+
+#define ADDR_MAX	4096	// max. number of different addresses
+sAddr Addr[ADDR_MAX];
+int AddrNum = 0;
+
+u64 Samples = 0;		// number of samples
+u64 Unknown = 0;		// samples outside symbols
+u64 Lost = 0;			// bytes skipped on synchronization
+volatile Bool Stop = False;	// stop reading (Ctrl+C)
+
+// map Flash alias address 0x08xxxxxx to 0x00xxxxxx
+INLINE u32 AddrMap(u32 addr) { return ((addr >> 24) == 0x08) ? (addr & 0x00ffffff) : addr; }
+
+// find function by address (returns -1 if not found)
+int FuncFind(u32 addr)
+{
+	addr = AddrMap(addr);
+	int lo = 0, hi = FuncNum - 1;
+	while (lo <= hi)
+	{
+		int mid = (lo + hi) / 2;
+		sFunc* f = &Func[mid];
+		if (addr < f->addr)
+			hi = mid - 1;
+		else if (addr >= f->addr + f->size)
+			lo = mid + 1;
+		else
+			return mid;
+	}
+	return -1;
+}
+
+// load symbols from ELF symbol table: LoadSymbols() (shared with _tools/rvsim)
+#include "../rvsim/elfsym.h"
+
+// load ELF file (returns False on error)
+Bool LoadElf(const char* name)
+{
+	FILE* f = fopen(name, "rb");
+	if (f == NULL) { fprintf(stderr, "Cannot open %s\n", name); return False; }
+	fseek(f, 0, SEEK_END);
+	u32 len = (u32)ftell(f);
+	fseek(f, 0, SEEK_SET);
+	u8* elf = (u8*)malloc(len);
+	if ((elf == NULL) || (fread(elf, 1, len, f) != len))
+	{
+		fclose(f);
+		free(elf);
+		fprintf(stderr, "Cannot read %s\n", name);
+		return False;
+	}
+	fclose(f);
+
+	// check header (32-bit, little endian, RISC-V)
+	if ((len < 0x34) || (memcmp(elf, "\177ELF", 4) != 0) || (elf[4] != 1) || (elf[5] != 1)
+		|| (*(u16*)&elf[0x12] != 243))
+	{
+		fprintf(stderr, "%s is not 32-bit RISC-V ELF file\n", name);
+		free(elf);
+		return False;
+	}
+
+	// load symbols
+	if (!LoadSymbols(elf, len))
+	{
+		fprintf(stderr, "%s has invalid section or symbol table\n", name);
+		free(elf);
+		return False;
+	}
+	free(elf);
+	return True;
+}
+
+// ----------------------------------------------------------------------------
+//                               Samples
+// ----------------------------------------------------------------------------
+
+// add one sample
+void AddSample(u32 addr)
+{
+	Samples++;
+
+	// function
+	int f = FuncFind(addr);
+	if (f < 0)
+		Unknown++;
+	else
+		Func[f].samples++;
+
+	// address
+	int i;
+	for (i = 0; i < AddrNum; i++) if (Addr[i].addr == addr) break;
+	if (i == AddrNum)
+	{
+		if (AddrNum >= ADDR_MAX) return;
+		AddrNum++;
+		Addr[i].addr = addr;
+		Addr[i].samples = 0;
+	}
+	Addr[i].samples++;
+}
+
+// read samples from the stream
+void ReadSamples(FILE* f, u64 maxnum)
+{
+	int c, n = 0;
+	u32 v = 0;
+	while (!Stop && ((maxnum == 0) || (Samples < maxnum)) && ((c = fgetc(f)) != EOF))
+	{
+		// first byte of the sample
+		if ((c & 0x80) != 0)
+		{
+			if (n != 0) Lost += n;
+			v = c & 0x7f;
+			n = 1;
+			continue;
+		}
+
+		// next byte, skip bytes without first byte
+		if (n == 0)
+		{
+			Lost++;
+			continue;
+		}
+		v = (v << 7) | c;
+		n++;
+
+		// sample is complete
+		if (n == 4)
+		{
+			u32 addr = (v & 0x07ffffff) << 1;
+			if ((v & (1 << 27)) != 0) addr |= 0x20000000;
+			AddSample(addr);
+			n = 0;
+		}
+	}
+}
+
+// ----------------------------------------------------------------------------
+//                                 Report
+// ----------------------------------------------------------------------------
+
+// compare functions by samples (for qsort)
+int CompFunc(const void* a, const void* b)
+{
+	const sFunc* fa = (const sFunc*)a;
+	const sFunc* fb = (const sFunc*)b;
+	return (fa->samples < fb->samples) ? 1 : ((fa->samples > fb->samples) ? -1 : 0);
+}
+
+// compare addresses by samples (for qsort)
+int CompAddr(const void* a, const void* b)
+{
+	const sAddr* aa = (const sAddr*)a;
+	const sAddr* ab = (const sAddr*)b;
+	return (aa->samples < ab->samples) ? 1 : ((aa->samples > ab->samples) ? -1 : 0);
+}
+
+// print report
+void Report(int num, Bool addr)
+{
+	int i;
+	printf("\nsamples %llu, outside symbols %llu, lost bytes %llu\n",
+		(unsigned long long)Samples, (unsigned long long)Unknown, (unsigned long long)Lost);
+	if (Samples == 0) return;
+
+	qsort(Func, FuncNum, sizeof(sFunc), CompFunc);
+	printf("\n%10s %6s  %s\n", "samples", "%", "function");
+	if ((num <= 0) || (num > FuncNum)) num = FuncNum;
+	for (i = 0; (i < num) && (Func[i].samples > 0); i++)
+	{
+		printf("%10llu %5.1f%%  %s\n", (unsigned long long)Func[i].samples,
+			100.0 * Func[i].samples / Samples, Func[i].name);
+	}
+
+	if (addr)
+	{
+		qsort(Addr, AddrNum, sizeof(sAddr), CompAddr);
+		printf("\n%10s %6s  %s\n", "samples", "%", "address");
+		for (i = 0; (i < AddrNum) && (i < 30); i++)
+		{
+			printf("%10llu %5.1f%%  0x%08X\n", (unsigned long long)Addr[i].samples,
+				100.0 * Addr[i].samples / Samples, Addr[i].addr);
+		}
+	}
+}
+
+// ----------------------------------------------------------------------------
+//                                  Main
+// ----------------------------------------------------------------------------
+
+// Ctrl+C handler
+void OnSignal(int sig)
+{
+	(void)sig;
+	Stop = True;
+}
+
+// print help
+void Help(void)
+{
+	fprintf(stderr,
+		"Flat profile from samples of the PC profiler\n"
+		"Usage: prof [options] Program.elf input\n"
+		"  -s num   stop after number of samples (default 0 = until end of input)\n"
+		"  -n num   number of functions in the report (default 30, 0 = all)\n"
+		"  -a       print also the hottest addresses\n");
+}
+
+int main(int argc, char* argv[])
+{
+	u64 maxnum = 0;
+	int num = 30;
+	Bool addr = False;
+	const char* elf = NULL;
+	const char* input = NULL;
+	int i;
+
+	// parse arguments
+	for (i = 1; i < argc; i++)
+	{
+		const char* a = argv[i];
+		if ((strcmp(a, "-s") == 0) || (strcmp(a, "-n") == 0))
+		{
+			if (i + 1 >= argc) { Help(); return 1; }
+			if (a[1] == 's')
+				maxnum = strtoull(argv[++i], NULL, 0);
+			else
+				num = atoi(argv[++i]);
+		}
+		else if (strcmp(a, "-a") == 0)
+			addr = True;
+		else if ((a[0] != '-') && (elf == NULL))
+			elf = a;
+		else if ((a[0] != '-') && (input == NULL))
+			input = a;
+		else
+		{
+			Help();
+			return 1;
+		}
+	}
+	if ((elf == NULL) || (input == NULL)) { Help(); return 1; }
+
+	// load symbols
+	if (!LoadElf(elf)) return 1;
+
+	// read samples
+	FILE* f = fopen(input, "rb");
+	if (f == NULL) { fprintf(stderr, "Cannot open %s\n", input); return 1; }
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = OnSignal;
+	sigaction(SIGINT, &sa, NULL);	// without SA_RESTART, to interrupt waiting for input
+	ReadSamples(f, maxnum);
+	fclose(f);
+
+	Report(num, addr);
+	return 0;
+}
@@ -0,0 +1,103 @@
+// ****************************************************************************
+//
+//                  Load function symbols from ELF file
+//
+// ****************************************************************************
+// Shared by rvsim.c and _tools/prof/prof.c. Include it after definition of
+// the type sFunc (with fields name, addr and size), the list Func with FuncNum
+// entries and the function AddrMap(). All offsets of the file are checked,
+// so a truncated or damaged file is reported instead of read out of range.
+
+#ifndef _ELFSYM_H
+#define _ELFSYM_H
+
+// check that the range lies inside the ELF file
+INLINE Bool ElfRange(u32 off, u32 size, u32 len) { return (off <= len) && (size <= len - off); }
+
+// load symbols from ELF symbol table (returns False on invalid file)
+Bool LoadSymbols(const u8* elf, u32 len)
+{
+	if (len < 0x34) return False;
+	u32 shoff = *(const u32*)&elf[0x20];
+	u16 shentsize = *(const u16*)&elf[0x2E];
+	u16 shnum = *(const u16*)&elf[0x30];
+	if ((shnum > 0) && ((shentsize < 0x28) || !ElfRange(shoff, (u32)shnum*shentsize, len))) return False;
+
+	int i, j;
+	for (i = 0; i < shnum; i++)
+	{
+		const u8* sh = &elf[shoff + i*shentsize];
+		if (*(const u32*)&sh[4] != 2) continue; // SHT_SYMTAB
+		u32 off = *(const u32*)&sh[0x10];
+		u32 size = *(const u32*)&sh[0x14];
+		u32 link = *(const u32*)&sh[0x18];
+		if (!ElfRange(off, size, len) || (link >= shnum)) return False;
+
+		// string table
+		const u8* strsh = &elf[shoff + link*shentsize];
+		u32 stroff = *(const u32*)&strsh[0x10];
+		u32 strsize = *(const u32*)&strsh[0x14];
+		if (!ElfRange(stroff, strsize, len)) return False;
+		const char* str = (const char*)&elf[stroff];
+
+		int n = size / 16;
+		sFunc* fnc = (sFunc*)realloc(Func, (FuncNum + n + 1)*sizeof(sFunc));
+		if (fnc == NULL) return False;
+		Func = fnc;
+		memset(&Func[FuncNum], 0, (n + 1)*sizeof(sFunc));
+		for (j = 0; j < n; j++)
+		{
+			const u8* s = &elf[off + j*16];
+			u32 name = *(const u32*)&s[0];
+			u32 value = *(const u32*)&s[4];
+			u32 sz = *(const u32*)&s[8];
+			u8 info = s[12];
+			u16 shndx = *(const u16*)&s[14];
+
+			// name must be terminated inside the string table
+			if ((name >= strsize) || (memchr(&str[name], 0, strsize - name) == NULL)) continue;
+			const char* nm = &str[name];
+
+			// STT_FUNC, or STT_NOTYPE label in executable section (assembler function, not mapping symbol $x)
+			if ((info & 0x0f) != 2)
+			{
+				if (((info & 0x0f) != 0) || (shndx == 0) || (shndx >= shnum) || (nm[0] == '$') || (nm[0] == '.') || (nm[0] == 0)) continue;
+				const u8* sec = &elf[shoff + shndx*shentsize];
+				if ((*(const u32*)&sec[8] & 4) == 0) continue; // SHF_EXECINSTR
+			}
+			sFunc* f = &Func[FuncNum++];
+			f->name = strdup(nm);
+			f->addr = AddrMap(value);
+			f->size = sz;
+		}
+	}
+
+	// sort by address (insertion sort, symbol table is almost sorted)
+	for (i = 1; i < FuncNum; i++)
+	{
+		sFunc f = Func[i];
+		for (j = i; (j > 0) && (Func[j-1].addr > f.addr); j--) Func[j] = Func[j-1];
+		Func[j] = f;
+	}
+
+	// remove aliases of the same address, assembler labels get size up to next symbol
+	j = 0;
+	for (i = 0; i < FuncNum; i++)
+	{
+		if ((j > 0) && (Func[j-1].addr == Func[i].addr))
+		{
+			if (Func[j-1].size == 0) Func[j-1] = Func[i];
+			continue;
+		}
+		Func[j++] = Func[i];
+	}
+	FuncNum = j;
+	for (i = 0; i < FuncNum; i++)
+	{
+		if (Func[i].size == 0) Func[i].size = (i + 1 < FuncNum) ? (Func[i+1].addr - Func[i].addr) : 2;
+		if ((i + 1 < FuncNum) && (Func[i].addr + Func[i].size > Func[i+1].addr)) Func[i].size = Func[i+1].addr - Func[i].addr;
+	}
+	return True;
+}
+
+#endif // _ELFSYM_H
@@ -0,0 +1,1704 @@
+// ****************************************************************************
+//
+//               RV32EC/RV32EmC instruction set simulator (Linux)
+//
+// ****************************************************************************
+// Runs .elf files produced by the Makefiles and reports number of CPU clock
+// cycles per function symbol. Compile on Linux:
+//	gcc -O2 -o rvsim rvsim.c
+// Run:
+//	./rvsim [options] Program.elf
+//
+// Options:
+//   -m cpu ..... CPU core: v2a = QingKe V2A, CH32V003, RV32EC (default)
+//                          v2c = QingKe V2C, CH32V002/V004/V005/V006/V007, RV32EmC
+//                          v4  = QingKe V4, CH32X035/V103/V203/V303, RV32IMAC
+//   -c num ..... stop after number of clock cycles (default 480000000 = 10 s at 48 MHz)
+//   -w num ..... flash wait states (default: from FLASH->ACTLR register, as set by SystemInit)
+//   -f name .... benchmark function: print min/avg/max cycles per call
+//   -e name .... stop when function is called
+//   -n num ..... number of functions in the report (default 30, 0 = all)
+//   -q ......... do not print USART1 output
+//   -t ......... trace executed instructions to stderr
+//
+// Emulated hardware (CH32V00x address map):
+//   Flash 256 KB at 0x00000000 (alias 0x08000000), SRAM 64 KB at 0x20000000,
+//   SysTick, PFIC interrupts (with HPE hardware stacking), TIM1/TIM2 update and
+//   compare interrupts, GPIO output/input registers, USART1 transmitter (to stdout),
+//   SPI1 data register (counts transferred bytes), ADC1 and I2C1 ready flags,
+//   RCC and FLASH ready flags.
+//   Other peripheral registers behave as memory.
+//
+// Timing model (sTiming, cycle-approximate, see TimingTab[]):
+//   - every instruction takes 1 cycle in execution stage
+//   - taken branch and jump refill the pipeline (+jump cycles)
+//   - load and store access the bus (+load, +store cycles)
+//   - flash is read by 32-bit words, every new word from flash costs wait
+//     states; compressed instructions share one fetched word; SRAM has no waits
+//   - load from flash costs wait states
+//   - multiplication and division cost +mul and +div cycles
+//   - interrupt entry and return cost +irq cycles (hardware stacking)
+// Parameters are estimates from the description of the QingKe pipeline. Calibrate
+// them with Time() measurement on target, e.g. with ch32/DEMO/FIXBENCH.
+//
+// WCH "XW" compressed extension (c.lbu, c.lhu, c.sb, c.sh and SP variants),
+// generated by GCC with -march=...xw, is decoded:
+//   Q0 001 c.lbu  rd',uimm(rs1')   uimm[0|4|3] = [12|11|10], uimm[2|1] = [6|5]
+//   Q0 101 c.sb   rs2',uimm(rs1')  same as c.lbu
+//   Q2 001 c.lhu  rd',uimm(rs1')   uimm[5|4|3] = [12|11|10], uimm[2|1] = [6|5]
+//   Q2 101 c.sh   rs2',uimm(rs1')  same as c.lhu
+//   Q0 100 00 ... SP based: [6] = store, [5] = halfword, reg' = [4:2],
+//                 byte uimm[3:0] = [10:7], halfword uimm[3:1] = [10:8], uimm[4] = [7]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// base types (see global.h)
+typedef int8_t s8;
+typedef uint8_t u8;
+typedef int16_t s16;
+typedef uint16_t u16;
+typedef int32_t s32;
+typedef uint32_t u32;
+typedef int64_t s64;
+typedef uint64_t u64;
+typedef unsigned char Bool;
+#define True 1
+#define False 0
+#define INLINE static inline
+#define B0 (1U<<0)
+#define B1 (1U<<1)
+#define B2 (1U<<2)
+#define B3 (1U<<3)
+#define B7 (1U<<7)
+#define B31 (1U<<31)
+
+// ----------------------------------------------------------------------------
+//                              Configuration
+// ----------------------------------------------------------------------------
+
+// CPU core
+#define CPU_V2A		0	// QingKe V2A, RV32EC
+#define CPU_V2C		1	// QingKe V2C, RV32EmC (multiplication only)
+#define CPU_V4		2	// QingKe V4, RV32IMAC
+
+// timing of instructions (additional clock cycles)
+typedef struct {
+	const char*	name;	// name of the CPU core
+	Bool	rve;		// only 16 registers
+	Bool	mul;		// has multiplication
+	Bool	div;		// has division
+	Bool	atom;		// has atomic instructions
+	int	jump;		// taken branch or jump
+	int	load;		// load from memory
+	int	store;		// store to memory
+	int	mul_clk;	// multiplication
+	int	div_clk;	// division
+	int	irq;		// interrupt entry or return
+} sTiming;
+
+const sTiming TimingTab[3] = {
+	//  name   rve    mul    div    atom   jump load store mul div irq
+	{ "v2a", True,  False, False, False, 1,   1,   1,    0,  0,  4 },
+	{ "v2c", True,  True,  False, False, 1,   1,   1,    1,  0,  4 },
+	{ "v4",  False, True,  True,  True,  2,   1,   0,    0,  16, 3 },
+};
+
+const sTiming* Tim = &TimingTab[CPU_V2A]; // current timing
+
+// memory
+#define FLASH_SIZE	0x40000		// size of Flash memory (256 KB)
+#define SRAM_BASE	0x20000000	// SRAM base address
+#define SRAM_SIZE	0x10000		// size of SRAM (64 KB)
+#define PERIPH_BASE	0x40000000	// peripherals base address
+#define PERIPH_SIZE	0x30000		// size of peripherals area
+#define CORE_BASE	0xE0000000	// core peripherals base address
+#define CORE_SIZE	0x10000		// size of core peripherals area
+#define SYSFLASH_BASE	0x1FFFF000	// system flash (option bytes, chip ID)
+#define SYSFLASH_SIZE	0x1000		// size of system flash
+
+// peripherals
+#define PFIC_BASE	0xE000E000	// interrupt controller
+#define SYSTICK_BASE	0xE000F000	// SysTick system counter
+#define TIM2_BASE	0x40000000	// TIM2 timer
+#define I2C1_BASE	0x40005400	// I2C1
+#define ADC1_BASE	0x40012400	// ADC1
+#define GPIOA_BASE	0x40010800	// GPIO port A
+#define GPIOD_BASE	0x40011400	// GPIO port D
+#define TIM1_BASE	0x40012C00	// TIM1 timer
+#define SPI1_BASE	0x40013000	// SPI1
+#define USART1_BASE	0x40013800	// USART1
+#define RCC_BASE	0x40021000	// RCC
+#define FLASHR_BASE	0x40022000	// flash registers
+
+// interrupts
+#define IRQ_SYSTICK	12		// SysTick interrupt
+#define IRQ_SW		14		// software interrupt
+#define IRQ_TIM1_UP	35		// TIM1 update interrupt
+#define IRQ_TIM1_CC	36		// TIM1 capture/compare interrupt
+#define IRQ_TIM2	38		// TIM2 interrupt
+#define IRQ_NUM		64		// max. number of interrupts
+
+// CSR registers
+#define CSR_MSTATUS	0x300
+#define CSR_MTVEC	0x305
+#define CSR_MEPC	0x341
+#define CSR_MCAUSE	0x342
+#define CSR_GINTENR	0x800		// global interrupt enable (alias of MIE and MPIE of mstatus)
+#define CSR_INTSYSCR	0x804		// interrupt system control (B0: HPE enable, B1: nesting enable)
+
+#define MSTATUS_MIE	B3		// interrupt enable
+#define MSTATUS_MPIE	B7		// previous interrupt enable
+
+// ----------------------------------------------------------------------------
+//                                  State
+// ----------------------------------------------------------------------------
+
+// memory
+u8 Flash[FLASH_SIZE];		// Flash memory
+u8 Sram[SRAM_SIZE];		// SRAM memory
+u8 Periph[PERIPH_SIZE];		// peripheral registers
+u8 Core[CORE_SIZE];		// core peripheral registers
+u8 SysFlash[SYSFLASH_SIZE];	// system flash
+
+// CPU
+u32 Reg[32];			// registers (x0 is always 0)
+u32 Pc;				// program counter
+u32 Csr[4096];			// CSR registers
+u64 Cycles = 0;			// clock cycle counter
+u64 Instr = 0;			// instruction counter
+u32 MinSp = 0xffffffff;		// minimal stack pointer
+Bool Halt = False;		// stop simulation
+int ExitCode = 0;		// exit code
+const char* HaltMsg = "";	// reason of stop
+int WaitStates = -1;		// flash wait states (-1 = use FLASH->ACTLR)
+u32 FetchWord = 1;		// address of last fetched word from Flash (1 = none)
+
+// interrupts
+u64 IrqEnable = 0;		// enabled interrupts (PFIC->IENR)
+u64 IrqSwPend = 0;		// software pending interrupts (PFIC->IPSR)
+u64 IrqHwPend = 0;		// pending interrupt requests from peripherals
+u64 IrqCount = 0;		// number of served interrupts
+
+#define HPE_DEPTH	8		// max. nesting level of interrupts
+typedef struct {
+	u32	reg[32];	// saved registers
+	int	irq;		// interrupt number
+	u8	prio;		// priority of the interrupt
+} sHpe;
+sHpe Hpe[HPE_DEPTH];		// hardware stacking of registers
+int HpeNum = 0;			// current nesting level of interrupts
+
+// peripherals
+u32 SysTickDiv = 0;		// SysTick prescaler HCLK/8
+u32 TimDiv[2];			// TIM1 and TIM2 prescaler counter
+u64 SpiBytes = 0;		// number of bytes sent to SPI1
+u64 UsartBytes = 0;		// number of bytes sent to USART1
+Bool UsartOut = True;		// print USART1 output
+Bool Trace = False;		// trace instructions
+
+// ----------------------------------------------------------------------------
+//                               Symbols
+// ----------------------------------------------------------------------------
+
+// function symbol with statistics
+typedef struct {
+	char*	name;		// name of the function
+	u32	addr;		// start address
+	u32	size;		// size in bytes
+	u64	self;		// cycles spent in the function itself
+	u64	incl;		// cycles spent in the function including called functions
+	u64	instr;		// number of instructions
+	u64	calls;		// number of calls
+	u64	min;		// min. cycles per call
+	u64	max;		// max. cycles per call
+	int	active;		// number of active calls (recursion)
+} sFunc;
+
+sFunc* Func = NULL;		// list of functions, sorted by address
+int FuncNum = 0;		// number of functions
+int FuncCur = -1;		// current function (-1 = unknown)
+int BenchFunc = -1;		// benchmarked function (-1 = none)
+int StopFunc = -1;		// stop on function (-1 = none)
+
+// shadow call stack
+#define CALL_DEPTH	256
+typedef struct {
+	int	func;		// called function
+	u32	ret;		// return address
+	u64	start;		// cycle counter on entry
+} sCall;
+sCall CallStack[CALL_DEPTH];
+int CallNum = 0;
+Bool CallFlow = False;		// call stack was changed by call, return or interrupt in current instruction
+
+// map Flash alias address 0x08xxxxxx to 0x00xxxxxx
+INLINE u32 AddrMap(u32 addr) { return ((addr >> 24) == 0x08) ? (addr & 0x00ffffff) : addr; }
+
+// find function by address (returns -1 if not found)
+int FuncFind(u32 addr)
+{
+	addr = AddrMap(addr);
+	if ((FuncCur >= 0) && (addr - Func[FuncCur].addr < Func[FuncCur].size)) return FuncCur;
+	int lo = 0, hi = FuncNum - 1;
+	while (lo <= hi)
+	{
+		int mid = (lo + hi) / 2;
+		sFunc* f = &Func[mid];
+		if (addr < f->addr)
+			hi = mid - 1;
+		else if (addr >= f->addr + f->size)
+			lo = mid + 1;
+		else
+			return mid;
+	}
+	return -1;
+}
+
+// find function by name (returns -1 if not found)
+int FuncFindName(const char* name)
+{
+	int i;
+	for (i = 0; i < FuncNum; i++) if (strcmp(Func[i].name, name) == 0) return i;
+	return -1;
+}
+
+// function name with offset
+const char* FuncName(u32 addr)
+{
+	static char buf[200];
+	int f = FuncFind(addr);
+	if (f < 0)
+		snprintf(buf, sizeof(buf), "?");
+	else
+		snprintf(buf, sizeof(buf), "%s+0x%X", Func[f].name, AddrMap(addr) - Func[f].addr);
+	return buf;
+}
+
+// push new frame on call stack (f = function, -1 = unknown code; ret = return address)
+void CallPush(int f, u32 ret)
+{
+	if (CallNum >= CALL_DEPTH)
+	{
+		memmove(&CallStack[0], &CallStack[1], (CALL_DEPTH-1)*sizeof(sCall));
+		CallNum--;
+	}
+	sCall* c = &CallStack[CallNum++];
+	c->func = f;
+	c->ret = ret;
+	c->start = Cycles;
+	CallFlow = True;
+	if (f < 0) return;
+	Func[f].calls++;
+	Func[f].active++;
+	if (f == StopFunc)
+	{
+		Halt = True;
+		HaltMsg = "stop function called";
+	}
+}
+
+// pop frame from call stack and update statistics of the function
+void CallPop(void)
+{
+	sCall* c = &CallStack[--CallNum];
+	CallFlow = True;
+	if (c->func < 0) return;
+	sFunc* f = &Func[c->func];
+	u64 t = Cycles - c->start;
+	f->active--;
+	if (f->active == 0) f->incl += t;
+	if ((f->min == 0) || (t < f->min)) f->min = t;
+	if (t > f->max) f->max = t;
+}
+
+// call function (jump with link to target address, or interrupt entry)
+// - Unknown code gets a frame too, so it can be paired with its return.
+void CallEnter(u32 target, u32 ret)
+{
+	CallPush(FuncFind(target), ret);
+}
+
+// return from function (pop frames up to the return address; returns False if no frame matches)
+Bool CallLeave(u32 target)
+{
+	int i;
+	for (i = CallNum-1; (i >= 0) && (i >= CallNum - 8); i--)
+	{
+		if (CallStack[i].ret == target)
+		{
+			while (CallNum > i) CallPop();
+			return True;
+		}
+	}
+	return False;
+}
+
+// transfer from function 'from' to other function 'to' without call and return
+// (tail call "j func" or "jr t0", jump or fall-through into assembler label)
+// - The frame of the current function is replaced by the new function with the
+//   same return address. If the current function has no frame on top of the stack,
+//   the new frame is nested and it is closed together with the enclosing frame.
+void CallTail(int from, int to)
+{
+	if (to < 0) return;
+	u32 ret = 1; // not a valid return address
+	if ((CallNum > 0) && ((CallStack[CallNum-1].func == from) || (CallStack[CallNum-1].func < 0)))
+	{
+		ret = CallStack[CallNum-1].ret;
+		CallPop();
+	}
+	CallPush(to, ret);
+}
+
+// load symbols from ELF symbol table: LoadSymbols() (shared with _tools/prof)
+#include "elfsym.h"
+
+// ----------------------------------------------------------------------------
+//                               ELF loader
+// ----------------------------------------------------------------------------
+
+// get pointer to memory (returns NULL on invalid address)
+u8* MemPtr(u32 addr, u32 size)
+{
+	u32 top = addr >> 24;
+	if ((top == 0x00) || (top == 0x08))
+	{
+		addr &= 0x00ffffff;
+		if (addr + size <= FLASH_SIZE) return &Flash[addr];
+	}
+	else if (addr - SRAM_BASE + size <= SRAM_SIZE) return &Sram[addr - SRAM_BASE];
+	return NULL;
+}
+
+// load ELF file (returns False on error)
+Bool LoadElf(const char* name)
+{
+	FILE* f = fopen(name, "rb");
+	if (f == NULL) { fprintf(stderr, "Cannot open %s\n", name); return False; }
+	fseek(f, 0, SEEK_END);
+	u32 len = (u32)ftell(f);
+	fseek(f, 0, SEEK_SET);
+	u8* elf = (u8*)malloc(len);
+	if (fread(elf, 1, len, f) != len) { fclose(f); fprintf(stderr, "Cannot read %s\n", name); return False; }
+	fclose(f);
+
+	// check header (32-bit, little endian, RISC-V)
+	if ((len < 0x34) || (memcmp(elf, "\177ELF", 4) != 0) || (elf[4] != 1) || (elf[5] != 1)
+		|| (*(u16*)&elf[0x12] != 243))
+	{
+		fprintf(stderr, "%s is not 32-bit RISC-V ELF file\n", name);
+		return False;
+	}
+
+	// load program segments to load addresses
+	u32 phoff = *(u32*)&elf[0x1C];
+	u16 phentsize = *(u16*)&elf[0x2A];
+	u16 phnum = *(u16*)&elf[0x2C];
+	if ((phnum > 0) && ((phentsize < 0x20) || !ElfRange(phoff, (u32)phnum*phentsize, len)))
+	{
+		fprintf(stderr, "%s has invalid program header table\n", name);
+		return False;
+	}
+	int i;
+	for (i = 0; i < phnum; i++)
+	{
+		const u8* ph = &elf[phoff + i*phentsize];
+		if (*(const u32*)&ph[0] != 1) continue; // PT_LOAD
+		u32 off = *(const u32*)&ph[4];
+		u32 paddr = *(const u32*)&ph[0x0C];
+		u32 filesz = *(const u32*)&ph[0x10];
+		if (filesz == 0) continue;
+		if (!ElfRange(off, filesz, len))
+		{
+			fprintf(stderr, "Segment 0x%08X size %u is out of file\n", paddr, filesz);
+			return False;
+		}
+		u8* d = MemPtr(paddr, filesz);
+		if (d == NULL)
+		{
+			fprintf(stderr, "Segment 0x%08X size %u is out of memory\n", paddr, filesz);
+			return False;
+		}
+		memcpy(d, &elf[off], filesz);
+	}
+
+	Pc = *(u32*)&elf[0x18];
+	if (!LoadSymbols(elf, len))
+	{
+		fprintf(stderr, "%s has invalid section or symbol table\n", name);
+		free(elf);
+		return False;
+	}
+	free(elf);
+	return True;
+}
+
+// ----------------------------------------------------------------------------
+//                              Peripherals
+// ----------------------------------------------------------------------------
+
+#define PERIPH32(addr) (*(u32*)&Periph[(addr) - PERIPH_BASE])
+#define CORE32(addr) (*(u32*)&Core[(addr) - CORE_BASE])
+
+#define SYSTICK_CTLR	CORE32(SYSTICK_BASE + 0x00)
+#define SYSTICK_SR	CORE32(SYSTICK_BASE + 0x04)
+#define SYSTICK_CNT	CORE32(SYSTICK_BASE + 0x08)
+#define SYSTICK_CMP	CORE32(SYSTICK_BASE + 0x10)
+
+// timer registers
+#define TIM_CTLR1(base)	PERIPH32((base) + 0x00)
+#define TIM_DIER(base)	PERIPH32((base) + 0x0C)
+#define TIM_INTFR(base)	PERIPH32((base) + 0x10)
+#define TIM_CNT(base)	PERIPH32((base) + 0x24)
+#define TIM_PSC(base)	PERIPH32((base) + 0x28)
+#define TIM_ATRLR(base)	PERIPH32((base) + 0x2C)
+#define TIM_CHCVR(base,ch) PERIPH32((base) + 0x34 + (ch)*4)
+
+const u32 TimBase[2] = { TIM1_BASE, TIM2_BASE };
+const int TimIrq[2] = { IRQ_TIM1_UP, IRQ_TIM2 }; // update interrupt
+const int TimIrqCC[2] = { IRQ_TIM1_CC, IRQ_TIM2 }; // capture/compare interrupt
+
+// update interrupt request from peripherals
+void IrqUpdate(void)
+{
+	u64 p = 0;
+	if (((SYSTICK_SR & B0) != 0) && ((SYSTICK_CTLR & B1) != 0)) p |= 1ULL << IRQ_SYSTICK;
+	int i;
+	for (i = 0; i < 2; i++)
+	{
+		u32 base = TimBase[i];
+		u32 f = TIM_INTFR(base) & TIM_DIER(base);
+		if ((f & B0) != 0) p |= 1ULL << TimIrq[i];
+		if ((f & 0x1e) != 0) p |= 1ULL << TimIrqCC[i];
+	}
+	IrqHwPend = p;
+}
+
+// advance peripherals by number of clock cycles
+void PeriphTime(u32 clk)
+{
+	Bool upd = False;
+
+	// SysTick counter
+	u32 ctlr = SYSTICK_CTLR;
+	if ((ctlr & B0) != 0)
+	{
+		u32 n = clk;
+		if ((ctlr & B2) == 0)
+		{
+			// HCLK/8
+			SysTickDiv += clk;
+			n = SysTickDiv >> 3;
+			SysTickDiv &= 7;
+		}
+		if (n > 0)
+		{
+			u32 cnt = SYSTICK_CNT;
+			u32 cmp = SYSTICK_CMP;
+			if ((u32)(cmp - cnt - 1) < n)
+			{
+				// compare match
+				SYSTICK_SR |= B0;
+				upd = True;
+				if ((ctlr & B3) != 0)
+					cnt = n - (cmp - cnt) - 1;
+				else
+					cnt += n;
+			}
+			else
+				cnt += n;
+			SYSTICK_CNT = cnt;
+		}
+	}
+
+	// timers TIM1 and TIM2 (up counting)
+	int i;
+	for (i = 0; i < 2; i++)
+	{
+		u32 base = TimBase[i];
+		if ((TIM_CTLR1(base) & B0) == 0) continue;
+		u32 psc = (TIM_PSC(base) & 0xffff) + 1;
+		TimDiv[i] += clk;
+		if (TimDiv[i] < psc) continue;
+		u32 n = TimDiv[i] / psc;
+		TimDiv[i] -= n * psc;
+		u32 old = TIM_CNT(base) & 0xffff;
+		u32 cnt = old + n;
+		u32 arr = (TIM_ATRLR(base) & 0xffff) + 1;
+
+		// compare match of channels 1..4 (counter passed compare value)
+		int ch;
+		for (ch = 0; ch < 4; ch++)
+		{
+			u32 cmp = TIM_CHCVR(base, ch) & 0xffff;
+			if ((cmp < arr) && (((cmp > old) && (cmp <= cnt)) || ((cnt >= arr) && (cmp <= cnt - arr))))
+			{
+				TIM_INTFR(base) |= B1 << ch;
+				upd = True;
+			}
+		}
+
+		// update event
+		if (cnt >= arr)
+		{
+			cnt %= arr;
+			TIM_INTFR(base) |= B0;
+			upd = True;
+		}
+		TIM_CNT(base) = cnt;
+	}
+
+	if (upd) IrqUpdate();
+}
+
+// number of clock cycles to next peripheral event (0 = no event)
+u32 PeriphNextEvent(void)
+{
+	u32 next = 0;
+	u32 ctlr = SYSTICK_CTLR;
+	if ((ctlr & (B0|B1)) == (B0|B1))
+	{
+		next = SYSTICK_CMP - SYSTICK_CNT;
+		if ((ctlr & B2) == 0) next *= 8;
+		if (next == 0) next = 1;
+	}
+	int i;
+	for (i = 0; i < 2; i++)
+	{
+		u32 base = TimBase[i];
+		u32 dier = TIM_DIER(base);
+		if (((TIM_CTLR1(base) & B0) == 0) || ((dier & 0x1f) == 0)) continue;
+		u32 psc = (TIM_PSC(base) & 0xffff) + 1;
+		u32 cnt = TIM_CNT(base) & 0xffff;
+		u32 arr = (TIM_ATRLR(base) & 0xffff) + 1;
+		u32 n = arr - cnt; // update event
+		int ch;
+		for (ch = 0; ch < 4; ch++)
+		{
+			u32 cmp = TIM_CHCVR(base, ch) & 0xffff;
+			if (((dier & (B1 << ch)) != 0) && (cmp > cnt) && (cmp < arr) && (cmp - cnt < n)) n = cmp - cnt;
+		}
+		n *= psc;
+		if ((next == 0) || (n < next)) next = n;
+	}
+	return next;
+}
+
+// read peripheral register
+u32 PeriphRead(u32 addr)
+{
+	u32 a = addr & ~3;
+	u32 val = PERIPH32(a);
+	switch (a)
+	{
+	// RCC->CTLR: HSIRDY, HSERDY and PLLRDY follow enable bits
+	case RCC_BASE + 0x00:
+		val |= ((val & B0) << 1) | ((val & (1U<<16)) << 1) | ((val & (1U<<24)) << 1);
+		break;
+
+	// RCC->CFGR0: SWS follows SW
+	case RCC_BASE + 0x04:
+		val = (val & ~0x0c) | ((val & 3) << 2);
+		break;
+
+	// FLASH->STATR: not busy
+	case FLASHR_BASE + 0x0C:
+		val &= ~B0;
+		break;
+
+	// USART1->STATR: transmitter is always empty
+	case USART1_BASE + 0x00:
+		val |= B7 | (1U<<6);
+		break;
+
+	// SPI1->STATR: transmitter empty, receiver ready, not busy
+	case SPI1_BASE + 0x08:
+		val = (val & ~B7) | B1 | B0;
+		break;
+
+	// SPI1->DATAR: received data (MISO is pulled up)
+	case SPI1_BASE + 0x0C:
+		val = 0xff;
+		break;
+
+	// ADC1->STATR: conversion is complete
+	case ADC1_BASE + 0x00:
+		val |= B1 | B2;
+		break;
+
+	// ADC1->CTLR2: calibration is complete
+	case ADC1_BASE + 0x08:
+		val &= ~(B2 | B3);
+		break;
+
+	// I2C1->STAR1: start sent, address sent, byte transferred, receiver ready, transmitter empty
+	case I2C1_BASE + 0x14:
+		val = B0 | B1 | B2 | (1U<<6) | B7;
+		break;
+
+	// I2C1->STAR2: not busy
+	case I2C1_BASE + 0x18:
+		val = 0;
+		break;
+	}
+
+	// GPIOx->INDR: inputs read the output register (pull-ups, keys are released)
+	if ((a >= GPIOA_BASE) && (a < GPIOD_BASE + 0x400) && ((a & 0x3ff) == 0x08))
+		val = PERIPH32(a + 4);
+
+	return val >> ((addr & 3)*8);
+}
+
+// write peripheral register
+void PeriphWrite(u32 addr, u32 val, u32 mask)
+{
+	u32 a = addr & ~3;
+	int sh = (addr & 3)*8;
+	val <<= sh;
+	mask <<= sh;
+
+	// GPIOx->BSHR and GPIOx->BCR
+	if ((a >= GPIOA_BASE) && (a < GPIOD_BASE + 0x400))
+	{
+		u32 port = a & ~0x3ff;
+		switch (a & 0x3ff)
+		{
+		case 0x10:
+			PERIPH32(port + 0x0C) = (PERIPH32(port + 0x0C) | (val & 0xffff)) & ~(val >> 16);
+			return;
+		case 0x14:
+			PERIPH32(port + 0x0C) &= ~(val & 0xffff);
+			return;
+		}
+	}
+
+	switch (a)
+	{
+	// USART1->DATAR: send character
+	case USART1_BASE + 0x04:
+		UsartBytes++;
+		if (UsartOut) { putchar((u8)val); fflush(stdout); }
+		return;
+
+	// SPI1->DATAR: send data
+	case SPI1_BASE + 0x0C:
+		SpiBytes++;
+		return;
+	}
+
+	PERIPH32(a) = (PERIPH32(a) & ~mask) | (val & mask);
+
+	// timer interrupt flags or interrupt enable changed
+	if ((a - TIM1_BASE <= 0x10) || (a - TIM2_BASE <= 0x10)) IrqUpdate();
+}
+
+// write core peripheral register
+void CoreWrite(u32 addr, u32 val, u32 mask)
+{
+	u32 a = addr & ~3;
+	int sh = (addr & 3)*8;
+	val <<= sh;
+	mask <<= sh;
+	val &= mask;
+
+	// PFIC->IENR, IRER, IPSR, IPRR
+	if ((a >= PFIC_BASE + 0x100) && (a < PFIC_BASE + 0x300) && ((a & 0x7f) < 8))
+	{
+		u64 bits = (u64)val << (((a & 0x7f) >> 2) * 32);
+		switch ((a - PFIC_BASE) & 0x380)
+		{
+		case 0x100: IrqEnable |= bits; break;
+		case 0x180: IrqEnable &= ~bits; break;
+		case 0x200: IrqSwPend |= bits; break;
+		case 0x280: IrqSwPend &= ~bits; break;
+		}
+		return;
+	}
+
+	// PFIC->CFGR (with key) or PFIC->SCTLR: system reset
+	if (((a == PFIC_BASE + 0x48) && ((val & 0xffff0000) == 0xBEEF0000) && ((val & B7) != 0)) ||
+		((a == PFIC_BASE + 0xD10) && ((val & B31) != 0)))
+	{
+		Halt = True;
+		HaltMsg = "system reset";
+		return;
+	}
+
+	CORE32(a) = (CORE32(a) & ~mask) | val;
+
+	// SysTick: software interrupt, status changed
+	if ((a >= SYSTICK_BASE) && (a < SYSTICK_BASE + 0x14))
+	{
+		if ((SYSTICK_CTLR & B31) != 0) IrqSwPend |= 1ULL << IRQ_SYSTICK;
+		IrqUpdate();
+	}
+}
+
+// read core peripheral register
+u32 CoreRead(u32 addr)
+{
+	u32 a = addr & ~3;
+	u32 val = CORE32(a);
+	if ((a >= PFIC_BASE) && (a < PFIC_BASE + 0x10))
+		val = (u32)(IrqEnable >> ((a - PFIC_BASE) >> 2) * 32); // PFIC->ISR
+	else if ((a >= PFIC_BASE + 0x20) && (a < PFIC_BASE + 0x30))
+		val = (u32)((IrqSwPend | IrqHwPend) >> ((a - PFIC_BASE - 0x20) >> 2) * 32); // PFIC->IPR
+	return val >> ((addr & 3)*8);
+}
+
+// ----------------------------------------------------------------------------
+//                             Memory access
+// ----------------------------------------------------------------------------
+
+// memory access error
+void MemError(u32 addr, const char* what)
+{
+	static char buf[200];
+	snprintf(buf, sizeof(buf), "invalid %s at address 0x%08X", what, addr);
+	HaltMsg = buf;
+	Halt = True;
+	ExitCode = 2;
+}
+
+// current flash wait states
+INLINE int FlashWait(void)
+{
+	return (WaitStates >= 0) ? WaitStates : (int)(PERIPH32(FLASHR_BASE) & 3);
+}
+
+// load data from memory (size = 1, 2 or 4)
+u32 Load(u32 addr, int size)
+{
+	if ((addr & (size-1)) != 0) { MemError(addr, "unaligned load"); return 0; }
+	Cycles += Tim->load;
+	u32 top = addr >> 24;
+	if ((top == 0x00) || (top == 0x08))
+	{
+		u32 a = addr & 0x00ffffff;
+		if (a < FLASH_SIZE)
+		{
+			Cycles += FlashWait();
+			if (size == 1) return Flash[a];
+			if (size == 2) return *(u16*)&Flash[a];
+			return *(u32*)&Flash[a];
+		}
+	}
+	else if (addr - SRAM_BASE < SRAM_SIZE)
+	{
+		u32 a = addr - SRAM_BASE;
+		if (size == 1) return Sram[a];
+		if (size == 2) return *(u16*)&Sram[a];
+		return *(u32*)&Sram[a];
+	}
+	else if (addr - PERIPH_BASE < PERIPH_SIZE)
+	{
+		u32 val = PeriphRead(addr);
+		return (size == 4) ? val : (val & ((1U << (size*8)) - 1));
+	}
+	else if (addr - CORE_BASE < CORE_SIZE)
+	{
+		u32 val = CoreRead(addr);
+		return (size == 4) ? val : (val & ((1U << (size*8)) - 1));
+	}
+	else if (addr - SYSFLASH_BASE < SYSFLASH_SIZE)
+	{
+		u32 a = addr - SYSFLASH_BASE;
+		if (size == 1) return SysFlash[a];
+		if (size == 2) return *(u16*)&SysFlash[a];
+		return *(u32*)&SysFlash[a];
+	}
+	MemError(addr, "load");
+	return 0;
+}
+
+// store data to memory (size = 1, 2 or 4)
+void Store(u32 addr, u32 val, int size)
+{
+	if ((addr & (size-1)) != 0) { MemError(addr, "unaligned store"); return; }
+	Cycles += Tim->store;
+	if (addr - SRAM_BASE < SRAM_SIZE)
+	{
+		u32 a = addr - SRAM_BASE;
+		if (size == 1)
+			Sram[a] = (u8)val;
+		else if (size == 2)
+			*(u16*)&Sram[a] = (u16)val;
+		else
+			*(u32*)&Sram[a] = val;
+		return;
+	}
+	u32 mask = (size == 4) ? 0xffffffff : ((1U << (size*8)) - 1);
+	if (addr - PERIPH_BASE < PERIPH_SIZE)
+		PeriphWrite(addr, val & mask, mask);
+	else if (addr - CORE_BASE < CORE_SIZE)
+		CoreWrite(addr, val & mask, mask);
+	else if (((addr >> 24) == 0x08) || ((addr >> 24) == 0x00) || (addr - SYSFLASH_BASE < SYSFLASH_SIZE))
+		; // writing to Flash is ignored (programming is not emulated)
+	else
+		MemError(addr, "store");
+}
+
+// fetch 16-bit instruction halfword, count flash wait states of new 32-bit words
+u16 Fetch16(u32 addr)
+{
+	u32 top = addr >> 24;
+	if ((top == 0x00) || (top == 0x08))
+	{
+		u32 a = addr & 0x00ffffff;
+		if (a + 2 <= FLASH_SIZE)
+		{
+			u32 w = a & ~3;
+			if (w != FetchWord)
+			{
+				FetchWord = w;
+				Cycles += FlashWait();
+			}
+			return *(u16*)&Flash[a];
+		}
+	}
+	else if (addr - SRAM_BASE + 2 <= SRAM_SIZE)
+	{
+		FetchWord = 1;
+		return *(u16*)&Sram[addr - SRAM_BASE];
+	}
+	MemError(addr, "instruction fetch");
+	return 0;
+}
+
+// ----------------------------------------------------------------------------
+//                              CSR registers
+// ----------------------------------------------------------------------------
+
+// read CSR register
+u32 CsrRead(int csr)
+{
+	switch (csr)
+	{
+	case CSR_GINTENR: return Csr[CSR_MSTATUS] & (MSTATUS_MIE | MSTATUS_MPIE);
+	case 0xB00: case 0xC00: return (u32)Cycles; // mcycle, cycle
+	case 0xB80: case 0xC80: return (u32)(Cycles >> 32); // mcycleh, cycleh
+	case 0xB02: case 0xC02: return (u32)Instr; // minstret, instret
+	case 0xB82: case 0xC82: return (u32)(Instr >> 32); // minstreth, instreth
+	case 0xF11: return 0x00000612; // mvendorid WCH
+	}
+	return Csr[csr];
+}
+
+// write CSR register
+void CsrWrite(int csr, u32 val)
+{
+	if (csr == CSR_GINTENR)
+		Csr[CSR_MSTATUS] = (Csr[CSR_MSTATUS] & ~(MSTATUS_MIE | MSTATUS_MPIE)) | (val & (MSTATUS_MIE | MSTATUS_MPIE));
+	else if ((csr >> 10) != 3) // not read-only
+		Csr[csr] = val;
+}
+
+// ----------------------------------------------------------------------------
+//                               Interrupts
+// ----------------------------------------------------------------------------
+
+// jump to interrupt or exception handler
+void TrapEnter(u32 cause, int irq)
+{
+	u32 ms = Csr[CSR_MSTATUS];
+	ms = (ms & ~MSTATUS_MPIE) | ((ms & MSTATUS_MIE) << 4);
+	ms &= ~MSTATUS_MIE;
+	Csr[CSR_MSTATUS] = ms;
+	Csr[CSR_MEPC] = Pc;
+	Csr[CSR_MCAUSE] = cause;
+
+	// hardware stacking of registers (HPE)
+	if (((Csr[CSR_INTSYSCR] & B0) != 0) && (HpeNum < HPE_DEPTH))
+	{
+		sHpe* h = &Hpe[HpeNum++];
+		memcpy(h->reg, Reg, sizeof(Reg));
+		h->irq = irq;
+		h->prio = (irq >= 0) ? Core[PFIC_BASE + 0x400 + irq - CORE_BASE] : 0;
+	}
+
+	// vector table
+	u32 tvec = Csr[CSR_MTVEC];
+	u32 base = tvec & ~3;
+	int n = (cause & B31) ? (cause & 0x3ff) : 3; // exceptions use HardFault vector
+	switch (tvec & 3)
+	{
+	case 0: Pc = base; break;
+	case 1: Pc = base + n*4; break;
+	default: Pc = Load(base + n*4, 4) & ~1; break;
+	}
+	Cycles += Tim->irq;
+	FetchWord = 1;
+	CallEnter(Pc, Csr[CSR_MEPC]);
+}
+
+// return from interrupt
+void TrapLeave(void)
+{
+	u32 ms = Csr[CSR_MSTATUS];
+	ms = (ms & ~MSTATUS_MIE) | ((ms & MSTATUS_MPIE) >> 4) | MSTATUS_MPIE;
+	Csr[CSR_MSTATUS] = ms;
+	Pc = Csr[CSR_MEPC];
+	if (((Csr[CSR_INTSYSCR] & B0) != 0) && (HpeNum > 0))
+	{
+		HpeNum--;
+		memcpy(Reg, Hpe[HpeNum].reg, sizeof(Reg));
+		// restore with nesting enabled, the previous level can be interrupted again
+		if (HpeNum > 0) Csr[CSR_MSTATUS] |= MSTATUS_MIE;
+	}
+	Cycles += Tim->irq;
+	FetchWord = 1;
+	CallLeave(Pc);
+}
+
+// check and serve pending interrupt
+void IrqCheck(void)
+{
+	u64 pend = (IrqSwPend | IrqHwPend) & IrqEnable;
+	if (pend == 0) return;
+
+	// select pending interrupt with highest priority (lowest number)
+	int i, irq = -1;
+	u8 prio = 0xff;
+	for (i = 0; i < IRQ_NUM; i++)
+	{
+		if ((pend & (1ULL << i)) == 0) continue;
+		u8 p = Core[PFIC_BASE + 0x400 + i - CORE_BASE];
+		if ((irq < 0) || (p < prio)) { irq = i; prio = p; }
+	}
+
+	// nesting: interrupt in handler only with higher priority
+	if ((HpeNum > 0) && (((Csr[CSR_INTSYSCR] & B1) == 0) || (prio >= Hpe[HpeNum-1].prio))) return;
+	if ((Csr[CSR_MSTATUS] & MSTATUS_MIE) == 0) return;
+
+	IrqSwPend &= ~(1ULL << irq);
+	IrqCount++;
+	TrapEnter(B31 | irq, irq);
+}
+
+// ----------------------------------------------------------------------------
+//                               Execution
+// ----------------------------------------------------------------------------
+
+// illegal instruction
+void Illegal(u32 ins)
+{
+	static char buf[200];
+	snprintf(buf, sizeof(buf), "illegal instruction 0x%08X at 0x%08X %s", ins, Pc, FuncName(Pc));
+	HaltMsg = buf;
+	Halt = True;
+	ExitCode = 2;
+}
+
+// sign extension of N-bit value
+INLINE s32 Sext(u32 val, int bits) { return (s32)(val << (32 - bits)) >> (32 - bits); }
+
+// get bit field
+#define BITS(ins, hi, lo) (((ins) >> (lo)) & ((1U << ((hi) - (lo) + 1)) - 1))
+#define BIT(ins, n) (((ins) >> (n)) & 1)
+
+// check register number (RV32E has only 16 registers)
+INLINE Bool RegOk(u32 r) { return !Tim->rve || (r < 16); }
+
+// write register
+INLINE void SetReg(u32 r, u32 val)
+{
+	if (r != 0)
+	{
+		Reg[r] = val;
+		if ((r == 2) && (val < MinSp) && (val - SRAM_BASE < SRAM_SIZE)) MinSp = val;
+	}
+}
+
+// jump to address (link register rd; counts pipeline refill and call/return statistics)
+void Jump(u32 target, u32 rd, u32 link, Bool ret)
+{
+	SetReg(rd, link);
+	Cycles += Tim->jump;
+	FetchWord = 1;
+	if ((rd == 1) || (rd == 5))
+		CallEnter(target, link);
+	else if (ret)
+		CallLeave(target); // if no frame matches, Step() handles it as tail call
+	if ((target == Pc) && (rd == 0))
+	{
+		// endless loop "j ." - wait for interrupt or halt
+		u32 next = PeriphNextEvent();
+		if (((Csr[CSR_MSTATUS] & MSTATUS_MIE) == 0) || (next == 0))
+		{
+			Halt = True;
+			HaltMsg = "endless loop";
+		}
+		else
+		{
+			Cycles += next;
+			PeriphTime(next);
+		}
+	}
+	Pc = target;
+}
+
+// multiplication and division (funct3 of M extension)
+u32 MulDiv(int f3, u32 a, u32 b)
+{
+	switch (f3)
+	{
+	case 0: return a * b; // mul
+	case 1: return (u32)(((s64)(s32)a * (s64)(s32)b) >> 32); // mulh
+	case 2: return (u32)(((s64)(s32)a * (s64)(u64)b) >> 32); // mulhsu
+	case 3: return (u32)(((u64)a * (u64)b) >> 32); // mulhu
+	case 4: // div
+		if (b == 0) return 0xffffffff;
+		if ((a == 0x80000000) && (b == 0xffffffff)) return a;
+		return (u32)((s32)a / (s32)b);
+	case 5: return (b == 0) ? 0xffffffff : (a / b); // divu
+	case 6: // rem
+		if (b == 0) return a;
+		if ((a == 0x80000000) && (b == 0xffffffff)) return 0;
+		return (u32)((s32)a % (s32)b);
+	default: return (b == 0) ? a : (a % b); // remu
+	}
+}
+
+// execute 32-bit instruction
+void Exec32(u32 ins)
+{
+	u32 op = ins & 0x7f;
+	u32 rd = BITS(ins, 11, 7);
+	u32 f3 = BITS(ins, 14, 12);
+	u32 rs1 = BITS(ins, 19, 15);
+	u32 rs2 = BITS(ins, 24, 20);
+	u32 f7 = BITS(ins, 31, 25);
+
+	// check register numbers used by instruction format
+	Bool ok = True;
+	if ((op != 0x63) && (op != 0x23)) ok = RegOk(rd); // not branch or store (no rd)
+	if ((op != 0x37) && (op != 0x17) && (op != 0x6f) && !((op == 0x73) && (f3 & 4))) ok = ok && RegOk(rs1); // not LUI, AUIPC, JAL, CSRxI
+	if ((op == 0x63) || (op == 0x23) || (op == 0x33) || (op == 0x2f)) ok = ok && RegOk(rs2); // branch, store, ALU, atomic
+	if (!ok) { Illegal(ins); return; }
+	u32 a = Reg[rs1];
+	u32 b = Reg[rs2];
+	s32 imm = (s32)ins >> 20;
+	u32 next = Pc + 4;
+
+	switch (op)
+	{
+	// LUI
+	case 0x37:
+		SetReg(rd, ins & 0xfffff000);
+		break;
+
+	// AUIPC
+	case 0x17:
+		SetReg(rd, Pc + (ins & 0xfffff000));
+		break;
+
+	// JAL
+	case 0x6f:
+		{
+			s32 off = (BIT(ins, 31) << 20) | (BITS(ins, 19, 12) << 12) | (BIT(ins, 20) << 11) | (BITS(ins, 30, 21) << 1);
+			Jump(Pc + Sext(off, 21), rd, next, False);
+		}
+		return;
+
+	// JALR
+	case 0x67:
+		Jump((a + imm) & ~1, rd, next, (rd == 0) && ((rs1 == 1) || (rs1 == 5)));
+		return;
+
+	// branch
+	case 0x63:
+		{
+			Bool t;
+			switch (f3)
+			{
+			case 0: t = (a == b); break;
+			case 1: t = (a != b); break;
+			case 4: t = ((s32)a < (s32)b); break;
+			case 5: t = ((s32)a >= (s32)b); break;
+			case 6: t = (a < b); break;
+			case 7: t = (a >= b); break;
+			default: Illegal(ins); return;
+			}
+			if (t)
+			{
+				s32 off = (BIT(ins, 31) << 12) | (BIT(ins, 7) << 11) | (BITS(ins, 30, 25) << 5) | (BITS(ins, 11, 8) << 1);
+				Jump(Pc + Sext(off, 13), 0, 0, False);
+				return;
+			}
+		}
+		break;
+
+	// load
+	case 0x03:
+		{
+			u32 addr = a + imm;
+			switch (f3)
+			{
+			case 0: SetReg(rd, (u32)(s8)Load(addr, 1)); break;
+			case 1: SetReg(rd, (u32)(s16)Load(addr, 2)); break;
+			case 2: SetReg(rd, Load(addr, 4)); break;
+			case 4: SetReg(rd, Load(addr, 1)); break;
+			case 5: SetReg(rd, Load(addr, 2)); break;
+			default: Illegal(ins); return;
+			}
+		}
+		break;
+
+	// store
+	case 0x23:
+		{
+			u32 addr = a + ((imm & ~0x1f) | rd);
+			switch (f3)
+			{
+			case 0: Store(addr, b, 1); break;
+			case 1: Store(addr, b, 2); break;
+			case 2: Store(addr, b, 4); break;
+			default: Illegal(ins); return;
+			}
+		}
+		break;
+
+	// ALU with immediate
+	case 0x13:
+		switch (f3)
+		{
+		case 0: SetReg(rd, a + imm); break;
+		case 1: SetReg(rd, a << (imm & 0x1f)); break;
+		case 2: SetReg(rd, ((s32)a < imm) ? 1 : 0); break;
+		case 3: SetReg(rd, (a < (u32)imm) ? 1 : 0); break;
+		case 4: SetReg(rd, a ^ imm); break;
+		case 5: SetReg(rd, (f7 & 0x20) ? (u32)((s32)a >> (imm & 0x1f)) : (a >> (imm & 0x1f))); break;
+		case 6: SetReg(rd, a | imm); break;
+		default: SetReg(rd, a & imm); break;
+		}
+		break;
+
+	// ALU with registers
+	case 0x33:
+		if (f7 == 1)
+		{
+			// M extension
+			if ((f3 < 4) ? !Tim->mul : !Tim->div) { Illegal(ins); return; }
+			Cycles += (f3 < 4) ? Tim->mul_clk : Tim->div_clk;
+			SetReg(rd, MulDiv(f3, a, b));
+			break;
+		}
+		switch (f3)
+		{
+		case 0: SetReg(rd, (f7 & 0x20) ? (a - b) : (a + b)); break;
+		case 1: SetReg(rd, a << (b & 0x1f)); break;
+		case 2: SetReg(rd, ((s32)a < (s32)b) ? 1 : 0); break;
+		case 3: SetReg(rd, (a < b) ? 1 : 0); break;
+		case 4: SetReg(rd, a ^ b); break;
+		case 5: SetReg(rd, (f7 & 0x20) ? (u32)((s32)a >> (b & 0x1f)) : (a >> (b & 0x1f))); break;
+		case 6: SetReg(rd, a | b); break;
+		default: SetReg(rd, a & b); break;
+		}
+		break;
+
+	// FENCE
+	case 0x0f:
+		break;
+
+	// atomic operations
+	case 0x2f:
+		{
+			if (!Tim->atom || (f3 != 2)) { Illegal(ins); return; }
+			u32 f5 = f7 >> 2;
+			if (f5 == 2) { SetReg(rd, Load(a, 4)); break; } // lr.w
+			if (f5 == 3) { Store(a, b, 4); SetReg(rd, 0); break; } // sc.w (always succeeds)
+			u32 m = Load(a, 4);
+			u32 r;
+			switch (f5)
+			{
+			case 0x01: r = b; break; // amoswap
+			case 0x00: r = m + b; break; // amoadd
+			case 0x04: r = m ^ b; break; // amoxor
+			case 0x0C: r = m & b; break; // amoand
+			case 0x08: r = m | b; break; // amoor
+			case 0x10: r = ((s32)m < (s32)b) ? m : b; break; // amomin
+			case 0x14: r = ((s32)m > (s32)b) ? m : b; break; // amomax
+			case 0x18: r = (m < b) ? m : b; break; // amominu
+			case 0x1C: r = (m > b) ? m : b; break; // amomaxu
+			default: Illegal(ins); return;
+			}
+			Store(a, r, 4);
+			SetReg(rd, m);
+		}
+		break;
+
+	// system
+	case 0x73:
+		if (f3 == 0)
+		{
+			switch (ins)
+			{
+			case 0x00000073: // ecall
+				Pc = next;
+				TrapEnter(11, -1);
+				return;
+
+			case 0x00100073: // ebreak
+				Halt = True;
+				HaltMsg = "ebreak";
+				break;
+
+			case 0x30200073: // mret
+				TrapLeave();
+				return;
+
+			case 0x10500073: // wfi - skip time to next event
+				if (((IrqSwPend | IrqHwPend) & IrqEnable) == 0)
+				{
+					u32 n = PeriphNextEvent();
+					if (n == 0)
+					{
+						Halt = True;
+						HaltMsg = "wfi without wake-up event";
+					}
+					else
+					{
+						Cycles += n;
+						PeriphTime(n);
+					}
+				}
+				break;
+
+			default:
+				Illegal(ins);
+				return;
+			}
+		}
+		else
+		{
+			// CSR instructions
+			u32 csr = ins >> 20;
+			u32 src = (f3 & 4) ? rs1 : a;
+			u32 old = CsrRead(csr);
+			switch (f3 & 3)
+			{
+			case 1: CsrWrite(csr, src); break;
+			case 2: if (rs1 != 0) CsrWrite(csr, old | src); break;
+			case 3: if (rs1 != 0) CsrWrite(csr, old & ~src); break;
+			default: Illegal(ins); return;
+			}
+			SetReg(rd, old);
+		}
+		break;
+
+	default:
+		Illegal(ins);
+		return;
+	}
+	Pc = next;
+}
+
+// compressed register rd', rs1', rs2'
+#define RC(n) (8 + (n))
+
+// execute 16-bit compressed instruction
+void Exec16(u32 ins)
+{
+	u32 f3 = BITS(ins, 15, 13);
+	u32 next = Pc + 2;
+	u32 r1 = RC(BITS(ins, 9, 7));
+	u32 r2 = RC(BITS(ins, 4, 2));
+	u32 rd = BITS(ins, 11, 7);
+	u32 rs2 = BITS(ins, 6, 2);
+	s32 imm6 = Sext((BIT(ins, 12) << 5) | BITS(ins, 6, 2), 6);
+	u32 u;
+
+	switch (((ins & 3) << 3) | f3)
+	{
+	// ---- quadrant 0
+
+	// c.addi4spn
+	case 0x00:
+		u = (BITS(ins, 12, 11) << 4) | (BITS(ins, 10, 7) << 6) | (BIT(ins, 6) << 2) | (BIT(ins, 5) << 3);
+		if (u == 0) { Illegal(ins); return; }
+		SetReg(r2, Reg[2] + u);
+		break;
+
+	// c.lbu (XW)
+	case 0x01:
+		u = BIT(ins, 12) | (BIT(ins, 5) << 1) | (BIT(ins, 6) << 2) | (BITS(ins, 11, 10) << 3);
+		SetReg(r2, Load(Reg[r1] + u, 1));
+		break;
+
+	// c.lw
+	case 0x02:
+		u = (BITS(ins, 12, 10) << 3) | (BIT(ins, 6) << 2) | (BIT(ins, 5) << 6);
+		SetReg(r2, Load(Reg[r1] + u, 4));
+		break;
+
+	// c.lbusp, c.lhusp, c.sbsp, c.shsp (XW)
+	case 0x04:
+		if (BITS(ins, 12, 11) != 0) { Illegal(ins); return; }
+		if (BIT(ins, 5))
+			u = (BITS(ins, 10, 8) << 1) | (BIT(ins, 7) << 4);
+		else
+			u = BITS(ins, 10, 7);
+		if (BIT(ins, 6))
+			Store(Reg[2] + u, Reg[r2], BIT(ins, 5) ? 2 : 1);
+		else
+			SetReg(r2, Load(Reg[2] + u, BIT(ins, 5) ? 2 : 1));
+		break;
+
+	// c.sb (XW)
+	case 0x05:
+		u = BIT(ins, 12) | (BIT(ins, 5) << 1) | (BIT(ins, 6) << 2) | (BITS(ins, 11, 10) << 3);
+		Store(Reg[r1] + u, Reg[r2], 1);
+		break;
+
+	// c.sw
+	case 0x06:
+		u = (BITS(ins, 12, 10) << 3) | (BIT(ins, 6) << 2) | (BIT(ins, 5) << 6);
+		Store(Reg[r1] + u, Reg[r2], 4);
+		break;
+
+	// ---- quadrant 1
+
+	// c.addi, c.nop
+	case 0x08:
+		if (!RegOk(rd)) { Illegal(ins); return; }
+		SetReg(rd, Reg[rd] + imm6);
+		break;
+
+	// c.jal
+	case 0x09:
+	// c.j
+	case 0x0D:
+		{
+			s32 off = (BIT(ins, 12) << 11) | (BIT(ins, 11) << 4) | (BITS(ins, 10, 9) << 8) | (BIT(ins, 8) << 10)
+				| (BIT(ins, 7) << 6) | (BIT(ins, 6) << 7) | (BITS(ins, 5, 3) << 1) | (BIT(ins, 2) << 5);
+			Jump(Pc + Sext(off, 12), (f3 == 1) ? 1 : 0, next, False);
+		}
+		return;
+
+	// c.li
+	case 0x0A:
+		if (!RegOk(rd)) { Illegal(ins); return; }
+		SetReg(rd, imm6);
+		break;
+
+	// c.addi16sp, c.lui
+	case 0x0B:
+		if (!RegOk(rd)) { Illegal(ins); return; }
+		if (rd == 2)
+		{
+			s32 off = (BIT(ins, 12) << 9) | (BIT(ins, 6) << 4) | (BIT(ins, 5) << 6) | (BITS(ins, 4, 3) << 7) | (BIT(ins, 2) << 5);
+			SetReg(2, Reg[2] + Sext(off, 10));
+		}
+		else
+			SetReg(rd, (u32)imm6 << 12);
+		break;
+
+	// ALU
+	case 0x0C:
+		switch (BITS(ins, 11, 10))
+		{
+		case 0: SetReg(r1, Reg[r1] >> (imm6 & 0x1f)); break; // c.srli
+		case 1: SetReg(r1, (u32)((s32)Reg[r1] >> (imm6 & 0x1f))); break; // c.srai
+		case 2: SetReg(r1, Reg[r1] & imm6); break; // c.andi
+		default:
+			if (BIT(ins, 12)) { Illegal(ins); return; }
+			switch (BITS(ins, 6, 5))
+			{
+			case 0: SetReg(r1, Reg[r1] - Reg[r2]); break; // c.sub
+			case 1: SetReg(r1, Reg[r1] ^ Reg[r2]); break; // c.xor
+			case 2: SetReg(r1, Reg[r1] | Reg[r2]); break; // c.or
+			default: SetReg(r1, Reg[r1] & Reg[r2]); break; // c.and
+			}
+			break;
+		}
+		break;
+
+	// c.beqz, c.bnez
+	case 0x0E:
+	case 0x0F:
+		if ((Reg[r1] == 0) == (f3 == 6))
+		{
+			s32 off = (BIT(ins, 12) << 8) | (BITS(ins, 11, 10) << 3) | (BITS(ins, 6, 5) << 6) | (BITS(ins, 4, 3) << 1) | (BIT(ins, 2) << 5);
+			Jump(Pc + Sext(off, 9), 0, 0, False);
+			return;
+		}
+		break;
+
+	// ---- quadrant 2
+
+	// c.slli
+	case 0x10:
+		if (!RegOk(rd)) { Illegal(ins); return; }
+		SetReg(rd, Reg[rd] << (imm6 & 0x1f));
+		break;
+
+	// c.lhu (XW)
+	case 0x11:
+		u = (BIT(ins, 5) << 1) | (BIT(ins, 6) << 2) | (BITS(ins, 12, 10) << 3);
+		SetReg(r2, Load(Reg[r1] + u, 2));
+		break;
+
+	// c.lwsp
+	case 0x12:
+		if (!RegOk(rd) || (rd == 0)) { Illegal(ins); return; }
+		u = (BIT(ins, 12) << 5) | (BITS(ins, 6, 4) << 2) | (BITS(ins, 3, 2) << 6);
+		SetReg(rd, Load(Reg[2] + u, 4));
+		break;
+
+	// c.jr, c.mv, c.ebreak, c.jalr, c.add
+	case 0x14:
+		if (!RegOk(rd) || !RegOk(rs2)) { Illegal(ins); return; }
+		if (BIT(ins, 12) == 0)
+		{
+			if (rs2 == 0)
+			{
+				if (rd == 0) { Illegal(ins); return; }
+				Jump(Reg[rd] & ~1, 0, 0, (rd == 1) || (rd == 5)); // c.jr
+				return;
+			}
+			SetReg(rd, Reg[rs2]); // c.mv
+		}
+		else
+		{
+			if (rs2 == 0)
+			{
+				if (rd == 0)
+				{
+					Halt = True; // c.ebreak
+					HaltMsg = "ebreak";
+					break;
+				}
+				Jump(Reg[rd] & ~1, 1, next, False); // c.jalr
+				return;
+			}
+			SetReg(rd, Reg[rd] + Reg[rs2]); // c.add
+		}
+		break;
+
+	// c.sh (XW)
+	case 0x15:
+		u = (BIT(ins, 5) << 1) | (BIT(ins, 6) << 2) | (BITS(ins, 12, 10) << 3);
+		Store(Reg[r1] + u, Reg[r2], 2);
+		break;
+
+	// c.swsp
+	case 0x16:
+		if (!RegOk(rs2)) { Illegal(ins); return; }
+		u = (BITS(ins, 12, 9) << 2) | (BITS(ins, 8, 7) << 6);
+		Store(Reg[2] + u, Reg[rs2], 4);
+		break;
+
+	default:
+		Illegal(ins);
+		return;
+	}
+	Pc = next;
+}
+
+// execute one instruction
+void Step(void)
+{
+	u64 start = Cycles;
+	u32 pc = Pc;
+	int f = FuncFind(pc);
+	FuncCur = f;
+
+	// fetch instruction
+	u32 ins = Fetch16(pc);
+	if ((ins & 3) == 3) ins |= (u32)Fetch16(pc + 2) << 16;
+	if (Halt) return;
+	if (Trace) fprintf(stderr, "%10llu %08X: %08X  %s\n", (unsigned long long)Cycles, pc, ins, FuncName(pc));
+
+	// execute instruction (one cycle in execution stage)
+	Cycles++;
+	Instr++;
+	CallFlow = False;
+	if ((ins & 3) == 3)
+		Exec32(ins);
+	else
+		Exec16(ins);
+
+	// transfer to other function without call or return (tail call, jump, fall-through)
+	if (!CallFlow && !Halt)
+	{
+		int f2 = FuncFind(Pc);
+		if (f2 != f) CallTail(f, f2);
+	}
+
+	// instruction statistics
+	u32 clk = (u32)(Cycles - start);
+	if (f >= 0)
+	{
+		Func[f].self += clk;
+		Func[f].instr++;
+	}
+
+	// peripherals and interrupts
+	PeriphTime(clk);
+	if ((Csr[CSR_MSTATUS] & MSTATUS_MIE) != 0) IrqCheck();
+}
+
+// ----------------------------------------------------------------------------
+//                                 Report
+// ----------------------------------------------------------------------------
+
+// compare functions by self cycles (for qsort)
+int CompSelf(const void* a, const void* b)
+{
+	const sFunc* fa = *(const sFunc* const*)a;
+	const sFunc* fb = *(const sFunc* const*)b;
+	return (fa->self < fb->self) ? 1 : ((fa->self > fb->self) ? -1 : 0);
+}
+
+// print report
+void Report(int num)
+{
+	int i, n = 0;
+	u64 self = 0;
+	sFunc** list = (sFunc**)malloc(FuncNum * sizeof(sFunc*));
+
+	// close open calls
+	while (CallNum > 0) CallPop();
+
+	for (i = 0; i < FuncNum; i++)
+	{
+		if (Func[i].instr == 0) continue;
+
+		// code executed without frame (e.g. after lost frame on call stack overflow)
+		// is not included in inclusive time, but inclusive time cannot be less than self time
+		if (Func[i].incl < Func[i].self) Func[i].incl = Func[i].self;
+
+		list[n++] = &Func[i];
+		self += Func[i].self;
+	}
+	qsort(list, n, sizeof(sFunc*), CompSelf);
+
+	printf("\n---- stop: %s (PC=0x%08X %s)\n", HaltMsg, Pc, FuncName(Pc));
+	printf("core %s, flash wait states %d%s\n", Tim->name, FlashWait(), (WaitStates >= 0) ? " (forced)" : "");
+	printf("cycles %llu, instructions %llu, CPI %.3f, %.3f ms at 48 MHz\n",
+		(unsigned long long)Cycles, (unsigned long long)Instr,
+		(Instr > 0) ? (double)Cycles / Instr : 0.0, Cycles / 48000.0);
+	printf("interrupts %llu, USART1 bytes %llu, SPI1 bytes %llu, cycles outside symbols %llu\n",
+		(unsigned long long)IrqCount, (unsigned long long)UsartBytes, (unsigned long long)SpiBytes,
+		(unsigned long long)(Cycles - self));
+	if (MinSp != 0xffffffff) printf("min. stack pointer 0x%08X\n", MinSp);
+
+	printf("\n%12s %6s %12s %9s %10s %11s  %s\n", "self cyc", "self%", "incl cyc", "calls", "cyc/call", "instr", "function");
+	if ((num <= 0) || (num > n)) num = n;
+	for (i = 0; i < num; i++)
+	{
+		sFunc* f = list[i];
+		printf("%12llu %5.1f%% %12llu %9llu %10llu %11llu  %s\n",
+			(unsigned long long)f->self, (Cycles > 0) ? 100.0 * f->self / Cycles : 0.0,
+			(unsigned long long)f->incl, (unsigned long long)f->calls,
+			(unsigned long long)((f->calls > 0) ? (f->incl + f->calls/2) / f->calls : 0),
+			(unsigned long long)f->instr, f->name);
+	}
+
+	if (BenchFunc >= 0)
+	{
+		sFunc* f = &Func[BenchFunc];
+		printf("\nbenchmark %s: calls %llu, cycles min %llu, avg %llu, max %llu\n", f->name,
+			(unsigned long long)f->calls, (unsigned long long)f->min,
+			(unsigned long long)((f->calls > 0) ? (f->incl + f->calls/2) / f->calls : 0),
+			(unsigned long long)f->max);
+	}
+	free(list);
+}
+
+// ----------------------------------------------------------------------------
+//                                  Main
+// ----------------------------------------------------------------------------
+
+// print help
+void Help(void)
+{
+	fprintf(stderr,
+		"RV32EC/RV32EmC instruction set simulator\n"
+		"Usage: rvsim [options] Program.elf\n"
+		"  -m cpu   CPU core v2a (CH32V003, default), v2c (CH32V002/V006), v4 (RV32IMAC)\n"
+		"  -c num   stop after number of clock cycles (default 480000000)\n"
+		"  -w num   flash wait states (default: from FLASH->ACTLR)\n"
+		"  -f name  benchmark function: print min/avg/max cycles per call\n"
+		"  -e name  stop when function is called\n"
+		"  -n num   number of functions in the report (default 30, 0 = all)\n"
+		"  -q       do not print USART1 output\n"
+		"  -t       trace executed instructions to stderr\n");
+}
+
+int main(int argc, char* argv[])
+{
+	u64 maxclk = 480000000;
+	int num = 30;
+	const char* bench = NULL;
+	const char* stop = NULL;
+	const char* file = NULL;
+	int i;
+
+	// parse arguments
+	for (i = 1; i < argc; i++)
+	{
+		const char* a = argv[i];
+		if ((a[0] == '-') && (a[1] != 0) && (a[2] == 0) && (strchr("mcwfen", a[1]) != NULL))
+		{
+			if (i + 1 >= argc) { Help(); return 1; }
+			const char* v = argv[++i];
+			switch (a[1])
+			{
+			case 'm':
+				if (strcmp(v, "v2a") == 0) Tim = &TimingTab[CPU_V2A];
+				else if (strcmp(v, "v2c") == 0) Tim = &TimingTab[CPU_V2C];
+				else if (strcmp(v, "v4") == 0) Tim = &TimingTab[CPU_V4];
+				else { Help(); return 1; }
+				break;
+			case 'c': maxclk = strtoull(v, NULL, 0); break;
+			case 'w': WaitStates = atoi(v); break;
+			case 'f': bench = v; break;
+			case 'e': stop = v; break;
+			case 'n': num = atoi(v); break;
+			}
+		}
+		else if (strcmp(a, "-q") == 0)
+			UsartOut = False;
+		else if (strcmp(a, "-t") == 0)
+			Trace = True;
+		else if ((a[0] != '-') && (file == NULL))
+			file = a;
+		else
+		{
+			Help();
+			return 1;
+		}
+	}
+	if (file == NULL) { Help(); return 1; }
+
+	// load program
+	memset(SysFlash, 0xff, sizeof(SysFlash));
+	memset(Flash, 0xff, sizeof(Flash));
+	if (!LoadElf(file)) return 1;
+	if (bench != NULL)
+	{
+		BenchFunc = FuncFindName(bench);
+		if (BenchFunc < 0) { fprintf(stderr, "Function %s not found\n", bench); return 1; }
+	}
+	if (stop != NULL)
+	{
+		StopFunc = FuncFindName(stop);
+		if (StopFunc < 0) { fprintf(stderr, "Function %s not found\n", stop); return 1; }
+	}
+
+	// reset state: HSI on, machine mode
+	PERIPH32(RCC_BASE) = B0;
+	Csr[CSR_MSTATUS] = 0x1800;
+	CallEnter(Pc, 0xffffffff);
+
+	// run
+	HaltMsg = "cycle limit";
+	while (!Halt && (Cycles < maxclk)) Step();
+
+	Report(num);
+	return ExitCode;
+}
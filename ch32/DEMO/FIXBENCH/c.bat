@@ -0,0 +1,3 @@
+@echo off
+rem Compilation...
+..\..\..\_c1.bat
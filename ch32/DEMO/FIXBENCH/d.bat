@@ -0,0 +1,3 @@
+@echo off
+rem Delete...
+..\..\..\_d1.bat
@@ -0,0 +1,3 @@
+@echo off
+rem Export to hardware...
+..\..\..\_e1.bat
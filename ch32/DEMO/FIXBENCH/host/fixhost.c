@@ -0,0 +1,125 @@
+// Host test and benchmark of fixed-point library lib_fix against float and libm.
+// Compile on Linux: gcc -O2 -o fixhost fixhost.c -lm
+// Run: ./fixhost
+
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+// base types (see global.h)
+typedef int8_t s8;
+typedef uint8_t u8;
+typedef int16_t s16;
+typedef uint16_t u16;
+typedef int32_t s32;
+typedef uint32_t u32;
+typedef int64_t s64;
+typedef uint64_t u64;
+typedef unsigned char Bool;
+#define True 1
+#define False 0
+#define INLINE static inline
+#define NOINLINE __attribute__((noinline))
+#define ALIGNED __attribute__((aligned(4)))
+#define count_of(a) (sizeof(a)/sizeof((a)[0]))
+#define B14 (1U<<14)
+#define B18 (1UL<<18)
+#define B30 (1UL<<30)
+#define B31 (1UL<<31)
+
+// use only lib_fix module, skip SDK and devices
+#define _GLOBAL_H
+#define _SDK_INCLUDE_H
+#define _LIB_INCLUDE_H
+#define _FONT_INCLUDE_H
+#define USE_FIX 1
+
+#include "../../../../_lib/inc/lib_fix.h"
+#include "../../../../_lib/src/lib_fix.c"
+
+#define LOOPS 10000000
+
+volatile u32 Sink;
+
+// get time in [ns]
+static double Now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec*1e9 + ts.tv_nsec;
+}
+
+#define BENCH(name, expr) do { double t = Now(); u32 acc = 0; int i;		\
+	for (i = 0; i < LOOPS; i++) { acc += (u32)(expr); } Sink = acc;		\
+	printf("  %-28s %6.2f ns\n", name, (Now() - t)/LOOPS); } while (0)
+
+int main(void)
+{
+	int i;
+	double err, maxerr;
+
+	// self-check
+	printf("FixCheck: %s\n", FixCheck() ? "OK" : "ERROR");
+
+	// accuracy
+	maxerr = 0;
+	for (i = 0; i < 0x10000; i++)
+	{
+		err = fabs(FixSin((u16)i)/65536.0 - sin(i*2*M_PI/65536));
+		if (err > maxerr) maxerr = err;
+	}
+	printf("FixSin max. error: %.7f (%.2f LSB)\n", maxerr, maxerr*65536);
+
+	maxerr = 0;
+	for (i = 0; i < 0x10000; i++)
+	{
+		err = fabs(FixSinFast((u16)i)/65536.0 - sin(i*2*M_PI/65536));
+		if (err > maxerr) maxerr = err;
+	}
+	printf("FixSinFast max. error: %.7f\n", maxerr);
+
+	maxerr = 0;
+	for (i = 0; i < 0x10000; i += 7)
+	{
+		double a = i*2*M_PI/65536;
+		s32 x = (s32)(cos(a)*1000000), y = (s32)(sin(a)*1000000);
+		double d = (s16)(u16)(FixAtan2(y, x) - (u16)i) * 360.0/65536;
+		if (fabs(d) > maxerr) maxerr = fabs(d);
+	}
+	printf("FixAtan2 max. error: %.4f deg\n", maxerr);
+
+	maxerr = 0;
+	for (i = 1; i < 0x7fffffff - 7919*3; i += 7919*3)
+	{
+		err = fabs(FixSqrt(i)/65536.0 - sqrt(i/65536.0));
+		if (err > maxerr) maxerr = err;
+	}
+	printf("FixSqrt max. error: %.7f (%.2f LSB)\n", maxerr, maxerr*65536);
+
+	for (i = 0; i < 0x10000; i++)
+	{
+		int d;
+		for (d = 1; d < 256; d += 3) if (DivU16U8((u16)i, (u8)d) != i/d) { printf("DivU16U8 ERROR %d/%d\n", i, d); return 1; }
+	}
+	printf("DivU16U8 exact: OK\n");
+
+	// speed on host (relative only; use FIXBENCH on target to get real cycles)
+	printf("Host speed per operation:\n");
+	volatile float fa = 1.2345f, fb = 0.987f;
+	volatile fix16 xa = FIX16(1.2345), xb = FIX16(0.987);
+	BENCH("float mul", (s32)(fa*fb*65536));
+	BENCH("FixMul", FixMul(xa, xb));
+	BENCH("float div", (s32)(fa/fb*65536));
+	BENCH("FixDiv", FixDiv(xa, xb));
+	BENCH("sinf", (s32)(sinf((float)i*0.0001f)*65536));
+	BENCH("FixSin", FixSin((u16)i));
+	BENCH("sqrtf", (s32)(sqrtf((float)i)*65536));
+	BENCH("FixSqrt", FixSqrt(i));
+	BENCH("atan2f", (s32)(atan2f((float)(i & 0xff), 100.0f)*65536));
+	BENCH("FixAtan2", FixAtan2(i & 0xff, 100));
+	BENCH("u16 / u8 division", (u16)i / (u8)(i | 1));
+	BENCH("DivU16U8", DivU16U8((u16)i, (u8)(i | 1)));
+
+	return 0;
+}
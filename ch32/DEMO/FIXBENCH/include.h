@@ -0,0 +1,10 @@
+
+// ****************************************************************************
+//                                 
+//                              Includes
+//
+// ****************************************************************************
+
+#include INCLUDES_H		// all includes
+
+#include "src/main.h"		// main code
@@ -0,0 +1,6 @@
+@echo off
+rem All Re-Compilation...
+cd ..
+call a.bat
+cd src
+
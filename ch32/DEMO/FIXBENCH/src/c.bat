@@ -0,0 +1,6 @@
+@echo off
+rem Compilation...
+cd ..
+call c.bat
+cd src
+
@@ -0,0 +1,5 @@
+@echo off
+rem Delete...
+cd ..
+call d.bat
+cd src
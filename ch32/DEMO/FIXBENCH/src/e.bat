@@ -0,0 +1,5 @@
+@echo off
+rem Export to hardware...
+cd ..
+call e.bat
+cd src
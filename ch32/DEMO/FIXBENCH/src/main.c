@@ -0,0 +1,91 @@
+// Fixed-point math benchmark: compares lib_fix functions with soft-float
+// and libgcc integer division. Results in CPU clock cycles per operation
+// are sent to USART1 (PD5:TX, 115200 Baud, 8 bits, no parity, 1 stop bit).
+
+#include "../include.h"
+
+#define LOOPS	256		// number of loops of one test
+
+// input values in volatile variables, so that compiler cannot pre-calculate results
+volatile float FA = 1.2345f;
+volatile float FB = 0.987f;
+volatile fix16 XA = FIX16(1.2345);
+volatile fix16 XB = FIX16(0.987);
+volatile int IA = 12345;
+volatile int IB = 37;
+volatile u32 Sink;		// result sink
+
+u32 LoopClk;			// clock cycles of empty loop
+
+// send result of one test
+void Report(const char* name, u32 clk)
+{
+	char buf[16];
+	clk = (clk + LOOPS/2)/LOOPS;
+	if (clk > LoopClk) clk -= LoopClk; else clk = 0;
+	USART1_SendText(name);
+	DecUNum(buf, clk, 0);
+	USART1_SendText(buf);
+	USART1_SendText(" clk\r\n");
+}
+
+// float sine, polynomial of 7th order (typical soft-float replacement of sinf())
+float FloatSin(float x)
+{
+	float x2 = x*x;
+	return x*(1.0f - x2*(1.0f/6 - x2*(1.0f/120 - x2*(1.0f/5040))));
+}
+
+// float square root, Newton iterations
+float FloatSqrt(float x)
+{
+	float r = x;
+	int i;
+	if (x <= 0) return 0;
+	for (i = 0; i < 8; i++) r = 0.5f*(r + x/r);
+	return r;
+}
+
+#define BENCH(name, expr) do { u32 t = Time(); u32 acc = 0; int i;		\
+	for (i = 0; i < LOOPS; i++) { acc += (u32)(expr); } Sink = acc;		\
+	Report(name, Time() - t); } while (0)
+
+int main(void)
+{
+	// setup USART1 mapping 0
+	GPIO_Remap_USART1(0);
+	USART1_Init(115200, USART_WORDLEN_8, USART_PARITY_NONE, USART_STOP_1);
+	GPIO_Mode(PD5, GPIO_MODE_AF);		// TX
+
+	while(True)
+	{
+		WaitMs(1000);
+		USART1_SendText(FixCheck() ? "\r\nFixCheck OK\r\n" : "\r\nFixCheck ERROR\r\n");
+
+		// empty loop
+		LoopClk = 0;
+		{ u32 t = Time(); u32 acc = 0; int i;
+		for (i = 0; i < LOOPS; i++) { acc += XA; } Sink = acc;
+		LoopClk = (Time() - t + LOOPS/2)/LOOPS; }
+
+		// arithmetics (float versions as used by Tiny-Bike_float.c)
+		BENCH("float add:  ", (s32)(FA + FB));
+		BENCH("fix16 add:  ", XA + XB);
+		BENCH("float mul:  ", (s32)(FA * FB));
+		BENCH("FixMul:     ", FixMul(XA, XB));
+		BENCH("Fix8Mul:    ", Fix8Mul((fix8)XA, (fix8)XB));
+		BENCH("float div:  ", (s32)(FA / FB));
+		BENCH("FixDiv:     ", FixDiv(XA, XB));
+		BENCH("int div:    ", (u16)IA / (u8)IB);
+		BENCH("DivU16U8:   ", DivU16U8((u16)IA, (u8)IB));
+
+		// functions
+		BENCH("float sin:  ", (s32)(FloatSin(FA)*65536));
+		BENCH("FixSin:     ", FixSin((u16)(XA + i)));
+		BENCH("FixSinFast: ", FixSinFast((u16)(XA + i)));
+		BENCH("float sqrt: ", (s32)FloatSqrt(FA));
+		BENCH("FixSqrt:    ", FixSqrt(XA + i));
+		BENCH("ISqrt:      ", ISqrt(IA + i));
+		BENCH("FixAtan2:   ", FixAtan2(IB + i, IA));
+	}
+}
@@ -0,0 +1,5 @@
+@echo off
+rem Reset device...
+cd ..
+call r.bat
+cd src
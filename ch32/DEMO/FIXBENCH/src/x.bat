@@ -0,0 +1,6 @@
+@echo off
+rem Rebuild and write...
+cd ..
+call x.bat
+cd src
+
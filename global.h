@@ -27,7 +27,11 @@
 #define NOINLINE __attribute__((noinline))
 
 // Interrupt handler
+#if USE_HOST
+#define HANDLER
+#else
 #define HANDLER __attribute__((interrupt("WCH-Interrupt-fast")))
+#endif
 
 // weak function
 #define WEAK __attribute__((weak))
@@ -39,7 +43,11 @@
 #define PACKED __attribute__ ((packed))
 
 // place time critical function into RAM
+#if USE_HOST
+#define NOFLASH(fnc) NOINLINE fnc
+#else
 #define NOFLASH(fnc) NOINLINE __attribute__((section(".time_critical." #fnc))) fnc
+#endif
 
 // forbidden to replace the "for" loop with the "memset" function
 #define NOMEMSET __attribute__((optimize("no-tree-loop-distribute-patterns")))
@@ -75,6 +83,18 @@
 // change endian of u16 (little endian LSB MSB = Intel, big endian MSB LSB = Motorola)
 #define ENDIAN16(k) ( (((k)>>8)&0xff) | (((k)&0xff)<<8) )
 
+// give time to emulated interrupts in a polling loop (only in host emulation, no code on the device)
+#if USE_HOST
+#ifdef __cplusplus
+extern "C" void HostPoll(void);
+#else
+void HostPoll(void);
+#endif
+#define HOST_POLL() HostPoll()
+#else
+#define HOST_POLL()
+#endif
+
 // ----------------------------------------------------------------------------
 //                              Base data types
 // ----------------------------------------------------------------------------
@@ -96,8 +116,13 @@ typedef signed char s8;
 typedef unsigned char u8;
 typedef signed short s16;		// on 8-bit system use "signed int"
 typedef unsigned short u16;		// on 8-bit system use "unsigned int"
+#ifdef __LP64__
+typedef signed int s32;			// 64-bit system (host emulation)
+typedef unsigned int u32;
+#else
 typedef signed long int s32;		// on 64-bit system use "signed int"
 typedef unsigned long int u32;		// on 64-bit system use "unsigned int"
+#endif
 typedef signed long long int s64;
 typedef unsigned long long int u64;
 
@@ -236,6 +261,16 @@ STATIC_ASSERT(sizeof(u64) == 8, "Incorrect typedef u64!");
 #include "_devices/tinyboy/_config.h"
 #endif
 
+// host emulation: SD card, FAT filesystem and screen shots are not emulated
+#if USE_HOST
+#undef USE_SD
+#define USE_SD		0
+#undef USE_FAT
+#define USE_FAT		0
+#undef USE_SCREENSHOT
+#define USE_SCREENSHOT	0
+#endif
+
 #include <string.h>		// memcpy
 #include <stdarg.h>		// va_list
 #include <math.h>		// HUGE_VAL
@@ -248,6 +283,14 @@ STATIC_ASSERT(sizeof(u64) == 8, "Incorrect typedef u64!");
 #define USE_CRC		1	// 1=use CRC library
 #endif
 
+#ifndef USE_CRC_HW
+#if (CH32V2 || CH32V3) && !USE_HOST
+#define USE_CRC_HW	1	// 1=use hardware CRC unit for CRC-32 (CH32V2, CH32V3)
+#else
+#define USE_CRC_HW	0	// 1=use hardware CRC unit for CRC-32 (CH32V2, CH32V3)
+#endif
+#endif
+
 #ifndef USE_DECNUM
 #define USE_DECNUM	1	// 1=use decode number
 #endif
@@ -256,6 +299,14 @@ STATIC_ASSERT(sizeof(u64) == 8, "Incorrect typedef u64!");
 #define USE_FAT		0	// 1=use FAT filesystem
 #endif
 
+#ifndef USE_FIX
+#define USE_FIX		1	// 1=use fixed-point math library
+#endif
+
+#ifndef USE_KVS
+#define USE_KVS		0	// 1=use key/value store in Flash (requires USE_FLASH and USE_CRC)
+#endif
+
 #ifndef USE_RAND
 #define USE_RAND	1	// 1=use random number generator
 #endif
@@ -272,10 +323,18 @@ STATIC_ASSERT(sizeof(u64) == 8, "Incorrect typedef u64!");
 #define USE_ADC		1	// 1=use ADC peripheral
 #endif
 
+#ifndef USE_ADCSCAN
+#define USE_ADCSCAN	0	// 1=use continuous ADC scanning with DMA and oversampling (requires USE_ADC and USE_DMA)
+#endif
+
 #ifndef USE_DMA
 #define USE_DMA		1	// 1=use DMA peripheral
 #endif
 
+#ifndef USE_DMAQ
+#define USE_DMAQ	0	// 1=use asynchronous DMA memory copy and fill (requires USE_DMA)
+#endif
+
 #ifndef USE_FLASH
 #define USE_FLASH	1	// 1=use Flash programming
 #endif
@@ -284,6 +343,10 @@ STATIC_ASSERT(sizeof(u64) == 8, "Incorrect typedef u64!");
 #define USE_I2C		1	// 1=use I2C peripheral
 #endif
 
+#ifndef USE_I2CQ
+#define USE_I2CQ	0	// 1=use interrupt driven I2C master with transaction queue (requires USE_I2C)
+#endif
+
 #ifndef USE_IRQ
 #define USE_IRQ		1	// 1=use IRQ interrupt support
 #endif
@@ -292,10 +355,34 @@ STATIC_ASSERT(sizeof(u64) == 8, "Incorrect typedef u64!");
 #define USE_PWR		1	// 1=use power control
 #endif
 
+#ifndef USE_PROF
+#define USE_PROF	0	// 1=use sampling PC profiler (requires USE_TIM and USE_USART)
+#endif
+
+#ifndef USE_RCCSPEED
+#define USE_RCCSPEED	0	// 1=use run-time change of system clock RCC_SetSpeed() (CH32V0)
+#endif
+
 #ifndef USE_SPI
 #define USE_SPI		1	// 1=use SPI peripheral
 #endif
 
+#ifndef USE_SPIDMA
+#define USE_SPIDMA	0	// 1=use SPI DMA transfer (requires USE_SPI and USE_DMA)
+#endif
+
+#ifndef USE_SWTIMER
+#define USE_SWTIMER	0	// 1=use software timers (timer wheel)
+#endif
+
+#ifndef USE_TASK
+#define USE_TASK	0	// 1=use cooperative task scheduler
+#endif
+
+#ifndef USE_TASK_STACK
+#define USE_TASK_STACK	0	// 1=use tasks with own stack (requires USE_TASK; for CH32V2, CH32V3)
+#endif
+
 #ifndef USE_TIM
 #define USE_TIM		1	// 1=use timers
 #endif
@@ -304,4 +391,19 @@ STATIC_ASSERT(sizeof(u64) == 8, "Incorrect typedef u64!");
 #define USE_USART	1	// 1=use USART peripheral
 #endif
 
+#ifndef USE_USARTBUF
+#define USE_USARTBUF	0	// 1=use buffered USART driver with DMA ring buffers (requires USE_USART and USE_DMA)
+#endif
+
+#ifndef USE_HOST
+#define USE_HOST	0	// 1=host emulation build (set by "make host")
+#endif
+
+// run-time change of system clock: number of HCLK clock cycles per 1 us is a variable
+#if USE_RCCSPEED && !USE_HOST
+extern u32 RCC_HclkPerUs;	// number of HCLK clock cycles per 1 us (updated by RCC_UpdateFreq())
+#undef HCLK_PER_US
+#define HCLK_PER_US	RCC_HclkPerUs
+#endif
+
 #endif // _GLOBAL_H